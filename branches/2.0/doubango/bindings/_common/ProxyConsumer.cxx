@@ -240,6 +240,7 @@ m_pWrappedPlugin(pConsumer),
 m_pCallback(tsk_null)
 {
 	memset(&m_PullBuffer, 0, sizeof(m_PullBuffer));
+	m_PullBuffer.nLastSlotIndex = -1;
 	memset(&m_Resampler, 0, sizeof(m_Resampler));
 
 	if(m_pWrappedPlugin){
@@ -304,8 +305,16 @@ bail:
 
 bool ProxyAudioConsumer::setPullBuffer(const void* pPullBufferPtr, unsigned nPullBufferSize)
 {
-	m_PullBuffer.pPullBufferPtr = pPullBufferPtr;
-	m_PullBuffer.nPullBufferSize = nPullBufferSize;
+	return setPullRing(pPullBufferPtr, nPullBufferSize, 1);
+}
+
+bool ProxyAudioConsumer::setPullRing(const void* pRingPtr, unsigned nSlotSize, unsigned nSlotCount)
+{
+	m_PullBuffer.pPullBufferPtr = pRingPtr;
+	m_PullBuffer.nPullBufferSize = nSlotSize;
+	m_PullBuffer.nSlotCount = (pRingPtr && nSlotSize) ? TSK_MAX(nSlotCount, 1) : 0;
+	m_PullBuffer.nSlotIndex = 0;
+	m_PullBuffer.nLastSlotIndex = -1;
 	return true;
 }
 
@@ -314,11 +323,17 @@ unsigned ProxyAudioConsumer::pull(void* _pOutput/*=tsk_null*/, unsigned _nSize/*
 	if((m_pWrappedPlugin = (twrap_consumer_proxy_audio_t*)tsk_object_ref(m_pWrappedPlugin))){
 		void* pOutput;
 		unsigned nSize;
+		bool bToRing = false;
 		if(_pOutput && _nSize){
 			pOutput = _pOutput, nSize = _nSize;
 		}
+		else if(m_PullBuffer.nSlotCount){
+			// write directly into the application's ring
+			pOutput = ((uint8_t*)m_PullBuffer.pPullBufferPtr) + (m_PullBuffer.nSlotIndex * m_PullBuffer.nPullBufferSize), nSize = m_PullBuffer.nPullBufferSize;
+			bToRing = true;
+		}
 		else{
-			pOutput = (void*)m_PullBuffer.pPullBufferPtr, nSize = m_PullBuffer.nPullBufferSize;
+			pOutput = tsk_null, nSize = 0;
 		}
 
 		tsk_size_t nRetSize = 0;
@@ -335,6 +350,11 @@ unsigned ProxyAudioConsumer::pull(void* _pOutput/*=tsk_null*/, unsigned _nSize/*
 
 		tdav_consumer_audio_tick(TDAV_CONSUMER_AUDIO(m_pWrappedPlugin));
 
+		if(bToRing && nRetSize){
+			m_PullBuffer.nLastSlotIndex = (int)m_PullBuffer.nSlotIndex;
+			m_PullBuffer.nSlotIndex = (m_PullBuffer.nSlotIndex + 1) % m_PullBuffer.nSlotCount;
+		}
+
 		m_pWrappedPlugin = (twrap_consumer_proxy_audio_t*)tsk_object_unref(m_pWrappedPlugin);
 		return nRetSize;
 	}
@@ -492,13 +512,13 @@ int twrap_consumer_proxy_video_consume(tmedia_consumer_t* self, const void* buff
 		}
 		else{
 			if(video->pcConsumer->hasConsumeBuffer()){
-				unsigned nCopiedSize = video->pcConsumer->copyBuffer(buffer, size); 
+				unsigned nCopiedSize = const_cast<ProxyVideoConsumer*>(video->pcConsumer)->copyBuffer(buffer, size); 
 				ret = callback->bufferCopied(nCopiedSize, size);
 			}
 			else{
-				ProxyVideoFrame* frame = new ProxyVideoFrame(buffer, size, const_cast<ProxyVideoConsumer*>(video->pcConsumer)->getDecodedWidth(), const_cast<ProxyVideoConsumer*>(video->pcConsumer)->getDecodedHeight(), proto_hdr);
-				ret = callback->consume(frame);
-				delete frame, frame = tsk_null;
+				// the frame only references the decoded buffer (no copy) and is valid until consume() returns
+				const ProxyVideoFrame frame(buffer, size, const_cast<ProxyVideoConsumer*>(video->pcConsumer)->getDecodedWidth(), const_cast<ProxyVideoConsumer*>(video->pcConsumer)->getDecodedHeight(), proto_hdr);
+				ret = callback->consume(&frame);
 			}
 		}
 	}
@@ -628,8 +648,8 @@ m_pCallback(tsk_null),
 ProxyPlugin(twrap_proxy_plugin_video_consumer)
 {
 	m_pWrappedPlugin->id = this->getId();
-	m_ConsumeBuffer.pConsumeBufferPtr = tsk_null;
-	m_ConsumeBuffer.nConsumeBufferSize = 0;
+	memset(&m_ConsumeBuffer, 0, sizeof(m_ConsumeBuffer));
+	m_ConsumeBuffer.nLastSlotIndex = -1;
 }
 
 ProxyVideoConsumer::~ProxyVideoConsumer()
@@ -723,17 +743,28 @@ bool ProxyVideoConsumer::getAutoResizeDisplay()const
 
 bool ProxyVideoConsumer::setConsumeBuffer(const void* pConsumeBufferPtr, unsigned nConsumeBufferSize)
 {
-	m_ConsumeBuffer.pConsumeBufferPtr = pConsumeBufferPtr;
-	m_ConsumeBuffer.nConsumeBufferSize = nConsumeBufferSize;
+	return setConsumeRing(pConsumeBufferPtr, nConsumeBufferSize, 1);
+}
+
+bool ProxyVideoConsumer::setConsumeRing(const void* pRingPtr, unsigned nSlotSize, unsigned nSlotCount)
+{
+	m_ConsumeBuffer.pConsumeBufferPtr = pRingPtr;
+	m_ConsumeBuffer.nConsumeBufferSize = nSlotSize;
+	m_ConsumeBuffer.nSlotCount = (pRingPtr && nSlotSize) ? TSK_MAX(nSlotCount, 1) : 0;
+	m_ConsumeBuffer.nSlotIndex = 0;
+	m_ConsumeBuffer.nLastSlotIndex = -1;
 	return true;
 }
 
-unsigned ProxyVideoConsumer::copyBuffer(const void* pBuffer, unsigned nSize)const
+// called by the decoder thread only: the slot index is updated before "bufferCopied()" is raised
+unsigned ProxyVideoConsumer::copyBuffer(const void* pBuffer, unsigned nSize)
 {
 	unsigned nRetsize = 0;
-	if(pBuffer && nSize && m_ConsumeBuffer.pConsumeBufferPtr && m_ConsumeBuffer.nConsumeBufferSize){
+	if(pBuffer && nSize && m_ConsumeBuffer.pConsumeBufferPtr && m_ConsumeBuffer.nConsumeBufferSize && m_ConsumeBuffer.nSlotCount){
 		nRetsize = (nSize > m_ConsumeBuffer.nConsumeBufferSize) ? m_ConsumeBuffer.nConsumeBufferSize : nSize;
-		memcpy((void*)m_ConsumeBuffer.pConsumeBufferPtr, pBuffer, nRetsize);
+		memcpy(((uint8_t*)m_ConsumeBuffer.pConsumeBufferPtr) + (m_ConsumeBuffer.nSlotIndex * m_ConsumeBuffer.nConsumeBufferSize), pBuffer, nRetsize);
+		m_ConsumeBuffer.nLastSlotIndex = (int)m_ConsumeBuffer.nSlotIndex;
+		m_ConsumeBuffer.nSlotIndex = (m_ConsumeBuffer.nSlotIndex + 1) % m_ConsumeBuffer.nSlotCount;
 	}
 	return nRetsize;
 }
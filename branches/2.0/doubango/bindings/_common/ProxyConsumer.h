@@ -69,6 +69,11 @@ public:
 	bool setActualSndCardPlaybackParams(int nPtime, int nRate, int nChannels);
 	bool queryForResampler(uint16_t nInFreq, uint16_t nOutFreq, uint16_t nFrameDuration, uint16_t nChannels, uint16_t nResamplerQuality);
 	bool setPullBuffer(const void* pPullBufferPtr, unsigned nPullBufferSize);
+	// "nSlotCount" contiguous slots of "nSlotSize" bytes each: every "pull()" without output writes into the next slot
+	// which stays valid (no need to copy it) until the ring wraps
+	bool setPullRing(const void* pRingPtr, unsigned nSlotSize, unsigned nSlotCount);
+	// slot written by the last "pull()" into the registered buffer/ring, -1 if none
+	int getPullSlotIndex()const { return m_PullBuffer.nLastSlotIndex; }
 	unsigned pull(void* pOutput=tsk_null, unsigned nSize=0);
 	bool setGain(unsigned nGain);
 	unsigned getGain();
@@ -92,7 +97,10 @@ private:
 	ProxyAudioConsumerCallback* m_pCallback;
 	struct{
 		const void* pPullBufferPtr;
-		unsigned nPullBufferSize;
+		unsigned nPullBufferSize; // size of a slot
+		unsigned nSlotCount;
+		unsigned nSlotIndex; // next slot to write
+		int nLastSlotIndex;
 	} m_PullBuffer;
 
 	struct{
@@ -113,7 +121,8 @@ public:
 
 	virtual int prepare(int nWidth, int nHeight, int nFps) { return -1; }
 	virtual int consume(const ProxyVideoFrame* frame) { return -1; }
-	// only called if a buffer is registered using setPullBuffer(). Otherwise, consume() will be called
+	// only called if a buffer is registered using setConsumeBuffer() or setConsumeRing(). Otherwise, consume() will be called
+	// use "ProxyVideoConsumer::getConsumeSlotIndex()" to know which slot of the ring holds the frame
 	virtual int bufferCopied(unsigned nCopiedSize, unsigned nAvailableSize) { return -1; }
 	virtual int start() { return -1; }
 	virtual int pause() { return -1; }
@@ -139,12 +148,17 @@ public:
 	bool setAutoResizeDisplay(bool bAutoResizeDisplay);
 	bool getAutoResizeDisplay()const;
 	bool setConsumeBuffer(const void* pConsumeBufferPtr, unsigned nConsumeBufferSize);
+	// "nSlotCount" contiguous slots of "nSlotSize" bytes each: every decoded frame is copied into the next slot which
+	// stays valid (no need to copy it to record or forward the frame) until the ring wraps
+	bool setConsumeRing(const void* pRingPtr, unsigned nSlotSize, unsigned nSlotCount);
+	// slot holding the frame notified by the last "bufferCopied()", -1 if none
+	int getConsumeSlotIndex()const { return m_ConsumeBuffer.nLastSlotIndex; }
 	unsigned pull(void* pOutput, unsigned nSize);
 	bool reset();
 	
 #if !defined(SWIG)
 	bool hasConsumeBuffer()const { return m_ConsumeBuffer.pConsumeBufferPtr && m_ConsumeBuffer.nConsumeBufferSize; }
-	unsigned copyBuffer(const void* pBuffer, unsigned nSize)const;
+	unsigned copyBuffer(const void* pBuffer, unsigned nSize);
 	inline ProxyVideoConsumerCallback* getCallback()const { return m_pCallback; }
 	virtual inline bool isWrapping(tsk_object_t* wrapped_plugin){
 		return m_pWrappedPlugin == wrapped_plugin;
@@ -171,7 +185,10 @@ private:
 	ProxyVideoConsumerCallback* m_pCallback;
 	struct{
 		const void* pConsumeBufferPtr;
-		unsigned nConsumeBufferSize;
+		unsigned nConsumeBufferSize; // size of a slot
+		unsigned nSlotCount;
+		unsigned nSlotIndex; // next slot to write
+		int nLastSlotIndex;
 	} m_ConsumeBuffer;
 	bool m_bAutoResizeDisplay;
 
@@ -0,0 +1,49 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+* Copyright (C) 2015 Doubango Telecom.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_audio_dsp.h
+ * @brief Audio DSP kernels (gain, mixing, format conversion, levels) on 16-bit PCM samples.
+ * The best implementation for the CPU (AVX2, SSE2, NEON or portable C) is selected by @ref tdav_audio_dsp_init.
+ */
+#ifndef TINYDAV_AUDIO_DSP_H
+#define TINYDAV_AUDIO_DSP_H
+
+#include "tinydav_config.h"
+
+#include "tsk_common.h"
+
+TDAV_BEGIN_DECLS
+
+int tdav_audio_dsp_init();
+int tdav_audio_dsp_select(const char* name);
+const char* tdav_audio_dsp_get_name();
+
+void tdav_audio_dsp_gain_s16(int16_t* samples, tsk_size_t count, int32_t shift);
+void tdav_audio_dsp_mix_s16(int16_t* dst, const int16_t* src, tsk_size_t count);
+void tdav_audio_dsp_s16_to_float(float* dst, const int16_t* src, tsk_size_t count);
+void tdav_audio_dsp_float_to_s16(int16_t* dst, const float* src, tsk_size_t count);
+void tdav_audio_dsp_interleave_s16(int16_t* dst, const int16_t* left, const int16_t* right, tsk_size_t count);
+void tdav_audio_dsp_deinterleave_s16(int16_t* left, int16_t* right, const int16_t* src, tsk_size_t count);
+void tdav_audio_dsp_level_s16(const int16_t* samples, tsk_size_t count, int32_t* peak, int32_t* rms);
+
+TDAV_END_DECLS
+
+#endif /* TINYDAV_AUDIO_DSP_H */
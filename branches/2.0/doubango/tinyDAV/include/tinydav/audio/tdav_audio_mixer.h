@@ -0,0 +1,50 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+* Copyright (C) 2015 Doubango Telecom.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_audio_mixer.h
+ * @brief N-way audio conference mixer. Each participant (an audio session) hears the mix of the loudest speakers but itself.
+ */
+#ifndef TINYDAV_AUDIO_MIXER_H
+#define TINYDAV_AUDIO_MIXER_H
+
+#include "tinydav_config.h"
+
+#include "tsk_common.h"
+
+TDAV_BEGIN_DECLS
+
+#define TDAV_AUDIO_MIXER_PTIME				20 /* milliseconds */
+#define TDAV_AUDIO_MIXER_SPEAKERS_MAX_DEFAULT	3 /* number of participants mixed at the same time */
+
+struct tdav_audio_mixer_s;
+struct tmedia_session_s;
+
+struct tdav_audio_mixer_s* tdav_audio_mixer_create(uint32_t rate, tsk_size_t speakers_max);
+int tdav_audio_mixer_start(struct tdav_audio_mixer_s* self);
+int tdav_audio_mixer_attach(struct tdav_audio_mixer_s* self, struct tmedia_session_s* session);
+int tdav_audio_mixer_detach(struct tdav_audio_mixer_s* self, uint64_t session_id);
+int tdav_audio_mixer_set_gain(struct tdav_audio_mixer_s* self, uint64_t session_id, int32_t gain_percent);
+uint64_t tdav_audio_mixer_get_active_speaker(struct tdav_audio_mixer_s* self);
+int tdav_audio_mixer_stop(struct tdav_audio_mixer_s* self);
+
+TDAV_END_DECLS
+
+#endif /* TINYDAV_AUDIO_MIXER_H */
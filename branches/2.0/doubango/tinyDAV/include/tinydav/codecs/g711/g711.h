@@ -39,6 +39,12 @@ short alaw2linear(unsigned char	a_val);
 unsigned char linear2ulaw(short	pcm_val);
 short ulaw2linear(unsigned char	u_val);
 
+void g711_init_tables();
+void g711_ulaw_encode(unsigned char* out, const short* amp, int len);
+void g711_alaw_encode(unsigned char* out, const short* amp, int len);
+void g711_ulaw_decode(short* amp, const unsigned char* in, int len);
+void g711_alaw_decode(short* amp, const unsigned char* in, int len);
+
 TDAV_END_DECLS
 
 #endif /* TINYDAV_CODEC_G711_IMPLEMENTATION_H */
@@ -67,8 +67,10 @@ typedef struct
     /*! 6 for 48000kbps, 7 for 56000kbps, or 8 for 64000kbps. */
     int bits_per_sample;
 
-    /*! Signal history for the QMF */
-    int x[24];
+    /*! Signal history for the QMF: ring of 24 samples mirrored (x[i] == x[i + 24]) so that
+        the 24 samples starting at x[ptr] are always contiguous, oldest first. */
+    int x[48];
+    int ptr;
 
     struct
     {
@@ -105,8 +107,10 @@ typedef struct
     /*! 6 for 48000kbps, 7 for 56000kbps, or 8 for 64000kbps. */
     int bits_per_sample;
 
-    /*! Signal history for the QMF */
-    int x[24];
+    /*! Signal history for the QMF: ring of 24 samples mirrored (x[i] == x[i + 24]) so that
+        the 24 samples starting at x[ptr] are always contiguous, oldest first. */
+    int x[48];
+    int ptr;
 
     struct
     {
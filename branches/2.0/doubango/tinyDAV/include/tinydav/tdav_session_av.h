@@ -99,6 +99,7 @@ typedef struct tdav_session_av_s
 		struct tmedia_codec_s* codec;
 		uint16_t seq_num;
 		uint32_t timestamp;
+		struct trtp_rtp_packet_s* packet; // reused for all outgoing FEC packets
 	} ulpfec;
 
 	struct{
@@ -39,6 +39,9 @@ TDAV_BEGIN_DECLS
 
 #define TDAV_VIDEO_FRAME(self) ((tdav_video_frame_t*)(self))
 
+// Maximum distance between the lowest and the highest sequence numbers of a frame
+#define TDAV_VIDEO_FRAME_PKTS_MAX	2048
+
 typedef uint16_t tdav_video_frame_seq_nums[16];
 typedef tsk_list_t tdav_video_frames_L_t;
 
@@ -49,8 +52,13 @@ typedef struct tdav_video_frame_s
 	uint8_t payload_type;
 	uint32_t timestamp;
 	uint16_t highest_seq_num;
+	uint16_t lowest_seq_num;
 	uint32_t ssrc;
-	trtp_rtp_packets_L_t* pkts;
+	// packets indexed by "seq_num - lowest_seq_num" (null = missing), sorted by construction
+	trtp_rtp_packet_t** pkts;
+	tsk_size_t pkts_span; // highest_seq_num - lowest_seq_num + 1
+	tsk_size_t pkts_count; // number of non-null packets
+	tsk_size_t pkts_capacity;
 	
 	TSK_DECLARE_SAFEOBJ;
 }
@@ -0,0 +1,47 @@
+/*
+* Copyright (C) 2011-2015 Mamadou DIOP
+* Copyright (C) 2011-2015 Doubango Telecom <http://www.doubango.org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_video_jb_pool.h
+ * @brief Decode pool shared by all video jitter buffers. The number of threads depends on the CPU budget, not on the number of sessions.
+ */
+#ifndef TINYDAV_VIDEO_JB_POOL_H
+#define TINYDAV_VIDEO_JB_POOL_H
+
+#include "tinydav_config.h"
+
+#include "tsk_common.h"
+
+TDAV_BEGIN_DECLS
+
+struct tdav_video_jb_pool_task_s;
+
+/** Runs one decoding step for a jitter buffer. Returns the number of milliseconds to wait before the next step. */
+typedef uint64_t (*tdav_video_jb_pool_task_cb_f)(const void* usr_data);
+
+int tdav_video_jb_pool_init();
+struct tdav_video_jb_pool_task_s* tdav_video_jb_pool_attach(tdav_video_jb_pool_task_cb_f callback, const void* usr_data);
+int tdav_video_jb_pool_detach(struct tdav_video_jb_pool_task_s** task);
+int tdav_video_jb_pool_wakeup(struct tdav_video_jb_pool_task_s* task);
+int tdav_video_jb_pool_deinit();
+
+TDAV_END_DECLS
+
+#endif /* TINYDAV_VIDEO_JB_POOL_H */
@@ -78,6 +78,14 @@ typedef struct tdav_session_video_s
 		uint8_t payload_type;
 		struct tmedia_codec_s* codec;
 		tsk_mutex_handle_t* h_mutex;
+
+		// encode pipeline (null when frames are encoded on the producer's thread)
+		struct tdav_video_pipeline_s* pipeline;
+		uint64_t send_duration_us; // time spent sending the packets of the frame being encoded
+
+		// encode group (null if the session doesn't share its encoder)
+		struct tdav_video_encgroup_s* group;
+		tsk_bool_t producer_paused; // paused while a member of the group (the leader's producer feeds the encoder)
 	} encoder;
 
 	struct{
@@ -0,0 +1,79 @@
+/*
+* Copyright (C) 2011-2015 Mamadou DIOP
+* Copyright (C) 2011-2015 Doubango Telecom <http://www.doubango.org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_video_encgroup.h
+ * @brief Encode group: video sessions sending the same source share a single encoder.
+ * Only the first started session of the group (the leader) encodes the frames from its producer. The encoded chunks are fanned out to the other
+ * sessions (the members) which only packetize them using their own RTP manager (SSRC, sequence number, timestamp, SRTP context...).
+ * The members' producers are paused while they are in the group (no capture or conversion for frames that would be dropped) and
+ * restarted when the member becomes the leader or leaves the group without stopping.
+ */
+#ifndef TINYDAV_VIDEO_ENCGROUP_H
+#define TINYDAV_VIDEO_ENCGROUP_H
+
+#include "tinydav_config.h"
+
+#include "tinymedia/tmedia_common.h"
+
+#include "tsk_object.h"
+#include "tsk_safeobj.h"
+#include "tsk_mutex.h"
+
+TDAV_BEGIN_DECLS
+
+struct tdav_session_video_s;
+
+/** Called for each member (the leader excluded) with the chunk encoded by the leader. */
+typedef int (*tdav_video_encgroup_send_cb_f)(struct tdav_session_video_s* member, const tmedia_video_encode_result_xt* result);
+/** Called when a session joins the group: checks that the chunks encoded by the leader can be sent "as is" (same codec, format, packetization and size). */
+typedef tsk_bool_t (*tdav_video_encgroup_match_cb_f)(const struct tdav_session_video_s* leader, const struct tdav_session_video_s* session);
+/** Called when a session joins the group as a member (pause its producer) or becomes the leader (restart its producer). */
+typedef int (*tdav_video_encgroup_role_cb_f)(struct tdav_session_video_s* session, tsk_bool_t leader);
+
+typedef struct tdav_video_encgroup_s
+{
+	TSK_DECLARE_OBJECT;
+
+	struct tdav_session_video_s** sessions; // weak references to the started sessions, sessions[0] is the leader
+	tsk_size_t sessions_count;
+	tsk_size_t sessions_capacity;
+
+	tsk_bool_t idr_requested; // a member (or a new leader) needs an IDR frame
+
+	tsk_mutex_handle_t* h_mutex_members; // serializes join() and leave(), held while "role_cb" pauses or restarts a producer
+
+	TSK_DECLARE_SAFEOBJ;
+}
+tdav_video_encgroup_t;
+
+TINYDAV_API tdav_video_encgroup_t* tdav_video_encgroup_create();
+int tdav_video_encgroup_join(tdav_video_encgroup_t* self, struct tdav_session_video_s* session, tdav_video_encgroup_match_cb_f match_cb, tdav_video_encgroup_role_cb_f role_cb);
+int tdav_video_encgroup_leave(tdav_video_encgroup_t* self, struct tdav_session_video_s* session, tdav_video_encgroup_role_cb_f role_cb);
+tsk_bool_t tdav_video_encgroup_is_leader(tdav_video_encgroup_t* self, const struct tdav_session_video_s* session);
+int tdav_video_encgroup_fanout(tdav_video_encgroup_t* self, const struct tdav_session_video_s* leader, tdav_video_encgroup_send_cb_f send_cb, const tmedia_video_encode_result_xt* result);
+int tdav_video_encgroup_request_idr(tdav_video_encgroup_t* self);
+tsk_bool_t tdav_video_encgroup_take_idr_request(tdav_video_encgroup_t* self);
+
+TINYDAV_GEXTERN const tsk_object_def_t *tdav_video_encgroup_def_t;
+
+TDAV_END_DECLS
+
+#endif /* TINYDAV_VIDEO_ENCGROUP_H */
@@ -0,0 +1,74 @@
+/*
+* Copyright (C) 2011-2015 Mamadou DIOP
+* Copyright (C) 2011-2015 Doubango Telecom <http://www.doubango.org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_video_pipeline.h
+ * @brief Video encode pipeline: bounded queue of captured frames processed (converted, encoded and sent) on a dedicated thread.
+ */
+#ifndef TINYDAV_VIDEO_PIPELINE_H
+#define TINYDAV_VIDEO_PIPELINE_H
+
+#include "tinydav_config.h"
+
+#include "tsk_common.h"
+
+TDAV_BEGIN_DECLS
+
+/** Maximum number of captured frames waiting to be encoded. The oldest frame is dropped when the queue is full. */
+#define TDAV_VIDEO_PIPELINE_QUEUE_MAX	3
+
+typedef enum tdav_video_pipeline_stage_e
+{
+	tdav_video_pipeline_stage_queue, // time spent in the queue (capture -> encode thread)
+	tdav_video_pipeline_stage_convert, // chroma conversion, resizing, rotation...
+	tdav_video_pipeline_stage_encode,
+	tdav_video_pipeline_stage_send, // RTP packetization, SRTP and sending
+
+	tdav_video_pipeline_stage_count
+}
+tdav_video_pipeline_stage_t;
+
+typedef struct tdav_video_pipeline_stats_xs
+{
+	uint64_t frames_in;
+	uint64_t frames_out;
+	uint64_t frames_dropped;
+	struct{
+		uint64_t count;
+		uint64_t total_us; // microseconds
+		uint64_t max_us;
+	} stages[tdav_video_pipeline_stage_count];
+}
+tdav_video_pipeline_stats_xt;
+
+/** Called on the pipeline's thread for each queued frame. */
+typedef int (*tdav_video_pipeline_cb_f)(const void* usr_data, const void* buffer, tsk_size_t size);
+
+struct tdav_video_pipeline_s* tdav_video_pipeline_create(tdav_video_pipeline_cb_f callback, const void* usr_data);
+int tdav_video_pipeline_start(struct tdav_video_pipeline_s* self);
+int tdav_video_pipeline_put(struct tdav_video_pipeline_s* self, const void* buffer, tsk_size_t size);
+int tdav_video_pipeline_stop(struct tdav_video_pipeline_s* self);
+int tdav_video_pipeline_stats_update(struct tdav_video_pipeline_s* self, tdav_video_pipeline_stage_t stage, uint64_t duration_us);
+int tdav_video_pipeline_stats_get(struct tdav_video_pipeline_s* self, tdav_video_pipeline_stats_xt* stats);
+uint64_t tdav_video_pipeline_time_us();
+
+TDAV_END_DECLS
+
+#endif /* TINYDAV_VIDEO_PIPELINE_H */
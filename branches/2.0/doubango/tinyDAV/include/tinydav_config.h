@@ -105,6 +105,7 @@
 #endif
 
 #include <stdint.h>
+#include <stddef.h> /* size_t must be defined before "tsk_common.h" (tsk_size_t) */
 #ifdef __SYMBIAN32__
 #include <stdlib.h>
 #endif
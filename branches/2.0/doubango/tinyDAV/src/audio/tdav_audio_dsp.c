@@ -0,0 +1,590 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+* Copyright (C) 2015 Doubango Telecom.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_audio_dsp.c
+ * @brief Audio DSP kernels (gain, mixing, format conversion, levels) on 16-bit PCM samples.
+ * SSE2 and NEON are used when enabled at compile time (always the case on x86_64). AVX2 is compiled in with GCC/Clang on x86 and only
+ * used when the CPU supports it (checked at runtime). The remaining samples (less than a vector) are always processed by the portable code.
+ * The float samples are in [-1.0, 1.0]. All kernels round half away from zero when converting to 16-bit: they return the same samples.
+ */
+#include "tinydav/audio/tdav_audio_dsp.h"
+
+#include "tsk_string.h"
+#include "tsk_debug.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define TDAV_AUDIO_DSP_HAVE_SSE2		1
+#	include <emmintrin.h>
+#	if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#		define TDAV_AUDIO_DSP_HAVE_AVX2		1
+#		define TDAV_AUDIO_DSP_AVX2_TARGET	__attribute__((target("avx2")))
+#		include <immintrin.h>
+#	endif
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#	define TDAV_AUDIO_DSP_HAVE_NEON		1
+#	include <arm_neon.h>
+#endif
+
+#define TDAV_AUDIO_DSP_S16_MAX		32767
+#define TDAV_AUDIO_DSP_S16_MIN		-32768
+#define TDAV_AUDIO_DSP_SAT_S16(v)	((v) > TDAV_AUDIO_DSP_S16_MAX ? TDAV_AUDIO_DSP_S16_MAX : ((v) < TDAV_AUDIO_DSP_S16_MIN ? TDAV_AUDIO_DSP_S16_MIN : (v)))
+
+typedef void (*tdav_audio_dsp_gain_f)(int16_t* samples, tsk_size_t count, int32_t shift);
+typedef void (*tdav_audio_dsp_mix_f)(int16_t* dst, const int16_t* src, tsk_size_t count);
+typedef void (*tdav_audio_dsp_s16_to_float_f)(float* dst, const int16_t* src, tsk_size_t count);
+typedef void (*tdav_audio_dsp_float_to_s16_f)(int16_t* dst, const float* src, tsk_size_t count);
+typedef void (*tdav_audio_dsp_interleave_f)(int16_t* dst, const int16_t* left, const int16_t* right, tsk_size_t count);
+typedef void (*tdav_audio_dsp_deinterleave_f)(int16_t* left, int16_t* right, const int16_t* src, tsk_size_t count);
+typedef void (*tdav_audio_dsp_level_f)(const int16_t* samples, tsk_size_t count, int32_t* peak, uint64_t* energy);
+
+/* ============ Portable C ================= */
+
+static void _tdav_audio_dsp_gain_c(int16_t* samples, tsk_size_t count, int32_t shift)
+{
+	tsk_size_t i;
+	int32_t v;
+	for(i = 0; i < count; ++i){
+		v = ((int32_t)samples[i]) * (1 << shift);
+		samples[i] = (int16_t)TDAV_AUDIO_DSP_SAT_S16(v);
+	}
+}
+
+static void _tdav_audio_dsp_mix_c(int16_t* dst, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i;
+	int32_t v;
+	for(i = 0; i < count; ++i){
+		v = ((int32_t)dst[i]) + ((int32_t)src[i]);
+		dst[i] = (int16_t)TDAV_AUDIO_DSP_SAT_S16(v);
+	}
+}
+
+static void _tdav_audio_dsp_s16_to_float_c(float* dst, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i;
+	for(i = 0; i < count; ++i){
+		dst[i] = ((float)src[i]) * (1.f / 32768.f);
+	}
+}
+
+static void _tdav_audio_dsp_float_to_s16_c(int16_t* dst, const float* src, tsk_size_t count)
+{
+	tsk_size_t i;
+	float v;
+	for(i = 0; i < count; ++i){
+		v = src[i] * 32768.f;
+		v = TDAV_AUDIO_DSP_SAT_S16(v);
+		dst[i] = (int16_t)(v + (v >= 0.f ? .5f : -.5f)); // round to nearest
+	}
+}
+
+static void _tdav_audio_dsp_interleave_c(int16_t* dst, const int16_t* left, const int16_t* right, tsk_size_t count)
+{
+	tsk_size_t i;
+	for(i = 0; i < count; ++i){
+		dst[(i << 1)] = left[i];
+		dst[(i << 1) + 1] = right[i];
+	}
+}
+
+static void _tdav_audio_dsp_deinterleave_c(int16_t* left, int16_t* right, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i;
+	for(i = 0; i < count; ++i){
+		left[i] = src[(i << 1)];
+		right[i] = src[(i << 1) + 1];
+	}
+}
+
+static void _tdav_audio_dsp_level_c(const int16_t* samples, tsk_size_t count, int32_t* peak, uint64_t* energy)
+{
+	tsk_size_t i;
+	int32_t v;
+	for(i = 0; i < count; ++i){
+		v = samples[i];
+		*energy += (uint64_t)(v * v);
+		if(v < 0){
+			v = -v;
+		}
+		if(v > *peak){
+			*peak = v;
+		}
+	}
+}
+
+/* ============ SSE2 ================= */
+
+#if TDAV_AUDIO_DSP_HAVE_SSE2
+
+// saturating left shift: the samples are clamped to the range which doesn't overflow and the ones clamped to the top get all their low bits set
+static void _tdav_audio_dsp_gain_sse2(int16_t* samples, tsk_size_t count, int32_t shift)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	const __m128i hi = _mm_set1_epi16((int16_t)(TDAV_AUDIO_DSP_S16_MAX >> shift));
+	const __m128i lo = _mm_set1_epi16((int16_t)(TDAV_AUDIO_DSP_S16_MIN >> shift));
+	const __m128i sh = _mm_cvtsi32_si128(shift);
+	__m128i v, over;
+	for(i = 0; i < count8; i += 8){
+		v = _mm_loadu_si128((const __m128i*)&samples[i]);
+		over = _mm_srli_epi16(_mm_cmpgt_epi16(v, hi), 1);
+		v = _mm_max_epi16(_mm_min_epi16(v, hi), lo);
+		_mm_storeu_si128((__m128i*)&samples[i], _mm_or_si128(_mm_sll_epi16(v, sh), over));
+	}
+	_tdav_audio_dsp_gain_c(&samples[count8], (count - count8), shift);
+}
+
+static void _tdav_audio_dsp_mix_sse2(int16_t* dst, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	for(i = 0; i < count8; i += 8){
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_adds_epi16(_mm_loadu_si128((const __m128i*)&dst[i]), _mm_loadu_si128((const __m128i*)&src[i])));
+	}
+	_tdav_audio_dsp_mix_c(&dst[count8], &src[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_s16_to_float_sse2(float* dst, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	const __m128 scale = _mm_set1_ps(1.f / 32768.f);
+	__m128i v;
+	for(i = 0; i < count8; i += 8){
+		v = _mm_loadu_si128((const __m128i*)&src[i]);
+		_mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale));
+		_mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale));
+	}
+	_tdav_audio_dsp_s16_to_float_c(&dst[count8], &src[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_float_to_s16_sse2(int16_t* dst, const float* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	const __m128 scale = _mm_set1_ps(32768.f);
+	const __m128 max = _mm_set1_ps((float)TDAV_AUDIO_DSP_S16_MAX);
+	const __m128 min = _mm_set1_ps((float)TDAV_AUDIO_DSP_S16_MIN);
+	const __m128 half = _mm_set1_ps(.5f);
+	const __m128 sign = _mm_set1_ps(-0.f);
+	__m128 f0, f1;
+	for(i = 0; i < count8; i += 8){
+		// clamp before converting: out of range values are converted to 0x80000000
+		f0 = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(&src[i]), scale), max), min);
+		f1 = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(&src[i + 4]), scale), max), min);
+		// _mm_cvtps_epi32() rounds half to even: add +/-0.5 (copy of the sign bit) and truncate to round half away from zero like the C code
+		f0 = _mm_add_ps(f0, _mm_or_ps(_mm_and_ps(f0, sign), half));
+		f1 = _mm_add_ps(f1, _mm_or_ps(_mm_and_ps(f1, sign), half));
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_packs_epi32(_mm_cvttps_epi32(f0), _mm_cvttps_epi32(f1)));
+	}
+	_tdav_audio_dsp_float_to_s16_c(&dst[count8], &src[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_interleave_sse2(int16_t* dst, const int16_t* left, const int16_t* right, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	__m128i l, r;
+	for(i = 0; i < count8; i += 8){
+		l = _mm_loadu_si128((const __m128i*)&left[i]);
+		r = _mm_loadu_si128((const __m128i*)&right[i]);
+		_mm_storeu_si128((__m128i*)&dst[(i << 1)], _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128((__m128i*)&dst[(i << 1) + 8], _mm_unpackhi_epi16(l, r));
+	}
+	_tdav_audio_dsp_interleave_c(&dst[(count8 << 1)], &left[count8], &right[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_deinterleave_sse2(int16_t* left, int16_t* right, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	__m128i v0, v1;
+	for(i = 0; i < count8; i += 8){
+		v0 = _mm_loadu_si128((const __m128i*)&src[(i << 1)]);
+		v1 = _mm_loadu_si128((const __m128i*)&src[(i << 1) + 8]);
+		// sign-extended 32-bit lanes: packing back to 16 bits never saturates
+		_mm_storeu_si128((__m128i*)&left[i], _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(v0, 16), 16), _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16)));
+		_mm_storeu_si128((__m128i*)&right[i], _mm_packs_epi32(_mm_srai_epi32(v0, 16), _mm_srai_epi32(v1, 16)));
+	}
+	_tdav_audio_dsp_deinterleave_c(&left[count8], &right[count8], &src[(count8 << 1)], (count - count8));
+}
+
+static void _tdav_audio_dsp_level_sse2(const int16_t* samples, tsk_size_t count, int32_t* peak, uint64_t* energy)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i v, sq, max = zero, min = zero, acc = zero;
+	int16_t max_s[8], min_s[8];
+	uint64_t acc_s[2];
+	for(i = 0; i < count8; i += 8){
+		v = _mm_loadu_si128((const __m128i*)&samples[i]);
+		max = _mm_max_epi16(max, v);
+		min = _mm_min_epi16(min, v);
+		// each 32-bit sum of two squares is <= 2^31: unsigned, widened to 64 bits before accumulating
+		sq = _mm_madd_epi16(v, v);
+		acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+		acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+	}
+	_mm_storeu_si128((__m128i*)max_s, max);
+	_mm_storeu_si128((__m128i*)min_s, min);
+	_mm_storeu_si128((__m128i*)acc_s, acc);
+	for(i = 0; i < 8; ++i){
+		if(max_s[i] > *peak){
+			*peak = max_s[i];
+		}
+		if(-((int32_t)min_s[i]) > *peak){
+			*peak = -((int32_t)min_s[i]);
+		}
+	}
+	*energy += acc_s[0] + acc_s[1];
+	_tdav_audio_dsp_level_c(&samples[count8], (count - count8), peak, energy);
+}
+
+#endif /* TDAV_AUDIO_DSP_HAVE_SSE2 */
+
+/* ============ AVX2 ================= */
+
+#if TDAV_AUDIO_DSP_HAVE_AVX2
+
+TDAV_AUDIO_DSP_AVX2_TARGET
+static void _tdav_audio_dsp_gain_avx2(int16_t* samples, tsk_size_t count, int32_t shift)
+{
+	tsk_size_t i, count16 = (count & ~15);
+	const __m256i hi = _mm256_set1_epi16((int16_t)(TDAV_AUDIO_DSP_S16_MAX >> shift));
+	const __m256i lo = _mm256_set1_epi16((int16_t)(TDAV_AUDIO_DSP_S16_MIN >> shift));
+	const __m128i sh = _mm_cvtsi32_si128(shift);
+	__m256i v, over;
+	for(i = 0; i < count16; i += 16){
+		v = _mm256_loadu_si256((const __m256i*)&samples[i]);
+		over = _mm256_srli_epi16(_mm256_cmpgt_epi16(v, hi), 1);
+		v = _mm256_max_epi16(_mm256_min_epi16(v, hi), lo);
+		_mm256_storeu_si256((__m256i*)&samples[i], _mm256_or_si256(_mm256_sll_epi16(v, sh), over));
+	}
+	_tdav_audio_dsp_gain_sse2(&samples[count16], (count - count16), shift);
+}
+
+TDAV_AUDIO_DSP_AVX2_TARGET
+static void _tdav_audio_dsp_mix_avx2(int16_t* dst, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i, count16 = (count & ~15);
+	for(i = 0; i < count16; i += 16){
+		_mm256_storeu_si256((__m256i*)&dst[i], _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)&dst[i]), _mm256_loadu_si256((const __m256i*)&src[i])));
+	}
+	_tdav_audio_dsp_mix_sse2(&dst[count16], &src[count16], (count - count16));
+}
+
+#endif /* TDAV_AUDIO_DSP_HAVE_AVX2 */
+
+/* ============ NEON ================= */
+
+#if TDAV_AUDIO_DSP_HAVE_NEON
+
+static void _tdav_audio_dsp_gain_neon(int16_t* samples, tsk_size_t count, int32_t shift)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	const int16x8_t sh = vdupq_n_s16((int16_t)shift);
+	for(i = 0; i < count8; i += 8){
+		vst1q_s16(&samples[i], vqshlq_s16(vld1q_s16(&samples[i]), sh));
+	}
+	_tdav_audio_dsp_gain_c(&samples[count8], (count - count8), shift);
+}
+
+static void _tdav_audio_dsp_mix_neon(int16_t* dst, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	for(i = 0; i < count8; i += 8){
+		vst1q_s16(&dst[i], vqaddq_s16(vld1q_s16(&dst[i]), vld1q_s16(&src[i])));
+	}
+	_tdav_audio_dsp_mix_c(&dst[count8], &src[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_s16_to_float_neon(float* dst, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	int16x8_t v;
+	for(i = 0; i < count8; i += 8){
+		v = vld1q_s16(&src[i]);
+		vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), (1.f / 32768.f)));
+		vst1q_f32(&dst[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), (1.f / 32768.f)));
+	}
+	_tdav_audio_dsp_s16_to_float_c(&dst[count8], &src[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_float_to_s16_neon(int16_t* dst, const float* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	const float32x4_t half = vdupq_n_f32(.5f);
+	float32x4_t f0, f1;
+	for(i = 0; i < count8; i += 8){
+		f0 = vmulq_n_f32(vld1q_f32(&src[i]), 32768.f);
+		f1 = vmulq_n_f32(vld1q_f32(&src[i + 4]), 32768.f);
+		// vcvtq truncates: add +/-0.5 (copy of the sign bit) to round to nearest. The conversion saturates.
+		f0 = vaddq_f32(f0, vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(f0), vdupq_n_u32(0x80000000)), vreinterpretq_u32_f32(half))));
+		f1 = vaddq_f32(f1, vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(f1), vdupq_n_u32(0x80000000)), vreinterpretq_u32_f32(half))));
+		vst1q_s16(&dst[i], vcombine_s16(vqmovn_s32(vcvtq_s32_f32(f0)), vqmovn_s32(vcvtq_s32_f32(f1))));
+	}
+	_tdav_audio_dsp_float_to_s16_c(&dst[count8], &src[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_interleave_neon(int16_t* dst, const int16_t* left, const int16_t* right, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	int16x8x2_t v;
+	for(i = 0; i < count8; i += 8){
+		v.val[0] = vld1q_s16(&left[i]);
+		v.val[1] = vld1q_s16(&right[i]);
+		vst2q_s16(&dst[(i << 1)], v);
+	}
+	_tdav_audio_dsp_interleave_c(&dst[(count8 << 1)], &left[count8], &right[count8], (count - count8));
+}
+
+static void _tdav_audio_dsp_deinterleave_neon(int16_t* left, int16_t* right, const int16_t* src, tsk_size_t count)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	int16x8x2_t v;
+	for(i = 0; i < count8; i += 8){
+		v = vld2q_s16(&src[(i << 1)]);
+		vst1q_s16(&left[i], v.val[0]);
+		vst1q_s16(&right[i], v.val[1]);
+	}
+	_tdav_audio_dsp_deinterleave_c(&left[count8], &right[count8], &src[(count8 << 1)], (count - count8));
+}
+
+static void _tdav_audio_dsp_level_neon(const int16_t* samples, tsk_size_t count, int32_t* peak, uint64_t* energy)
+{
+	tsk_size_t i, count8 = (count & ~7);
+	int16x8_t v, max = vdupq_n_s16(0), min = vdupq_n_s16(0);
+	int64x2_t acc = vdupq_n_s64(0);
+	int16_t max_s[8], min_s[8];
+	int64_t acc_s[2];
+	for(i = 0; i < count8; i += 8){
+		v = vld1q_s16(&samples[i]);
+		max = vmaxq_s16(max, v);
+		min = vminq_s16(min, v);
+		acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(v), vget_low_s16(v)));
+		acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(v), vget_high_s16(v)));
+	}
+	vst1q_s16(max_s, max);
+	vst1q_s16(min_s, min);
+	vst1q_s64(acc_s, acc);
+	for(i = 0; i < 8; ++i){
+		if(max_s[i] > *peak){
+			*peak = max_s[i];
+		}
+		if(-((int32_t)min_s[i]) > *peak){
+			*peak = -((int32_t)min_s[i]);
+		}
+	}
+	*energy += (uint64_t)(acc_s[0] + acc_s[1]);
+	_tdav_audio_dsp_level_c(&samples[count8], (count - count8), peak, energy);
+}
+
+#endif /* TDAV_AUDIO_DSP_HAVE_NEON */
+
+/* ============ Dispatch ================= */
+
+typedef struct tdav_audio_dsp_kernels_s
+{
+	const char* name;
+	tdav_audio_dsp_gain_f gain;
+	tdav_audio_dsp_mix_f mix;
+	tdav_audio_dsp_s16_to_float_f s16_to_float;
+	tdav_audio_dsp_float_to_s16_f float_to_s16;
+	tdav_audio_dsp_interleave_f interleave;
+	tdav_audio_dsp_deinterleave_f deinterleave;
+	tdav_audio_dsp_level_f level;
+}
+tdav_audio_dsp_kernels_t;
+
+static const tdav_audio_dsp_kernels_t __dsp_kernels[] =
+{
+#if TDAV_AUDIO_DSP_HAVE_AVX2
+	{
+		"AVX2",
+		_tdav_audio_dsp_gain_avx2,
+		_tdav_audio_dsp_mix_avx2,
+		_tdav_audio_dsp_s16_to_float_sse2,
+		_tdav_audio_dsp_float_to_s16_sse2,
+		_tdav_audio_dsp_interleave_sse2,
+		_tdav_audio_dsp_deinterleave_sse2,
+		_tdav_audio_dsp_level_sse2,
+	},
+#endif
+#if TDAV_AUDIO_DSP_HAVE_SSE2
+	{
+		"SSE2",
+		_tdav_audio_dsp_gain_sse2,
+		_tdav_audio_dsp_mix_sse2,
+		_tdav_audio_dsp_s16_to_float_sse2,
+		_tdav_audio_dsp_float_to_s16_sse2,
+		_tdav_audio_dsp_interleave_sse2,
+		_tdav_audio_dsp_deinterleave_sse2,
+		_tdav_audio_dsp_level_sse2,
+	},
+#endif
+#if TDAV_AUDIO_DSP_HAVE_NEON
+	{
+		"NEON",
+		_tdav_audio_dsp_gain_neon,
+		_tdav_audio_dsp_mix_neon,
+		_tdav_audio_dsp_s16_to_float_neon,
+		_tdav_audio_dsp_float_to_s16_neon,
+		_tdav_audio_dsp_interleave_neon,
+		_tdav_audio_dsp_deinterleave_neon,
+		_tdav_audio_dsp_level_neon,
+	},
+#endif
+	{
+		"C",
+		_tdav_audio_dsp_gain_c,
+		_tdav_audio_dsp_mix_c,
+		_tdav_audio_dsp_s16_to_float_c,
+		_tdav_audio_dsp_float_to_s16_c,
+		_tdav_audio_dsp_interleave_c,
+		_tdav_audio_dsp_deinterleave_c,
+		_tdav_audio_dsp_level_c,
+	},
+};
+static const tsk_size_t __dsp_kernels_count = sizeof(__dsp_kernels) / sizeof(__dsp_kernels[0]);
+
+// best kernels enabled at compile time (AVX2 needs a runtime check)
+#if TDAV_AUDIO_DSP_HAVE_AVX2
+static const tdav_audio_dsp_kernels_t* __dsp = &__dsp_kernels[1];
+#else
+static const tdav_audio_dsp_kernels_t* __dsp = &__dsp_kernels[0];
+#endif
+
+static tsk_bool_t _tdav_audio_dsp_is_supported(const tdav_audio_dsp_kernels_t* kernels)
+{
+#if TDAV_AUDIO_DSP_HAVE_AVX2
+	if(kernels == &__dsp_kernels[0]){
+		return __builtin_cpu_supports("avx2") ? tsk_true : tsk_false;
+	}
+#endif
+	return tsk_true;
+}
+
+/** Selects the best kernels for the CPU. Must be called once (see @ref tdav_init): the kernels enabled at compile time are used until then.
+*/
+int tdav_audio_dsp_init()
+{
+	tsk_size_t i;
+	for(i = 0; i < __dsp_kernels_count; ++i){
+		if(_tdav_audio_dsp_is_supported(&__dsp_kernels[i])){
+			__dsp = &__dsp_kernels[i];
+			break;
+		}
+	}
+	TSK_DEBUG_INFO("Audio DSP kernels: %s", __dsp->name);
+	return 0;
+}
+
+/** Forces the kernels to use ("AVX2", "SSE2", "NEON" or "C"), e.g. to compare them. Not thread-safe: call it before processing any sample.
+* @retval Zero if succeed, non-zero if the kernels are not compiled in or not supported by the CPU.
+*/
+int tdav_audio_dsp_select(const char* name)
+{
+	tsk_size_t i;
+	for(i = 0; i < __dsp_kernels_count; ++i){
+		if(tsk_striequals(__dsp_kernels[i].name, name)){
+			if(!_tdav_audio_dsp_is_supported(&__dsp_kernels[i])){
+				return -2;
+			}
+			__dsp = &__dsp_kernels[i];
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/** Gets the name of the kernels in use ("AVX2", "SSE2", "NEON" or "C").
+*/
+const char* tdav_audio_dsp_get_name()
+{
+	return __dsp->name;
+}
+
+/** Multiplies the samples by 2^shift (saturating).
+*/
+void tdav_audio_dsp_gain_s16(int16_t* samples, tsk_size_t count, int32_t shift)
+{
+	if(!samples || shift <= 0){
+		return;
+	}
+	__dsp->gain(samples, count, TSK_MIN(shift, 15));
+}
+
+/** Adds "src" to "dst" (saturating).
+*/
+void tdav_audio_dsp_mix_s16(int16_t* dst, const int16_t* src, tsk_size_t count)
+{
+	if(dst && src){
+		__dsp->mix(dst, src, count);
+	}
+}
+
+void tdav_audio_dsp_s16_to_float(float* dst, const int16_t* src, tsk_size_t count)
+{
+	if(dst && src){
+		__dsp->s16_to_float(dst, src, count);
+	}
+}
+
+/** Converts float samples to 16-bit, rounded to nearest and saturated.
+*/
+void tdav_audio_dsp_float_to_s16(int16_t* dst, const float* src, tsk_size_t count)
+{
+	if(dst && src){
+		__dsp->float_to_s16(dst, src, count);
+	}
+}
+
+/** Interleaves two mono channels ("count" samples each) into a stereo buffer ("count" * 2 samples).
+*/
+void tdav_audio_dsp_interleave_s16(int16_t* dst, const int16_t* left, const int16_t* right, tsk_size_t count)
+{
+	if(dst && left && right){
+		__dsp->interleave(dst, left, right, count);
+	}
+}
+
+/** Splits a stereo buffer ("count" * 2 samples) into two mono channels ("count" samples each).
+*/
+void tdav_audio_dsp_deinterleave_s16(int16_t* left, int16_t* right, const int16_t* src, tsk_size_t count)
+{
+	if(left && right && src){
+		__dsp->deinterleave(left, right, src, count);
+	}
+}
+
+/** Computes the peak (max absolute value, up to 32768) and the RMS level of the samples. Any of the outputs could be null.
+*/
+void tdav_audio_dsp_level_s16(const int16_t* samples, tsk_size_t count, int32_t* peak, int32_t* rms)
+{
+	int32_t _peak = 0;
+	uint64_t energy = 0;
+	if(samples && count){
+		__dsp->level(samples, count, &_peak, &energy);
+	}
+	if(peak){
+		*peak = _peak;
+	}
+	if(rms){
+		*rms = count ? (int32_t)sqrt((double)energy / (double)count) : 0;
+	}
+}
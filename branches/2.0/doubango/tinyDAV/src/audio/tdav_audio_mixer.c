@@ -0,0 +1,663 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+* Copyright (C) 2015 Doubango Telecom.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_audio_mixer.c
+ * @brief N-way audio conference mixer.
+ * Attaching an audio session replaces its consumer and producer by the mixer's ones: the decoded (and resampled) frames go to the session's
+ * jitter buffer and the mixer pulls them every @ref TDAV_AUDIO_MIXER_PTIME milliseconds. The loudest participants (up to "speakers_max") are
+ * summed once, each speaker gets the sum minus its own contribution and all the other participants get the same sum. The result is
+ * sent to the session's encoder which resamples it to the codec's rate if needed.
+ */
+#include "tinydav/audio/tdav_audio_mixer.h"
+#include "tinydav/audio/tdav_audio_dsp.h"
+#include "tinydav/audio/tdav_consumer_audio.h"
+#include "tinydav/audio/tdav_producer_audio.h"
+#include "tinydav/audio/tdav_session_audio.h"
+
+#include "tinymedia/tmedia_scheduler.h"
+
+#include "tsk_time.h"
+#include "tsk_memory.h"
+#include "tsk_thread.h"
+#include "tsk_condwait.h"
+#include "tsk_debug.h"
+
+#define TDAV_AUDIO_MIXER_GAIN_UNITY		256 /* Q8 */
+#define TDAV_AUDIO_MIXER_SPEECH_LEVEL	64 /* RMS level under which a participant is not mixed */
+#define TDAV_AUDIO_MIXER_LATE_MAX		100 /* milliseconds before dropping the late ticks instead of catching up */
+
+#define TDAV_AUDIO_MIXER_SAT_S16(v)	((v) > 32767 ? 32767 : ((v) < -32768 ? -32768 : (v)))
+
+/* ============ Consumer (network to mixer) ================= */
+
+typedef struct tdav_consumer_mixer_s
+{
+	TDAV_DECLARE_CONSUMER_AUDIO;
+
+	uint32_t rate; // mixer's rate
+}
+tdav_consumer_mixer_t;
+
+static int tdav_consumer_mixer_set(tmedia_consumer_t* self, const tmedia_param_t* param)
+{
+	return tdav_consumer_audio_set(TDAV_CONSUMER_AUDIO(self), param);
+}
+
+static int tdav_consumer_mixer_prepare(tmedia_consumer_t* self, const tmedia_codec_t* codec)
+{
+	if(!self || !codec){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	self->audio.ptime = TDAV_AUDIO_MIXER_PTIME; // the jitter buffer is pulled by the mixer, not by a sound card
+	self->audio.in.channels = TMEDIA_CODEC_CHANNELS_AUDIO_DECODING(codec);
+	self->audio.in.rate = TMEDIA_CODEC_RATE_DECODING(codec);
+	// the session resamples the decoded frames to the mixer's format
+	self->audio.out.rate = ((tdav_consumer_mixer_t*)self)->rate;
+	self->audio.out.channels = 1;
+	return 0;
+}
+
+static int tdav_consumer_mixer_start(tmedia_consumer_t* self)
+{
+	return 0;
+}
+
+static int tdav_consumer_mixer_consume(tmedia_consumer_t* self, const void* buffer, tsk_size_t size, const tsk_object_t* proto_hdr)
+{
+	return tdav_consumer_audio_put(TDAV_CONSUMER_AUDIO(self), buffer, size, proto_hdr); // thread-safe
+}
+
+static int tdav_consumer_mixer_pause(tmedia_consumer_t* self)
+{
+	return 0;
+}
+
+static int tdav_consumer_mixer_stop(tmedia_consumer_t* self)
+{
+	return 0;
+}
+
+static tsk_object_t* tdav_consumer_mixer_ctor(tsk_object_t * self, va_list * app)
+{
+	tdav_consumer_mixer_t *consumer = self;
+	if(consumer){
+		/* init base */
+		tdav_consumer_audio_init(TDAV_CONSUMER_AUDIO(consumer));
+	}
+	return self;
+}
+static tsk_object_t* tdav_consumer_mixer_dtor(tsk_object_t * self)
+{
+	tdav_consumer_mixer_t *consumer = self;
+	if(consumer){
+		/* deinit base */
+		tdav_consumer_audio_deinit(TDAV_CONSUMER_AUDIO(consumer));
+	}
+	return self;
+}
+static const tsk_object_def_t tdav_consumer_mixer_def_s =
+{
+	sizeof(tdav_consumer_mixer_t),
+	tdav_consumer_mixer_ctor,
+	tdav_consumer_mixer_dtor,
+	tdav_consumer_audio_cmp,
+};
+// not registered: only created by the mixer
+static const tmedia_consumer_plugin_def_t tdav_consumer_mixer_plugin_def_s =
+{
+	&tdav_consumer_mixer_def_s,
+
+	tmedia_audio,
+	"Audio mixer consumer",
+
+	tdav_consumer_mixer_set,
+	tdav_consumer_mixer_prepare,
+	tdav_consumer_mixer_start,
+	tdav_consumer_mixer_consume,
+	tdav_consumer_mixer_pause,
+	tdav_consumer_mixer_stop
+};
+
+/* ============ Producer (mixer to network) ================= */
+
+typedef struct tdav_producer_mixer_s
+{
+	TDAV_DECLARE_PRODUCER_AUDIO;
+
+	uint32_t rate; // mixer's rate
+	tsk_bool_t started; // protected by the safeobj: stop() waits for the frame being encoded
+
+	TSK_DECLARE_SAFEOBJ;
+}
+tdav_producer_mixer_t;
+
+static int tdav_producer_mixer_set(tmedia_producer_t* self, const tmedia_param_t* param)
+{
+	return tdav_producer_audio_set(TDAV_PRODUCER_AUDIO(self), param);
+}
+
+static int tdav_producer_mixer_prepare(tmedia_producer_t* self, const tmedia_codec_t* codec)
+{
+	if(!self || !codec){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	// the session resamples the mixed frames to the codec's format
+	self->audio.rate = ((tdav_producer_mixer_t*)self)->rate;
+	self->audio.channels = 1;
+	self->audio.ptime = TDAV_AUDIO_MIXER_PTIME;
+	return 0;
+}
+
+static int tdav_producer_mixer_start(tmedia_producer_t* self)
+{
+	tdav_producer_mixer_t* producer = (tdav_producer_mixer_t*)self;
+	tsk_safeobj_lock(producer);
+	producer->started = tsk_true;
+	tsk_safeobj_unlock(producer);
+	return 0;
+}
+
+static int tdav_producer_mixer_pause(tmedia_producer_t* self)
+{
+	return 0;
+}
+
+// called by the session when it's stopped or destroyed: the encoder callback (the session) must never be called after this function returns
+static int tdav_producer_mixer_stop(tmedia_producer_t* self)
+{
+	tdav_producer_mixer_t* producer = (tdav_producer_mixer_t*)self;
+	tsk_safeobj_lock(producer);
+	producer->started = tsk_false;
+	tsk_safeobj_unlock(producer);
+	return 0;
+}
+
+static tsk_object_t* tdav_producer_mixer_ctor(tsk_object_t * self, va_list * app)
+{
+	tdav_producer_mixer_t *producer = self;
+	if(producer){
+		/* init base */
+		tdav_producer_audio_init(TDAV_PRODUCER_AUDIO(producer));
+		/* init self */
+		tsk_safeobj_init(producer);
+	}
+	return self;
+}
+static tsk_object_t* tdav_producer_mixer_dtor(tsk_object_t * self)
+{
+	tdav_producer_mixer_t *producer = self;
+	if(producer){
+		/* deinit base */
+		tdav_producer_audio_deinit(TDAV_PRODUCER_AUDIO(producer));
+		/* deinit self */
+		tsk_safeobj_deinit(producer);
+	}
+	return self;
+}
+static const tsk_object_def_t tdav_producer_mixer_def_s =
+{
+	sizeof(tdav_producer_mixer_t),
+	tdav_producer_mixer_ctor,
+	tdav_producer_mixer_dtor,
+	tdav_producer_audio_cmp,
+};
+// not registered: only created by the mixer
+static const tmedia_producer_plugin_def_t tdav_producer_mixer_plugin_def_s =
+{
+	&tdav_producer_mixer_def_s,
+
+	tmedia_audio,
+	"Audio mixer producer",
+
+	tdav_producer_mixer_set,
+	tdav_producer_mixer_prepare,
+	tdav_producer_mixer_start,
+	tdav_producer_mixer_pause,
+	tdav_producer_mixer_stop
+};
+
+/* ============ Mixer ================= */
+
+typedef struct tdav_audio_mixer_participant_s
+{
+	TSK_DECLARE_OBJECT;
+
+	uint64_t session_id;
+	tdav_consumer_mixer_t* consumer;
+	tdav_producer_mixer_t* producer;
+	int32_t gain; // Q8
+	int16_t* frame; // last frame pulled from the jitter buffer (gain applied)
+	int32_t level; // smoothed RMS level
+	tsk_bool_t has_frame;
+	tsk_bool_t speaking; // part of the mix
+}
+tdav_audio_mixer_participant_t;
+static const tsk_object_def_t *tdav_audio_mixer_participant_def_t;
+
+typedef struct tdav_audio_mixer_s
+{
+	TSK_DECLARE_OBJECT;
+
+	uint32_t rate;
+	tsk_size_t frame_samples;
+	tsk_size_t speakers_max;
+	tsk_list_t* participants;
+	uint64_t active_speaker; // session id
+	int32_t* mix; // sum of the speakers
+	int16_t* mix_s16; // "mix" saturated: what the participants not part of it hear
+	int16_t* out;
+
+	tsk_bool_t running;
+	tsk_thread_handle_t* thread[1];
+	tsk_condwait_handle_t* cond;
+}
+tdav_audio_mixer_t;
+static const tsk_object_def_t *tdav_audio_mixer_def_t;
+
+static int _tdav_audio_mixer_participant_pred_find_by_id(const tsk_list_item_t *item, const void *session_id)
+{
+	const tdav_audio_mixer_participant_t* participant = (const tdav_audio_mixer_participant_t*)item->data;
+	return (participant && participant->session_id == *((const uint64_t*)session_id)) ? 0 : -1;
+}
+
+static void* TSK_STDCALL _tdav_audio_mixer_thread_func(void *arg);
+
+/** Creates a new mixer.
+* @param rate The sampling rate used to mix the participants (e.g. 16000). Each participant is resampled to/from this rate.
+* @param speakers_max The max number of participants mixed at the same time (the loudest ones). Zero means @ref TDAV_AUDIO_MIXER_SPEAKERS_MAX_DEFAULT.
+*/
+tdav_audio_mixer_t* tdav_audio_mixer_create(uint32_t rate, tsk_size_t speakers_max)
+{
+	tdav_audio_mixer_t* self;
+	if(!rate){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return tsk_null;
+	}
+	if(!(self = tsk_object_new(tdav_audio_mixer_def_t))){
+		TSK_DEBUG_ERROR("Failed to create mixer");
+		return tsk_null;
+	}
+	self->rate = rate;
+	self->frame_samples = (tsk_size_t)((rate * TDAV_AUDIO_MIXER_PTIME) / 1000);
+	self->speakers_max = speakers_max ? speakers_max : TDAV_AUDIO_MIXER_SPEAKERS_MAX_DEFAULT;
+	if(!(self->participants = tsk_list_create())
+		|| !(self->mix = tsk_calloc(self->frame_samples, sizeof(int32_t)))
+		|| !(self->mix_s16 = tsk_calloc(self->frame_samples, sizeof(int16_t)))
+		|| !(self->out = tsk_calloc(self->frame_samples, sizeof(int16_t)))
+		|| !(self->cond = tsk_condwait_create())){
+		TSK_DEBUG_ERROR("Failed to allocate mixer");
+		TSK_OBJECT_SAFE_FREE(self);
+	}
+	return self;
+}
+
+int tdav_audio_mixer_start(tdav_audio_mixer_t* self)
+{
+	int ret;
+	if(!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(self->running){
+		return 0;
+	}
+	self->running = tsk_true;
+	if((ret = tsk_thread_create(&self->thread[0], _tdav_audio_mixer_thread_func, self)) != 0 || !self->thread[0]){
+		TSK_DEBUG_ERROR("Failed to create new thread");
+		self->running = tsk_false;
+		return -2;
+	}
+	tsk_thread_set_priority(self->thread[0], TSK_THREAD_PRIORITY_TIME_CRITICAL);
+	return 0;
+}
+
+/** Adds an audio session to the conference. Must be called before the session is started: its consumer and producer are replaced by the
+* mixer's ones (the session's jitter buffer, denoiser and encoder callback are kept).
+*/
+int tdav_audio_mixer_attach(tdav_audio_mixer_t* self, struct tmedia_session_s* session)
+{
+	tdav_session_av_t* base = (tdav_session_av_t*)session;
+	tdav_session_audio_t* audio = (tdav_session_audio_t*)session;
+	tdav_audio_mixer_participant_t* participant = tsk_null;
+	int ret = 0;
+
+	if(!self || !session){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(session->plugin != tdav_session_audio_plugin_def_t){
+		TSK_DEBUG_ERROR("Not an audio session");
+		return -1;
+	}
+
+	tsk_list_lock(self->participants);
+	tsk_safeobj_lock(base);
+
+	if(tsk_list_find_item_by_pred(self->participants, _tdav_audio_mixer_participant_pred_find_by_id, &session->id)){
+		TSK_DEBUG_WARN("Session %llu already attached", (unsigned long long)session->id);
+		goto bail;
+	}
+	if(!base->consumer || !base->producer || !audio->jitterbuffer){
+		TSK_DEBUG_ERROR("Session without consumer, producer or jitter buffer");
+		ret = -2;
+		goto bail;
+	}
+	if(base->consumer->is_prepared || base->producer->is_prepared){
+		TSK_DEBUG_ERROR("Session already started");
+		ret = -3;
+		goto bail;
+	}
+
+	if(!(participant = tsk_object_new(tdav_audio_mixer_participant_def_t))
+		|| !(participant->frame = tsk_calloc(self->frame_samples, sizeof(int16_t)))
+		|| !(participant->consumer = tsk_object_new(&tdav_consumer_mixer_def_s))
+		|| !(participant->producer = tsk_object_new(&tdav_producer_mixer_def_s))){
+		TSK_DEBUG_ERROR("Failed to create participant");
+		ret = -4;
+		goto bail;
+	}
+	participant->session_id = session->id;
+
+	TMEDIA_CONSUMER(participant->consumer)->plugin = &tdav_consumer_mixer_plugin_def_s;
+	TMEDIA_CONSUMER(participant->consumer)->session_id = session->id;
+	participant->consumer->rate = self->rate;
+	tdav_consumer_audio_set_denoise(TDAV_CONSUMER_AUDIO(participant->consumer), audio->denoise);
+	tdav_consumer_audio_set_jitterbuffer(TDAV_CONSUMER_AUDIO(participant->consumer), audio->jitterbuffer);
+
+	TMEDIA_PRODUCER(participant->producer)->plugin = &tdav_producer_mixer_plugin_def_s;
+	TMEDIA_PRODUCER(participant->producer)->session_id = session->id;
+	participant->producer->rate = self->rate;
+	tmedia_producer_set_enc_callback(TMEDIA_PRODUCER(participant->producer), base->producer->enc_cb.callback, base->producer->enc_cb.callback_data);
+
+	TSK_OBJECT_SAFE_FREE(base->consumer);
+	base->consumer = tsk_object_ref(TMEDIA_CONSUMER(participant->consumer));
+	TSK_OBJECT_SAFE_FREE(base->producer);
+	base->producer = tsk_object_ref(TMEDIA_PRODUCER(participant->producer));
+
+	TSK_DEBUG_INFO("Session %llu attached to the audio mixer", (unsigned long long)session->id);
+	tsk_list_push_back_data(self->participants, (void**)&participant);
+
+bail:
+	tsk_safeobj_unlock(base);
+	tsk_list_unlock(self->participants);
+	TSK_OBJECT_SAFE_FREE(participant);
+	return ret;
+}
+
+/** Removes a session from the conference. The session keeps the mixer's consumer and producer (it will neither hear nor be heard).
+*/
+int tdav_audio_mixer_detach(tdav_audio_mixer_t* self, uint64_t session_id)
+{
+	if(!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_list_lock(self->participants);
+	tsk_list_remove_item_by_pred(self->participants, _tdav_audio_mixer_participant_pred_find_by_id, &session_id);
+	if(self->active_speaker == session_id){
+		self->active_speaker = 0;
+	}
+	tsk_list_unlock(self->participants);
+	return 0;
+}
+
+/** Sets the gain applied to what a participant says (100 = unchanged).
+*/
+int tdav_audio_mixer_set_gain(tdav_audio_mixer_t* self, uint64_t session_id, int32_t gain_percent)
+{
+	tdav_audio_mixer_participant_t* participant;
+	int ret = 0;
+	if(!self || gain_percent < 0){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_list_lock(self->participants);
+	if((participant = (tdav_audio_mixer_participant_t*)tsk_list_find_object_by_pred(self->participants, _tdav_audio_mixer_participant_pred_find_by_id, &session_id))){
+		participant->gain = (gain_percent * TDAV_AUDIO_MIXER_GAIN_UNITY) / 100;
+	}
+	else{
+		TSK_DEBUG_ERROR("Session %llu not attached", (unsigned long long)session_id);
+		ret = -2;
+	}
+	tsk_list_unlock(self->participants);
+	return ret;
+}
+
+/** Gets the session id of the loudest participant (zero if nobody is talking).
+*/
+uint64_t tdav_audio_mixer_get_active_speaker(tdav_audio_mixer_t* self)
+{
+	return self ? self->active_speaker : 0;
+}
+
+int tdav_audio_mixer_stop(tdav_audio_mixer_t* self)
+{
+	if(!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(self->running){
+		self->running = tsk_false;
+		tsk_condwait_signal(self->cond);
+		tsk_thread_join(&self->thread[0]);
+	}
+	return 0;
+}
+
+// pulls a frame from the participant's jitter buffer
+static void _tdav_audio_mixer_pull(tdav_audio_mixer_t* self, tdav_audio_mixer_participant_t* participant)
+{
+	tsk_size_t i, size, frame_size = (self->frame_samples * sizeof(int16_t));
+	int32_t v, rms;
+
+	participant->has_frame = tsk_false;
+	participant->speaking = tsk_false;
+	if(TMEDIA_CONSUMER(participant->consumer)->is_started){
+		size = tdav_consumer_audio_get(TDAV_CONSUMER_AUDIO(participant->consumer), participant->frame, frame_size);
+		tdav_consumer_audio_tick(TDAV_CONSUMER_AUDIO(participant->consumer));
+		if((participant->has_frame = (size > 0))){
+			if(size < frame_size){
+				memset(((uint8_t*)participant->frame) + size, 0, (frame_size - size));
+			}
+			if(participant->gain != TDAV_AUDIO_MIXER_GAIN_UNITY){
+				for(i = 0; i < self->frame_samples; ++i){
+					v = (((int32_t)participant->frame[i]) * participant->gain) >> 8;
+					participant->frame[i] = (int16_t)TDAV_AUDIO_MIXER_SAT_S16(v);
+				}
+			}
+			tdav_audio_dsp_level_s16(participant->frame, self->frame_samples, tsk_null, &rms);
+			participant->level = ((participant->level * 3) + rms) >> 2;
+			return;
+		}
+	}
+	participant->level >>= 1;
+}
+
+static void _tdav_audio_mixer_process(tdav_audio_mixer_t* self)
+{
+	tsk_list_item_t* item;
+	tdav_audio_mixer_participant_t *participant, *loudest, *active = tsk_null;
+	tsk_size_t i, speakers = 0, frame_size = (self->frame_samples * sizeof(int16_t));
+	int32_t v;
+
+	tsk_list_lock(self->participants);
+
+	tsk_list_foreach(item, self->participants){
+		participant = (tdav_audio_mixer_participant_t*)item->data;
+		_tdav_audio_mixer_pull(self, participant);
+		if(participant->session_id == self->active_speaker){
+			active = participant;
+		}
+	}
+
+	// select the loudest participants
+	memset(self->mix, 0, self->frame_samples * sizeof(int32_t));
+	while(speakers < self->speakers_max){
+		loudest = tsk_null;
+		tsk_list_foreach(item, self->participants){
+			participant = (tdav_audio_mixer_participant_t*)item->data;
+			if(participant->has_frame && !participant->speaking && participant->level >= TDAV_AUDIO_MIXER_SPEECH_LEVEL && (!loudest || participant->level > loudest->level)){
+				loudest = participant;
+			}
+		}
+		if(!loudest){
+			break;
+		}
+		if(!speakers){
+			// the active speaker only changes when the new one is at least 25% louder
+			if(!active || !active->has_frame || active->level < TDAV_AUDIO_MIXER_SPEECH_LEVEL || (loudest->level << 2) > (active->level * 5)){
+				if(self->active_speaker != loudest->session_id){
+					TSK_DEBUG_INFO("Active speaker: %llu", (unsigned long long)loudest->session_id);
+					self->active_speaker = loudest->session_id;
+				}
+			}
+		}
+		loudest->speaking = tsk_true;
+		for(i = 0; i < self->frame_samples; ++i){
+			self->mix[i] += loudest->frame[i];
+		}
+		++speakers;
+	}
+	if(!speakers){
+		self->active_speaker = 0;
+	}
+	for(i = 0; i < self->frame_samples; ++i){
+		self->mix_s16[i] = (int16_t)TDAV_AUDIO_MIXER_SAT_S16(self->mix[i]);
+	}
+
+	// feed the encoders: "mix - self" for the speakers, "mix" for the others
+	tsk_list_foreach(item, self->participants){
+		participant = (tdav_audio_mixer_participant_t*)item->data;
+		tsk_safeobj_lock(participant->producer); // against the session's stop()
+		if(!participant->producer->started || !TMEDIA_PRODUCER(participant->producer)->enc_cb.callback){
+			tsk_safeobj_unlock(participant->producer);
+			continue;
+		}
+		if(participant->speaking){
+			for(i = 0; i < self->frame_samples; ++i){
+				v = self->mix[i] - participant->frame[i];
+				self->out[i] = (int16_t)TDAV_AUDIO_MIXER_SAT_S16(v);
+			}
+		}
+		else{
+			memcpy(self->out, self->mix_s16, frame_size); // the session could process the frame in place (gain, denoiser...)
+		}
+		TMEDIA_PRODUCER(participant->producer)->enc_cb.callback(TMEDIA_PRODUCER(participant->producer)->enc_cb.callback_data, self->out, frame_size);
+		tsk_safeobj_unlock(participant->producer);
+	}
+
+	tsk_list_unlock(self->participants);
+}
+
+static void* TSK_STDCALL _tdav_audio_mixer_thread_func(void *arg)
+{
+	tdav_audio_mixer_t* self = (tdav_audio_mixer_t*)arg;
+	uint64_t now, next = tsk_time_now();
+
+	TSK_DEBUG_INFO("Audio mixer thread - ENTER");
+
+	tmedia_scheduler_bind_current_thread();
+
+	while(self->running){
+		now = tsk_time_now();
+		if(now < next){
+			tsk_condwait_timedwait(self->cond, (next - now));
+			continue;
+		}
+		if((now - next) > TDAV_AUDIO_MIXER_LATE_MAX){
+			TSK_DEBUG_WARN("Audio mixer %llu ms late", (unsigned long long)(now - next));
+			next = now;
+		}
+		_tdav_audio_mixer_process(self);
+		next += TDAV_AUDIO_MIXER_PTIME;
+	}
+
+	TSK_DEBUG_INFO("Audio mixer thread - EXIT");
+
+	return tsk_null;
+}
+
+//=================================================================================================
+//	Audio mixer participant object definition
+//
+static tsk_object_t* tdav_audio_mixer_participant_ctor(tsk_object_t * self, va_list * app)
+{
+	tdav_audio_mixer_participant_t *participant = self;
+	if(participant){
+		participant->gain = TDAV_AUDIO_MIXER_GAIN_UNITY;
+	}
+	return self;
+}
+static tsk_object_t* tdav_audio_mixer_participant_dtor(tsk_object_t * self)
+{
+	tdav_audio_mixer_participant_t *participant = self;
+	if(participant){
+		TSK_OBJECT_SAFE_FREE(participant->consumer);
+		TSK_OBJECT_SAFE_FREE(participant->producer);
+		TSK_FREE(participant->frame);
+	}
+	return self;
+}
+static const tsk_object_def_t tdav_audio_mixer_participant_def_s =
+{
+	sizeof(tdav_audio_mixer_participant_t),
+	tdav_audio_mixer_participant_ctor,
+	tdav_audio_mixer_participant_dtor,
+	tsk_null,
+};
+static const tsk_object_def_t *tdav_audio_mixer_participant_def_t = &tdav_audio_mixer_participant_def_s;
+
+//=================================================================================================
+//	Audio mixer object definition
+//
+static tsk_object_t* tdav_audio_mixer_ctor(tsk_object_t * self, va_list * app)
+{
+	tdav_audio_mixer_t *mixer = self;
+	if(mixer){
+	}
+	return self;
+}
+static tsk_object_t* tdav_audio_mixer_dtor(tsk_object_t * self)
+{
+	tdav_audio_mixer_t *mixer = self;
+	if(mixer){
+		tdav_audio_mixer_stop(mixer);
+		TSK_OBJECT_SAFE_FREE(mixer->participants);
+		TSK_FREE(mixer->mix);
+		TSK_FREE(mixer->mix_s16);
+		TSK_FREE(mixer->out);
+		if(mixer->cond){
+			tsk_condwait_destroy(&mixer->cond);
+		}
+		TSK_DEBUG_INFO("*** Audio mixer destroyed ***");
+	}
+	return self;
+}
+static const tsk_object_def_t tdav_audio_mixer_def_s =
+{
+	sizeof(tdav_audio_mixer_t),
+	tdav_audio_mixer_ctor,
+	tdav_audio_mixer_dtor,
+	tsk_null,
+};
+static const tsk_object_def_t *tdav_audio_mixer_def_t = &tdav_audio_mixer_def_s;
@@ -28,6 +28,7 @@
 
 //#include "tinydav/codecs/dtmf/tdav_codec_dtmf.h"
 #include "tinydav/audio/tdav_consumer_audio.h"
+#include "tinydav/audio/tdav_audio_dsp.h"
 
 #include "tinymedia/tmedia_resampler.h"
 #include "tinymedia/tmedia_denoise.h"
@@ -672,11 +673,7 @@ static void _tdav_session_audio_apply_gain(void* buffer, int len, int bps, int g
 		}
 	}
 	else if (bps == 16) {
-		int16_t *buff = buffer;
-		for (i = 0; i < len / 2; i++) {
-			if (buff[i] > -max_val && buff[i] < max_val)
-				buff[i] = buff[i] << gain;
-		}
+		tdav_audio_dsp_gain_s16((int16_t*)buffer, (tsk_size_t)(len >> 1), gain);
 	}
 }
 
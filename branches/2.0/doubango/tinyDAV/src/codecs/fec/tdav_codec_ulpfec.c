@@ -30,6 +30,7 @@
 #include "tsk_debug.h"
 
 #define TDAV_FEC_PKT_HDR_SIZE	10
+#define TDAV_FEC_PAYLOAD_SIZE_MIN	1500 /* MTU: the level payload is allocated once and only grows for jumbo packets */
 
 typedef struct tdav_codec_ulpfec_s
 {
@@ -153,6 +154,39 @@ static const tsk_object_def_t tdav_fec_pkt_def_s =
 const tsk_object_def_t *tdav_fec_pkt_def_t = &tdav_fec_pkt_def_s;
 
 
+// dst[i] ^= src[i], 64 bits at a time (portable word loop, same as thttp_auth_ws_unmask())
+static void _tdav_codec_ulpfec_xor(uint8_t* dst, const uint8_t* src, tsk_size_t size)
+{
+	tsk_size_t i = 0;
+	uint64_t d, s;
+	for (; (i + 8) <= size; i += 8){
+		memcpy(&d, &dst[i], 8); // the RTP payload could be unaligned
+		memcpy(&s, &src[i], 8);
+		d ^= s;
+		memcpy(&dst[i], &d, 8);
+	}
+	for (; i < size; ++i){
+		dst[i] ^= src[i];
+	}
+}
+
+// makes sure "level" can hold "size" bytes, the new bytes are zeroed
+static int _tdav_codec_ulpfec_level_reserve(tdav_fec_level_t* level, tsk_size_t size)
+{
+	if (level->payload.size < size){
+		size = TSK_MAX(size, TDAV_FEC_PAYLOAD_SIZE_MIN);
+		if (!(level->payload.ptr = tsk_realloc(level->payload.ptr, size))){
+			TSK_DEBUG_ERROR("Failed to realloc size %u", (unsigned)size);
+			level->payload.size = 0;
+			return -1;
+		}
+		memset(&level->payload.ptr[level->payload.size], 0, (size - level->payload.size));
+		level->payload.size = size;
+	}
+	return 0;
+}
+
+
 tsk_size_t tdav_codec_ulpfec_guess_serialbuff_size(const tdav_codec_ulpfec_t* self)
 {
 	tsk_size_t size = TDAV_FEC_PKT_HDR_SIZE;
@@ -187,13 +221,13 @@ int tdav_codec_ulpfec_enc_reset(tdav_codec_ulpfec_t* self)
 	// reset packet
 	memset(&self->encoder.pkt->hdr, 0, sizeof(self->encoder.pkt->hdr));
 
-	// reset levels
+	// reset levels: only the first "hdr.length" bytes could have been XORed
 	tsk_list_foreach(item, self->encoder.pkt->levels){
 		if ((level = item->data)){
-			memset(&level->hdr, 0, sizeof(level->hdr));
 			if (level->payload.ptr){
-				memset(level->payload.ptr, 0, level->payload.size);
+				memset(level->payload.ptr, 0, TSK_MIN(level->hdr.length, level->payload.size));
 			}
+			memset(&level->hdr, 0, sizeof(level->hdr));
 		}
 	}
 	return 0;
@@ -201,24 +235,36 @@ int tdav_codec_ulpfec_enc_reset(tdav_codec_ulpfec_t* self)
 
 int tdav_codec_ulpfec_enc_protect(tdav_codec_ulpfec_t* self, const trtp_rtp_packet_t* rtp_packet)
 {
+	uint16_t offset;
+
 	if (!self || !self->encoder.pkt || !rtp_packet || !rtp_packet->header){
 		TSK_DEBUG_ERROR("invalid parameter");
 		return -1;
 	}
 
+	// Mask: 16 bits (L=0) or 48 bits (L=1) for the packets following "SN base"
+	offset = self->encoder.pkt->hdr.SN_base.set ? (uint16_t)(rtp_packet->header->seq_num - self->encoder.pkt->hdr.SN_base.value) : 0;
+	if (offset >= 48){
+		return 0; // out of the mask: not protected by this FEC packet
+	}
+	if (offset >= 16 && !self->encoder.pkt->hdr.L){
+		tdav_fec_level_t* level0 = TSK_LIST_FIRST_DATA(self->encoder.pkt->levels);
+		self->encoder.pkt->hdr.L = 1;
+		if (level0){
+			level0->hdr.mask <<= 32;
+		}
+	}
+
 	// Packet
 	self->encoder.pkt->hdr.P ^= rtp_packet->header->padding;
 	self->encoder.pkt->hdr.X ^= rtp_packet->header->extension;
 	self->encoder.pkt->hdr.CC ^= rtp_packet->header->csrc_count;
 	self->encoder.pkt->hdr.M ^= rtp_packet->header->marker;
 	self->encoder.pkt->hdr.PT ^= rtp_packet->header->payload_type;
-	if (!self->encoder.pkt->hdr.SN_base.set){
+	if (!self->encoder.pkt->hdr.SN_base.set){ // the first protected packet is the base (packets before it are out of the mask)
 		self->encoder.pkt->hdr.SN_base.value = rtp_packet->header->seq_num;
 		self->encoder.pkt->hdr.SN_base.set = 1;
 	}
-	else{
-		self->encoder.pkt->hdr.SN_base.value = TSK_MIN(self->encoder.pkt->hdr.SN_base.value, rtp_packet->header->seq_num);
-	}
 	self->encoder.pkt->hdr.TS ^= rtp_packet->header->timestamp;
 	self->encoder.pkt->hdr.length ^= (trtp_rtp_packet_guess_serialbuff_size(rtp_packet) - TRTP_RTP_HEADER_MIN_SIZE);
 
@@ -227,7 +273,6 @@ int tdav_codec_ulpfec_enc_protect(tdav_codec_ulpfec_t* self, const trtp_rtp_pack
 	{
 		tdav_fec_level_t* level0 = TSK_LIST_FIRST_DATA(self->encoder.pkt->levels);
 		const uint8_t* rtp_payload = (const uint8_t*)(rtp_packet->payload.data_const ? rtp_packet->payload.data_const : rtp_packet->payload.data);
-		tsk_size_t i;
 		if (!level0){
 			tdav_fec_level_t* _level0;
 			if (!(_level0 = tsk_object_new(tdav_fec_level_def_t))){
@@ -237,19 +282,13 @@ int tdav_codec_ulpfec_enc_protect(tdav_codec_ulpfec_t* self, const trtp_rtp_pack
 			level0 = _level0;
 			tsk_list_push_back_data(self->encoder.pkt->levels, (void**)&_level0);
 		}
-		if (level0->payload.size < rtp_packet->payload.size){
-			if (!(level0->payload.ptr = tsk_realloc(level0->payload.ptr, rtp_packet->payload.size))){
-				TSK_DEBUG_ERROR("Failed to realloc size %d", rtp_packet->payload.size);
-				level0->payload.size = 0;
-				return -3;
-			}
-			level0->payload.size = rtp_packet->payload.size;
-		}
-		for (i = 0; i < rtp_packet->payload.size; ++i){
-			level0->payload.ptr[i] ^= rtp_payload[i];
+		if (_tdav_codec_ulpfec_level_reserve(level0, rtp_packet->payload.size) != 0){
+			return -3;
 		}
+		_tdav_codec_ulpfec_xor(level0->payload.ptr, rtp_payload, rtp_packet->payload.size);
 		level0->hdr.mask_size = self->encoder.pkt->hdr.L ? 48 : 16;
-		level0->hdr.mask |= (uint64_t)((uint64_t)1 << (level0->hdr.mask_size - (rtp_packet->header->seq_num - self->encoder.pkt->hdr.SN_base.value)));
+		// RFC 5109 - 7.4: the MSB of the mask is the packet with sequence number "SN base"
+		level0->hdr.mask |= (uint64_t)((uint64_t)1 << (level0->hdr.mask_size - 1 - offset));
 		level0->hdr.length = (uint16_t)(TSK_MAX(level0->hdr.length, rtp_packet->payload.size));
 	}
 
@@ -366,10 +405,16 @@ static tsk_object_t* tdav_codec_ulpfec_ctor(tsk_object_t * self, va_list * app)
 	if (ulpfec){
 		/* init base: called by tmedia_codec_create() */
 		/* init self */
+		tdav_fec_level_t* level0;
 		if (!(ulpfec->encoder.pkt = tsk_object_new(tdav_fec_pkt_def_t))){
 			TSK_DEBUG_ERROR("Failed to create FEC packet");
 			return tsk_null;
 		}
+		// single-level protection: create the level and its payload now rather than when the first packet is protected
+		if ((level0 = tsk_object_new(tdav_fec_level_def_t))){
+			_tdav_codec_ulpfec_level_reserve(level0, TDAV_FEC_PAYLOAD_SIZE_MIN);
+			tsk_list_push_back_data(ulpfec->encoder.pkt->levels, (void**)&level0);
+		}
 	}
 	return self;
 }
@@ -293,3 +293,124 @@ unsigned char ulaw2alaw(unsigned char	uval)
 	return (unsigned char) ((uval & 0x80) ? (0xD5 ^ (_u2a[0xFF ^ uval] - 1)) :
 	    (unsigned char) (0x55 ^ (_u2a[0x7F ^ uval] - 1)));
 }
+
+/*
+ * Table-driven bulk conversions.
+ *
+ * linear2ulaw() only depends on (pcm_val >> 2) and linear2alaw() on (pcm_val >> 3) which means
+ * the encoding tables only need 16384 and 8192 entries (16KB + 8KB, fits in the L1/L2 caches).
+ * The tables are built by g711_init_tables() using the functions above: the bulk functions are
+ * bit-exact. Until the tables are built, the bulk functions use the per-sample functions.
+ */
+static unsigned char __linear2ulaw_lut[1 << 14];
+static unsigned char __linear2alaw_lut[1 << 13];
+static short __ulaw2linear_lut[256];
+static short __alaw2linear_lut[256];
+static int __luts_ready = 0;
+
+void g711_init_tables()
+{
+	int i;
+	if (__luts_ready) {
+		return;
+	}
+	for (i = 0; i < (1 << 14); i++) {
+		/* index = (pcm_val >> 2) as unsigned 14-bit value (negative values in the upper half) */
+		__linear2ulaw_lut[i] = linear2ulaw((short)(i << 2));
+	}
+	for (i = 0; i < (1 << 13); i++) {
+		__linear2alaw_lut[i] = linear2alaw((short)(i << 3));
+	}
+	for (i = 0; i < 256; i++) {
+		__ulaw2linear_lut[i] = ulaw2linear((unsigned char)i);
+		__alaw2linear_lut[i] = alaw2linear((unsigned char)i);
+	}
+	__luts_ready = 1;
+}
+
+#define G711_ULAW_INDEX(pcm)	(((unsigned short)(pcm)) >> 2)
+#define G711_ALAW_INDEX(pcm)	(((unsigned short)(pcm)) >> 3)
+
+void g711_ulaw_encode(unsigned char* out, const short* amp, int len)
+{
+	int i = 0;
+	if (__luts_ready) {
+		for (; i + 4 <= len; i += 4) {
+			out[i] = __linear2ulaw_lut[G711_ULAW_INDEX(amp[i])];
+			out[i + 1] = __linear2ulaw_lut[G711_ULAW_INDEX(amp[i + 1])];
+			out[i + 2] = __linear2ulaw_lut[G711_ULAW_INDEX(amp[i + 2])];
+			out[i + 3] = __linear2ulaw_lut[G711_ULAW_INDEX(amp[i + 3])];
+		}
+		for (; i < len; i++) {
+			out[i] = __linear2ulaw_lut[G711_ULAW_INDEX(amp[i])];
+		}
+	}
+	else {
+		for (; i < len; i++) {
+			out[i] = linear2ulaw(amp[i]);
+		}
+	}
+}
+
+void g711_alaw_encode(unsigned char* out, const short* amp, int len)
+{
+	int i = 0;
+	if (__luts_ready) {
+		for (; i + 4 <= len; i += 4) {
+			out[i] = __linear2alaw_lut[G711_ALAW_INDEX(amp[i])];
+			out[i + 1] = __linear2alaw_lut[G711_ALAW_INDEX(amp[i + 1])];
+			out[i + 2] = __linear2alaw_lut[G711_ALAW_INDEX(amp[i + 2])];
+			out[i + 3] = __linear2alaw_lut[G711_ALAW_INDEX(amp[i + 3])];
+		}
+		for (; i < len; i++) {
+			out[i] = __linear2alaw_lut[G711_ALAW_INDEX(amp[i])];
+		}
+	}
+	else {
+		for (; i < len; i++) {
+			out[i] = linear2alaw(amp[i]);
+		}
+	}
+}
+
+void g711_ulaw_decode(short* amp, const unsigned char* in, int len)
+{
+	int i = 0;
+	if (__luts_ready) {
+		for (; i + 4 <= len; i += 4) {
+			amp[i] = __ulaw2linear_lut[in[i]];
+			amp[i + 1] = __ulaw2linear_lut[in[i + 1]];
+			amp[i + 2] = __ulaw2linear_lut[in[i + 2]];
+			amp[i + 3] = __ulaw2linear_lut[in[i + 3]];
+		}
+		for (; i < len; i++) {
+			amp[i] = __ulaw2linear_lut[in[i]];
+		}
+	}
+	else {
+		for (; i < len; i++) {
+			amp[i] = ulaw2linear(in[i]);
+		}
+	}
+}
+
+void g711_alaw_decode(short* amp, const unsigned char* in, int len)
+{
+	int i = 0;
+	if (__luts_ready) {
+		for (; i + 4 <= len; i += 4) {
+			amp[i] = __alaw2linear_lut[in[i]];
+			amp[i + 1] = __alaw2linear_lut[in[i + 1]];
+			amp[i + 2] = __alaw2linear_lut[in[i + 2]];
+			amp[i + 3] = __alaw2linear_lut[in[i + 3]];
+		}
+		for (; i < len; i++) {
+			amp[i] = __alaw2linear_lut[in[i]];
+		}
+	}
+	else {
+		for (; i < len; i++) {
+			amp[i] = alaw2linear(in[i]);
+		}
+	}
+}
@@ -42,9 +42,6 @@
 
 static tsk_size_t tdav_codec_g711u_encode(tmedia_codec_t* self, const void* in_data, tsk_size_t in_size, void** out_data, tsk_size_t* out_max_size)
 {
-	register tsk_size_t i;
-	register uint8_t* pout_data;
-	register int16_t* pin_data;
 	tsk_size_t out_size;
 	
 	if(!self || !in_data || !in_size || !out_data){
@@ -63,18 +60,13 @@ static tsk_size_t tdav_codec_g711u_encode(tmedia_codec_t* self, const void* in_d
 		*out_max_size = out_size;
 	}
 	
-	pout_data = *out_data;
-	pin_data = (int16_t*)in_data;
-	for(i = 0; i<out_size; i++){
-		pout_data[i] = linear2ulaw(pin_data[i]);
-	}
+	g711_ulaw_encode((uint8_t*)*out_data, (const int16_t*)in_data, (int)out_size);
 	
 	return out_size;
 }
 
 static tsk_size_t tdav_codec_g711u_decode(tmedia_codec_t* self, const void* in_data, tsk_size_t in_size, void** out_data, tsk_size_t* out_max_size, const tsk_object_t* proto_hdr)
 {
-	tsk_size_t i;
 	tsk_size_t out_size;
 
 	if(!self || !in_data || !in_size || !out_data){
@@ -94,9 +86,7 @@ static tsk_size_t tdav_codec_g711u_decode(tmedia_codec_t* self, const void* in_d
 		*out_max_size = out_size;
 	}
 
-	for(i = 0; i<in_size; i++){
-		((short*)*out_data)[i] = ulaw2linear(((uint8_t*)in_data)[i]);
-	}
+	g711_ulaw_decode((short*)*out_data, (const uint8_t*)in_data, (int)in_size);
 	
 	return out_size;
 }
@@ -181,9 +171,6 @@ const tmedia_codec_plugin_def_t *tdav_codec_g711u_plugin_def_t = &tdav_codec_g71
 
 static tsk_size_t tdav_codec_g711a_encode(tmedia_codec_t* self, const void* in_data, tsk_size_t in_size, void** out_data, tsk_size_t* out_max_size)
 {
-	register tsk_size_t i;
-	register uint8_t* pout_data;
-	register int16_t* pin_data;
 	tsk_size_t out_size;
 	
 	if(!self || !in_data || !in_size || !out_data){
@@ -202,11 +189,7 @@ static tsk_size_t tdav_codec_g711a_encode(tmedia_codec_t* self, const void* in_d
 		*out_max_size = out_size;
 	}
 	
-	pout_data = *out_data;
-	pin_data = (int16_t*)in_data;
-	for(i = 0; i<out_size; i++){
-		pout_data[i] = linear2alaw(pin_data[i]);
-	}
+	g711_alaw_encode((uint8_t*)*out_data, (const int16_t*)in_data, (int)out_size);
 
 	return out_size;
 }
@@ -217,7 +200,7 @@ int count = 0;
 #endif
 static tsk_size_t tdav_codec_g711a_decode(tmedia_codec_t* self, const void* in_data, tsk_size_t in_size, void** out_data, tsk_size_t* out_max_size, const tsk_object_t* proto_hdr)
 {
-	tsk_size_t i, out_size;
+	tsk_size_t out_size;
 	
 	if(!self || !in_data || !in_size || !out_data){
 		TSK_DEBUG_ERROR("Invalid parameter");
@@ -239,9 +222,7 @@ static tsk_size_t tdav_codec_g711a_decode(tmedia_codec_t* self, const void* in_d
 		*out_max_size = out_size;
 	}
 	
-	for(i = 0; i<in_size; i++){
-		((short*)*out_data)[i] = alaw2linear(((uint8_t*)in_data)[i]);
-	}
+	g711_alaw_decode((short*)*out_data, (const uint8_t*)in_data, (int)in_size);
 #if 0
 	if(++count<=1000){
 		fwrite(*out_data, sizeof(short), in_size, file);
@@ -246,6 +246,8 @@ int g722_decode(g722_decode_state_t *s, int16_t amp[],
     int rhigh;
     int xout1;
     int xout2;
+    /* QMF history, oldest sample first */
+    const int *x;
     int wd1;
     int wd2;
     int wd3;
@@ -374,17 +376,18 @@ int g722_decode(g722_decode_state_t *s, int16_t amp[],
             else
             {
                 /* Apply the receive QMF */
-                for (i = 0;  i < 22;  i++)
-                    s->x[i] = s->x[i + 2];
-                s->x[22] = rlow + rhigh;
-                s->x[23] = rlow - rhigh;
+                /* Replace the two oldest samples (no shuffle) */
+                s->x[s->ptr] = s->x[s->ptr + 24] = rlow + rhigh;
+                s->x[s->ptr + 1] = s->x[s->ptr + 25] = rlow - rhigh;
+                s->ptr = (s->ptr + 2) % 24;
+                x = &s->x[s->ptr];
 
                 xout1 = 0;
                 xout2 = 0;
                 for (i = 0;  i < 12;  i++)
                 {
-                    xout2 += s->x[2*i]*qmf_coeffs[i];
-                    xout1 += s->x[2*i + 1]*qmf_coeffs[11 - i];
+                    xout2 += x[2*i]*qmf_coeffs[i];
+                    xout1 += x[2*i + 1]*qmf_coeffs[11 - i];
                 }
                 /* We shift by 12 to allow for the QMF filters (DC gain = 4096), less 1
                    to allow for the 15 bit input to the G.722 algorithm. */
@@ -268,6 +268,8 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     int mih;
     int i;
     int j;
+    int lo;
+    int hi;
     /* Low and high band PCM from the QMF */
     int xlow;
     int xhigh;
@@ -275,12 +277,16 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     /* Even and odd tap accumulators */
     int sumeven;
     int sumodd;
+    /* QMF history, oldest sample first */
+    const int *x;
     int ihigh;
     int ilow;
     int code;
 
     g722_bytes = 0;
     xhigh = 0;
+    /* One sample pair at a time, no SIMD (unlike tdav_audio_dsp.c): ADPCM is serial, the quantizer scale and the
+       predictors used for a sample are adapted from the previous one. Only the 12-tap QMF could be vectorized. */
     for (j = 0;  j < len;  )
     {
         if (s->itu_test_mode)
@@ -298,19 +304,19 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
             else
             {
                 /* Apply the transmit QMF */
-                /* Shuffle the buffer down */
-                for (i = 0;  i < 22;  i++)
-                    s->x[i] = s->x[i + 2];
-                s->x[22] = amp[j++];
-                s->x[23] = amp[j++];
+                /* Replace the two oldest samples (no shuffle) */
+                s->x[s->ptr] = s->x[s->ptr + 24] = amp[j++];
+                s->x[s->ptr + 1] = s->x[s->ptr + 25] = amp[j++];
+                s->ptr = (s->ptr + 2) % 24;
+                x = &s->x[s->ptr];
     
                 /* Discard every other QMF output */
                 sumeven = 0;
                 sumodd = 0;
                 for (i = 0;  i < 12;  i++)
                 {
-                    sumodd += s->x[2*i]*qmf_coeffs[i];
-                    sumeven += s->x[2*i + 1]*qmf_coeffs[11 - i];
+                    sumodd += x[2*i]*qmf_coeffs[i];
+                    sumeven += x[2*i + 1]*qmf_coeffs[11 - i];
                 }
                 /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
                    to allow for us summing two filters, plus 1 to allow for the 15 bit
@@ -334,12 +340,20 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
         /* Block 1L, QUANTL */
         wd = (el >= 0)  ?  el  :  -(el + 1);
 
-        for (i = 1;  i < 30;  i++)
+        /* First i in [1, 29] with wd < (q6[i]*det) >> 12, 30 if none. q6[1..29] is increasing
+           which means a binary search gives the same result as the linear one. */
+        lo = 1;
+        hi = 30;
+        while (lo < hi)
         {
+            i = (lo + hi) >> 1;
             wd1 = (q6[i]*s->band[0].det) >> 12;
             if (wd < wd1)
-                break;
+                hi = i;
+            else
+                lo = i + 1;
         }
+        i = lo;
         ilow = (el < 0)  ?  iln[i]  :  ilp[i];
 
         /* Block 2L, INVQAL */
@@ -39,6 +39,7 @@
 
 #include "tinymedia/tmedia_params.h"
 #include "tinymedia/tmedia_defaults.h"
+#include "tinymedia/tmedia_scheduler.h"
 
 #include "tsk_params.h"
 #include "tsk_memory.h"
@@ -69,6 +70,7 @@ typedef struct tdav_codec_h264_s
 		int rotation;
 		int32_t max_bw_kpbs;
 		tsk_bool_t passthrough; // whether to bypass encoding
+		int32_t threads; // acquired from the media scheduler
 	} encoder;
 	
 	// decoder
@@ -83,6 +85,7 @@ typedef struct tdav_codec_h264_s
 		tsk_size_t accumulator_size;
 		uint16_t last_seq;
 		tsk_bool_t passthrough; // whether to bypass decoding
+		int32_t threads; // acquired from the media scheduler
 	} decoder;
 }
 tdav_codec_h264_t;
@@ -794,9 +797,18 @@ int tdav_codec_h264_open_encoder(tdav_codec_h264_t* self)
 		return -2;
 	}
 
+	// Threading: share the CPU budget with the other codecs. Slice-based threading doesn't add latency.
+	self->encoder.threads = tmedia_scheduler_codec_threads_acquire();
+	self->encoder.context->thread_count = self->encoder.threads;
+#if defined(FF_THREAD_SLICE)
+	self->encoder.context->thread_type = FF_THREAD_SLICE;
+#endif
+
 	// Open encoder
 	if((ret = avcodec_open(self->encoder.context, self->encoder.codec)) < 0){
 		TSK_DEBUG_ERROR("Failed to open [%s] codec", TMEDIA_CODEC(self)->plugin->desc);
+		tmedia_scheduler_codec_threads_release(self->encoder.threads);
+		self->encoder.threads = 0;
 		return ret;
 	}
 
@@ -823,6 +835,10 @@ int tdav_codec_h264_close_encoder(tdav_codec_h264_t* self)
 		av_free(self->encoder.picture);
 		self->encoder.picture = tsk_null;
 	}
+	if(self->encoder.threads){
+		tmedia_scheduler_codec_threads_release(self->encoder.threads);
+		self->encoder.threads = 0;
+	}
 #endif
 	if(self->encoder.buffer){
 		TSK_FREE(self->encoder.buffer);
@@ -858,9 +874,18 @@ int tdav_codec_h264_open_decoder(tdav_codec_h264_t* self)
 	}
 	avcodec_get_frame_defaults(self->decoder.picture);
 
+	// Threading: slices only, frame-based threading would add one frame of latency per thread
+	self->decoder.threads = tmedia_scheduler_codec_threads_acquire();
+	self->decoder.context->thread_count = self->decoder.threads;
+#if defined(FF_THREAD_SLICE)
+	self->decoder.context->thread_type = FF_THREAD_SLICE;
+#endif
+
 	// Open decoder
 	if((ret = avcodec_open(self->decoder.context, self->decoder.codec)) < 0){
 		TSK_DEBUG_ERROR("Failed to open [%s] codec", TMEDIA_CODEC(self)->plugin->desc);
+		tmedia_scheduler_codec_threads_release(self->decoder.threads);
+		self->decoder.threads = 0;
 		return ret;
 	}
 
@@ -887,6 +912,10 @@ int tdav_codec_h264_close_decoder(tdav_codec_h264_t* self)
 		av_free(self->decoder.picture);
 		self->decoder.picture = tsk_null;
 	}
+	if(self->decoder.threads){
+		tmedia_scheduler_codec_threads_release(self->decoder.threads);
+		self->decoder.threads = 0;
+	}
 #endif
 	TSK_FREE(self->decoder.accumulator);
 	self->decoder.accumulator_pos = 0;
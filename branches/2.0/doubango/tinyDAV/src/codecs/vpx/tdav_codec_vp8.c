@@ -40,6 +40,7 @@
 
 #include "tinymedia/tmedia_params.h"
 #include "tinymedia/tmedia_defaults.h"
+#include "tinymedia/tmedia_scheduler.h"
 
 #include "tsk_string.h"
 #include "tsk_memory.h"
@@ -724,13 +725,8 @@ int tdav_codec_vp8_open_encoder(tdav_codec_vp8_t* self)
     enc_flags |= VPX_CODEC_USE_OUTPUT_PARTITION;
 #endif
 	self->encoder.cfg.g_lag_in_frames = 0;
-#if TDAV_UNDER_WINDOWS
-	{
-		SYSTEM_INFO SystemInfo;
-		GetSystemInfo(&SystemInfo);
-		self->encoder.cfg.g_threads = SystemInfo.dwNumberOfProcessors;
-	}
-#endif
+	// share the CPU budget with the other codecs (released when the encoder is closed)
+	self->encoder.cfg.g_threads = tmedia_scheduler_codec_threads_acquire();
 	self->encoder.cfg.rc_end_usage = VPX_CBR;
 	self->encoder.cfg.g_pass = VPX_RC_ONE_PASS;
 #if 0
@@ -747,6 +743,7 @@ int tdav_codec_vp8_open_encoder(tdav_codec_vp8_t* self)
 
 	if((vpx_ret = vpx_codec_enc_init(&self->encoder.context, vp8_interface_enc, &self->encoder.cfg, enc_flags)) != VPX_CODEC_OK){
 		TSK_DEBUG_ERROR("vpx_codec_enc_init failed with error =%s", vpx_codec_err_to_string(vpx_ret));
+		tmedia_scheduler_codec_threads_release((int32_t)self->encoder.cfg.g_threads);
 		return -3;
 	}
 	self->encoder.pic_id = /*(rand() ^ rand()) % 0x7FFF*/0/*Use zero: why do you want to make your life harder?*/;
@@ -799,13 +796,8 @@ int tdav_codec_vp8_open_decoder(tdav_codec_vp8_t* self)
 
 	self->decoder.cfg.w = TMEDIA_CODEC_VIDEO(self)->out.width;
 	self->decoder.cfg.h = TMEDIA_CODEC_VIDEO(self)->out.height;
-#if TDAV_UNDER_WINDOWS
-	{
-		SYSTEM_INFO SystemInfo;
-		GetSystemInfo(&SystemInfo);
-		self->decoder.cfg.threads = SystemInfo.dwNumberOfProcessors;
-	}
-#endif
+	// share the CPU budget with the other codecs (released when the decoder is closed)
+	self->decoder.cfg.threads = tmedia_scheduler_codec_threads_acquire();
 
 	dec_caps = vpx_codec_get_caps(&vpx_codec_vp8_dx_algo);
 #if !TDAV_UNDER_MOBILE
@@ -821,6 +813,7 @@ int tdav_codec_vp8_open_decoder(tdav_codec_vp8_t* self)
 
 	if((vpx_ret = vpx_codec_dec_init(&self->decoder.context, vp8_interface_dec, &self->decoder.cfg, dec_flags)) != VPX_CODEC_OK){
 		TSK_DEBUG_ERROR("vpx_codec_dec_init failed with error =%s", vpx_codec_err_to_string(vpx_ret));
+		tmedia_scheduler_codec_threads_release((int32_t)self->decoder.cfg.threads);
 		return -4;
 	}
 #if !TDAV_UNDER_MOBILE
@@ -839,6 +832,7 @@ int tdav_codec_vp8_close_encoder(tdav_codec_vp8_t* self)
 	if (self->encoder.initialized) {
 		vpx_codec_destroy(&self->encoder.context);
 		self->encoder.initialized = tsk_false;
+		tmedia_scheduler_codec_threads_release((int32_t)self->encoder.cfg.g_threads);
 	}
     self->encoder.rotation = 0; // reset rotation
 	TSK_DEBUG_INFO("tdav_codec_vp8_close_encoder(end)");
@@ -851,6 +845,7 @@ int tdav_codec_vp8_close_decoder(tdav_codec_vp8_t* self)
 	if(self->decoder.initialized){
 		vpx_codec_destroy(&self->decoder.context);
 		self->decoder.initialized = tsk_false;
+		tmedia_scheduler_codec_threads_release((int32_t)self->decoder.cfg.threads);
 	}
 	TSK_DEBUG_INFO("tdav_codec_vp8_close_decoder(end)");
 
@@ -62,7 +62,9 @@ static const tsk_size_t __codec_plugins_all_count = sizeof(__codec_plugins_all)/
 // Sessions
 #include "tinymedia/tmedia_session_ghost.h"
 #include "tinydav/audio/tdav_session_audio.h"
+#include "tinydav/audio/tdav_audio_dsp.h"
 #include "tinydav/video/tdav_session_video.h"
+#include "tinydav/video/jb/tdav_video_jb_pool.h"
 #include "tinydav/msrp/tdav_session_msrp.h"
 #include "tinydav/bfcp/tdav_session_bfcp.h"
 #include "tinydav/t140/tdav_session_t140.h"
@@ -81,6 +83,7 @@ static const tsk_size_t __codec_plugins_all_count = sizeof(__codec_plugins_all)/
 #include "tinydav/codecs/amr/tdav_codec_amr.h"
 #include "tinydav/codecs/bv/tdav_codec_bv16.h"
 #include "tinydav/codecs/g711/tdav_codec_g711.h"
+#include "tinydav/codecs/g711/g711.h"
 #include "tinydav/codecs/gsm/tdav_codec_gsm.h"
 #include "tinydav/codecs/ilbc/tdav_codec_ilbc.h"
 #include "tinydav/codecs/g729/tdav_codec_g729.h"
@@ -463,6 +466,15 @@ int tdav_init()
 	// collect all codecs before filtering
 	_tdav_codec_plugins_collect();
 
+	/* === Video decode pool (workers started on demand) === */
+	tdav_video_jb_pool_init();
+
+	/* === G.711 conversion tables === */
+	g711_init_tables();
+
+	/* === Audio DSP kernels (SIMD) === */
+	tdav_audio_dsp_init();
+
 	__b_initialized = tsk_true;
 
 	return ret;
@@ -752,6 +764,8 @@ int tdav_deinit()
 	// disperse all collected codecs
 	_tdav_codec_plugins_disperse();
 
+	tdav_video_jb_pool_deinit();
+
 	__b_initialized = tsk_false;
 
 	return ret;
@@ -903,7 +903,8 @@ const tsdp_header_M_t* tdav_session_av_get_lo(tdav_session_av_t* self, tsk_bool_
 			}
 		}
 		else{
-			/* from codecs to sdp */
+			/* from codecs to sdp: all enabled codecs are offered */
+			tmedia_session_instantiate_codecs(base);
 			tmedia_codec_to_sdp(base->codecs, base->M.lo);
 		}
 
@@ -1867,6 +1868,7 @@ int tdav_session_av_deinit(tdav_session_av_t* self)
 	/* RED and ULPFEC codecs */
 	TSK_OBJECT_SAFE_FREE(self->red.codec);
 	TSK_OBJECT_SAFE_FREE(self->ulpfec.codec);
+	TSK_OBJECT_SAFE_FREE(self->ulpfec.packet);
 
 	/* NAT Traversal context */
 	TSK_OBJECT_SAFE_FREE(self->natt_ctx);
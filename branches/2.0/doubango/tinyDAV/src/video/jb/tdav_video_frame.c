@@ -33,14 +33,14 @@
 #include <string.h>
 #include <stdlib.h>
 
+#define TDAV_VIDEO_FRAME_PKTS_GROW_MIN	16
+
+static int _tdav_video_frame_reserve(tdav_video_frame_t* self, tsk_size_t span);
+
 static tsk_object_t* tdav_video_frame_ctor(tsk_object_t * self, va_list * app)
 {
 	tdav_video_frame_t *frame = self;
 	if(frame){
-		if(!(frame->pkts = tsk_list_create())){
-			TSK_DEBUG_ERROR("Faile to list");
-			return tsk_null;
-		}
 		tsk_safeobj_init(frame);
 	}
 	return self;
@@ -49,7 +49,11 @@ static tsk_object_t* tdav_video_frame_dtor(tsk_object_t * self)
 { 
 	tdav_video_frame_t *frame = self;
 	if(frame){
-		TSK_OBJECT_SAFE_FREE(frame->pkts);
+		tsk_size_t i;
+		for(i = 0; i < frame->pkts_span; ++i){
+			TSK_OBJECT_SAFE_FREE(frame->pkts[i]);
+		}
+		TSK_FREE(frame->pkts);
 
 		tsk_safeobj_deinit(frame);
 	}
@@ -86,18 +90,26 @@ tdav_video_frame_t* tdav_video_frame_create(trtp_rtp_packet_t* rtp_pkt)
 	}
 
 	if((frame = tsk_object_new(tdav_video_frame_def_t))){
-		rtp_pkt = tsk_object_ref(rtp_pkt);
+		if(_tdav_video_frame_reserve(frame, 1) != 0){
+			TSK_OBJECT_SAFE_FREE(frame);
+			return tsk_null;
+		}
 		frame->payload_type = rtp_pkt->header->payload_type;
 		frame->timestamp = rtp_pkt->header->timestamp;
-		frame->highest_seq_num = rtp_pkt->header->seq_num;
+		frame->highest_seq_num = frame->lowest_seq_num = rtp_pkt->header->seq_num;
 		frame->ssrc = rtp_pkt->header->ssrc;
-		tsk_list_push_ascending_data(frame->pkts, (void**)&rtp_pkt);
+		frame->pkts[0] = tsk_object_ref(rtp_pkt);
+		frame->pkts_span = frame->pkts_count = 1;
 	}
 	return frame;
 }
 
+// O(1) except when the lowest sequence number changes (packets reordered) or when the array must grow
 int tdav_video_frame_put(tdav_video_frame_t* self, trtp_rtp_packet_t* rtp_pkt)
 {
+	int16_t offset;
+	tsk_size_t index, shift;
+
 	if(!self || !rtp_pkt || !rtp_pkt->header){
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return -1;
@@ -117,46 +129,53 @@ int tdav_video_frame_put(tdav_video_frame_t* self, trtp_rtp_packet_t* rtp_pkt)
 	}
 #endif
 
-	rtp_pkt = tsk_object_ref(rtp_pkt);
-	self->highest_seq_num = TSK_MAX(self->highest_seq_num, rtp_pkt->header->seq_num);
-	tsk_list_lock(self->pkts);
-	if (tdav_video_frame_find_by_seq_num(self, rtp_pkt->header->seq_num)) {
+	// signed distance: handles the sequence numbers wrapping
+	offset = (int16_t)(rtp_pkt->header->seq_num - self->lowest_seq_num);
+	if(offset >= 0){
+		index = (tsk_size_t)offset;
+		if(index >= self->pkts_span){
+			if(_tdav_video_frame_reserve(self, index + 1) != 0){
+				return -3;
+			}
+			self->pkts_span = index + 1;
+			self->highest_seq_num = rtp_pkt->header->seq_num;
+		}
+	}
+	else{
+		// older than the lowest packet: shift the array
+		shift = (tsk_size_t)(-offset);
+		if(_tdav_video_frame_reserve(self, self->pkts_span + shift) != 0){
+			return -3;
+		}
+		memmove(&self->pkts[shift], &self->pkts[0], self->pkts_span * sizeof(trtp_rtp_packet_t*));
+		memset(&self->pkts[0], 0, shift * sizeof(trtp_rtp_packet_t*));
+		self->pkts_span += shift;
+		self->lowest_seq_num = rtp_pkt->header->seq_num;
+		index = 0;
+	}
+
+	if(self->pkts[index]){
 		TSK_DEBUG_INFO("JB: Packet with seq_num=%hu duplicated", rtp_pkt->header->seq_num);
 	}
-	else {
-		tsk_list_push_ascending_data(self->pkts, (void**)&rtp_pkt);
+	else{
+		self->pkts[index] = tsk_object_ref(rtp_pkt);
+		++self->pkts_count;
 	}
-	tsk_list_unlock(self->pkts);
 
 	return 0;
 }
 
 const trtp_rtp_packet_t* tdav_video_frame_find_by_seq_num(const tdav_video_frame_t* self, uint16_t seq_num)
 {
-	const tsk_list_item_t *item;
-	const trtp_rtp_packet_t* pkt;
-	const trtp_rtp_packet_t* ret;
+	uint16_t index;
 
 	if(!self){
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return tsk_null;
 	}
 
-	ret = tsk_null;
-
-	tsk_list_lock(self->pkts);
-	tsk_list_foreach(item, self->pkts){
-		if(!(pkt = item->data) || !pkt->header){
-			continue;
-		}
-		if(pkt->header->seq_num == seq_num){
-			ret = pkt;
-			break;
-		}
-	}
-	tsk_list_unlock(self->pkts);
-
-	return ret;
+	index = (uint16_t)(seq_num - self->lowest_seq_num);
+	return (index < self->pkts_span) ? self->pkts[index] : tsk_null;
 }
 
 // @buffer_ptr pointer to the destination buffer
@@ -164,37 +183,38 @@ const trtp_rtp_packet_t* tdav_video_frame_find_by_seq_num(const tdav_video_frame
 // @retval number of copied bytes
 tsk_size_t tdav_video_frame_write(struct tdav_video_frame_s* self, void** buffer_ptr, tsk_size_t* buffer_size)
 {
-	const tsk_list_item_t *item;
 	const trtp_rtp_packet_t* pkt;
-	tsk_size_t ret_size = 0;
-	int32_t last_seq_num = -1; // guard against duplicated packets
+	tsk_size_t i, ret_size = 0;
 
 	if(!self || !buffer_ptr || !buffer_size){
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return 0;
 	}
 
-	tsk_list_lock(self->pkts);
-	tsk_list_foreach(item, self->pkts){
-		if(!(pkt = item->data) || !pkt->payload.size || !pkt->header || pkt->header->seq_num == last_seq_num){
+	// compute the final size first to resize the buffer only once
+	for(i = 0; i < self->pkts_span; ++i){
+		if((pkt = self->pkts[i])){
+			ret_size += pkt->payload.size;
+		}
+	}
+	if(ret_size > *buffer_size){
+		if(!(*buffer_ptr = tsk_realloc(*buffer_ptr, ret_size))){
+			TSK_DEBUG_ERROR("Failed to resize the buffer");
+			*buffer_size = 0;
+			return 0;
+		}
+		*buffer_size = ret_size;
+	}
+
+	ret_size = 0;
+	for(i = 0; i < self->pkts_span; ++i){
+		if(!(pkt = self->pkts[i]) || !pkt->payload.size){
 			continue;
 		}
-		if((ret_size + pkt->payload.size) > *buffer_size){
-			if(!(*buffer_ptr = tsk_realloc(*buffer_ptr, (ret_size + pkt->payload.size)))){
-				TSK_DEBUG_ERROR("Failed to resize the buffer");
-				*buffer_size = 0;
-				goto bail;
-			}
-			*buffer_size = (ret_size + pkt->payload.size);
-		}		
 		memcpy(&((uint8_t*)*buffer_ptr)[ret_size], (pkt->payload.data ? pkt->payload.data : pkt->payload.data_const), pkt->payload.size);
 		ret_size += pkt->payload.size;
-		last_seq_num = pkt->header->seq_num;
 	}
 
-bail:
-	tsk_list_unlock(self->pkts);
-
 	return ret_size;
 }
 
@@ -209,35 +229,61 @@ IMPORTANT: This function assume that the RTP packets use the marker bit to signa
 */
 tsk_bool_t tdav_video_frame_is_complete(const tdav_video_frame_t* self, int32_t last_seq_num_with_mark, int32_t* missing_seq_num_start, int32_t* missing_seq_num_count)
 {
-	const trtp_rtp_packet_t* pkt;
-	const tsk_list_item_t *item;
-	uint16_t i;
-	tsk_bool_t is_complete = tsk_false;
+	tsk_size_t i, j;
 
 	if(!self || !missing_seq_num_start || !missing_seq_num_count){
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return tsk_false;
 	}
 
-	i = 0;
-	tsk_list_lock(self->pkts);
-	tsk_list_foreach(item, self->pkts){
-		if(!(pkt = item->data)){
-			continue;
-		}
-		if(last_seq_num_with_mark >= 0 && pkt->header->seq_num != (last_seq_num_with_mark + ++i)){
-			*missing_seq_num_start = (last_seq_num_with_mark + i);
-			*missing_seq_num_count = pkt->header->seq_num - (*missing_seq_num_start);
-			break;
+	if(last_seq_num_with_mark >= 0){
+		// the first packet must follow the end of the previous frame
+		// a late or duplicated packet could be before it: not a gap (signed distance to handle the wrap)
+		int16_t distance = (int16_t)(self->lowest_seq_num - (uint16_t)(last_seq_num_with_mark + 1));
+		if(distance > 0){
+			*missing_seq_num_start = (uint16_t)(last_seq_num_with_mark + 1);
+			*missing_seq_num_count = distance;
+			return tsk_false;
 		}
-		if(item == self->pkts->tail){
-			if(!(is_complete = (pkt->header->marker))){
-				*missing_seq_num_start = (pkt->header->seq_num + 1);
-				*missing_seq_num_count = 1;
-			}
+		// no hole
+		if(self->pkts_count != self->pkts_span){
+			for(i = 0; i < self->pkts_span && self->pkts[i]; ++i) ;
+			for(j = i; j < self->pkts_span && !self->pkts[j]; ++j) ;
+			*missing_seq_num_start = (uint16_t)(self->lowest_seq_num + i);
+			*missing_seq_num_count = (int32_t)(j - i);
+			return tsk_false;
 		}
 	}
-	tsk_list_unlock(self->pkts);
 
-	return is_complete;
+	// the last packet is never null
+	if(!self->pkts[self->pkts_span - 1]->header->marker){
+		*missing_seq_num_start = (uint16_t)(self->highest_seq_num + 1);
+		*missing_seq_num_count = 1;
+		return tsk_false;
+	}
+	return tsk_true;
+}
+
+static int _tdav_video_frame_reserve(tdav_video_frame_t* self, tsk_size_t span)
+{
+	tsk_size_t capacity;
+	trtp_rtp_packet_t** pkts;
+
+	if(span <= self->pkts_capacity){
+		return 0;
+	}
+	if(span > TDAV_VIDEO_FRAME_PKTS_MAX){
+		TSK_DEBUG_ERROR("Too many packets in the video frame (%u > %u)", (unsigned)span, TDAV_VIDEO_FRAME_PKTS_MAX);
+		return -1;
+	}
+	capacity = TSK_MAX(TSK_MAX(span, (self->pkts_capacity << 1)), TDAV_VIDEO_FRAME_PKTS_GROW_MIN);
+	capacity = TSK_MIN(capacity, TDAV_VIDEO_FRAME_PKTS_MAX);
+	if(!(pkts = tsk_realloc(self->pkts, capacity * sizeof(trtp_rtp_packet_t*)))){
+		TSK_DEBUG_ERROR("Failed to allocate packets array");
+		return -2;
+	}
+	memset(&pkts[self->pkts_capacity], 0, (capacity - self->pkts_capacity) * sizeof(trtp_rtp_packet_t*));
+	self->pkts = pkts;
+	self->pkts_capacity = capacity;
+	return 0;
 }
@@ -24,6 +24,9 @@
  */
 #include "tinydav/video/jb/tdav_video_jb.h"
 #include "tinydav/video/jb/tdav_video_frame.h"
+#include "tinydav/video/jb/tdav_video_jb_pool.h"
+
+#include "tinymedia/tmedia_defaults.h"
 
 #include "tinyrtp/rtp/trtp_rtp_packet.h"
 
@@ -56,12 +59,20 @@
 #	define TDAV_VIDEO_JB_TAIL_MAX		(TDAV_VIDEO_JB_FPS_MAX << TDAV_VIDEO_JB_TAIL_MAX_LOG2)
 #endif
 
+// Size of the frames ring: "tail_max" can't be higher
+#define TDAV_VIDEO_JB_FRAMES_MAX		(TDAV_VIDEO_JB_FPS_MAX << TDAV_VIDEO_JB_TAIL_MAX_LOG2)
+
 #define TDAV_VIDEO_JB_RATE				90 /* KHz */
 
 #define TDAV_VIDEO_JB_LATENCY_MIN		2 /* Must be > 0 */
 #define TDAV_VIDEO_JB_LATENCY_MAX		15 /* Default, will be updated using fps */
 
 static const tdav_video_frame_t* _tdav_video_jb_get_frame(struct tdav_video_jb_s* self, uint32_t timestamp, uint8_t pt, tsk_bool_t *pt_matched);
+static int _tdav_video_jb_frames_insert(struct tdav_video_jb_s* self, tdav_video_frame_t** frame);
+static tdav_video_frame_t* _tdav_video_jb_frames_pop_first(struct tdav_video_jb_s* self);
+static void _tdav_video_jb_frames_clear(struct tdav_video_jb_s* self);
+static uint64_t _tdav_video_jb_decode_next(struct tdav_video_jb_s* self, uint64_t now);
+static uint64_t _tdav_video_jb_decode_pool_cb(const void* usr_data);
 static void* TSK_STDCALL _tdav_video_jb_decode_thread_func(void *arg);
 
 typedef struct tdav_video_jb_s
@@ -76,7 +87,9 @@ typedef struct tdav_video_jb_s
 	uint32_t last_timestamp;
 	int32_t conseq_frame_drop;
 	int32_t tail_max;
-	tdav_video_frames_L_t *frames;
+	// ring of frames sorted by timestamp, protected by the safeobj
+	tdav_video_frame_t* frames[TDAV_VIDEO_JB_FRAMES_MAX];
+	tsk_size_t frames_head;
 	int64_t frames_count;
 
 	tsk_size_t latency_min;
@@ -85,8 +98,12 @@ typedef struct tdav_video_jb_s
 	uint32_t decode_last_timestamp;
 	int32_t decode_last_seq_num_with_mark; // -1 = unset
 	uint64_t decode_last_time;
+	int32_t decode_prev_missing_seq_num_start;
+	int32_t decode_prev_missing_seq_num_count;
+	tsk_bool_t decode_cleaning_delay;
 	tsk_thread_handle_t* decode_thread[1];
 	tsk_condwait_handle_t* decode_thread_cond;
+	struct tdav_video_jb_pool_task_s* decode_task; // set when decoding on the shared pool instead of "decode_thread"
 
 	uint16_t seq_nums[0xFF];
 	tdav_video_jb_cb_f callback;
@@ -111,10 +128,6 @@ static tsk_object_t* tdav_video_jb_ctor(tsk_object_t * self, va_list * app)
 {
 	tdav_video_jb_t *jb = self;
 	if(jb){
-		if(!(jb->frames = tsk_list_create())){
-			TSK_DEBUG_ERROR("Failed to create list");
-			return tsk_null;
-		}
 		if(!(jb->decode_thread_cond = tsk_condwait_create())){
 			TSK_DEBUG_ERROR("Failed to create condition var");
 			return tsk_null;
@@ -142,7 +155,7 @@ static tsk_object_t* tdav_video_jb_dtor(tsk_object_t * self)
 		if(jb->started){
 			tdav_video_jb_stop(jb);
 		}
-		TSK_OBJECT_SAFE_FREE(jb->frames);
+		_tdav_video_jb_frames_clear(jb);
 		if(jb->decode_thread_cond){
 			tsk_condwait_destroy(&jb->decode_thread_cond);
 		}
@@ -208,6 +221,18 @@ int tdav_video_jb_start(tdav_video_jb_t* self)
 
 	self->started = tsk_true;
 
+	self->decode_last_seq_num_with_mark = -1; // -1 -> unset
+	self->decode_last_time = tsk_time_now();
+	self->decode_prev_missing_seq_num_start = self->decode_prev_missing_seq_num_count = 0;
+	self->decode_cleaning_delay = tsk_false;
+
+	if(tmedia_defaults_get_videojb_decode_pool_enabled()){
+		if((self->decode_task = tdav_video_jb_pool_attach(_tdav_video_jb_decode_pool_cb, self))){
+			return 0;
+		}
+		TSK_DEBUG_WARN("Failed to attach the video jitter buffer to the decode pool, using a dedicated thread");
+	}
+
 	if(!self->decode_thread[0]){
 		ret = tsk_thread_create(&self->decode_thread[0], _tdav_video_jb_decode_thread_func, self);
 		if(ret != 0 || !self->decode_thread[0]){
@@ -226,7 +251,7 @@ int tdav_video_jb_put(tdav_video_jb_t* self, trtp_rtp_packet_t* rtp_pkt)
     self->callback(&self->cb_data_rtp);
 #else
 	const tdav_video_frame_t* old_frame;
-	tsk_bool_t pt_matched = tsk_false, is_frame_late_or_dup = tsk_false, is_restarted = tsk_false;
+	tsk_bool_t pt_matched = tsk_false, is_frame_late_or_dup = tsk_false, is_restarted = tsk_false, wakeup = tsk_false;
 	uint16_t* seq_num;
 
 	if(!self || !rtp_pkt || !rtp_pkt->header){
@@ -289,13 +314,11 @@ int tdav_video_jb_put(tdav_video_jb_t* self, trtp_rtp_packet_t* rtp_pkt)
 			}
 			self->last_timestamp = rtp_pkt->header->timestamp;
 			
-			tsk_list_lock(self->frames);
 			if(self->frames_count >= self->tail_max){
 				if(++self->conseq_frame_drop >= self->tail_max){
 					TSK_DEBUG_ERROR("Too many frames dropped and fps=%d", self->fps);
-					tsk_list_clear_items(self->frames);
+					_tdav_video_jb_frames_clear(self);
 					self->conseq_frame_drop = 0;
-					self->frames_count = 1;
 					if(self->callback){
 						self->cb_data_any.type = tdav_video_jb_cb_data_type_tmfr;
 						self->cb_data_any.ssrc = rtp_pkt->header->ssrc;
@@ -303,16 +326,17 @@ int tdav_video_jb_put(tdav_video_jb_t* self, trtp_rtp_packet_t* rtp_pkt)
 					}
 				}
 				else{
+					tdav_video_frame_t* dropped_frame;
 					TSK_DEBUG_INFO("Dropping video frame because frames_count(%lld)>=tail_max(%d)", self->frames_count, self->tail_max);
-					tsk_list_remove_first_item(self->frames);
+					dropped_frame = _tdav_video_jb_frames_pop_first(self);
+					TSK_OBJECT_SAFE_FREE(dropped_frame);
 				}
 				tdav_video_jb_reset_fps_prob(self);
 			}
-			else{
-				++self->frames_count;
-			}
-			tsk_list_push_ascending_data(self->frames, (void**)&new_frame);
-			tsk_list_unlock(self->frames);
+			_tdav_video_jb_frames_insert(self, &new_frame);
+			TSK_OBJECT_SAFE_FREE(new_frame); // not null only if the insertion failed
+			// enough frames to start decoding: do not wait for the pool to check again
+			wakeup = (self->decode_task && self->frames_count == (int64_t)self->latency_min);
 		}
 		if(self->fps_prob <= 0 && self->avg_duration){
 			// compute FPS using timestamp values
@@ -336,6 +360,10 @@ int tdav_video_jb_put(tdav_video_jb_t* self, trtp_rtp_packet_t* rtp_pkt)
 		tdav_video_frame_put((tdav_video_frame_t*)old_frame, rtp_pkt);
 	}
 
+	if(wakeup){
+		tdav_video_jb_pool_wakeup(self->decode_task); // under the lock: stop() detaches the task
+	}
+
 	tsk_safeobj_unlock(self);
 
 	if(!is_frame_late_or_dup || is_restarted){
@@ -361,6 +389,15 @@ int tdav_video_jb_stop(tdav_video_jb_t* self)
 
 	self->started = tsk_false;
 
+	if(self->decode_task){
+		struct tdav_video_jb_pool_task_s* decode_task;
+		tsk_safeobj_lock(self); // against put()
+		decode_task = self->decode_task;
+		self->decode_task = tsk_null;
+		tsk_safeobj_unlock(self);
+		return tdav_video_jb_pool_detach(&decode_task);
+	}
+
 	ret = tsk_condwait_broadcast(self->decode_thread_cond);
 	
 	if(self->decode_thread[0]){
@@ -370,165 +407,199 @@ int tdav_video_jb_stop(tdav_video_jb_t* self)
 	return ret;
 }
 
+// must be called with the safeobj locked
 static const tdav_video_frame_t* _tdav_video_jb_get_frame(tdav_video_jb_t* self, uint32_t timestamp, uint8_t pt, tsk_bool_t *pt_matched)
 {
-	const tdav_video_frame_t* ret = tsk_null;
-	const tsk_list_item_t *item;
+	const tdav_video_frame_t* frame;
+	tsk_size_t i;
 	
 	*pt_matched =tsk_false;
 
-	tsk_list_lock(self->frames);
-	tsk_list_foreach(item, self->frames){
-		if(TDAV_VIDEO_FRAME(item->data)->payload_type == pt){
-			if(!(*pt_matched)) *pt_matched = tsk_true;
-			if(TDAV_VIDEO_FRAME(item->data)->timestamp == timestamp){
-				ret = item->data;
-				break;
+	// newest first: almost all packets belong to the last frame
+	for(i = (tsk_size_t)self->frames_count; i > 0; --i){
+		frame = self->frames[(self->frames_head + i - 1) % TDAV_VIDEO_JB_FRAMES_MAX];
+		if(frame->payload_type == pt){
+			*pt_matched = tsk_true;
+			if(frame->timestamp == timestamp){
+				return frame;
 			}
 		}
-		
 	}
-	tsk_list_unlock(self->frames);
 
-	return ret;
+	return tsk_null;
 }
 
-static void* TSK_STDCALL _tdav_video_jb_decode_thread_func(void *arg)
+// must be called with the safeobj locked. Takes the ownership of the frame (set to null) if succeed.
+static int _tdav_video_jb_frames_insert(tdav_video_jb_t* self, tdav_video_frame_t** frame)
 {
-	tdav_video_jb_t* jb = (tdav_video_jb_t*)arg;
-	//uint64_t delay;
-	int32_t missing_seq_num_start = 0, prev_missing_seq_num_start = 0;
-	int32_t missing_seq_num_count = 0, prev_lasted_missing_seq_num_count = 0;
-	const tdav_video_frame_t* frame;
-	tsk_list_item_t* item;
-	uint64_t next_decode_duration = 0, now, _now;
-	//uint64_t x_decode_duration = (1000 / jb->fps); // expected
-	//uint64_t x_decode_time = tsk_time_now();//expected
-	tsk_bool_t postpone, cleaning_delay = tsk_false;
-	static const uint64_t __toomuch_delay_to_be_valid = 10000; // guard against systems with buggy "tsk_time_now()" -Won't say Windows ...but :)-
-
-	jb->decode_last_seq_num_with_mark = -1; // -1 -> unset
-	jb->decode_last_time = tsk_time_now();
-
-	(void)(now);
-	//(void)(delay);
-	
-	TSK_DEBUG_INFO("Video jitter buffer thread - ENTER");
+	tsk_size_t i;
+	tdav_video_frame_t* prev;
 
-	while(jb->started){
-		now = tsk_time_now();
-		if (next_decode_duration > 0) {
-			tsk_condwait_timedwait(jb->decode_thread_cond, next_decode_duration);
-		}
-
-		if(!jb->started){
+	if(self->frames_count >= TDAV_VIDEO_JB_FRAMES_MAX){
+		TSK_DEBUG_ERROR("Video frames ring is full");
+		return -1;
+	}
+	// ascending timestamps: shift the newer frames (only when the frames are reordered)
+	for(i = (tsk_size_t)self->frames_count; i > 0; --i){
+		prev = self->frames[(self->frames_head + i - 1) % TDAV_VIDEO_JB_FRAMES_MAX];
+		if(tsk_object_cmp(prev, *frame) <= 0){
 			break;
 		}
+		self->frames[(self->frames_head + i) % TDAV_VIDEO_JB_FRAMES_MAX] = prev;
+	}
+	self->frames[(self->frames_head + i) % TDAV_VIDEO_JB_FRAMES_MAX] = *frame;
+	*frame = tsk_null;
+	++self->frames_count;
+	return 0;
+}
+
+// must be called with the safeobj locked
+static tdav_video_frame_t* _tdav_video_jb_frames_pop_first(tdav_video_jb_t* self)
+{
+	tdav_video_frame_t* frame;
+	if(self->frames_count <= 0){
+		return tsk_null;
+	}
+	frame = self->frames[self->frames_head];
+	self->frames[self->frames_head] = tsk_null;
+	self->frames_head = (self->frames_head + 1) % TDAV_VIDEO_JB_FRAMES_MAX;
+	--self->frames_count;
+	return frame;
+}
 
-		// TSK_DEBUG_INFO("Frames count = %d", jb->frames_count);
+// must be called with the safeobj locked
+static void _tdav_video_jb_frames_clear(tdav_video_jb_t* self)
+{
+	tdav_video_frame_t* frame;
+	while((frame = _tdav_video_jb_frames_pop_first(self))){
+		TSK_OBJECT_SAFE_FREE(frame);
+	}
+	self->frames_head = 0;
+}
 
-		if(jb->frames_count >= (int64_t)jb->latency_min){
-			item = tsk_null;
-			postpone = tsk_false;
-            
-			tsk_safeobj_lock(jb); // against get_frame()
-			tsk_list_lock(jb->frames); // against put()
-			
-			// is it still acceptable to wait for missing packets?
-			if (jb->frames_count < (int64_t)jb->latency_max){
-				frame = (const tdav_video_frame_t*)jb->frames->head->data;
-				if(!tdav_video_frame_is_complete(frame, jb->decode_last_seq_num_with_mark, &missing_seq_num_start, &missing_seq_num_count)){
-					TSK_DEBUG_INFO("Time to decode frame...but some RTP packets are missing (missing_seq_num_start=%d, missing_seq_num_count=%d, last_seq_num_with_mark=%d). Postpone :(", missing_seq_num_start, missing_seq_num_count, jb->decode_last_seq_num_with_mark);
-					// signal to the session that a sequence number is missing (will send a NACK)
-					// the missing seqnum has been already requested in jb_put() and here we request it again only ONE time
-					if(jb->callback){
-						if(prev_missing_seq_num_start != missing_seq_num_start || prev_lasted_missing_seq_num_count != missing_seq_num_count){ // guard to request it only once
-							jb->cb_data_any.type = tdav_video_jb_cb_data_type_fl;
-							jb->cb_data_any.ssrc = frame->ssrc;
-							jb->cb_data_any.fl.seq_num = prev_missing_seq_num_start = missing_seq_num_start;
-							jb->cb_data_any.fl.count = prev_lasted_missing_seq_num_count = missing_seq_num_count;
-							jb->callback(&jb->cb_data_any);
-						}
-						postpone = tsk_true;
-					}
-				}
-			}
-			else{
-				TSK_DEBUG_INFO("frames_count(%lld)>=latency_max(%u)...decoding video frame even if pkts are missing :(", jb->frames_count, (unsigned)jb->latency_max);
-				jb->decode_last_seq_num_with_mark = -1; // unset()
-			}
-			if(!postpone){
-				item = tsk_list_pop_first_item(jb->frames);
-				--jb->frames_count;
-			}
-			tsk_list_unlock(jb->frames);
-			tsk_safeobj_unlock(jb);
-            
-			if(item){
-				jb->decode_last_timestamp = ((const tdav_video_frame_t*)item->data)->timestamp;
+// decodes the next frame (if it's time to) and returns the number of milliseconds to wait before the next call
+// "now" is the time when the previous wait started
+static uint64_t _tdav_video_jb_decode_next(tdav_video_jb_t* jb, uint64_t now)
+{
+	int32_t missing_seq_num_start = 0, missing_seq_num_count = 0;
+	const tdav_video_frame_t* frame;
+	tdav_video_frame_t* popped_frame;
+	uint64_t next_decode_duration = 0, _now;
+	tsk_bool_t postpone;
+
+	// TSK_DEBUG_INFO("Frames count = %d", jb->frames_count);
+
+	if(jb->frames_count >= (int64_t)jb->latency_min){
+		popped_frame = tsk_null;
+		postpone = tsk_false;
+
+		tsk_safeobj_lock(jb); // against put()
+
+		if (jb->frames_count <= 0){
+			postpone = tsk_true; // cleared by put()
+		}
+		// is it still acceptable to wait for missing packets?
+		else if (jb->frames_count < (int64_t)jb->latency_max){
+			frame = jb->frames[jb->frames_head];
+			if(!tdav_video_frame_is_complete(frame, jb->decode_last_seq_num_with_mark, &missing_seq_num_start, &missing_seq_num_count)){
+				TSK_DEBUG_INFO("Time to decode frame...but some RTP packets are missing (missing_seq_num_start=%d, missing_seq_num_count=%d, last_seq_num_with_mark=%d). Postpone :(", missing_seq_num_start, missing_seq_num_count, jb->decode_last_seq_num_with_mark);
+				// signal to the session that a sequence number is missing (will send a NACK)
+				// the missing seqnum has been already requested in jb_put() and here we request it again only ONE time
 				if(jb->callback){
-					trtp_rtp_packet_t* pkt;
-					const tsk_list_item_t* _item = item; // save memory address as "tsk_list_foreach() will change it for each loop"
-					int32_t last_seq_num = -1; // guard against duplicated packets
-					frame = _item->data;
-					tsk_list_foreach(_item, frame->pkts){
-						if(!(pkt = _item->data) || !pkt->payload.size || !pkt->header || pkt->header->seq_num == last_seq_num || !jb->started){
-							TSK_DEBUG_ERROR("Skipping invalid rtp packet (do not decode!)");
-							continue;
-						}					
-						jb->cb_data_rtp.rtp.pkt = pkt;
-						jb->callback(&jb->cb_data_rtp);
-						if(pkt->header->marker){
-							jb->decode_last_seq_num_with_mark = pkt->header->seq_num;
-						}
+					if(jb->decode_prev_missing_seq_num_start != missing_seq_num_start || jb->decode_prev_missing_seq_num_count != missing_seq_num_count){ // guard to request it only once
+						jb->cb_data_any.type = tdav_video_jb_cb_data_type_fl;
+						jb->cb_data_any.ssrc = frame->ssrc;
+						jb->cb_data_any.fl.seq_num = jb->decode_prev_missing_seq_num_start = missing_seq_num_start;
+						jb->cb_data_any.fl.count = jb->decode_prev_missing_seq_num_count = missing_seq_num_count;
+						jb->callback(&jb->cb_data_any);
 					}
+					postpone = tsk_true;
 				}
-	            
-				TSK_OBJECT_SAFE_FREE(item);
 			}
 		}
-		
-#if 1
-		if (cleaning_delay || jb->frames_count > (int64_t)jb->latency_max){
-			//x_decode_time = now;
-			next_decode_duration = 0;
-			cleaning_delay = ((jb->frames_count << 1) > (int64_t)jb->latency_max); // cleanup up2 half
-		}
 		else{
-			next_decode_duration = (1000 / jb->fps);
-			_now = tsk_time_now();
-			if (_now > now) {
-				if ((_now - now) > next_decode_duration){
-					next_decode_duration = 0;
-				}
-				else {
-					next_decode_duration -= (_now - now);
+			TSK_DEBUG_INFO("frames_count(%lld)>=latency_max(%u)...decoding video frame even if pkts are missing :(", jb->frames_count, (unsigned)jb->latency_max);
+			jb->decode_last_seq_num_with_mark = -1; // unset()
+		}
+		if(!postpone){
+			popped_frame = _tdav_video_jb_frames_pop_first(jb);
+		}
+		tsk_safeobj_unlock(jb);
+
+		if(popped_frame){
+			jb->decode_last_timestamp = popped_frame->timestamp;
+			if(jb->callback){
+				trtp_rtp_packet_t* pkt;
+				tsk_size_t i;
+				// the packets are passed to the decoder as received (no copy), in sequence order
+				for(i = 0; i < popped_frame->pkts_span; ++i){
+					if(!(pkt = popped_frame->pkts[i])){
+						continue; // missing
+					}
+					if(!pkt->payload.size || !pkt->header || !jb->started){
+						TSK_DEBUG_ERROR("Skipping invalid rtp packet (do not decode!)");
+						continue;
+					}
+					jb->cb_data_rtp.rtp.pkt = pkt;
+					jb->callback(&jb->cb_data_rtp);
+					if(pkt->header->marker){
+						jb->decode_last_seq_num_with_mark = pkt->header->seq_num;
+					}
 				}
 			}
-			//delay = ( (now > x_decode_time) ? (now - x_decode_time) : (x_decode_duration >> 1)/* do not use zero to avoid endless loop when there is no frame to display */ );
-			//next_decode_duration = (delay > x_decode_duration) ? 0 : (x_decode_duration - delay);
-			//x_decode_duration = (1000 / jb->fps);
-			//x_decode_time += x_decode_duration;
+
+			TSK_OBJECT_SAFE_FREE(popped_frame);
+		}
+	}
+
+	if (jb->decode_cleaning_delay || jb->frames_count > (int64_t)jb->latency_max){
+		next_decode_duration = 0;
+		jb->decode_cleaning_delay = ((jb->frames_count << 1) > (int64_t)jb->latency_max); // cleanup up2 half
+	}
+	else{
+		next_decode_duration = (1000 / jb->fps);
+		_now = tsk_time_now();
+		if (_now > now) {
+			if ((_now - now) > next_decode_duration){
+				next_decode_duration = 0;
+			}
+			else {
+				next_decode_duration -= (_now - now);
+			}
 		}
-		//delay = /*(now - x_decode_time);*/(now > x_decode_time) ? (now - x_decode_time) : ( (jb->frames_count >= jb->latency_max) ? 0 : (x_decode_duration >> 1) )/* do not use zero to avoid endless loop when there is no frame to display */;
-		// delay = (jb->frames_count > jb->latency_max) ? 0 : ( (now > x_decode_time) ? (now - x_decode_time) : (x_decode_duration >> 1)/* do not use zero to avoid endless loop when there is no frame to display */ );
-		// comparison used as guard against time wrapping
-		/*if(delay > __toomuch_delay_to_be_valid){
-			TSK_DEBUG_INFO("Too much delay (%llu) in video jb. Reseting...", delay);
-			x_decode_time = now;
-			next_decode_duration = 0;
+	}
+
+	return next_decode_duration;
+}
+
+// called by the shared decode pool
+static uint64_t _tdav_video_jb_decode_pool_cb(const void* usr_data)
+{
+	tdav_video_jb_t* jb = (tdav_video_jb_t*)usr_data;
+	if(!jb->started){
+		return (1000 / jb->fps); // about to be detached
+	}
+	return _tdav_video_jb_decode_next(jb, tsk_time_now());
+}
+
+static void* TSK_STDCALL _tdav_video_jb_decode_thread_func(void *arg)
+{
+	tdav_video_jb_t* jb = (tdav_video_jb_t*)arg;
+	uint64_t next_decode_duration = 0, now;
+
+	TSK_DEBUG_INFO("Video jitter buffer thread - ENTER");
+
+	while(jb->started){
+		now = tsk_time_now();
+		if (next_decode_duration > 0) {
+			tsk_condwait_timedwait(jb->decode_thread_cond, next_decode_duration);
 		}
-		else*/{
-			//next_decode_duration = (delay > x_decode_duration) ? 0 : (x_decode_duration - delay);
-			//x_decode_duration = (1000 / jb->fps);
-			//x_decode_time += x_decode_duration;
+
+		if(!jb->started){
+			break;
 		}
-		
 
-		//TSK_DEBUG_INFO("next_decode_timeout=%llu, delay = %llu", next_decode_duration, delay);
-#else
-		next_decode_duration = (1000 / jb->fps);
-#endif
+		next_decode_duration = _tdav_video_jb_decode_next(jb, now);
 	}
 
 	TSK_DEBUG_INFO("Video jitter buffer thread - EXIT");
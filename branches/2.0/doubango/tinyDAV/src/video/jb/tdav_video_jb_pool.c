@@ -0,0 +1,385 @@
+/*
+* Copyright (C) 2011-2015 Mamadou DIOP
+* Copyright (C) 2011-2015 Doubango Telecom <http://www.doubango.org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_video_jb_pool.c
+ * @brief Decode pool shared by all video jitter buffers.
+ * Each jitter buffer is attached as a task to the least loaded worker (its home). A worker runs its own due tasks first and, when it has
+ * nothing to do, steals the late tasks of the busy workers. A task never runs on two workers at the same time which means the frames of a
+ * session are always decoded in order.
+ * The workers sleep until their next due task (or the next task they could steal) and are woken up by @ref tdav_video_jb_pool_wakeup() when a
+ * jitter buffer has a frame ready. The mutex is only held to pick a task and to reschedule it, never while decoding.
+ */
+#include "tinydav/video/jb/tdav_video_jb_pool.h"
+
+#include "tinymedia/tmedia_scheduler.h"
+
+#include "tsk_time.h"
+#include "tsk_memory.h"
+#include "tsk_thread.h"
+#include "tsk_mutex.h"
+#include "tsk_condwait.h"
+#include "tsk_semaphore.h"
+#include "tsk_debug.h"
+
+#define TDAV_VIDEO_JB_POOL_GROW_SIZE		8
+#define TDAV_VIDEO_JB_POOL_STEAL_LATENESS	5 /* milliseconds a task must be late before being stolen by another worker */
+#define TDAV_VIDEO_JB_POOL_IDLE_PERIOD		500 /* maximum sleep: a signal sent while the worker is not yet waiting on its condition is lost */
+
+typedef struct tdav_video_jb_pool_task_s
+{
+	tdav_video_jb_pool_task_cb_f callback;
+	const void* usr_data;
+	uint64_t next_time; // in milliseconds
+	tsk_bool_t running;
+	tsk_semaphore_handle_t* detach_sem; // set by detach() while the task is running
+	struct tdav_video_jb_pool_worker_s* worker; // home worker, null when the pool is destroyed
+}
+tdav_video_jb_pool_task_t;
+
+typedef struct tdav_video_jb_pool_worker_s
+{
+	tsk_size_t index;
+	tsk_thread_handle_t* thread[1];
+	tsk_condwait_handle_t* cond;
+	tsk_bool_t busy; // running a task
+	tdav_video_jb_pool_task_t** tasks;
+	tsk_size_t tasks_count;
+	tsk_size_t tasks_capacity;
+	uint64_t steals;
+}
+tdav_video_jb_pool_worker_t;
+
+static struct
+{
+	tsk_bool_t running;
+	tsk_mutex_handle_t* mutex;
+	tdav_video_jb_pool_worker_t* workers;
+	tsk_size_t workers_count;
+	tsk_size_t tasks_count;
+}
+__pool = { tsk_false, tsk_null, tsk_null, 0, 0 };
+
+static void* TSK_STDCALL _tdav_video_jb_pool_worker_thread_func(void *arg);
+
+/** Must be called once before attaching any task (see @ref tdav_init). The workers are only started when the first task is attached. */
+int tdav_video_jb_pool_init()
+{
+	if(!__pool.mutex && !(__pool.mutex = tsk_mutex_create())){
+		TSK_DEBUG_ERROR("Failed to create mutex");
+		return -1;
+	}
+	return 0;
+}
+
+// must be called with the mutex locked
+static int _tdav_video_jb_pool_start()
+{
+	tsk_size_t i;
+	int ret;
+	tsk_size_t count = (tsk_size_t)tmedia_scheduler_get_cpu_budget();
+
+	if(!(__pool.workers = tsk_calloc(count, sizeof(tdav_video_jb_pool_worker_t)))){
+		TSK_DEBUG_ERROR("Failed to allocate workers");
+		return -1;
+	}
+	__pool.running = tsk_true;
+	for(i = 0; i < count; ++i){
+		__pool.workers[i].index = i;
+		if(!(__pool.workers[i].cond = tsk_condwait_create())){
+			TSK_DEBUG_ERROR("Failed to create condition var");
+			break;
+		}
+		if((ret = tsk_thread_create(&__pool.workers[i].thread[0], _tdav_video_jb_pool_worker_thread_func, &__pool.workers[i])) != 0 || !__pool.workers[i].thread[0]){
+			TSK_DEBUG_ERROR("Failed to create new thread");
+			tsk_condwait_destroy(&__pool.workers[i].cond);
+			break;
+		}
+		tsk_thread_set_priority(__pool.workers[i].thread[0], TSK_THREAD_PRIORITY_HIGH); // not above the network and audio threads
+	}
+	__pool.workers_count = i;
+	TSK_DEBUG_INFO("Video decode pool started with %u workers", (unsigned)__pool.workers_count);
+	if(!__pool.workers_count){
+		__pool.running = tsk_false;
+		TSK_FREE(__pool.workers);
+		return -2;
+	}
+	return 0;
+}
+
+// must be called with the mutex locked
+static void _tdav_video_jb_pool_signal_idle(const tdav_video_jb_pool_worker_t* except)
+{
+	tsk_size_t i;
+	for(i = 0; i < __pool.workers_count; ++i){
+		if(&__pool.workers[i] != except && !__pool.workers[i].busy){
+			tsk_condwait_signal(__pool.workers[i].cond);
+			return;
+		}
+	}
+}
+
+/** Attaches a jitter buffer to the pool. The callback is called for the first time as soon as possible. */
+tdav_video_jb_pool_task_t* tdav_video_jb_pool_attach(tdav_video_jb_pool_task_cb_f callback, const void* usr_data)
+{
+	tdav_video_jb_pool_task_t* task = tsk_null;
+	tdav_video_jb_pool_worker_t* worker;
+	tsk_size_t i;
+
+	if(!callback){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return tsk_null;
+	}
+	if(!__pool.mutex){
+		TSK_DEBUG_ERROR("Video decode pool not initialized");
+		return tsk_null;
+	}
+
+	tsk_mutex_lock(__pool.mutex);
+	if(!__pool.workers_count && _tdav_video_jb_pool_start() != 0){
+		goto bail;
+	}
+	// home = least loaded worker
+	worker = &__pool.workers[0];
+	for(i = 1; i < __pool.workers_count; ++i){
+		if(__pool.workers[i].tasks_count < worker->tasks_count){
+			worker = &__pool.workers[i];
+		}
+	}
+	if(worker->tasks_count == worker->tasks_capacity){
+		tdav_video_jb_pool_task_t** tasks = tsk_realloc(worker->tasks, (worker->tasks_capacity + TDAV_VIDEO_JB_POOL_GROW_SIZE) * sizeof(tdav_video_jb_pool_task_t*));
+		if(!tasks){
+			TSK_DEBUG_ERROR("Failed to allocate tasks");
+			goto bail;
+		}
+		worker->tasks = tasks;
+		worker->tasks_capacity += TDAV_VIDEO_JB_POOL_GROW_SIZE;
+	}
+	if(!(task = tsk_calloc(1, sizeof(tdav_video_jb_pool_task_t)))){
+		TSK_DEBUG_ERROR("Failed to allocate task");
+		goto bail;
+	}
+	task->callback = callback;
+	task->usr_data = usr_data;
+	task->worker = worker;
+	worker->tasks[worker->tasks_count++] = task;
+	++__pool.tasks_count;
+	tsk_condwait_signal(worker->cond);
+
+bail:
+	tsk_mutex_unlock(__pool.mutex);
+	return task;
+}
+
+/** Detaches a jitter buffer from the pool. Waits for the step in progress (if any): the callback will never be called after this function returns. */
+int tdav_video_jb_pool_detach(tdav_video_jb_pool_task_t** task)
+{
+	tdav_video_jb_pool_worker_t* worker;
+	tsk_size_t i;
+
+	if(!task){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(!*task){
+		return 0;
+	}
+
+	if(__pool.mutex){
+		tsk_mutex_lock(__pool.mutex);
+		if((*task)->running){
+			// the worker posts the semaphore when the step in progress ends
+			if(!((*task)->detach_sem = tsk_semaphore_create_2(0))){
+				TSK_DEBUG_ERROR("Failed to create semaphore");
+				tsk_mutex_unlock(__pool.mutex);
+				return -2;
+			}
+			tsk_mutex_unlock(__pool.mutex);
+			tsk_semaphore_decrement((*task)->detach_sem);
+			tsk_mutex_lock(__pool.mutex);
+			tsk_semaphore_destroy(&(*task)->detach_sem);
+		}
+		if((worker = (*task)->worker)){
+			for(i = 0; i < worker->tasks_count; ++i){
+				if(worker->tasks[i] == *task){
+					worker->tasks[i] = worker->tasks[--worker->tasks_count];
+					--__pool.tasks_count;
+					break;
+				}
+			}
+		}
+		tsk_mutex_unlock(__pool.mutex);
+	}
+	TSK_FREE(*task);
+	return 0;
+}
+
+/** Schedules the next step of a task as soon as possible (e.g. a frame is ready to be decoded) instead of waiting for the delay returned by its callback. */
+int tdav_video_jb_pool_wakeup(tdav_video_jb_pool_task_t* task)
+{
+	uint64_t now;
+
+	if(!task){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(!__pool.mutex){
+		return 0;
+	}
+
+	now = tsk_time_now();
+	tsk_mutex_lock(__pool.mutex);
+	if(task->worker && !task->running && task->next_time > now){
+		task->next_time = now;
+		if(!task->worker->busy){
+			tsk_condwait_signal(task->worker->cond);
+		}
+		else{
+			_tdav_video_jb_pool_signal_idle(task->worker); // to steal the task if the home worker is still busy when it becomes late
+		}
+	}
+	tsk_mutex_unlock(__pool.mutex);
+	return 0;
+}
+
+/** Stops the workers. The tasks still attached will never be called again. */
+int tdav_video_jb_pool_deinit()
+{
+	tsk_size_t i, j;
+
+	if(!__pool.mutex){
+		return 0;
+	}
+
+	tsk_mutex_lock(__pool.mutex);
+	__pool.running = tsk_false;
+	tsk_mutex_unlock(__pool.mutex);
+
+	for(i = 0; i < __pool.workers_count; ++i){
+		tsk_condwait_signal(__pool.workers[i].cond);
+		tsk_thread_join(&__pool.workers[i].thread[0]);
+		tsk_condwait_destroy(&__pool.workers[i].cond);
+		TSK_DEBUG_INFO("Video decode pool worker #%u: tasks=%u, steals=%llu", (unsigned)i, (unsigned)__pool.workers[i].tasks_count, (unsigned long long)__pool.workers[i].steals);
+		for(j = 0; j < __pool.workers[i].tasks_count; ++j){
+			__pool.workers[i].tasks[j]->worker = tsk_null;
+		}
+		TSK_FREE(__pool.workers[i].tasks);
+	}
+	TSK_FREE(__pool.workers);
+	__pool.workers_count = 0;
+	__pool.tasks_count = 0;
+
+	tsk_mutex_destroy(&__pool.mutex);
+	return 0;
+}
+
+// must be called with the mutex locked
+static tdav_video_jb_pool_task_t* _tdav_video_jb_pool_pick(tdav_video_jb_pool_worker_t* self, uint64_t now, uint64_t* wait)
+{
+	tsk_size_t i, j;
+	tdav_video_jb_pool_task_t *task, *oldest = tsk_null;
+	tdav_video_jb_pool_worker_t* other;
+
+	*wait = TDAV_VIDEO_JB_POOL_IDLE_PERIOD;
+
+	// own tasks first: the decoder's state is more likely to be in this core's cache
+	for(i = 0; i < self->tasks_count; ++i){
+		task = self->tasks[i];
+		if(task->running){
+			continue; // stolen by another worker
+		}
+		if(task->next_time <= now){
+			if(!oldest || task->next_time < oldest->next_time){
+				oldest = task;
+			}
+		}
+		else if((task->next_time - now) < *wait){
+			*wait = (task->next_time - now);
+		}
+	}
+	if(oldest){
+		return oldest;
+	}
+
+	// steal a late task from a busy worker, otherwise sleep until one of its tasks becomes late
+	for(j = 1; j < __pool.workers_count; ++j){
+		other = &__pool.workers[(self->index + j) % __pool.workers_count];
+		if(!other->busy){
+			continue; // will run its tasks on time
+		}
+		for(i = 0; i < other->tasks_count; ++i){
+			task = other->tasks[i];
+			if(task->running){
+				continue;
+			}
+			if((task->next_time + TDAV_VIDEO_JB_POOL_STEAL_LATENESS) <= now){
+				++self->steals;
+				return task;
+			}
+			if((task->next_time + TDAV_VIDEO_JB_POOL_STEAL_LATENESS - now) < *wait){
+				*wait = (task->next_time + TDAV_VIDEO_JB_POOL_STEAL_LATENESS - now);
+			}
+		}
+	}
+
+	return tsk_null;
+}
+
+static void* TSK_STDCALL _tdav_video_jb_pool_worker_thread_func(void *arg)
+{
+	tdav_video_jb_pool_worker_t* worker = (tdav_video_jb_pool_worker_t*)arg;
+	tdav_video_jb_pool_task_t* task;
+	uint64_t wait, delay;
+
+	TSK_DEBUG_INFO("Video decode pool worker #%u - ENTER", (unsigned)worker->index);
+
+	tmedia_scheduler_bind_current_thread();
+
+	while(__pool.running){
+		tsk_mutex_lock(__pool.mutex);
+		if((task = _tdav_video_jb_pool_pick(worker, tsk_time_now(), &wait))){
+			task->running = tsk_true;
+			worker->busy = tsk_true;
+			if(worker->tasks_count > 1){
+				_tdav_video_jb_pool_signal_idle(worker); // our other tasks could have to be stolen
+			}
+		}
+		tsk_mutex_unlock(__pool.mutex);
+
+		if(task){
+			delay = task->callback(task->usr_data);
+			tsk_mutex_lock(__pool.mutex);
+			task->next_time = tsk_time_now() + delay;
+			task->running = tsk_false;
+			worker->busy = tsk_false;
+			if(task->detach_sem){
+				tsk_semaphore_increment(task->detach_sem);
+			}
+			tsk_mutex_unlock(__pool.mutex);
+		}
+		else if(__pool.running){
+			tsk_condwait_timedwait(worker->cond, wait);
+		}
+	}
+
+	TSK_DEBUG_INFO("Video decode pool worker #%u - EXIT", (unsigned)worker->index);
+
+	return tsk_null;
+}
@@ -26,6 +26,8 @@
  */
 #include "tinydav/video/tdav_session_video.h"
 #include "tinydav/video/tdav_converter_video.h"
+#include "tinydav/video/tdav_video_pipeline.h"
+#include "tinydav/video/tdav_video_encgroup.h"
 #include "tinydav/video/jb/tdav_video_jb.h"
 #include "tinydav/codecs/fec/tdav_codec_red.h"
 #include "tinydav/codecs/fec/tdav_codec_ulpfec.h"
@@ -106,7 +108,12 @@ static const tmedia_codec_action_t __action_encode_bw_down = tmedia_codec_action
 	uint64_t __now = tsk_time_now(); \
 	tsk_bool_t too_close = tsk_false; \
 	if((__now - (__self)->avpf.last_fir_time) > TDAV_SESSION_VIDEO_AVPF_FIR_HONOR_INTERVAL_MIN){ /* guard to avoid sending too many FIR */ \
-		_tdav_session_video_codec_set((__self), "action", __action_encode_idr); \
+		if((__self)->encoder.group){ /* the encoder is owned by the group's leader */ \
+			tdav_video_encgroup_request_idr((__self)->encoder.group); \
+		} \
+		else { \
+			_tdav_session_video_codec_set((__self), "action", __action_encode_idr); \
+		} \
 	}else { too_close = tsk_true; TSK_DEBUG_INFO("***IDR request tooo close(%llu ms)...ignoring****", (__now - (__self)->avpf.last_fir_time)); } \
 	if((__self)->cb_rtcpevent.func){ \
 		(__self)->cb_rtcpevent.func((__self)->cb_rtcpevent.context, tmedia_rtcp_event_type_fir, (__ssrc_media)); \
@@ -139,9 +146,8 @@ static int _tdav_session_video_open_decoder(tdav_session_video_t* self, uint8_t
 static int _tdav_session_video_decode(tdav_session_video_t* self, const trtp_rtp_packet_t* packet);
 static int _tdav_session_video_set_callbacks(tmedia_session_t* self);
 
-// Codec callback (From codec to the network)
-// or Producer callback to sendRaw() data "as is"
-static int tdav_session_video_raw_cb(const tmedia_video_encode_result_xt* result)
+// Packetize and send an encoded chunk
+static int _tdav_session_video_raw_send(const tmedia_video_encode_result_xt* result)
 {
 	tdav_session_av_t* base = (tdav_session_av_t*)result->usr_data;
 	tdav_session_video_t* video = (tdav_session_video_t*)result->usr_data;
@@ -267,7 +273,15 @@ static int tdav_session_video_raw_cb(const tmedia_video_encode_result_xt* result
 				ret = tdav_codec_ulpfec_enc_protect((struct tdav_codec_ulpfec_s*)base->ulpfec.codec, packet);
 				if(result->last_chunck){
 					trtp_rtp_packet_t* packet_fec;
-					if((packet_fec = trtp_rtp_packet_create(base->rtp_manager->rtp.ssrc.local, base->ulpfec.seq_num++, base->ulpfec.timestamp, base->ulpfec.payload_type, tsk_true))){
+					// the FEC packet is created once and only its header fields change
+					if(!base->ulpfec.packet){
+						base->ulpfec.packet = trtp_rtp_packet_create(base->rtp_manager->rtp.ssrc.local, base->ulpfec.seq_num, base->ulpfec.timestamp, base->ulpfec.payload_type, tsk_true);
+					}
+					if((packet_fec = base->ulpfec.packet)){
+						packet_fec->header->ssrc = base->rtp_manager->rtp.ssrc.local;
+						packet_fec->header->seq_num = base->ulpfec.seq_num++;
+						packet_fec->header->timestamp = base->ulpfec.timestamp;
+						packet_fec->header->payload_type = base->ulpfec.payload_type;
 						// serialize the FEC payload packet packet
 						s = tdav_codec_ulpfec_enc_serialize((const struct tdav_codec_ulpfec_s*)base->ulpfec.codec, &video->encoder.buffer, &video->encoder.buffer_size);
 						if(s > 0){
@@ -275,7 +289,8 @@ static int tdav_session_video_raw_cb(const tmedia_video_encode_result_xt* result
 							packet_fec->payload.size = s;
 							s = trtp_manager_send_rtp_packet(base->rtp_manager, packet_fec, tsk_true/* already encrypted */);
 						}
-						TSK_OBJECT_SAFE_FREE(packet_fec);
+						packet_fec->payload.data_const = tsk_null; // not owned
+						packet_fec->payload.size = 0;
 					}
 					base->ulpfec.timestamp += result->duration;
 					ret = tdav_codec_ulpfec_enc_reset((struct tdav_codec_ulpfec_s*)base->ulpfec.codec);
@@ -313,6 +328,92 @@ bail:
 	return ret;
 }
 
+// Encode group callback (From the leader's codec to a member)
+static int _tdav_session_video_group_send_cb(struct tdav_session_video_s* member, const tmedia_video_encode_result_xt* result)
+{
+	tmedia_video_encode_result_xt result_member;
+
+	if(!member->started){
+		return 0;
+	}
+	result_member = *result;
+	result_member.usr_data = member;
+	result_member.proto_hdr = tsk_null; // the member uses its own RTP manager (SSRC, seq num, timestamp, payload type) and SRTP context
+	return _tdav_session_video_raw_send(&result_member);
+}
+
+// Encode group callback: whether the chunks encoded by the leader can be sent by the session "as is"
+// Called with the group locked: the leader cannot leave the group (and close its encoder) meanwhile
+static tsk_bool_t _tdav_session_video_group_match_cb(const struct tdav_session_video_s* leader, const struct tdav_session_video_s* session)
+{
+	const tmedia_codec_t *codec_leader = leader->encoder.codec, *codec = session->encoder.codec;
+	char *fmtp_leader, *fmtp;
+	tsk_bool_t match;
+
+	if(!codec_leader || !codec || codec_leader->plugin != codec->plugin){
+		return tsk_false;
+	}
+	if(TMEDIA_CODEC_VIDEO(codec_leader)->out.width != TMEDIA_CODEC_VIDEO(codec)->out.width || TMEDIA_CODEC_VIDEO(codec_leader)->out.height != TMEDIA_CODEC_VIDEO(codec)->out.height){
+		return tsk_false;
+	}
+	// negotiated format parameters (e.g. H.264 profile, level and packetization-mode)
+	fmtp_leader = tmedia_codec_sdp_att_get(codec_leader, "fmtp");
+	fmtp = tmedia_codec_sdp_att_get(codec, "fmtp");
+	match = tsk_striequals(fmtp_leader, fmtp) || (tsk_strnullORempty(fmtp_leader) && tsk_strnullORempty(fmtp));
+	TSK_FREE(fmtp_leader);
+	TSK_FREE(fmtp);
+	return match;
+}
+
+// Encode group callback: a member doesn't need its producer, a new leader feeds the encoder using its own producer
+static int _tdav_session_video_group_role_cb(struct tdav_session_video_s* session, tsk_bool_t leader)
+{
+	tmedia_producer_t* producer = TDAV_SESSION_AV(session)->producer;
+	int ret = 0;
+
+	if(!producer || !producer->is_started || session->encoder.producer_paused == !leader){
+		return 0;
+	}
+	// start() resumes a paused producer
+	if((ret = leader ? tmedia_producer_start(producer) : tmedia_producer_pause(producer)) == 0){
+		session->encoder.producer_paused = !leader;
+	}
+	else{
+		TSK_DEBUG_WARN("Failed to %s the producer of the encode group's %s", leader ? "restart" : "pause", leader ? "leader" : "member");
+	}
+	return ret;
+}
+
+// Joins the encode group or encodes alone if the session cannot share the leader's encoder
+static void _tdav_session_video_group_join(tdav_session_video_t* video)
+{
+	if(tdav_video_encgroup_join(video->encoder.group, video, _tdav_session_video_group_match_cb, _tdav_session_video_group_role_cb) != 0){
+		TSK_DEBUG_WARN("Failed to join the encode group: the session will use its own encoder");
+		TSK_OBJECT_SAFE_FREE(video->encoder.group);
+	}
+}
+
+// Codec callback (From codec to the network)
+// or Producer callback to sendRaw() data "as is"
+static int tdav_session_video_raw_cb(const tmedia_video_encode_result_xt* result)
+{
+	tdav_session_video_t* video = (tdav_session_video_t*)result->usr_data;
+	uint64_t start_us = video->encoder.pipeline ? tdav_video_pipeline_time_us() : 0;
+	int ret;
+
+	ret = _tdav_session_video_raw_send(result);
+
+	// encode once, send to all members of the group
+	if(video->encoder.group){
+		tdav_video_encgroup_fanout(video->encoder.group, video, _tdav_session_video_group_send_cb, result);
+	}
+
+	if(start_us){
+		video->encoder.send_duration_us += (tdav_video_pipeline_time_us() - start_us);
+	}
+	return ret;
+}
+
 // Codec Callback after decoding
 static int tdav_session_video_decode_cb(const tmedia_video_decode_result_xt* result)
 {
@@ -342,12 +443,13 @@ static int tdav_session_video_decode_cb(const tmedia_video_decode_result_xt* res
 	return 0;
 }
 
-// Producer callback (From the producer to the network) => encode data before send()
-static int tdav_session_video_producer_enc_cb(const void* callback_data, const void* buffer, tsk_size_t size)
+// Convert, encode and send a frame from the producer
+// Called on the producer's thread or on the pipeline's thread (if enabled)
+static int _tdav_session_video_encode(tdav_session_video_t* video, const void* buffer, tsk_size_t size)
 {
-	tdav_session_video_t* video = (tdav_session_video_t*)callback_data;
-	tdav_session_av_t* base = (tdav_session_av_t*)callback_data;
+	tdav_session_av_t* base = (tdav_session_av_t*)video;
 	tsk_size_t yuv420p_size = 0;
+	uint64_t start_us = 0;
 	int ret = 0;
 
 	if(!base){
@@ -447,7 +549,13 @@ static int tdav_session_video_producer_enc_cb(const void* callback_data, const v
 			// update one-shot parameters
 			tmedia_converter_video_set(video->conv.toYUV420, base->producer->video.rotation, TMEDIA_CODEC_VIDEO(video->encoder.codec)->out.flip, base->producer->video.mirror, video->encoder.scale_rotated_frames);
 			
+			if(video->encoder.pipeline){
+				start_us = tdav_video_pipeline_time_us();
+			}
 			yuv420p_size = tmedia_converter_video_process(video->conv.toYUV420, buffer, size, &video->encoder.conv_buffer, &video->encoder.conv_buffer_size);
+			if(video->encoder.pipeline){
+				tdav_video_pipeline_stats_update(video->encoder.pipeline, tdav_video_pipeline_stage_convert, (tdav_video_pipeline_time_us() - start_us));
+			}
 			if(!yuv420p_size || !video->encoder.conv_buffer){
 				TSK_DEBUG_ERROR("Failed to convert XXX buffer to YUV42P");
 				ret = -6;
@@ -455,7 +563,16 @@ static int tdav_session_video_producer_enc_cb(const void* callback_data, const v
 			}
 		}
 
+		// IDR requested by a member of the group (or new leader)
+		if(video->encoder.group && tdav_video_encgroup_take_idr_request(video->encoder.group)){
+			_tdav_session_video_codec_set(video, "action", __action_encode_idr);
+		}
+
 		// Encode data
+		if(video->encoder.pipeline){
+			start_us = tdav_video_pipeline_time_us();
+			video->encoder.send_duration_us = 0; // updated by tdav_session_video_raw_cb() while encoding
+		}
 		tsk_mutex_lock(video->encoder.h_mutex);
 		if(video->encoder.codec){ // codec is destroyed by stop() which use same mutex
 			if(video->encoder.conv_buffer && yuv420p_size){
@@ -468,7 +585,12 @@ static int tdav_session_video_producer_enc_cb(const void* callback_data, const v
 			}
 		}
 		tsk_mutex_unlock(video->encoder.h_mutex);
-
+		if(video->encoder.pipeline){
+			uint64_t duration_us = (tdav_video_pipeline_time_us() - start_us);
+			// the codecs packetize and send the RTP packets from encode()
+			tdav_video_pipeline_stats_update(video->encoder.pipeline, tdav_video_pipeline_stage_encode, (duration_us > video->encoder.send_duration_us) ? (duration_us - video->encoder.send_duration_us) : 0);
+			tdav_video_pipeline_stats_update(video->encoder.pipeline, tdav_video_pipeline_stage_send, video->encoder.send_duration_us);
+		}
 
 		if(out_size){
 			/* Never called, see tdav_session_video_raw_cb() */
@@ -484,6 +606,38 @@ bail: ;
 	return ret;
 }
 
+// Pipeline callback (From the producer's queue to the network)
+static int _tdav_session_video_pipeline_cb(const void* usr_data, const void* buffer, tsk_size_t size)
+{
+	return _tdav_session_video_encode((tdav_session_video_t*)usr_data, buffer, size);
+}
+
+// Producer callback (From the producer to the network) => encode data before send()
+static int tdav_session_video_producer_enc_cb(const void* callback_data, const void* buffer, tsk_size_t size)
+{
+	tdav_session_video_t* video = (tdav_session_video_t*)callback_data;
+
+	if(!video){
+		TSK_DEBUG_ERROR("Null session");
+		return 0;
+	}
+
+	// only the leader of the group encodes, the frames are sent to the members by tdav_session_video_raw_cb()
+	if(video->encoder.group && !tdav_video_encgroup_is_leader(video->encoder.group, video)){
+		return 0;
+	}
+
+	if(video->encoder.pipeline){
+		// do nothing if session is held or not started yet
+		if(TMEDIA_SESSION(video)->lo_held || !video->started){
+			return 0;
+		}
+		// do not block the producer: the frame is converted, encoded and sent on the pipeline's thread
+		return tdav_video_pipeline_put(video->encoder.pipeline, buffer, size);
+	}
+	return _tdav_session_video_encode(video, buffer, size);
+}
+
 // RTP callback (Network -> Decoder -> Consumer)
 static int tdav_session_video_rtp_cb(const void* callback_data, const trtp_rtp_packet_t* packet)
 {
@@ -963,6 +1117,7 @@ static int tdav_session_video_set(tmedia_session_t* self, const tmedia_param_t*
 				tsk_list_item_t* item;
 				tsk_bool_t flip = (tsk_bool_t)TSK_TO_INT32((uint8_t*)param->value);
 				tmedia_codecs_L_t *codecs = tsk_object_ref(self->codecs);
+				self->flip.in = flip; // for the codecs not created yet
 				tsk_list_foreach(item, codecs){
 					TMEDIA_CODEC_VIDEO(item->data)->in.flip = flip;
 				}
@@ -981,6 +1136,7 @@ static int tdav_session_video_set(tmedia_session_t* self, const tmedia_param_t*
 				tsk_list_item_t* item;
 				tsk_bool_t flip = (tsk_bool_t)TSK_TO_INT32((uint8_t*)param->value);
 				tmedia_codecs_L_t *codecs = tsk_object_ref(self->codecs);
+				self->flip.out = flip; // for the codecs not created yet
 				tsk_list_foreach(item, codecs){
 					TMEDIA_CODEC_VIDEO(item->data)->out.flip = flip;
 				}
@@ -993,7 +1149,7 @@ static int tdav_session_video_set(tmedia_session_t* self, const tmedia_param_t*
 		if(param->value_type == tmedia_pvt_int32){
 			if(tsk_striequals(param->key, "bandwidth-level")){
 				tsk_list_item_t* item;
-				self->bl = (tmedia_bandwidth_level_t) TSK_TO_INT32((uint8_t*)param->value);
+				self->bl = (tmedia_bandwidth_level_t) TSK_TO_INT32((uint8_t*)param->value); // also for the codecs not created yet
 				self->codecs = tsk_object_ref(self->codecs);
 				tsk_list_foreach(item, self->codecs){
 					((tmedia_codec_t*)item->data)->bl = self->bl;
@@ -1001,6 +1157,23 @@ static int tdav_session_video_set(tmedia_session_t* self, const tmedia_param_t*
 				tsk_object_unref(self->codecs);
 			}
 		}
+		else if(param->value_type == tmedia_pvt_pobject){
+			if(tsk_striequals(param->key, "encode-group")){
+				// share the encoder with the other sessions of the group
+				if(video->started && video->encoder.group){
+					tdav_video_encgroup_leave(video->encoder.group, video, _tdav_session_video_group_role_cb);
+				}
+				TSK_OBJECT_SAFE_FREE(video->encoder.group);
+				video->encoder.group = tsk_object_ref(param->value);
+				if(video->started && video->encoder.group){
+					_tdav_session_video_group_join(video);
+				}
+				// encoding alone (or leading the new group) with the producer paused as a member of the previous group
+				if(video->encoder.producer_paused && (!video->encoder.group || tdav_video_encgroup_is_leader(video->encoder.group, video))){
+					_tdav_session_video_group_role_cb(video, tsk_true);
+				}
+			}
+		}
 	}
 
 	return ret;
@@ -1087,6 +1260,16 @@ static int tdav_session_video_start(tmedia_session_t* self)
 		TSK_DEBUG_ERROR("tdav_session_av_start(video) failed");
 		return ret;
 	}	
+
+	if (video->encoder.pipeline) {
+		if ((ret = tdav_video_pipeline_start(video->encoder.pipeline))) {
+			TSK_DEBUG_ERROR("Failed to start video encode pipeline");
+			return ret;
+		}
+	}
+	if (video->encoder.group) {
+		_tdav_session_video_group_join(video);
+	}
 	video->started = tsk_true;
 	return ret;
 }
@@ -1102,8 +1285,18 @@ static int tdav_session_video_stop(tmedia_session_t* self)
 	video = (tdav_session_video_t*)self;
 	base = (tdav_session_av_t*)self;
 
+	// stop receiving the frames encoded by the group's leader before closing the RTP manager
+	if (video->encoder.group) {
+		tdav_video_encgroup_leave(video->encoder.group, video, _tdav_session_video_group_role_cb);
+	}
+
 	// must be here to make sure not other thread will lock the encoder once we have done it
 	video->started = tsk_false;
+
+	// wait for the frame being encoded (if any) before closing the codecs
+	if (video->encoder.pipeline) {
+		ret = tdav_video_pipeline_stop(video->encoder.pipeline);
+	}
 	
 	if (video->jb) {
 		ret = tdav_video_jb_stop(video->jb);
@@ -1119,6 +1312,8 @@ static int tdav_session_video_stop(tmedia_session_t* self)
 	TSK_OBJECT_SAFE_FREE(video->encoder.codec);
 	tsk_mutex_unlock(video->encoder.h_mutex);
 	TSK_OBJECT_SAFE_FREE(video->decoder.codec);
+	// the producer (paused if the session was a member of the encode group) is stopped
+	video->encoder.producer_paused = tsk_false;
 
 	// reset rotation info (MUST for reINVITE when mobile device in portrait[90 degrees])
 	video->encoder.rotation = 0;
@@ -1336,6 +1531,13 @@ static int _tdav_session_video_init(tdav_session_video_t *p_self, tmedia_type_t
 		tdav_video_jb_set_callback(p_self->jb, _tdav_session_video_jb_cb, p_self);
 	}
 
+	if (tmedia_defaults_get_video_enc_pipeline_enabled()) {
+		if (!(p_self->encoder.pipeline = tdav_video_pipeline_create(_tdav_session_video_pipeline_cb, p_self))) {
+			TSK_DEBUG_ERROR("Failed to create video encode pipeline");
+			return -5;
+		}
+	}
+
 	if (p_base->producer) {
 		tmedia_producer_set_enc_callback(p_base->producer, tdav_session_video_producer_enc_cb, p_self);
 		tmedia_producer_set_raw_callback(p_base->producer, tdav_session_video_raw_cb, p_self);
@@ -1385,6 +1587,8 @@ static tsk_object_t* tdav_session_video_dtor(tsk_object_t * self)
 		TSK_OBJECT_SAFE_FREE(video->avpf.packets);
 
 		TSK_OBJECT_SAFE_FREE(video->jb);
+		TSK_OBJECT_SAFE_FREE(video->encoder.pipeline);
+		TSK_OBJECT_SAFE_FREE(video->encoder.group);
 
 		if(video->encoder.h_mutex){
 			tsk_mutex_destroy(&video->encoder.h_mutex);
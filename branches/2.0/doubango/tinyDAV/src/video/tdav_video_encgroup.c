@@ -0,0 +1,222 @@
+/*
+* Copyright (C) 2011-2015 Mamadou DIOP
+* Copyright (C) 2011-2015 Doubango Telecom <http://www.doubango.org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_video_encgroup.c
+ * @brief Encode group: video sessions sending the same source share a single encoder.
+ * The sessions join the group when they start and leave it when they stop (before closing their RTP manager) which means the fan-out
+ * never reaches a stopped session. When the leader leaves, the next member becomes the leader and starts with an IDR frame.
+ * The producers are paused and restarted by "role_cb" outside the object's lock: the producers' threads take it (is_leader(), fanout())
+ * while holding their own lock.
+ */
+#include "tinydav/video/tdav_video_encgroup.h"
+
+#include "tsk_memory.h"
+#include "tsk_debug.h"
+
+#define TDAV_VIDEO_ENCGROUP_GROW_SIZE	16
+
+/** Creates a new encode group. Attach it to the video sessions using the "encode-group" session parameter. */
+tdav_video_encgroup_t* tdav_video_encgroup_create()
+{
+	return tsk_object_new(tdav_video_encgroup_def_t);
+}
+
+/** Adds a started session to the group. Fails if the session cannot send what the leader encodes (checked using "match_cb").
+* "role_cb" is called to pause the producer if the session joins as a member. */
+int tdav_video_encgroup_join(tdav_video_encgroup_t* self, struct tdav_session_video_s* session, tdav_video_encgroup_match_cb_f match_cb, tdav_video_encgroup_role_cb_f role_cb)
+{
+	tsk_size_t i;
+	tsk_bool_t member = tsk_false;
+	int ret = 0;
+
+	if(!self || !session){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	tsk_mutex_lock(self->h_mutex_members);
+	tsk_safeobj_lock(self);
+	for(i = 0; i < self->sessions_count; ++i){
+		if(self->sessions[i] == session){
+			goto bail; // already joined
+		}
+	}
+	if(self->sessions_count > 0 && match_cb && !match_cb(self->sessions[0], session)){
+		TSK_DEBUG_WARN("Video session not compatible with the encode group's leader (codec, format, packetization or size)");
+		ret = -3;
+		goto bail;
+	}
+	if(self->sessions_count == self->sessions_capacity){
+		struct tdav_session_video_s** sessions = tsk_realloc(self->sessions, (self->sessions_capacity + TDAV_VIDEO_ENCGROUP_GROW_SIZE) * sizeof(struct tdav_session_video_s*));
+		if(!sessions){
+			TSK_DEBUG_ERROR("Failed to allocate new sessions");
+			ret = -2;
+			goto bail;
+		}
+		self->sessions = sessions;
+		self->sessions_capacity += TDAV_VIDEO_ENCGROUP_GROW_SIZE;
+	}
+	self->sessions[self->sessions_count++] = session;
+	// the new member must start decoding with an IDR frame
+	if(self->sessions_count > 1){
+		self->idr_requested = tsk_true;
+		member = tsk_true;
+	}
+	TSK_DEBUG_INFO("Video session joined encode group: count=%u", (unsigned)self->sessions_count);
+
+bail:
+	tsk_safeobj_unlock(self);
+	// frames from the member's producer would be dropped
+	if(member && role_cb){
+		role_cb(session, tsk_false);
+	}
+	tsk_mutex_unlock(self->h_mutex_members);
+	return ret;
+}
+
+/** Removes a session from the group. "role_cb" is called to restart the producer of the next member if the leader leaves. */
+int tdav_video_encgroup_leave(tdav_video_encgroup_t* self, struct tdav_session_video_s* session, tdav_video_encgroup_role_cb_f role_cb)
+{
+	tsk_size_t i;
+	struct tdav_session_video_s* leader = tsk_null;
+
+	if(!self || !session){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	// the new leader cannot leave (and stop its producer) before its producer is restarted
+	tsk_mutex_lock(self->h_mutex_members);
+	// locking waits for the fan-out in progress (if any)
+	tsk_safeobj_lock(self);
+	for(i = 0; i < self->sessions_count; ++i){
+		if(self->sessions[i] == session){
+			// keep the order: the next member in line becomes the leader
+			memmove(&self->sessions[i], &self->sessions[i + 1], (self->sessions_count - i - 1) * sizeof(struct tdav_session_video_s*));
+			--self->sessions_count;
+			if(i == 0 && self->sessions_count > 0){
+				self->idr_requested = tsk_true; // the new leader's encoder has no reference frame
+				leader = self->sessions[0];
+			}
+			TSK_DEBUG_INFO("Video session left encode group: count=%u", (unsigned)self->sessions_count);
+			break;
+		}
+	}
+	tsk_safeobj_unlock(self);
+	if(leader && role_cb){
+		role_cb(leader, tsk_true);
+	}
+	tsk_mutex_unlock(self->h_mutex_members);
+
+	return 0;
+}
+
+tsk_bool_t tdav_video_encgroup_is_leader(tdav_video_encgroup_t* self, const struct tdav_session_video_s* session)
+{
+	tsk_bool_t is_leader;
+	if(!self || !session){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return tsk_false;
+	}
+	tsk_safeobj_lock(self);
+	is_leader = (self->sessions_count > 0 && self->sessions[0] == session);
+	tsk_safeobj_unlock(self);
+	return is_leader;
+}
+
+/** Sends the chunk encoded by the leader to all other members. */
+int tdav_video_encgroup_fanout(tdav_video_encgroup_t* self, const struct tdav_session_video_s* leader, tdav_video_encgroup_send_cb_f send_cb, const tmedia_video_encode_result_xt* result)
+{
+	tsk_size_t i;
+
+	if(!self || !send_cb || !result){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	tsk_safeobj_lock(self);
+	if(self->sessions_count > 1 && self->sessions[0] == leader){
+		for(i = 1; i < self->sessions_count; ++i){
+			send_cb(self->sessions[i], result);
+		}
+	}
+	tsk_safeobj_unlock(self);
+
+	return 0;
+}
+
+/** Asks the leader to encode an IDR frame (e.g. FIR received by a member). */
+int tdav_video_encgroup_request_idr(tdav_video_encgroup_t* self)
+{
+	if(!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_safeobj_lock(self);
+	self->idr_requested = tsk_true;
+	tsk_safeobj_unlock(self);
+	return 0;
+}
+
+/** Called by the leader before encoding. */
+tsk_bool_t tdav_video_encgroup_take_idr_request(tdav_video_encgroup_t* self)
+{
+	tsk_bool_t requested = tsk_false;
+	if(self){
+		tsk_safeobj_lock(self);
+		requested = self->idr_requested;
+		self->idr_requested = tsk_false;
+		tsk_safeobj_unlock(self);
+	}
+	return requested;
+}
+
+
+//=================================================================================================
+//	Video encode group object definition
+//
+static tsk_object_t* tdav_video_encgroup_ctor(tsk_object_t * self, va_list * app)
+{
+	tdav_video_encgroup_t *group = self;
+	if(group){
+		tsk_safeobj_init(group);
+		group->h_mutex_members = tsk_mutex_create();
+	}
+	return self;
+}
+static tsk_object_t* tdav_video_encgroup_dtor(tsk_object_t * self)
+{
+	tdav_video_encgroup_t *group = self;
+	if(group){
+		TSK_FREE(group->sessions);
+		tsk_mutex_destroy(&group->h_mutex_members);
+		tsk_safeobj_deinit(group);
+	}
+	return self;
+}
+static const tsk_object_def_t tdav_video_encgroup_def_s =
+{
+	sizeof(tdav_video_encgroup_t),
+	tdav_video_encgroup_ctor,
+	tdav_video_encgroup_dtor,
+	tsk_null,
+};
+const tsk_object_def_t *tdav_video_encgroup_def_t = &tdav_video_encgroup_def_s;
@@ -0,0 +1,319 @@
+/*
+* Copyright (C) 2011-2015 Mamadou DIOP
+* Copyright (C) 2011-2015 Doubango Telecom <http://www.doubango.org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tdav_video_pipeline.c
+ * @brief Video encode pipeline: bounded queue of captured frames processed (converted, encoded and sent) on a dedicated thread.
+ * The producer's thread only copies the frame into a pre-allocated slot. Under overload (encoder slower than the capture) the oldest
+ * queued frame is dropped which means the latency never grows beyond @ref TDAV_VIDEO_PIPELINE_QUEUE_MAX frames.
+ */
+#include "tinydav/video/tdav_video_pipeline.h"
+
+#include "tinymedia/tmedia_scheduler.h"
+
+#include "tsk_object.h"
+#include "tsk_time.h"
+#include "tsk_memory.h"
+#include "tsk_thread.h"
+#include "tsk_mutex.h"
+#include "tsk_semaphore.h"
+#include "tsk_debug.h"
+
+typedef struct tdav_video_pipeline_frame_s
+{
+	void* ptr;
+	tsk_size_t size;
+	tsk_size_t capacity;
+	uint64_t time_us; // time when the frame was queued
+}
+tdav_video_pipeline_frame_t;
+
+typedef struct tdav_video_pipeline_s
+{
+	TSK_DECLARE_OBJECT;
+
+	tsk_bool_t started;
+
+	tdav_video_pipeline_frame_t frames[TDAV_VIDEO_PIPELINE_QUEUE_MAX];
+	tsk_size_t frames_head;
+	tsk_size_t frames_count;
+	tdav_video_pipeline_frame_t frame_work; // frame being processed, swapped with the queued one to avoid copies
+
+	tdav_video_pipeline_stats_xt stats;
+
+	tdav_video_pipeline_cb_f callback;
+	const void* usr_data;
+
+	tsk_thread_handle_t* thread[1];
+	tsk_semaphore_handle_t* sem; // value = number of queued frames
+	tsk_mutex_handle_t* mutex;
+}
+tdav_video_pipeline_t;
+
+static void* TSK_STDCALL _tdav_video_pipeline_thread_func(void *arg);
+static void _tdav_video_pipeline_stats_update(tdav_video_pipeline_t* self, tdav_video_pipeline_stage_t stage, uint64_t duration_us);
+
+static tsk_object_t* tdav_video_pipeline_ctor(tsk_object_t * self, va_list * app)
+{
+	tdav_video_pipeline_t *pipeline = self;
+	if(pipeline){
+		if(!(pipeline->mutex = tsk_mutex_create()) || !(pipeline->sem = tsk_semaphore_create())){
+			TSK_DEBUG_ERROR("Failed to create mutex or semaphore");
+			return tsk_null;
+		}
+	}
+	return self;
+}
+static tsk_object_t* tdav_video_pipeline_dtor(tsk_object_t * self)
+{
+	tdav_video_pipeline_t *pipeline = self;
+	if(pipeline){
+		tsk_size_t i;
+		tdav_video_pipeline_stop(pipeline);
+		for(i = 0; i < TDAV_VIDEO_PIPELINE_QUEUE_MAX; ++i){
+			TSK_FREE(pipeline->frames[i].ptr);
+		}
+		TSK_FREE(pipeline->frame_work.ptr);
+		if(pipeline->sem){
+			tsk_semaphore_destroy(&pipeline->sem);
+		}
+		if(pipeline->mutex){
+			tsk_mutex_destroy(&pipeline->mutex);
+		}
+	}
+	return self;
+}
+static const tsk_object_def_t tdav_video_pipeline_def_s =
+{
+	sizeof(tdav_video_pipeline_t),
+	tdav_video_pipeline_ctor,
+	tdav_video_pipeline_dtor,
+	tsk_null,
+};
+
+tdav_video_pipeline_t* tdav_video_pipeline_create(tdav_video_pipeline_cb_f callback, const void* usr_data)
+{
+	tdav_video_pipeline_t* pipeline;
+
+	if(!callback){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return tsk_null;
+	}
+	if((pipeline = tsk_object_new(&tdav_video_pipeline_def_s))){
+		pipeline->callback = callback;
+		pipeline->usr_data = usr_data;
+	}
+	return pipeline;
+}
+
+int tdav_video_pipeline_start(tdav_video_pipeline_t* self)
+{
+	int ret = 0;
+	if(!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(self->started){
+		return 0;
+	}
+
+	self->started = tsk_true;
+
+	if(!self->thread[0]){
+		ret = tsk_thread_create(&self->thread[0], _tdav_video_pipeline_thread_func, self);
+		if(ret != 0 || !self->thread[0]){
+			TSK_DEBUG_ERROR("Failed to create new thread");
+			self->started = tsk_false;
+			return (ret ? ret : -2);
+		}
+		ret = tsk_thread_set_priority(self->thread[0], TSK_THREAD_PRIORITY_HIGH);
+	}
+
+	return ret;
+}
+
+// called on the producer's thread
+int tdav_video_pipeline_put(tdav_video_pipeline_t* self, const void* buffer, tsk_size_t size)
+{
+	tdav_video_pipeline_frame_t* frame;
+	tsk_bool_t dropped = tsk_false;
+
+	if(!self || !buffer || !size){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	if(!self->started){
+		return 0;
+	}
+
+	tsk_mutex_lock(self->mutex);
+	if(self->frames_count == TDAV_VIDEO_PIPELINE_QUEUE_MAX){
+		// drop the oldest frame: the encoder is late
+		self->frames_head = (self->frames_head + 1) % TDAV_VIDEO_PIPELINE_QUEUE_MAX;
+		--self->frames_count;
+		++self->stats.frames_dropped;
+		dropped = tsk_true;
+	}
+	frame = &self->frames[(self->frames_head + self->frames_count) % TDAV_VIDEO_PIPELINE_QUEUE_MAX];
+	if(frame->capacity < size){
+		if(!(frame->ptr = tsk_realloc(frame->ptr, size))){
+			TSK_DEBUG_ERROR("Failed to allocate buffer with size = %u", (unsigned)size);
+			frame->capacity = 0;
+			if(dropped){
+				tsk_semaphore_decrement(self->sem); // the semaphore must reflect the number of queued frames (never blocks)
+			}
+			tsk_mutex_unlock(self->mutex);
+			return -2;
+		}
+		frame->capacity = size;
+	}
+	memcpy(frame->ptr, buffer, size);
+	frame->size = size;
+	frame->time_us = tdav_video_pipeline_time_us();
+	++self->frames_count;
+	++self->stats.frames_in;
+	tsk_mutex_unlock(self->mutex);
+
+	// the number of queued frames doesn't change when a frame is dropped
+	if(!dropped){
+		tsk_semaphore_increment(self->sem);
+	}
+	return 0;
+}
+
+int tdav_video_pipeline_stop(tdav_video_pipeline_t* self)
+{
+	int ret = 0;
+	if(!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(!self->started){
+		return 0;
+	}
+
+	self->started = tsk_false;
+	tsk_semaphore_increment(self->sem); // wake up the thread
+	if(self->thread[0]){
+		ret = tsk_thread_join(&self->thread[0]);
+	}
+
+	// drop the frames not processed yet and consume the matching semaphore values
+	tsk_mutex_lock(self->mutex);
+	for(; self->frames_count > 0; --self->frames_count){
+		tsk_semaphore_decrement(self->sem);
+		++self->stats.frames_dropped;
+	}
+	self->frames_head = 0;
+	TSK_DEBUG_INFO("Video pipeline stopped: in=%llu, out=%llu, dropped=%llu, queue=%lluus(avg), encode=%lluus(avg)",
+		(unsigned long long)self->stats.frames_in, (unsigned long long)self->stats.frames_out, (unsigned long long)self->stats.frames_dropped,
+		(unsigned long long)(self->stats.stages[tdav_video_pipeline_stage_queue].count ? (self->stats.stages[tdav_video_pipeline_stage_queue].total_us / self->stats.stages[tdav_video_pipeline_stage_queue].count) : 0),
+		(unsigned long long)(self->stats.stages[tdav_video_pipeline_stage_encode].count ? (self->stats.stages[tdav_video_pipeline_stage_encode].total_us / self->stats.stages[tdav_video_pipeline_stage_encode].count) : 0));
+	tsk_mutex_unlock(self->mutex);
+
+	return ret;
+}
+
+/** Adds a sample to the latency counters of a stage. */
+int tdav_video_pipeline_stats_update(tdav_video_pipeline_t* self, tdav_video_pipeline_stage_t stage, uint64_t duration_us)
+{
+	if(!self || stage >= tdav_video_pipeline_stage_count){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_mutex_lock(self->mutex);
+	_tdav_video_pipeline_stats_update(self, stage, duration_us);
+	tsk_mutex_unlock(self->mutex);
+	return 0;
+}
+
+int tdav_video_pipeline_stats_get(tdav_video_pipeline_t* self, tdav_video_pipeline_stats_xt* stats)
+{
+	if(!self || !stats){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_mutex_lock(self->mutex);
+	*stats = self->stats;
+	tsk_mutex_unlock(self->mutex);
+	return 0;
+}
+
+/** Monotonic-enough time in microseconds, used for the latency counters. */
+uint64_t tdav_video_pipeline_time_us()
+{
+	struct timeval tv;
+	tsk_gettimeofday(&tv, tsk_null);
+	return (((uint64_t)tv.tv_sec) * 1000000) + ((uint64_t)tv.tv_usec);
+}
+
+// must be called with the mutex held
+static void _tdav_video_pipeline_stats_update(tdav_video_pipeline_t* self, tdav_video_pipeline_stage_t stage, uint64_t duration_us)
+{
+	++self->stats.stages[stage].count;
+	self->stats.stages[stage].total_us += duration_us;
+	if(duration_us > self->stats.stages[stage].max_us){
+		self->stats.stages[stage].max_us = duration_us;
+	}
+}
+
+static void* TSK_STDCALL _tdav_video_pipeline_thread_func(void *arg)
+{
+	tdav_video_pipeline_t* pipeline = (tdav_video_pipeline_t*)arg;
+	tdav_video_pipeline_frame_t frame;
+	uint64_t now;
+
+	TSK_DEBUG_INFO("Video pipeline thread - ENTER");
+
+	tmedia_scheduler_bind_current_thread();
+
+	while(pipeline->started){
+		tsk_semaphore_decrement(pipeline->sem);
+		if(!pipeline->started){
+			break;
+		}
+
+		tsk_mutex_lock(pipeline->mutex);
+		if(!pipeline->frames_count){
+			tsk_mutex_unlock(pipeline->mutex);
+			continue;
+		}
+		// swap the oldest queued frame with the working one (the slot will reuse the memory)
+		frame = pipeline->frames[pipeline->frames_head];
+		pipeline->frames[pipeline->frames_head] = pipeline->frame_work;
+		pipeline->frame_work = frame;
+		pipeline->frames_head = (pipeline->frames_head + 1) % TDAV_VIDEO_PIPELINE_QUEUE_MAX;
+		--pipeline->frames_count;
+		now = tdav_video_pipeline_time_us();
+		_tdav_video_pipeline_stats_update(pipeline, tdav_video_pipeline_stage_queue, (now > frame.time_us) ? (now - frame.time_us) : 0);
+		tsk_mutex_unlock(pipeline->mutex);
+
+		pipeline->callback(pipeline->usr_data, pipeline->frame_work.ptr, pipeline->frame_work.size);
+
+		tsk_mutex_lock(pipeline->mutex);
+		++pipeline->stats.frames_out;
+		tsk_mutex_unlock(pipeline->mutex);
+	}
+
+	TSK_DEBUG_INFO("Video pipeline thread - EXIT");
+
+	return tsk_null;
+}
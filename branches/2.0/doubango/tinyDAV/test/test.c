@@ -25,11 +25,17 @@
 #include "tinydav.h"
 
 #include "test_sessions.h"
+#include "test_codecs.h"
+#include "test_audio_dsp.h"
+#include "test_ulpfec.h"
 
 #define LOOP						0
 
 #define RUN_TEST_ALL				0
 #define RUN_TEST_SESSIONS			1
+#define RUN_TEST_CODECS				0
+#define RUN_TEST_AUDIO_DSP			0
+#define RUN_TEST_ULPFEC				0
 
 // Codecs : http://www.itu.int/rec/T-REC-G.191-200509-S/en
 
@@ -50,6 +56,18 @@ int main()
 		test_sessions();
 #endif
 
+#if RUN_TEST_CODECS || RUN_TEST_ALL
+		test_codecs();
+#endif
+
+#if RUN_TEST_AUDIO_DSP || RUN_TEST_ALL
+		test_audio_dsp();
+#endif
+
+#if RUN_TEST_ULPFEC || RUN_TEST_ALL
+		test_ulpfec();
+#endif
+
 	}
 	while(LOOP);
 
@@ -0,0 +1,184 @@
+/*
+* Copyright (C) 2009 Mamadou Diop.
+* Copyright (C) 2015 Doubango Telecom <http://doubango.org>.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+#ifndef _TINYDEV_TEST_AUDIO_DSP_H
+#define _TINYDEV_TEST_AUDIO_DSP_H
+
+/* Checks each audio DSP kernels set compiled in and supported by the CPU (see tdav_audio_dsp_select()) against plain C loops and against the
+* portable C kernels: all sets must return the same samples, including when rounding .5 ties to 16-bit.
+* The sizes are not multiple of the vectors' size to also check the remaining samples.
+*/
+
+#include "tinydav/audio/tdav_audio_dsp.h"
+
+#include <math.h>
+
+#define TEST_AUDIO_DSP_SAMPLES		(160 + 13)
+
+static const char* TEST_AUDIO_DSP_KERNELS[] = { "AVX2", "SSE2", "NEON", "C" };
+
+static int16_t test_audio_dsp_sat(int32_t v)
+{
+	return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+// outputs of the selected kernels on the same inputs
+typedef struct test_audio_dsp_out_s
+{
+	int16_t gain[TEST_AUDIO_DSP_SAMPLES];
+	int16_t mix[TEST_AUDIO_DSP_SAMPLES];
+	float s16_to_float[TEST_AUDIO_DSP_SAMPLES];
+	int16_t float_to_s16[TEST_AUDIO_DSP_SAMPLES];
+	int16_t ties_to_s16[TEST_AUDIO_DSP_SAMPLES];
+	int16_t interleave[TEST_AUDIO_DSP_SAMPLES << 1];
+	int32_t peak, rms;
+}
+test_audio_dsp_out_t;
+
+static void test_audio_dsp_run(const int16_t* a, const int16_t* b, const float* ties, test_audio_dsp_out_t* out)
+{
+	float f[TEST_AUDIO_DSP_SAMPLES];
+
+	memcpy(out->gain, b, sizeof(out->gain));
+	tdav_audio_dsp_gain_s16(out->gain, TEST_AUDIO_DSP_SAMPLES, 3);
+	memcpy(out->mix, a, sizeof(out->mix));
+	tdav_audio_dsp_mix_s16(out->mix, b, TEST_AUDIO_DSP_SAMPLES);
+	tdav_audio_dsp_s16_to_float(out->s16_to_float, a, TEST_AUDIO_DSP_SAMPLES);
+	memcpy(f, out->s16_to_float, sizeof(f));
+	f[0] = 2.f, f[1] = -2.f;
+	tdav_audio_dsp_float_to_s16(out->float_to_s16, f, TEST_AUDIO_DSP_SAMPLES);
+	tdav_audio_dsp_float_to_s16(out->ties_to_s16, ties, TEST_AUDIO_DSP_SAMPLES);
+	tdav_audio_dsp_interleave_s16(out->interleave, a, b, TEST_AUDIO_DSP_SAMPLES);
+	tdav_audio_dsp_level_s16(a, TEST_AUDIO_DSP_SAMPLES, &out->peak, &out->rms);
+}
+
+static void test_audio_dsp_check(const int16_t* a, const int16_t* b)
+{
+	int16_t c[TEST_AUDIO_DSP_SAMPLES], d[TEST_AUDIO_DSP_SAMPLES], st[TEST_AUDIO_DSP_SAMPLES << 1];
+	float f[TEST_AUDIO_DSP_SAMPLES];
+	int32_t shift, peak, rms, peak_ref;
+	double energy_ref;
+	tsk_size_t i, errors = 0;
+
+	/* gain */
+	for(shift = 1; shift <= 15; ++shift){
+		memcpy(c, b, sizeof(c));
+		tdav_audio_dsp_gain_s16(c, TEST_AUDIO_DSP_SAMPLES, shift);
+		for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+			errors += (c[i] != test_audio_dsp_sat(((int32_t)b[i]) * (1 << shift)));
+		}
+	}
+	printf("[%s] gain: %u errors\n", tdav_audio_dsp_get_name(), (unsigned)errors);
+
+	/* mix */
+	errors = 0;
+	memcpy(c, a, sizeof(c));
+	tdav_audio_dsp_mix_s16(c, b, TEST_AUDIO_DSP_SAMPLES);
+	for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+		errors += (c[i] != test_audio_dsp_sat(((int32_t)a[i]) + ((int32_t)b[i])));
+	}
+	printf("[%s] mix: %u errors\n", tdav_audio_dsp_get_name(), (unsigned)errors);
+
+	/* int16 -> float -> int16 */
+	errors = 0;
+	tdav_audio_dsp_s16_to_float(f, a, TEST_AUDIO_DSP_SAMPLES);
+	f[0] = 2.f, f[1] = -2.f; // must saturate
+	tdav_audio_dsp_float_to_s16(c, f, TEST_AUDIO_DSP_SAMPLES);
+	errors += (c[0] != 32767) + (c[1] != -32768);
+	for(i = 2; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+		errors += (c[i] != a[i]);
+	}
+	printf("[%s] int16<->float: %u errors\n", tdav_audio_dsp_get_name(), (unsigned)errors);
+
+	/* interleave / deinterleave */
+	errors = 0;
+	tdav_audio_dsp_interleave_s16(st, a, b, TEST_AUDIO_DSP_SAMPLES);
+	for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+		errors += (st[(i << 1)] != a[i]) + (st[(i << 1) + 1] != b[i]);
+	}
+	tdav_audio_dsp_deinterleave_s16(c, d, st, TEST_AUDIO_DSP_SAMPLES);
+	for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+		errors += (c[i] != a[i]) + (d[i] != b[i]);
+	}
+	printf("[%s] (de)interleave: %u errors\n", tdav_audio_dsp_get_name(), (unsigned)errors);
+
+	/* levels */
+	peak_ref = 0, energy_ref = 0;
+	for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+		energy_ref += ((double)a[i]) * ((double)a[i]);
+		peak_ref = TSK_MAX(peak_ref, (a[i] < 0 ? -((int32_t)a[i]) : a[i]));
+	}
+	tdav_audio_dsp_level_s16(a, TEST_AUDIO_DSP_SAMPLES, &peak, &rms);
+	printf("[%s] level: peak=%d (expected %d), rms=%d (expected %d)\n", tdav_audio_dsp_get_name(),
+		peak, peak_ref, rms, (int32_t)sqrt(energy_ref / TEST_AUDIO_DSP_SAMPLES));
+}
+
+void test_audio_dsp()
+{
+	int16_t a[TEST_AUDIO_DSP_SAMPLES], b[TEST_AUDIO_DSP_SAMPLES];
+	float ties[TEST_AUDIO_DSP_SAMPLES];
+	static test_audio_dsp_out_t ref, out;
+	tsk_size_t i, k, errors;
+	int32_t tie;
+
+	for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+		a[i] = (int16_t)(rand() & 0xFFFF);
+		b[i] = (int16_t)((rand() & 0xFFFF) >> (i & 7));
+		// k + 0.5 (exact in float): half away from zero gives k + 1 for positive values and k for negative ones
+		tie = (int32_t)(rand() & 0xFFFF) - 32768;
+		ties[i] = (((float)tie) + .5f) / 32768.f;
+	}
+	a[3] = -32768, a[4] = 32767, b[5] = -32768;
+	ties[0] = .5f / 32768.f, ties[1] = -.5f / 32768.f, ties[2] = 1.5f / 32768.f, ties[3] = -1.5f / 32768.f, ties[4] = 32766.5f / 32768.f, ties[5] = -32767.5f / 32768.f;
+	ties[TEST_AUDIO_DSP_SAMPLES - 1] = 2.5f / 32768.f, ties[TEST_AUDIO_DSP_SAMPLES - 2] = -2.5f / 32768.f; // remaining samples (portable code)
+
+	/* reference: portable C kernels */
+	tdav_audio_dsp_select("C");
+	test_audio_dsp_run(a, b, ties, &ref);
+	errors = 0;
+	for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+		tie = (int32_t)floor(ties[i] * 32768.f);
+		errors += (ref.ties_to_s16[i] != test_audio_dsp_sat(tie >= 0 ? tie + 1 : tie));
+	}
+	printf("[C] .5 ties: %u errors\n", (unsigned)errors);
+
+	for(k = 0; k < sizeof(TEST_AUDIO_DSP_KERNELS)/sizeof(TEST_AUDIO_DSP_KERNELS[0]); ++k){
+		if(tdav_audio_dsp_select(TEST_AUDIO_DSP_KERNELS[k]) != 0){
+			printf("[%s] not available\n", TEST_AUDIO_DSP_KERNELS[k]);
+			continue;
+		}
+		test_audio_dsp_check(a, b);
+
+		/* same samples as the portable C kernels */
+		test_audio_dsp_run(a, b, ties, &out);
+		errors = 0;
+		for(i = 0; i < TEST_AUDIO_DSP_SAMPLES; ++i){
+			errors += (out.gain[i] != ref.gain[i]) + (out.mix[i] != ref.mix[i]) + (out.s16_to_float[i] != ref.s16_to_float[i])
+				+ (out.float_to_s16[i] != ref.float_to_s16[i]) + (out.ties_to_s16[i] != ref.ties_to_s16[i])
+				+ (out.interleave[(i << 1)] != ref.interleave[(i << 1)]) + (out.interleave[(i << 1) + 1] != ref.interleave[(i << 1) + 1]);
+		}
+		errors += (out.peak != ref.peak) + (out.rms != ref.rms);
+		printf("[%s] vs [C]: %u errors\n", TEST_AUDIO_DSP_KERNELS[k], (unsigned)errors);
+	}
+
+	tdav_audio_dsp_init(); // back to the best kernels
+}
+
+#endif /* _TINYDEV_TEST_AUDIO_DSP_H */
@@ -0,0 +1,270 @@
+/*
+* Copyright (C) 2009 Mamadou Diop.
+* Copyright (C) 2012 Doubango Telecom <http://doubango.org>.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+#ifndef _TINYDEV_TEST_CODECS_H
+#define _TINYDEV_TEST_CODECS_H
+
+/* Transcoding throughput (samples/s) of the G.711 and G.722 kernels.
+* The table-driven G.711 bulk functions are checked against the per-sample ones for all the 16-bit inputs and all the codes.
+* The G.722 bitstream and decoded PCM are checked against golden hashes produced by the original (spandsp) g722_encode.c/g722_decode.c.
+*/
+
+#include "tinydav/codecs/g711/g711.h"
+#include "tinydav/codecs/g722/g722_enc_dec.h"
+
+#include "tsk_time.h"
+
+#define TEST_CODECS_SAMPLES		(16000 * 10) /* 10 seconds @ 16kHz */
+#define TEST_CODECS_ROUNDS		50
+#define TEST_CODECS_FRAME		320 /* 20ms @ 16kHz */
+
+static void test_codecs_print(const char* name, uint64_t duration_ms, tsk_size_t samples)
+{
+	printf("%-28s %8llu ms  %10.2f Msamples/s\n", name, (unsigned long long)duration_ms,
+		duration_ms ? ((double)samples / (double)duration_ms) / 1000.0 : 0.0);
+}
+
+static void test_codecs_g711()
+{
+	static int16_t pcm[TEST_CODECS_SAMPLES], pcm_out[TEST_CODECS_SAMPLES];
+	static uint8_t codes[TEST_CODECS_SAMPLES];
+	int16_t s16;
+	uint8_t u8;
+	tsk_size_t i, k, errors = 0;
+	uint64_t start;
+
+	g711_init_tables();
+
+	/* bit-exactness */
+	for(i = 0; i < 65536; ++i){
+		s16 = (int16_t)i;
+		g711_ulaw_encode(&u8, &s16, 1);
+		errors += (u8 != linear2ulaw(s16));
+		g711_alaw_encode(&u8, &s16, 1);
+		errors += (u8 != linear2alaw(s16));
+	}
+	for(i = 0; i < 256; ++i){
+		u8 = (uint8_t)i;
+		g711_ulaw_decode(&s16, &u8, 1);
+		errors += (s16 != ulaw2linear(u8));
+		g711_alaw_decode(&s16, &u8, 1);
+		errors += (s16 != alaw2linear(u8));
+	}
+	printf("G.711 bulk vs per-sample: %u errors\n", (unsigned)errors);
+
+	for(i = 0; i < TEST_CODECS_SAMPLES; ++i){
+		pcm[i] = (int16_t)((rand() & 0xFFFF) >> (i & 7)); /* all segments */
+	}
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; ++i){
+			codes[i] = linear2ulaw(pcm[i]);
+		}
+	}
+	test_codecs_print("G.711u encode (per-sample)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; i += TEST_CODECS_FRAME){
+			g711_ulaw_encode(&codes[i], &pcm[i], TEST_CODECS_FRAME);
+		}
+	}
+	test_codecs_print("G.711u encode (bulk)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; ++i){
+			pcm_out[i] = ulaw2linear(codes[i]);
+		}
+	}
+	test_codecs_print("G.711u decode (per-sample)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; i += TEST_CODECS_FRAME){
+			g711_ulaw_decode(&pcm_out[i], &codes[i], TEST_CODECS_FRAME);
+		}
+	}
+	test_codecs_print("G.711u decode (bulk)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; ++i){
+			codes[i] = linear2alaw(pcm[i]);
+		}
+	}
+	test_codecs_print("G.711a encode (per-sample)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; i += TEST_CODECS_FRAME){
+			g711_alaw_encode(&codes[i], &pcm[i], TEST_CODECS_FRAME);
+		}
+	}
+	test_codecs_print("G.711a encode (bulk)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; ++i){
+			pcm_out[i] = alaw2linear(codes[i]);
+		}
+	}
+	test_codecs_print("G.711a decode (per-sample)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; i += TEST_CODECS_FRAME){
+			g711_alaw_decode(&pcm_out[i], &codes[i], TEST_CODECS_FRAME);
+		}
+	}
+	test_codecs_print("G.711a decode (bulk)", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+}
+
+#define TEST_CODECS_G722_SAMPLES	(16000 * 2) /* 2 seconds @ 16kHz: every kind of input */
+
+/* FNV-1a */
+static uint32_t test_codecs_hash(uint32_t hash, const uint8_t* data, tsk_size_t size)
+{
+	tsk_size_t i;
+	for(i = 0; i < size; ++i){
+		hash = (hash ^ data[i]) * 16777619U;
+	}
+	return hash;
+}
+
+/* Integer-only (same on all platforms): tones, loud noise, saturated square wave and quiet noise, 4000 samples each */
+static void test_codecs_g722_input(int16_t* pcm, tsk_size_t count)
+{
+	uint32_t seed = 0x12345678;
+	int32_t tri = 0, step = 311;
+	tsk_size_t i;
+	for(i = 0; i < count; ++i){
+		seed = (seed * 1664525U) + 1013904223U;
+		if((tri += step) > 20000 || tri < -20000){
+			step = -step;
+		}
+		switch((i / 4000) & 3){
+			case 0: pcm[i] = (int16_t)(tri + (int32_t)((seed >> 16) & 0x3FF) - 512); break;
+			case 1: pcm[i] = (int16_t)((seed >> 16) >> (i & 7)); break;
+			case 2: pcm[i] = ((i / 37) & 1) ? 32767 : -32768; break;
+			default: pcm[i] = (int16_t)((int32_t)((seed >> 16) & 0x3F) - 32); break;
+		}
+	}
+}
+
+typedef struct test_codecs_g722_vector_s
+{
+	const char* name;
+	int rate;
+	int options;
+	uint32_t hash_codes;
+	uint32_t hash_pcm;
+}
+test_codecs_g722_vector_t;
+
+/* Produced by g722_encode.c/g722_decode.c before the mirrored QMF history and the binary-search quantizer */
+static const test_codecs_g722_vector_t test_codecs_g722_vectors[] =
+{
+	{ "64k", 64000, 0, 0x55680997, 0x37d526c0 },
+	{ "56k packed", 56000, G722_PACKED, 0xc8933129, 0xab145d1c },
+	{ "56k unpacked", 56000, 0, 0xaa19140b, 0x1feba84d },
+	{ "48k packed", 48000, G722_PACKED, 0x06b3f91e, 0x1c4e7a42 },
+	{ "48k unpacked", 48000, 0, 0x49d59341, 0x54d03c9b },
+	{ "64k 8kHz", 64000, G722_SAMPLE_RATE_8000, 0x02882d33, 0x03d8ffd6 },
+};
+
+/* Encodes then decodes the input frame by frame and checks both against the golden hashes */
+static tsk_size_t test_codecs_g722_check()
+{
+	static int16_t pcm[TEST_CODECS_G722_SAMPLES], pcm_out[TEST_CODECS_G722_SAMPLES];
+	static uint8_t codes[TEST_CODECS_G722_SAMPLES];
+	g722_encode_state_t enc_state;
+	g722_decode_state_t dec_state;
+	tsk_size_t i, j, k, codes_count, pcm_count, errors = 0;
+	uint32_t hash_codes, hash_pcm;
+	uint8_t le[2];
+
+	test_codecs_g722_input(pcm, TEST_CODECS_G722_SAMPLES);
+
+	for(k = 0; k < sizeof(test_codecs_g722_vectors) / sizeof(test_codecs_g722_vectors[0]); ++k){
+		const test_codecs_g722_vector_t* vector = &test_codecs_g722_vectors[k];
+		g722_encode_init(&enc_state, vector->rate, vector->options);
+		g722_decode_init(&dec_state, vector->rate, vector->options);
+		for(i = 0, codes_count = 0; i < TEST_CODECS_G722_SAMPLES; i += TEST_CODECS_FRAME){
+			codes_count += g722_encode(&enc_state, &codes[codes_count], &pcm[i], TEST_CODECS_FRAME);
+		}
+		for(i = 0, pcm_count = 0; i < codes_count; i += j){
+			j = TSK_MIN(codes_count - i, (TEST_CODECS_FRAME >> 1));
+			pcm_count += g722_decode(&dec_state, &pcm_out[pcm_count], &codes[i], (int)j);
+		}
+		hash_codes = test_codecs_hash(2166136261U, codes, codes_count);
+		for(i = 0, hash_pcm = 2166136261U; i < pcm_count; ++i){
+			le[0] = (uint8_t)(pcm_out[i] & 0xFF), le[1] = (uint8_t)((pcm_out[i] >> 8) & 0xFF);
+			hash_pcm = test_codecs_hash(hash_pcm, le, 2);
+		}
+		printf("G.722 %-13s codes=%u (0x%08x) pcm=%u (0x%08x)%s\n", vector->name, (unsigned)codes_count, hash_codes, (unsigned)pcm_count, hash_pcm,
+			(hash_codes == vector->hash_codes && hash_pcm == vector->hash_pcm) ? "" : " FAILED");
+		errors += (hash_codes != vector->hash_codes) + (hash_pcm != vector->hash_pcm);
+	}
+	return errors;
+}
+
+static void test_codecs_g722()
+{
+	static int16_t pcm[TEST_CODECS_SAMPLES], pcm_out[TEST_CODECS_SAMPLES];
+	static uint8_t codes[TEST_CODECS_SAMPLES >> 1];
+	g722_encode_state_t enc_state;
+	g722_decode_state_t dec_state;
+	tsk_size_t i, k;
+	uint64_t start;
+
+	printf("G.722 vs reference: %u errors\n", (unsigned)test_codecs_g722_check());
+
+	for(i = 0; i < TEST_CODECS_SAMPLES; ++i){
+		pcm[i] = (int16_t)((rand() & 0xFFFF) >> (i & 7));
+	}
+
+	g722_encode_init(&enc_state, 64000, G722_PACKED);
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; i += TEST_CODECS_FRAME){
+			g722_encode(&enc_state, &codes[i >> 1], &pcm[i], TEST_CODECS_FRAME);
+		}
+	}
+	test_codecs_print("G.722 encode", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+
+	g722_decode_init(&dec_state, 64000, G722_PACKED);
+	start = tsk_time_now();
+	for(k = 0; k < TEST_CODECS_ROUNDS; ++k){
+		for(i = 0; i < TEST_CODECS_SAMPLES; i += TEST_CODECS_FRAME){
+			g722_decode(&dec_state, &pcm_out[i], &codes[i >> 1], (TEST_CODECS_FRAME >> 1));
+		}
+	}
+	test_codecs_print("G.722 decode", (tsk_time_now() - start), TEST_CODECS_SAMPLES * TEST_CODECS_ROUNDS);
+}
+
+void test_codecs()
+{
+	test_codecs_g711();
+	test_codecs_g722();
+}
+
+#endif /* _TINYDEV_TEST_CODECS_H */
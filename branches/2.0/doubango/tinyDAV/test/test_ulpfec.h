@@ -0,0 +1,180 @@
+/*
+* Copyright (C) 2012-2015 Doubango Telecom <http://www.doubango.org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+#ifndef _TINYDEV_TEST_ULPFEC_H
+#define _TINYDEV_TEST_ULPFEC_H
+
+/* ULPFEC (RFC 5109) packets generated by the encoder, checked byte by byte:
+* - a small group computed by hand (header, mask and XORed payload)
+* - groups of 20 (L=1), 60 (only the first 48 are protected) and across the sequence number wrap, checked against the mask
+*	expected by hand and against the XORs computed as described in RFC 5109 section 7
+*/
+
+#include "tinydav/codecs/fec/tdav_codec_ulpfec.h"
+
+#include "tinyrtp/rtp/trtp_rtp_packet.h"
+
+#define TEST_ULPFEC_PAYLOAD_MAX		128
+
+typedef struct test_ulpfec_group_s
+{
+	const char* name;
+	uint16_t seq_num; /* first packet (SN base) */
+	tsk_size_t count;
+	uint8_t mask[6]; /* expected mask (2 bytes if L=0, 6 bytes if L=1) */
+	tsk_size_t mask_size;
+}
+test_ulpfec_group_t;
+
+static const test_ulpfec_group_t test_ulpfec_groups[] =
+{
+	{ "20 packets", 1000, 20, { 0xFF, 0xFF, 0xF0, 0x00, 0x00, 0x00 }, 6 },
+	{ "60 packets", 2000, 60, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, 6 },
+	{ "16 packets, wrap", 65530, 16, { 0xFF, 0xFF }, 2 },
+	{ "20 packets, wrap", 65530, 20, { 0xFF, 0xFF, 0xF0, 0x00, 0x00, 0x00 }, 6 },
+};
+
+static trtp_rtp_packet_t* test_ulpfec_packet_create(uint16_t seq_num, uint32_t timestamp, uint8_t payload_type, tsk_bool_t marker, const uint8_t* payload, tsk_size_t size)
+{
+	trtp_rtp_packet_t* packet;
+	if((packet = trtp_rtp_packet_create(0x11223344, seq_num, timestamp, payload_type, marker))){
+		packet->payload.data_const = payload;
+		packet->payload.size = size;
+	}
+	return packet;
+}
+
+static tsk_size_t test_ulpfec_check(const char* name, const uint8_t* expected, tsk_size_t expected_size, const uint8_t* fec, tsk_size_t fec_size)
+{
+	tsk_size_t i, errors = (fec_size != expected_size) ? 1 : 0;
+	for(i = 0; i < TSK_MIN(fec_size, expected_size); ++i){
+		if(fec[i] != expected[i]){
+			if(!errors++){
+				printf("ULPFEC %s: byte %u is 0x%02x instead of 0x%02x\n", name, (unsigned)i, fec[i], expected[i]);
+			}
+		}
+	}
+	printf("ULPFEC %-18s size=%u: %s\n", name, (unsigned)fec_size, errors ? "FAILED" : "OK");
+	return errors;
+}
+
+/* Three packets (SN 100, 101 and 103) computed by hand */
+static tsk_size_t test_ulpfec_small(struct tdav_codec_ulpfec_s* codec, void** fec, tsk_size_t* fec_max_size)
+{
+	static const uint8_t payload0[] = { 0x01, 0x02, 0x03, 0x04 };
+	static const uint8_t payload1[] = { 0xF0, 0x0F };
+	static const uint8_t payload3[] = { 0xAA, 0xBB, 0xCC };
+	static const uint8_t expected[] =
+	{
+		0x00, /* E=0, L=0, P=X=CC=0 */
+		0xE1, /* M=0^0^1, PT=96^96^97 */
+		0x00, 0x64, /* SN base=100 */
+		0x00, 0x00, 0x0F, 0xA0, /* TS=1000^1000^4000 */
+		0x00, 0x05, /* length recovery=4^2^3 */
+		0x00, 0x04, /* protection length=4 (longest payload) */
+		0xD0, 0x00, /* mask: SN base+0, +1 and +3 */
+		0x5B, 0xB6, 0xCF, 0x04, /* 01^F0^AA, 02^0F^BB, 03^00^CC, 04^00^00 */
+	};
+	trtp_rtp_packet_t* packets[3];
+	tsk_size_t i, size;
+
+	packets[0] = test_ulpfec_packet_create(100, 1000, 96, tsk_false, payload0, sizeof(payload0));
+	packets[1] = test_ulpfec_packet_create(101, 1000, 96, tsk_false, payload1, sizeof(payload1));
+	packets[2] = test_ulpfec_packet_create(103, 4000, 97, tsk_true, payload3, sizeof(payload3));
+
+	tdav_codec_ulpfec_enc_reset(codec);
+	for(i = 0; i < 3; ++i){
+		tdav_codec_ulpfec_enc_protect(codec, packets[i]);
+		TSK_OBJECT_SAFE_FREE(packets[i]);
+	}
+	size = tdav_codec_ulpfec_enc_serialize(codec, fec, fec_max_size);
+	return test_ulpfec_check("3 packets", expected, sizeof(expected), (const uint8_t*)*fec, size);
+}
+
+/* RFC 5109 section 7: the FEC header fields are the XOR of the protected packets' fields, the payload the XOR of their
+* payloads (zero-padded to the longest one) and the mask has one bit per packet following SN base (MSB first) */
+static tsk_size_t test_ulpfec_group(struct tdav_codec_ulpfec_s* codec, const test_ulpfec_group_t* group, void** fec, tsk_size_t* fec_max_size)
+{
+	static uint8_t payloads[60][TEST_ULPFEC_PAYLOAD_MAX];
+	uint8_t expected[10 + 2 + 6 + TEST_ULPFEC_PAYLOAD_MAX] = { 0 };
+	uint8_t* pexpected;
+	trtp_rtp_packet_t* packet;
+	tsk_size_t i, j, size, protected_count = TSK_MIN(group->count, 48), length = 0;
+	uint32_t timestamp = 0, marker = 0, payload_type = 0, length_recovery = 0;
+	uint16_t seq_num;
+
+	tdav_codec_ulpfec_enc_reset(codec);
+	for(i = 0; i < group->count; ++i){
+		seq_num = (uint16_t)(group->seq_num + i);
+		size = 20 + ((seq_num * 7) % (TEST_ULPFEC_PAYLOAD_MAX - 20));
+		for(j = 0; j < size; ++j){
+			payloads[i][j] = (uint8_t)((seq_num * 31) + j);
+		}
+		if((packet = test_ulpfec_packet_create(seq_num, 3000 * (uint32_t)(i / 3), (uint8_t)(96 + (i & 1)), ((i % 3) == 2), payloads[i], size))){
+			tdav_codec_ulpfec_enc_protect(codec, packet);
+			TSK_OBJECT_SAFE_FREE(packet);
+		}
+		if(i < protected_count){
+			timestamp ^= 3000 * (uint32_t)(i / 3);
+			payload_type ^= (96 + (i & 1));
+			marker ^= ((i % 3) == 2);
+			length_recovery ^= (uint32_t)size;
+			length = TSK_MAX(length, size);
+			for(j = 0; j < size; ++j){
+				expected[10 + 2 + group->mask_size + j] ^= payloads[i][j];
+			}
+		}
+	}
+
+	pexpected = expected;
+	*pexpected++ = (group->mask_size == 6) ? 0x40 : 0x00; /* L */
+	*pexpected++ = (uint8_t)((marker << 7) | (payload_type & 0x7F));
+	*pexpected++ = (uint8_t)(group->seq_num >> 8), *pexpected++ = (uint8_t)(group->seq_num & 0xFF);
+	*pexpected++ = (uint8_t)(timestamp >> 24), *pexpected++ = (uint8_t)(timestamp >> 16), *pexpected++ = (uint8_t)(timestamp >> 8), *pexpected++ = (uint8_t)timestamp;
+	*pexpected++ = (uint8_t)(length_recovery >> 8), *pexpected++ = (uint8_t)(length_recovery & 0xFF);
+	*pexpected++ = (uint8_t)(length >> 8), *pexpected++ = (uint8_t)(length & 0xFF);
+	memcpy(pexpected, group->mask, group->mask_size);
+
+	size = tdav_codec_ulpfec_enc_serialize(codec, fec, fec_max_size);
+	return test_ulpfec_check(group->name, expected, (10 + 2 + group->mask_size + length), (const uint8_t*)*fec, size);
+}
+
+void test_ulpfec()
+{
+	struct tdav_codec_ulpfec_s* codec;
+	void* fec = tsk_null;
+	tsk_size_t i, fec_max_size = 0, errors = 0;
+
+	if(!(codec = (struct tdav_codec_ulpfec_s*)tsk_object_new(tdav_codec_ulpfec_plugin_def_t->objdef))){
+		printf("ULPFEC: failed to create the codec\n");
+		return;
+	}
+	/* the same codec is reset between the groups, as done by the video session */
+	errors += test_ulpfec_small(codec, &fec, &fec_max_size);
+	for(i = 0; i < sizeof(test_ulpfec_groups) / sizeof(test_ulpfec_groups[0]); ++i){
+		errors += test_ulpfec_group(codec, &test_ulpfec_groups[i], &fec, &fec_max_size);
+	}
+	errors += test_ulpfec_small(codec, &fec, &fec_max_size);
+	printf("ULPFEC: %u errors\n", (unsigned)errors);
+
+	TSK_FREE(fec);
+	TSK_OBJECT_SAFE_FREE(codec);
+}
+
+#endif /* _TINYDEV_TEST_ULPFEC_H */
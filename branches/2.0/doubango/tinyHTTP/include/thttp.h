@@ -33,6 +33,7 @@
 
 #include "tinyhttp/thttp_event.h"
 #include "tinyhttp/thttp_session.h"
+#include "tinyhttp/thttp_pool.h"
 
 #include "tnet_transport.h"
 
@@ -81,6 +82,22 @@
 * @endcode
 */
 
+/**@def THTTP_STACK_SET_CONN_POOL(ENABLED_BOOL, MAX_IDLE_INT)
+* Enables or disables the connection pool. Not enabled by default.
+* When enabled, idle keep-alive connections are shared by all sessions targeting the same host, connections are completed
+* by the transport thread instead of blocking the caller and the requests sent while the connection is in progress
+* are pipelined as soon as it's established.
+* This is a helper macro for @ref thttp_stack_create and @ref thttp_stack_set.
+* @param ENABLED_BOOL Whether to enable the pool (tsk_bool_t).
+* @param MAX_IDLE_INT Maximum number of idle connections to keep per host (int). Zero or negative value means @ref THTTP_POOL_MAX_IDLE_PER_HOST_DEFAULT.
+*
+* @code
+* thttp_stack_create(callback, 
+*	THTTP_STACK_SET_CONN_POOL(tsk_true, 4),
+*	THTTP_STACK_SET_NULL());
+* @endcode
+*/
+
 THTTP_BEGIN_DECLS
 
 typedef enum thttp_stack_param_type_e
@@ -110,6 +127,10 @@ typedef enum thttp_stack_param_type_e
 	thttp_pname_tls_certs,
 #define THTTP_STACK_SET_TLS_CERTS(CA_FILE_STR, PUB_FILE_STR, PRIV_FILE_STR)			thttp_pname_tls_certs, (const char*)CA_FILE_STR, (const char*)PUB_FILE_STR, (const char*)PRIV_FILE_STR
 
+	/* Connection pool */
+	thttp_pname_conn_pool,
+#define THTTP_STACK_SET_CONN_POOL(ENABLED_BOOL, MAX_IDLE_INT)						thttp_pname_conn_pool, (tsk_bool_t)ENABLED_BOOL, (int)MAX_IDLE_INT
+
 	/* User Data */
 	thttp_pname_userdata,
 #define THTTP_STACK_SET_USERDATA(USERDATA_PTR)	thttp_pname_userdata, (const void*)USERDATA_PTR
@@ -152,6 +173,13 @@ typedef struct thttp_stack_s
 		char* pvk;
 	}tls;
 
+	/* Connection pool */
+	struct {
+		tsk_bool_t enabled;
+		int max_idle; // per host
+		thttp_pool_conns_L_t* conns; // idle connections
+	}pool;
+
 	thttp_sessions_L_t* sessions;
 	
 	const void* userdata;
@@ -59,6 +59,7 @@ TINYHTTP_API int thttp_auth_digest_response(const tsk_md5string_t *ha1, const ch
 											const char* qop, const tsk_md5string_t* ha2, tsk_md5string_t* response);
 
 TINYHTTP_API tsk_size_t thttp_auth_ws_response(const char* key, thttp_auth_ws_keystring_t* response);
+TINYHTTP_API void thttp_auth_ws_unmask(void* out, const void* in, tsk_size_t size, const uint8_t mask_key[4]);
 
 THTTP_END_DECLS
 
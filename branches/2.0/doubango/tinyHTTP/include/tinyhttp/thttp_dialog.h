@@ -51,8 +51,6 @@ typedef struct thttp_dialog_s
 	
 	tsk_fsm_t* fsm;
 	
-	tsk_buffer_t* buf;
-	
 	struct thttp_session_s* session;
 	struct thttp_action_s* action;
 	tsk_bool_t answered;
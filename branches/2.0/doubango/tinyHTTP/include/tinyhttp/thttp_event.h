@@ -47,7 +47,9 @@ typedef enum thttp_event_type_e
 	thttp_event_auth_failed,
 	thttp_event_closed,
 	thttp_event_transport_error,
-	thttp_event_dialog_terminated
+	thttp_event_dialog_terminated,
+	thttp_event_message_headers, /**< Streaming mode: the headers of an incoming message have been received. */
+	thttp_event_message_chunk /**< Streaming mode: part of the content of an incoming message (see @a chunk_data). */
 }
 thttp_event_type_t;
 
@@ -61,6 +63,10 @@ typedef struct thttp_event_s
 	char* description;
 	
 	struct thttp_message_s *message;
+
+	/* streaming mode: only valid during the callback (points into the receive buffer) */
+	const void* chunk_data;
+	tsk_size_t chunk_size;
 }
 thttp_event_t;
 
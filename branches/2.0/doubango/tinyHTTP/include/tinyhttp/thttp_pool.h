@@ -0,0 +1,64 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file thttp_pool.h
+ * @brief Per-host pool of idle keep-alive HTTP/HTTPS connections shared by all sessions of a stack.
+ */
+#ifndef THTTP_POOL_H
+#define THTTP_POOL_H
+
+#include "tinyhttp_config.h"
+
+#include "tnet_socket.h"
+
+#include "tsk_object.h"
+#include "tsk_list.h"
+
+THTTP_BEGIN_DECLS
+
+struct thttp_stack_s;
+
+/** Default maximum number of idle connections kept per host. */
+#define THTTP_POOL_MAX_IDLE_PER_HOST_DEFAULT	4
+
+/** Idle keep-alive connection. */
+typedef struct thttp_pool_conn_s
+{
+	TSK_DECLARE_OBJECT;
+
+	char* host;
+	tnet_port_t port;
+	tnet_socket_type_t type;
+	tnet_fd_t fd;
+}
+thttp_pool_conn_t;
+
+typedef tsk_list_t thttp_pool_conns_L_t; /**< List of @ref thttp_pool_conn_t elements. */
+
+tnet_fd_t thttp_pool_acquire(struct thttp_stack_s* stack, const char* host, tnet_port_t port, tnet_socket_type_t type);
+int thttp_pool_release(struct thttp_stack_s* stack, const char* host, tnet_port_t port, tnet_socket_type_t type, tnet_fd_t fd);
+tsk_bool_t thttp_pool_remove_fd(struct thttp_stack_s* stack, tnet_fd_t fd);
+int thttp_pool_clear(struct thttp_stack_s* stack);
+
+TINYHTTP_GEXTERN const tsk_object_def_t *thttp_pool_conn_def_t;
+
+THTTP_END_DECLS
+
+#endif /* THTTP_POOL_H */
@@ -38,6 +38,7 @@
 #include "tinyhttp/thttp_dialog.h"
 
 #include "tnet_types.h"
+#include "tnet_socket.h"
 
 #include "tsk_object.h"
 #include "tsk_list.h"
@@ -52,6 +53,7 @@ struct thttp_message_s;
 typedef uint64_t thttp_session_id_t;			
 #define THTTP_SESSION_INVALID_ID				0
 #define THTTP_SESSION_INVALID_HANDLE			tsk_null
+#define THTTP_SESSION_TRANSPORT_ERROR_CODE		-0xFF
 
 /** List of all supported options.
 * To pass an option to the sesion, use @ref THTTP_SESSION_SET_OPTION() macro.
@@ -72,6 +74,7 @@ typedef enum thttp_session_param_type_e
 	httpp_cred,
 	httpp_header,
 	httpp_userdata,
+	httpp_streaming,
 }
 thttp_session_param_type_t;
 
@@ -148,6 +151,21 @@ thttp_session_set(session,
 * @endcode
 */
 /**@ingroup thttp_session_group
+* @def THTTP_SESSION_SET_STREAMING
+* Enables or disables streaming mode. When enabled, the headers of each incoming message are raised as soon as they are
+* received (@ref thttp_event_message_headers) and the content is raised as it comes (@ref thttp_event_message_chunk) instead of
+* being accumulated. Chunked bodies are de-chunked in place. @ref thttp_event_message is still raised when the message is complete (without content).
+* This is a helper macro for @ref thttp_session_create and @ref thttp_session_set.
+* @param ENABLED_BOOL Whether to enable streaming mode (<i>tsk_bool_t</i>). Default: @a tsk_false.
+*
+* @code
+// session = thttp_session_create(stack,
+thttp_session_set(session,
+	THTTP_SESSION_SET_STREAMING(tsk_true),
+	THTTP_SESSION_SET_NULL());
+* @endcode
+*/
+/**@ingroup thttp_session_group
 * @def THTTP_SESSION_SET_NULL
 * Ends session parameters. Must always be the last one.
 */
@@ -156,8 +174,21 @@ thttp_session_set(session,
 #define THTTP_SESSION_SET_HEADER(NAME_STR, VALUE_STR)			httpp_header, (const char*)NAME_STR, (const char*)VALUE_STR
 #define THTTP_SESSION_UNSET_HEADER(NAME_STR)					THTTP_SESSION_SET_HEADER(NAME_STR, (const char*)-1)
 #define THTTP_SESSION_SET_USERDATA(USERDATA_PTR)				httpp_userdata, (const void*)USERDATA_PTR
+#define THTTP_SESSION_SET_STREAMING(ENABLED_BOOL)				httpp_streaming, (tsk_bool_t)ENABLED_BOOL
 #define THTTP_SESSION_SET_NULL()								httpp_null
 
+/** State of the incoming message parser. */
+typedef enum thttp_session_stream_state_e
+{
+	thttp_session_stream_state_headers,
+	thttp_session_stream_state_content,
+	thttp_session_stream_state_chunk_size,
+	thttp_session_stream_state_chunk_data,
+	thttp_session_stream_state_chunk_crlf,
+	thttp_session_stream_state_trailer
+}
+thttp_session_stream_state_t;
+
 typedef struct thttp_session_s
 {
 	TSK_DECLARE_OBJECT;
@@ -169,6 +200,24 @@ typedef struct thttp_session_s
 	tsk_params_L_t *headers;
 
 	tnet_fd_t fd;
+	/* state of the connection (used when the connection pool is enabled) */
+	struct{
+		char* host;
+		tnet_port_t port;
+		tnet_socket_type_t type;
+		tsk_bool_t connected;
+		tsk_bool_t reusable;
+		tsk_list_t* pending; // serialized requests (tsk_buffer_t) waiting for the connection to complete
+	}conn;
+	tsk_buffer_t* buf; // received data, shared by all pipelined dialogs
+	/* incremental parsing of the received data */
+	struct{
+		tsk_bool_t enabled; // streaming mode
+		thttp_session_stream_state_t state;
+		struct thttp_message_s* message; // message being received
+		tsk_bool_t notify; // whether the message is raised to the application
+		tsk_size_t remaining; // bytes remaining in the current content or chunk
+	}stream;
 
 	thttp_challenges_L_t *challenges;
 	thttp_dialogs_L_t* dialogs;
@@ -199,6 +248,9 @@ int thttp_session_update_challenges(thttp_session_t *self, const thttp_response_
 
 int thttp_session_signal_closed(thttp_session_t *self);
 int thttp_session_signal_error(thttp_session_t *self);
+int thttp_session_signal_connected(thttp_session_t *self);
+int thttp_session_send_data(thttp_session_t *self, const char* host, tnet_port_t port, tnet_socket_type_t type, int timeout, const void* data, tsk_size_t size);
+int thttp_session_release_conn(thttp_session_t *self);
 
 
 thttp_session_t* thttp_session_get_by_fd(thttp_sessions_L_t* sessions, tnet_fd_t fd);
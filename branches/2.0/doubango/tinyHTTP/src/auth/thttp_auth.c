@@ -264,3 +264,47 @@ tsk_size_t thttp_auth_ws_response(const char* key, thttp_auth_ws_keystring_t* re
 		return tsk_base64_encode(result, (size >> 1), (char**)&response);
 	}
 }
+
+/**@ingroup thttp_auth_group
+ *
+ * Unmasks WebSocket payload data as per RFC 6455 subclause 5.3 (masking and unmasking are the same operation).
+ * The data is processed 64 bits at a time, with the key rotated to match the first aligned byte.
+ * @param [out]	out			The unmasked data. Could be equal to @a in (in-place unmasking).
+ * @param [in]	in			The masked data.
+ * @param [in]	size		The size of the data.
+ * @param [in]	mask_key	The 32-bit masking key.
+ */
+void thttp_auth_ws_unmask(void* out, const void* in, tsk_size_t size, const uint8_t mask_key[4])
+{
+	uint8_t* pout = (uint8_t*)out;
+	const uint8_t* pin = (const uint8_t*)in;
+	tsk_size_t i = 0, k;
+	uint8_t mask8[8];
+	uint64_t mask64, word;
+
+	if (!out || !in || !mask_key){
+		TSK_DEBUG_ERROR("invalid parameter");
+		return;
+	}
+
+	// bytes before the first aligned word
+	for (; i < size && (((uintptr_t)&pout[i]) & 7); ++i){
+		pout[i] = (pin[i] ^ mask_key[i & 3]);
+	}
+	if ((size - i) >= 8){
+		// key rotated to start at "i" (unchanged while moving by 8 bytes)
+		for (k = 0; k < 8; ++k){
+			mask8[k] = mask_key[(i + k) & 3];
+		}
+		memcpy(&mask64, mask8, 8);
+		for (; (i + 8) <= size; i += 8){
+			memcpy(&word, &pin[i], 8); // "in" could be unaligned
+			word ^= mask64;
+			memcpy(&pout[i], &word, 8);
+		}
+	}
+	// remaining bytes
+	for (; i < size; ++i){
+		pout[i] = (pin[i] ^ mask_key[i & 3]);
+	}
+}
@@ -29,6 +29,7 @@
 #include "tinyhttp/parsers/thttp_parser_message.h"
 
 #include "tinyhttp/headers/thttp_header_Transfer_Encoding.h"
+#include "tinyhttp/headers/thttp_header_Dummy.h"
 
 #include "tinyhttp/thttp_dialog.h"
 
@@ -266,22 +267,212 @@ int ret = thttp_action_GET(session, "http://ipv6.google.com",
 /**@defgroup thttp_stack_group HTTP/HTTPS stack
 */
 
-/* min size of a stream chunck to form a valid HTTP message */
-#define THTTP_MIN_STREAM_CHUNCK_SIZE 0x32
+#define THTTP_MESSAGE_DESCRIPTION(message) \
+		THTTP_MESSAGE_IS_RESPONSE(message) ? THTTP_RESPONSE_PHRASE(message) : THTTP_REQUEST_METHOD(message)
+
+int thttp_stack_alert(const thttp_stack_t *self, const thttp_event_t* e);
+
+/* Whether the connection could be reused after receiving this message (RFC 2616 - 8.1.2.1 Negotiation) */
+static tsk_bool_t _thttp_message_is_persistent(const thttp_message_t* message)
+{
+	const thttp_header_Dummy_t* Connection = (const thttp_header_Dummy_t*)thttp_message_get_headerByName(message, "Connection");
+	if(Connection && Connection->value){
+		if(tsk_striequals(Connection->value, "close")){
+			return tsk_false;
+		}
+		if(tsk_striequals(Connection->value, "keep-alive")){
+			return tsk_true;
+		}
+	}
+	return !tsk_striequals(message->http_version, THTTP_MESSAGE_VERSION_10);
+}
+
+/* Delivers a piece of the body: raised to the application in streaming mode and appended to the message otherwise */
+static int _thttp_session_deliver_content(thttp_stack_t* stack, thttp_session_t* session, const void* data, tsk_size_t size)
+{
+	int ret = 0;
+	if(session->stream.enabled){
+		thttp_event_t* e;
+		if(session->stream.notify && (e = thttp_event_create(thttp_event_message_chunk, session, "Body chunk", session->stream.message))){
+			e->chunk_data = data;
+			e->chunk_size = size;
+			ret = thttp_stack_alert(stack, e);
+			TSK_OBJECT_SAFE_FREE(e);
+		}
+	}
+	else{
+		ret = thttp_message_append_content(session->stream.message, data, size);
+	}
+	return ret;
+}
+
+/* Parses the session's receive buffer in place. The state is kept in the session which means a message (headers, content
+* or chunks) could span any number of network reads without being parsed twice. In streaming mode the headers are raised as
+* soon as they are parsed and the content is raised as it comes, pointing into the receive buffer (no copy).
+* When a message is complete it's passed to the oldest dialog (pipelined responses come in the requests order).
+*/
+static int _thttp_session_process_buffer(thttp_stack_t* stack, thttp_session_t* session)
+{
+	int ret = 0, index;
+	tsk_size_t pos = 0, avail, n;
+	const char* p;
+	tsk_bool_t complete;
+	tsk_ragel_state_t state;
+	thttp_dialog_t* dialog;
+	thttp_event_t* e;
+
+	for(;;){
+		p = ((const char*)TSK_BUFFER_DATA(session->buf)) + pos;
+		avail = TSK_BUFFER_SIZE(session->buf) - pos;
+		complete = tsk_false;
+
+		switch(session->stream.state){
+			case thttp_session_stream_state_headers:
+				{
+					const thttp_header_Transfer_Encoding_t* transfer_Encoding;
+					if(!avail || (index = tsk_strindexOf(p, avail, "\r\n\r\n"/*2CRLF*/)) < 0){
+						TSK_DEBUG_INFO("No all HTTP headers in the TCP buffer.");
+						goto done;
+					}
+					/* Parse the HTTP message without the content. */
+					TSK_OBJECT_SAFE_FREE(session->stream.message);
+					tsk_ragel_state_init(&state, p, index + 4/*2CRLF*/);
+					if((ret = thttp_message_parse(&state, &session->stream.message, tsk_false/* do not extract the content */)) || !session->stream.message){
+						TSK_DEBUG_ERROR("Failed to parse HTTP message.");
+						pos += index + 4/*2CRLF*/;
+						TSK_OBJECT_SAFE_FREE(session->stream.message);
+						continue;
+					}
+					pos += index + 4/*2CRLF*/;
+					
+					/* Provisional responses and challenges are handled by the dialog */
+					session->stream.notify = !THTTP_RESPONSE_IS_1XX(session->stream.message) && !THTTP_RESPONSE_IS(session->stream.message, 401) && !THTTP_RESPONSE_IS(session->stream.message, 407);
+					if(session->stream.enabled && session->stream.notify){
+						if((e = thttp_event_create(thttp_event_message_headers, session, THTTP_MESSAGE_DESCRIPTION(session->stream.message), session->stream.message))){
+							thttp_stack_alert(stack, e);
+							TSK_OBJECT_SAFE_FREE(e);
+						}
+					}
+
+					if((transfer_Encoding = (const thttp_header_Transfer_Encoding_t*)thttp_message_get_header(session->stream.message, thttp_htype_Transfer_Encoding)) && tsk_striequals(transfer_Encoding->encoding, "chunked")){
+						TSK_DEBUG_INFO("CHUNKED transfer.");
+						session->stream.state = thttp_session_stream_state_chunk_size;
+					}
+					else if((session->stream.remaining = THTTP_MESSAGE_CONTENT_LENGTH(session->stream.message))){
+						session->stream.state = thttp_session_stream_state_content;
+					}
+					else{ /* No content */
+						complete = tsk_true;
+					}
+					break;
+				}
+
+			case thttp_session_stream_state_content:
+				{
+					if(!session->stream.enabled && avail < session->stream.remaining){
+						/* whole message mode: wait for all the content to avoid growing the message's content */
+						TSK_DEBUG_INFO("No all HTTP content in the TCP buffer.");
+						goto done;
+					}
+					if(!(n = TSK_MIN(avail, session->stream.remaining))){
+						goto done;
+					}
+					if(session->stream.enabled){
+						_thttp_session_deliver_content(stack, session, p, n);
+					}
+					else{
+						thttp_message_add_content(session->stream.message, tsk_null, p, n);
+					}
+					pos += n;
+					if(!(session->stream.remaining -= n)){
+						complete = tsk_true;
+					}
+					break;
+				}
+
+			case thttp_session_stream_state_chunk_size:
+				{
+					/* RFC 2616 - 19.4.6 Introduction of Transfer-Encoding */
+					// read chunk-size, chunk-extension (if any) and CRLF
+					if((index = tsk_strindexOf(p, avail, "\r\n")) < 0){
+						goto done;
+					}
+					session->stream.remaining = (tsk_size_t)tsk_atox(p);
+					pos += index + 2/*CRLF*/;
+					session->stream.state = session->stream.remaining ? thttp_session_stream_state_chunk_data : thttp_session_stream_state_trailer;
+					break;
+				}
+
+			case thttp_session_stream_state_chunk_data:
+				{
+					if(!(n = TSK_MIN(avail, session->stream.remaining))){
+						goto done;
+					}
+					_thttp_session_deliver_content(stack, session, p, n);
+					pos += n;
+					if(!(session->stream.remaining -= n)){
+						session->stream.state = thttp_session_stream_state_chunk_crlf;
+					}
+					break;
+				}
+
+			case thttp_session_stream_state_chunk_crlf:
+				{
+					if(avail < 2/*CRLF*/){
+						goto done;
+					}
+					pos += 2/*CRLF*/;
+					session->stream.state = thttp_session_stream_state_chunk_size;
+					break;
+				}
+
+			case thttp_session_stream_state_trailer:
+				{
+					// trailer headers (ignored) then empty line
+					if((index = tsk_strindexOf(p, avail, "\r\n")) < 0){
+						goto done;
+					}
+					pos += index + 2/*CRLF*/;
+					complete = (index == 0);
+					break;
+				}
+		}
+
+		if(complete){
+			session->stream.state = thttp_session_stream_state_headers;
+			/* remove the parsed data before alerting the dialog: the connection could be released if the buffer is empty */
+			tsk_buffer_remove(session->buf, 0, pos);
+			pos = 0;
+
+			if(!_thttp_message_is_persistent(session->stream.message)){
+				session->conn.reusable = tsk_false;
+			}
+			/* Pipelined responses come in the same order as the requests => get the oldest dialog */
+			if((dialog = thttp_dialog_get_oldest(session->dialogs))){
+				ret = thttp_dialog_fsm_act(dialog, thttp_atype_i_message, session->stream.message, tsk_null);
+				TSK_OBJECT_SAFE_FREE(dialog);
+			}
+			else{
+				TSK_DEBUG_ERROR("Failed to found associated dialog.");
+				ret = -5;
+			}
+			TSK_OBJECT_SAFE_FREE(session->stream.message);
+		}
+	}
+
+done:
+	if(pos){
+		tsk_buffer_remove(session->buf, 0, pos);
+	}
+	return ret;
+}
 
 /** Callback function used by the transport layer to alert the stack when new messages come. */
 static int thttp_transport_layer_stream_cb(const tnet_transport_event_t* e)
 {
 	int ret = -1;
-	tsk_ragel_state_t state;
-	thttp_message_t *message = tsk_null;
-	int endOfheaders = -1;
-	const thttp_stack_t *stack = e->callback_data;
-	thttp_dialog_t* dialog = tsk_null;
+	thttp_stack_t *stack = (thttp_stack_t*)e->callback_data;
 	thttp_session_t* session = tsk_null;
-	tsk_bool_t have_all_content = tsk_false;
-	
-	tsk_safeobj_lock(stack);
 
 	switch(e->type){
 		case event_data: {
@@ -292,22 +483,38 @@ static int thttp_transport_layer_stream_cb(const tnet_transport_event_t* e)
 			if((session = thttp_session_get_by_fd(stack->sessions, e->local_fd))){
 				ret = thttp_session_signal_closed(session);
 			}
-			goto bail;
+			else if(thttp_pool_remove_fd(stack, e->local_fd)){
+				TSK_DEBUG_INFO("Idle HTTP/HTTPS connection closed (fd=%d).", e->local_fd);
+				ret = 0;
+			}
+			goto done;
 
 		case event_error:
 			// alert all dialogs
 			if((session = thttp_session_get_by_fd(stack->sessions, e->local_fd))){
 				ret = thttp_session_signal_error(session);
 			}
-			goto bail;
+			else if(thttp_pool_remove_fd(stack, e->local_fd)){
+				ret = 0;
+			}
+			goto done;
+
 		case event_connected:
+			// send the requests queued while the connection was in progress
+			if((session = thttp_session_get_by_fd(stack->sessions, e->local_fd))){
+				ret = thttp_session_signal_connected(session);
+			}
+			else{
+				ret = 0;
+			}
+			goto done;
+
 		default:{
-				tsk_safeobj_unlock(stack);
 				return 0;
 			}
 	}
 	
-	/* Gets the associated dialog */
+	/* Gets the associated session */
 	if(!(session = thttp_session_get_by_fd(stack->sessions, e->local_fd))){
 		if ((stack->mode & thttp_stack_mode_server)) {
 			// server mode -> add new session
@@ -317,116 +524,33 @@ static int thttp_transport_layer_stream_cb(const tnet_transport_event_t* e)
 			if (!session) {
 				TSK_DEBUG_ERROR("Failed to create new session.");
 				ret = -5;
-				goto bail;
+				goto done;
 			}
 		}
 		else {
 			// client mode -> session *must* exist
 			TSK_DEBUG_ERROR("Failed to found associated session.");
 			ret = -4;
-			goto bail;
+			goto done;
 		}
-	}	
-
-	// Get dialog associated to this session
-	if(!(dialog = thttp_dialog_get_oldest(session->dialogs))){
-		TSK_DEBUG_ERROR("Failed to found associated dialog.");
-		ret = -5;
-		goto bail;
 	}
 
+	/* From now on only this session is locked: the other sessions could process their data in parallel */
+	tsk_safeobj_lock(session);
+
 	/* Check if buffer is too big to be valid (have we missed some chuncks?) */
 	//if(TSK_BUFFER_SIZE(buf) >= THTTP_MAX_CONTENT_SIZE){
-	//	tsk_buffer_cleanup(dialog->buf);
+	//	tsk_buffer_cleanup(session->buf);
 	//}
 
-	/* Append new content. */
-	tsk_buffer_append(dialog->buf, e->data, e->size);
-	
-	/* Check if we have all HTTP headers. */
-parse_buffer:
-	if((endOfheaders = tsk_strindexOf(TSK_BUFFER_DATA(dialog->buf), TSK_BUFFER_SIZE(dialog->buf), "\r\n\r\n"/*2CRLF*/)) < 0){
-		TSK_DEBUG_INFO("No all HTTP headers in the TCP buffer.");
-		goto bail;
-	}
-	
-	/* If we are here this mean that we have all HTTP headers.
-	*	==> Parse the HTTP message without the content.
-	*/
-	tsk_ragel_state_init(&state, TSK_BUFFER_DATA(dialog->buf), endOfheaders + 4/*2CRLF*/);
-	if(!(ret = thttp_message_parse(&state, &message, tsk_false/* do not extract the content */))){
-		const thttp_header_Transfer_Encoding_t* transfer_Encoding;
-
-		/* chunked? */
-		if((transfer_Encoding = (const thttp_header_Transfer_Encoding_t*)thttp_message_get_header(message, thttp_htype_Transfer_Encoding)) && tsk_striequals(transfer_Encoding->encoding, "chunked")){
-			const char* start = (const char*)(TSK_BUFFER_TO_U8(dialog->buf) + (endOfheaders + 4/*2CRLF*/));
-			const char* end = (const char*)(TSK_BUFFER_TO_U8(dialog->buf) + TSK_BUFFER_SIZE(dialog->buf));
-			int index;
-
-			TSK_DEBUG_INFO("CHUNKED transfer.");
-			while(start < end){
-				/* RFC 2616 - 19.4.6 Introduction of Transfer-Encoding */
-				// read chunk-size, chunk-extension (if any) and CRLF
-				tsk_size_t chunk_size = (tsk_size_t)tsk_atox(start);
-				if((index = tsk_strindexOf(start, (tsk_size_t)(end-start), "\r\n")) >=0){
-					start += index + 2/*CRLF*/;
-				}
-				else{
-					TSK_DEBUG_INFO("Parsing chunked data has failed.");
-					break;
-				}
+	/* Append new content and parse as much as possible */
+	tsk_buffer_append(session->buf, e->data, e->size);
+	ret = _thttp_session_process_buffer(stack, session);
 
-				if(chunk_size == 0 && ((start + 2) <= end) && *start == '\r' && *(start+ 1) == '\n'){
-					int parsed_len = (int)(start - (const char*)(TSK_BUFFER_TO_U8(dialog->buf))) + 2/*CRLF*/;
-					tsk_buffer_remove(dialog->buf, 0, parsed_len);
-					have_all_content = tsk_true;
-					break;
-				}
-					
-				thttp_message_append_content(message, start, chunk_size);
-				start += chunk_size + 2/*CRLF*/;
-			}
-		}
-		else{
-			tsk_size_t clen = THTTP_MESSAGE_CONTENT_LENGTH(message); /* MUST have content-length header. */
-			if(clen == 0){ /* No content */
-				tsk_buffer_remove(dialog->buf, 0, (endOfheaders + 4/*2CRLF*/)); /* Remove HTTP headers and CRLF ==> must never happen */
-				have_all_content = tsk_true;
-			}
-			else{ /* There is a content */
-				if((endOfheaders + 4/*2CRLF*/ + clen) > TSK_BUFFER_SIZE(dialog->buf)){ /* There is content but not all the content. */
-					TSK_DEBUG_INFO("No all HTTP content in the TCP buffer.");
-					goto bail;
-				}
-				else{
-					/* Add the content to the message. */
-					thttp_message_add_content(message, tsk_null, TSK_BUFFER_TO_U8(dialog->buf) + endOfheaders + 4/*2CRLF*/, clen);
-					/* Remove HTTP headers, CRLF and the content. */
-					tsk_buffer_remove(dialog->buf, 0, (endOfheaders + 4/*2CRLF*/ + clen));
-					have_all_content = tsk_true;
-				}
-			}
-		}
-	}
-	
-	/* Alert the dialog (FSM) */
-	if(message){
-		if(have_all_content){ /* only if we have all data */
-			ret = thttp_dialog_fsm_act(dialog, thttp_atype_i_message, message, tsk_null);
-			/* Parse next chunck */
-			if(TSK_BUFFER_SIZE(dialog->buf) >= THTTP_MIN_STREAM_CHUNCK_SIZE){
-				TSK_OBJECT_SAFE_FREE(message);
-				goto parse_buffer;
-			}
-		}
-	}
+	tsk_safeobj_unlock(session);
 
-bail:
-	TSK_OBJECT_SAFE_FREE(dialog);
+done:
 	TSK_OBJECT_SAFE_FREE(session);
-	TSK_OBJECT_SAFE_FREE(message);
-
-	tsk_safeobj_unlock(stack);
 
 	return ret;
 }
@@ -497,6 +621,19 @@ int __thttp_stack_set(thttp_stack_t *self, va_list* app)
 				break;
 			}
 
+			//
+			// Connection pool
+			//
+		case thttp_pname_conn_pool:
+			{	/* (tsk_bool_t)ENABLED_BOOL, (int)MAX_IDLE_INT */
+				self->pool.enabled = va_arg(*app, tsk_bool_t);
+				self->pool.max_idle = va_arg(*app, int);
+				if(self->pool.max_idle <= 0){
+					self->pool.max_idle = THTTP_POOL_MAX_IDLE_PER_HOST_DEFAULT;
+				}
+				break;
+			}
+
 			//
 			// Userdata
 			//
@@ -677,9 +814,12 @@ int thttp_stack_stop(thttp_stack_handle_t *self)
 	// FIXME: stop = destroy transport
 	if(1){
 		tsk_list_item_t* item;
+		tsk_list_lock(stack->sessions);
 		tsk_list_foreach(item, stack->sessions){
 			thttp_session_closefd((thttp_session_handle_t*)item->data);
 		}
+		tsk_list_unlock(stack->sessions);
+		thttp_pool_clear(stack);
 		
 		TSK_OBJECT_SAFE_FREE(stack->transport);
 		stack->started = tsk_false;
@@ -745,6 +885,8 @@ static tsk_object_t* thttp_stack_ctor(tsk_object_t * self, va_list * app)
 		tsk_safeobj_init(stack);
 
 		stack->sessions = tsk_list_create();
+		stack->pool.conns = tsk_list_create();
+		stack->pool.max_idle = THTTP_POOL_MAX_IDLE_PER_HOST_DEFAULT;
 	}
 	return self;
 }
@@ -763,6 +905,10 @@ static tsk_object_t* thttp_stack_dtor(tsk_object_t * self)
 		TSK_OBJECT_SAFE_FREE(stack->sessions);
 		tsk_safeobj_unlock(stack);
 
+		/* Connection pool */
+		thttp_pool_clear(stack);
+		TSK_OBJECT_SAFE_FREE(stack->pool.conns);
+
 		/* Network */
 		TSK_FREE(stack->local_ip);
 		TSK_FREE(stack->proxy_ip);
@@ -78,7 +78,8 @@ int thttp_action_perform(thttp_session_handle_t *session, const char* urlstring,
 	}
 	
 	va_start(ap, method);
-	if((action = thttp_action_create(thttp_atype_o_request, urlstring, method, &ap))){		
+	if((action = thttp_action_create(thttp_atype_o_request, urlstring, method, &ap))){
+		tsk_safeobj_lock(sess);
 		if((dialog = thttp_dialog_new(sess))){
 			ret = thttp_dialog_fsm_act(dialog, action->type, tsk_null, action);
 			
@@ -88,6 +89,7 @@ int thttp_action_perform(thttp_session_handle_t *session, const char* urlstring,
 			TSK_DEBUG_ERROR("Failed to create new HTTP/HTTPS dialog.");
 			ret = -2;
 		}
+		tsk_safeobj_unlock(sess);
 		TSK_OBJECT_SAFE_FREE(action);
 	}
 	va_end(ap);
@@ -46,7 +46,7 @@
 #define THTTP_MESSAGE_DESCRIPTION(message) \
 		THTTP_MESSAGE_IS_RESPONSE(message) ? THTTP_RESPONSE_PHRASE(message) : THTTP_REQUEST_METHOD(message)
 
-#define THTTP_DIALOG_TRANSPORT_ERROR_CODE	-0xFF
+#define THTTP_DIALOG_TRANSPORT_ERROR_CODE	THTTP_SESSION_TRANSPORT_ERROR_CODE
 
 /* ======================== internal functions ======================== */
 int thttp_dialog_send_request(thttp_dialog_t *self);
@@ -367,37 +367,23 @@ int thttp_dialog_send_request(thttp_dialog_t *self)
 		}
 	}
 	
-	/* connect to the server not already done */
-	if(self->session->fd == TNET_INVALID_FD){
+	/* connect to the server if not already done and send (or queue) the request */
+	{
 		const char* host = request->line.request.url->host;
 		uint16_t port = request->line.request.url->port;
 		if (!tsk_strnullORempty(self->session->stack->proxy_ip) && self->session->stack->proxy_port) {
 			host = self->session->stack->proxy_ip;
 			port = self->session->stack->proxy_port;
 		}
-		if ((self->session->fd = tnet_transport_connectto(self->session->stack->transport, host, port, type)) == TNET_INVALID_FD) {
-			TSK_DEBUG_ERROR("Failed to connect to %s:%d.", host, port);
-			ret = -3;
-			goto bail;
+		if ((ret = thttp_session_send_data(self->session, host, port, type, timeout, output->data, output->size)) == 0) {
+			TSK_DEBUG_INFO("HTTP/HTTPS message successfully sent.");
+			thttp_dialog_update_timestamp(self);
 		}
-		
-		if ((ret = tnet_sockfd_waitUntilWritable(self->session->fd, timeout))) {
-			TSK_DEBUG_ERROR("%d milliseconds elapsed and the socket is still not connected.", timeout);
-			if(tnet_transport_remove_socket(self->session->stack->transport, &self->session->fd)){
-				tnet_sockfd_close(&self->session->fd);
-			}
-			goto bail;
+		else if (ret == THTTP_SESSION_TRANSPORT_ERROR_CODE) {
+			TSK_DEBUG_INFO("Failed to sent HTTP/HTTPS message.");
+			ret = THTTP_DIALOG_TRANSPORT_ERROR_CODE;
 		}
 	}
-	if (tnet_transport_send(self->session->stack->transport, self->session->fd, output->data, output->size)) {
-		TSK_DEBUG_INFO("HTTP/HTTPS message successfully sent.");
-		thttp_dialog_update_timestamp(self);
-		ret = 0;
-	}
-	else {
-		TSK_DEBUG_INFO("Failed to sent HTTP/HTTPS message.");
-		ret = THTTP_DIALOG_TRANSPORT_ERROR_CODE;
-	}
 
 bail:
 	TSK_OBJECT_SAFE_FREE(request);
@@ -434,6 +420,8 @@ int thttp_dialog_OnTerminated(thttp_dialog_t *self)
 		}
 		
 		tsk_list_remove_item_by_data(self->session->dialogs, self);
+		/* the connection could be reused by another session */
+		thttp_session_release_conn(self->session);
 		return 0;
 	}
 
@@ -456,9 +444,6 @@ static tsk_object_t* thttp_dialog_ctor(tsk_object_t * self, va_list * app)
 	static thttp_dialog_id_t unique_id = 0;
 	if(dialog){
 		dialog->id = ++unique_id;
-		if (!(dialog->buf = tsk_buffer_create_null())) {
-			return tsk_null;
-		}
 		dialog->session = tsk_object_ref(va_arg(*app, thttp_session_t*));
 
 		/* create and init FSM */
@@ -511,8 +496,6 @@ static tsk_object_t* thttp_dialog_dtor(tsk_object_t * self)
 	
 		TSK_OBJECT_SAFE_FREE(dialog->session);
 		TSK_OBJECT_SAFE_FREE(dialog->action);
-
-		TSK_OBJECT_SAFE_FREE(dialog->buf);
 	}
 
 	return self;
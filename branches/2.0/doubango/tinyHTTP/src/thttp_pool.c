@@ -0,0 +1,186 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file thttp_pool.c
+ * @brief Per-host pool of idle keep-alive HTTP/HTTPS connections shared by all sessions of a stack.
+ * A connection is owned by at most one session at a time (the one with pending dialogs) which means
+ * received data can always be matched to a session by fd. When the session has no more dialogs the
+ * connection is released to the pool and could be acquired by any other session targeting the same host.
+ */
+#include "tinyhttp/thttp_pool.h"
+
+#include "thttp.h"
+
+#include "tnet_utils.h"
+
+#include "tsk_string.h"
+#include "tsk_memory.h"
+#include "tsk_debug.h"
+
+static int _thttp_pool_conn_pred_fd(const tsk_list_item_t* item, const void* fd)
+{
+	return (((const thttp_pool_conn_t*)item->data)->fd == *((const tnet_fd_t*)fd)) ? 0 : -1;
+}
+
+static tsk_bool_t _thttp_pool_conn_match(const thttp_pool_conn_t* conn, const char* host, tnet_port_t port, tnet_socket_type_t type)
+{
+	return (conn->port == port && conn->type == type && tsk_striequals(conn->host, host));
+}
+
+static int _thttp_pool_close_fd(struct thttp_stack_s* stack, tnet_fd_t* fd)
+{
+	if (*fd != TNET_INVALID_FD) {
+		if (!stack->transport || tnet_transport_remove_socket(stack->transport, fd)) {
+			return tnet_sockfd_close(fd);
+		}
+	}
+	return 0;
+}
+
+/** Takes an idle connection to @a host:@a port from the pool.
+* @retval The fd of an already connected socket or @a TNET_INVALID_FD if there is no idle connection.
+*/
+tnet_fd_t thttp_pool_acquire(struct thttp_stack_s* stack, const char* host, tnet_port_t port, tnet_socket_type_t type)
+{
+	tnet_fd_t fd = TNET_INVALID_FD;
+	tsk_list_item_t* item;
+
+	if (!stack || !stack->pool.conns || !host) {
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return TNET_INVALID_FD;
+	}
+
+	tsk_list_lock(stack->pool.conns);
+again:
+	tsk_list_foreach(item, stack->pool.conns) {
+		thttp_pool_conn_t* conn = (thttp_pool_conn_t*)item->data;
+		if (_thttp_pool_conn_match(conn, host, port, type)) {
+			tnet_fd_t conn_fd = conn->fd;
+			tsk_list_remove_item(stack->pool.conns, item);
+			// the peer could have closed the connection while it was idle
+			if (stack->transport && tnet_transport_have_socket(stack->transport, conn_fd)) {
+				fd = conn_fd;
+				TSK_DEBUG_INFO("HTTP pool: reusing fd=%d for %s:%u", fd, host, port);
+				break;
+			}
+			goto again;
+		}
+	}
+	tsk_list_unlock(stack->pool.conns);
+
+	return fd;
+}
+
+/** Gives back a connection to the pool. The connection is closed if the host already has enough idle connections.
+*/
+int thttp_pool_release(struct thttp_stack_s* stack, const char* host, tnet_port_t port, tnet_socket_type_t type, tnet_fd_t fd)
+{
+	int count = 0;
+	thttp_pool_conn_t* conn;
+	const tsk_list_item_t* item;
+
+	if (!stack || !stack->pool.conns || !host || fd == TNET_INVALID_FD) {
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	tsk_list_lock(stack->pool.conns);
+	tsk_list_foreach(item, stack->pool.conns) {
+		if (_thttp_pool_conn_match((const thttp_pool_conn_t*)item->data, host, port, type)) {
+			++count;
+		}
+	}
+	if (count >= stack->pool.max_idle || !(conn = tsk_object_new(thttp_pool_conn_def_t))) {
+		tsk_list_unlock(stack->pool.conns);
+		TSK_DEBUG_INFO("HTTP pool: too many idle connections to %s:%u, closing fd=%d", host, port, fd);
+		return _thttp_pool_close_fd(stack, &fd);
+	}
+	conn->host = tsk_strdup(host);
+	conn->port = port;
+	conn->type = type;
+	conn->fd = fd;
+	tsk_list_push_back_data(stack->pool.conns, (void**)&conn);
+	tsk_list_unlock(stack->pool.conns);
+
+	return 0;
+}
+
+/** Removes an idle connection (e.g. closed by the remote peer).
+* @retval @a tsk_true if @a fd was an idle connection and @a tsk_false otherwise.
+*/
+tsk_bool_t thttp_pool_remove_fd(struct thttp_stack_s* stack, tnet_fd_t fd)
+{
+	tsk_bool_t removed = tsk_false;
+	if (stack && stack->pool.conns) {
+		tsk_list_lock(stack->pool.conns);
+		removed = tsk_list_remove_item_by_pred(stack->pool.conns, _thttp_pool_conn_pred_fd, &fd);
+		tsk_list_unlock(stack->pool.conns);
+	}
+	return removed;
+}
+
+/** Closes all idle connections.
+*/
+int thttp_pool_clear(struct thttp_stack_s* stack)
+{
+	tsk_list_item_t* item;
+	if (!stack || !stack->pool.conns) {
+		return -1;
+	}
+	tsk_list_lock(stack->pool.conns);
+	while ((item = tsk_list_pop_first_item(stack->pool.conns))) {
+		_thttp_pool_close_fd(stack, &((thttp_pool_conn_t*)item->data)->fd);
+		TSK_OBJECT_SAFE_FREE(item);
+	}
+	tsk_list_unlock(stack->pool.conns);
+	return 0;
+}
+
+
+
+//========================================================
+//	HTTP pooled connection object definition
+//
+static tsk_object_t* thttp_pool_conn_ctor(tsk_object_t * self, va_list * app)
+{
+	thttp_pool_conn_t *conn = self;
+	if (conn) {
+		conn->fd = TNET_INVALID_FD;
+	}
+	return self;
+}
+
+static tsk_object_t* thttp_pool_conn_dtor(tsk_object_t * self)
+{
+	thttp_pool_conn_t *conn = self;
+	if (conn) {
+		TSK_FREE(conn->host);
+	}
+	return self;
+}
+
+static const tsk_object_def_t thttp_pool_conn_def_s =
+{
+	sizeof(thttp_pool_conn_t),
+	thttp_pool_conn_ctor,
+	thttp_pool_conn_dtor,
+	tsk_null,
+};
+const tsk_object_def_t *thttp_pool_conn_def_t = &thttp_pool_conn_def_s;
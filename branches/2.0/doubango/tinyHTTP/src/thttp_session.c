@@ -35,6 +35,8 @@
 #include "tinyhttp/headers/thttp_header_Dummy.h"
 #include "tinyhttp/headers/thttp_header_WWW_Authenticate.h"
 
+#include "tnet_utils.h"
+
 #include "tsk_debug.h"
 
 /**@defgroup thttp_session_group HTTP Session
@@ -88,6 +90,12 @@ int __thttp_session_set(thttp_session_t *self, va_list* app)
 					break;
 				}
 
+			case httpp_streaming:
+				{	/* (tsk_bool_t)ENABLED_BOOL */
+					self->stream.enabled = va_arg(*app, tsk_bool_t);
+					break;
+				}
+
 			default:
 				{	/* va_list will be unsafe => exit */
 					TSK_DEBUG_ERROR("NOT SUPPORTED.");
@@ -226,6 +234,106 @@ int thttp_session_closefd(thttp_session_handle_t *_self)
 	return ret;
 }
 
+/** Sends serialized data to @a host:@a port, connecting the session first if not already done.
+* When the connection pool is enabled the connect() is non-blocking: the data is queued and will be sent, in order
+* and pipelined with any other request sent in the meantime, when the transport signals the connection.
+* Otherwise, waits until the socket is writable or @a timeout (in milliseconds) elapses.
+*/
+int thttp_session_send_data(thttp_session_t *self, const char* host, tnet_port_t port, tnet_socket_type_t type, int timeout, const void* data, tsk_size_t size)
+{
+	int ret = 0;
+	thttp_stack_t* stack;
+
+	if(!self || !self->stack || !host || !data || !size){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	stack = (thttp_stack_t*)self->stack;
+
+	tsk_safeobj_lock(self);
+
+	/* connect to the server if not already done */
+	if(self->fd == TNET_INVALID_FD){
+		tsk_strupdate(&self->conn.host, host);
+		self->conn.port = port;
+		self->conn.type = type;
+		self->conn.connected = tsk_false;
+		self->conn.reusable = stack->pool.enabled;
+		tsk_buffer_cleanup(self->buf);
+
+		if(stack->pool.enabled && (self->fd = thttp_pool_acquire(stack, host, port, type)) != TNET_INVALID_FD){
+			self->conn.connected = tsk_true;
+		}
+		else{
+			if((self->fd = tnet_transport_connectto(stack->transport, host, port, type)) == TNET_INVALID_FD){
+				TSK_DEBUG_ERROR("Failed to connect to %s:%d.", host, port);
+				ret = -3;
+				goto bail;
+			}
+			if(!stack->pool.enabled){
+				if((ret = tnet_sockfd_waitUntilWritable(self->fd, timeout))){
+					TSK_DEBUG_ERROR("%d milliseconds elapsed and the socket is still not connected.", timeout);
+					if(tnet_transport_remove_socket(stack->transport, &self->fd)){
+						tnet_sockfd_close(&self->fd);
+					}
+					goto bail;
+				}
+				self->conn.connected = tsk_true;
+			}
+			else if(tnet_sockfd_waitUntilWritable(self->fd, 0) == 0){
+				/* the "connected" event could have been raised before we got the fd */
+				self->conn.connected = tsk_true;
+			}
+		}
+	}
+
+	if(self->conn.connected){
+		if(!tnet_transport_send(stack->transport, self->fd, data, size)){
+			ret = THTTP_SESSION_TRANSPORT_ERROR_CODE;
+		}
+	}
+	else{
+		tsk_buffer_t* buffer;
+		if(!(buffer = tsk_buffer_create(data, size))){
+			ret = -4;
+			goto bail;
+		}
+		TSK_DEBUG_INFO("Connection to %s:%d in progress, queuing HTTP/HTTPS request.", host, port);
+		tsk_list_push_back_data(self->conn.pending, (void**)&buffer);
+	}
+
+bail:
+	tsk_safeobj_unlock(self);
+	return ret;
+}
+
+/** Gives back the connection to the stack's pool if the session has no more dialogs.
+*/
+int thttp_session_release_conn(thttp_session_t *self)
+{
+	int ret = 0;
+	thttp_stack_t* stack;
+
+	if(!self || !self->stack){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	stack = (thttp_stack_t*)self->stack;
+
+	tsk_safeobj_lock(self);
+	if(stack->pool.enabled && self->fd != TNET_INVALID_FD && self->conn.connected && self->conn.reusable
+		&& TSK_LIST_IS_EMPTY(self->dialogs) && TSK_LIST_IS_EMPTY(self->conn.pending) && !TSK_BUFFER_SIZE(self->buf)){
+		ret = thttp_pool_release(stack, self->conn.host, self->conn.port, self->conn.type, self->fd);
+		self->fd = TNET_INVALID_FD;
+		self->conn.connected = tsk_false;
+	}
+	tsk_safeobj_unlock(self);
+
+	return ret;
+}
+
 /** Updates authentications headers.
 */
 int thttp_session_update_challenges(thttp_session_t *self, const thttp_response_t* response, tsk_bool_t answered)
@@ -393,6 +501,14 @@ again:
 	switch(atype){
 		case thttp_thttp_atype_closed:
 			self->fd = TNET_INVALID_FD;
+			self->conn.connected = tsk_false;
+			tsk_list_clear_items(self->conn.pending);
+			tsk_buffer_cleanup(self->buf);
+			self->stream.state = thttp_session_stream_state_headers;
+			TSK_OBJECT_SAFE_FREE(self->stream.message);
+			break;
+		case thttp_atype_error:
+			self->conn.reusable = tsk_false;
 			break;
 		default:
 			break;
@@ -415,6 +531,33 @@ int thttp_session_signal_error(thttp_session_t *self)
 	return thttp_session_signal(self, thttp_atype_error);
 }
 
+/** Signals that the non-blocking connect() completed and sends (pipelines) the queued requests. */
+int thttp_session_signal_connected(thttp_session_t *self)
+{
+	tsk_list_item_t *item;
+
+	if(!self || !self->stack){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	tsk_safeobj_lock(self);
+	if(!self->conn.connected && self->fd != TNET_INVALID_FD){
+		self->conn.connected = tsk_true;
+		while((item = tsk_list_pop_first_item(self->conn.pending))){
+			const tsk_buffer_t* buffer = (const tsk_buffer_t*)item->data;
+			if(!tnet_transport_send(self->stack->transport, self->fd, buffer->data, buffer->size)){
+				/* the transport layer will raise the error event */
+				TSK_DEBUG_ERROR("Failed to send queued HTTP/HTTPS request.");
+			}
+			TSK_OBJECT_SAFE_FREE(item);
+		}
+	}
+	tsk_safeobj_unlock(self);
+
+	return 0;
+}
+
 
 /** Retrieves a session by fd */
 thttp_session_t* thttp_session_get_by_fd(thttp_sessions_L_t* sessions, tnet_fd_t fd)
@@ -423,17 +566,18 @@ thttp_session_t* thttp_session_get_by_fd(thttp_sessions_L_t* sessions, tnet_fd_t
 	const tsk_list_item_t *item;
 	
 	if(!sessions){
-		goto bail;
+		return tsk_null;
 	}
 
+	tsk_list_lock(sessions);
 	tsk_list_foreach(item, sessions){
 		if(((thttp_session_t*)item->data)->fd == fd){
 			ret = tsk_object_ref(item->data);
-			goto bail;
+			break;
 		}
 	}
+	tsk_list_unlock(sessions);
 
-bail:
 	return ret;
 }
 
@@ -456,13 +600,17 @@ static tsk_object_t* _thttp_session_create(tsk_object_t * self, va_list * app)
 		session->challenges = tsk_list_create();
 		session->dialogs = tsk_list_create();
 		session->fd = TNET_INVALID_FD;
+		session->conn.pending = tsk_list_create();
+		session->buf = tsk_buffer_create_null();
 		
 		session->id = THTTP_SESSION_INVALID_ID;
 
 		/* add the session to the stack */
 		if(session->stack){
 			session->id = ++unique_id;
+			tsk_list_lock(session->stack->sessions);
 			tsk_list_push_back_data(session->stack->sessions, (void**)&session);
+			tsk_list_unlock(session->stack->sessions);
 		}
 	}
 
@@ -477,8 +625,13 @@ static tsk_object_t* thttp_session_destroy(tsk_object_t * self)
 
 		/* remove from the stack */
 		if(session->stack){
+			tsk_list_lock(session->stack->sessions);
 			tsk_list_remove_item_by_data(session->stack->sessions, session);
+			tsk_list_unlock(session->stack->sessions);
 		}
+
+		/* give back the connection to the pool (no-op if the pool is disabled) */
+		thttp_session_release_conn(session);
 		
 		TSK_OBJECT_SAFE_FREE(session->options);
 		TSK_OBJECT_SAFE_FREE(session->headers);
@@ -496,6 +649,12 @@ static tsk_object_t* thttp_session_destroy(tsk_object_t * self)
 			}
 		}
 
+		// connection
+		TSK_FREE(session->conn.host);
+		TSK_OBJECT_SAFE_FREE(session->conn.pending);
+		TSK_OBJECT_SAFE_FREE(session->buf);
+		TSK_OBJECT_SAFE_FREE(session->stream.message);
+
 		tsk_safeobj_deinit(session);
 	}
 	return self;
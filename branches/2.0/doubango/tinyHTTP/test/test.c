@@ -63,6 +63,7 @@ int main()
 
 #if RUN_TEST_AUTH || RUN_TEST_ALL
 		test_ws_auth();
+		test_ws_unmask();
 		test_basic_auth();
 		test_digest_auth();
 #endif
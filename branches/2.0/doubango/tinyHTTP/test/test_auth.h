@@ -87,6 +87,51 @@ void test_ws_auth()
 }
 
 
+#define TEST_WS_UNMASK_SIZE		(1 << 20) /* large WSS payload */
+#define TEST_WS_UNMASK_LOOPS	200
+
+/* Checks thttp_auth_ws_unmask() against a byte-wise loop (all alignments, in place or not) then measures both */
+void test_ws_unmask()
+{
+	static const uint8_t mask_key[4] = { 0x37, 0xfa, 0x21, 0x3d };
+	uint8_t *in = tsk_malloc(TEST_WS_UNMASK_SIZE + 8), *out = tsk_malloc(TEST_WS_UNMASK_SIZE + 8);
+	tsk_size_t i, off, size, errors = 0;
+	uint64_t start, loop;
+
+	for(i = 0; i < TEST_WS_UNMASK_SIZE + 8; ++i){
+		in[i] = (uint8_t)rand();
+	}
+	for(off = 0; off < 8; ++off){
+		for(size = 0; size < 64; ++size){
+			thttp_auth_ws_unmask(&out[(off * 3) & 7], &in[off], size, mask_key);
+			for(i = 0; i < size; ++i){
+				errors += (out[((off * 3) & 7) + i] != (in[off + i] ^ mask_key[i & 3]));
+			}
+			memcpy(out, in, 64 + 8);
+			thttp_auth_ws_unmask(&out[off], &out[off], size, mask_key);
+			thttp_auth_ws_unmask(&out[off], &out[off], size, mask_key);
+			errors += (memcmp(out, in, 64 + 8) != 0);
+		}
+	}
+	TSK_DEBUG_INFO("[WS_UNMASK] ==> %s", errors ? "NOK" : "OK");
+
+	start = tsk_time_now();
+	for(loop = 0; loop < TEST_WS_UNMASK_LOOPS; ++loop){
+		for(i = 0; i < TEST_WS_UNMASK_SIZE; ++i){
+			out[i] = (in[i + 1] ^ mask_key[i & 3]);
+		}
+	}
+	TSK_DEBUG_INFO("[WS_UNMASK] byte-wise: %llu ms for %d x %d bytes", (unsigned long long)(tsk_time_now() - start), TEST_WS_UNMASK_LOOPS, TEST_WS_UNMASK_SIZE);
+	start = tsk_time_now();
+	for(loop = 0; loop < TEST_WS_UNMASK_LOOPS; ++loop){
+		thttp_auth_ws_unmask(out, &in[1], TEST_WS_UNMASK_SIZE, mask_key);
+	}
+	TSK_DEBUG_INFO("[WS_UNMASK] thttp_auth_ws_unmask(): %llu ms for %d x %d bytes", (unsigned long long)(tsk_time_now() - start), TEST_WS_UNMASK_LOOPS, TEST_WS_UNMASK_SIZE);
+
+	TSK_FREE(in);
+	TSK_FREE(out);
+}
+
 
 //========================================================================
 
@@ -171,6 +171,8 @@ tmedia_codec_id_t;
 
 /**Max number of plugins (codec types) we can create */
 #define TMED_CODEC_MAX_PLUGINS			0xFF
+/** Maximum number of SDP templates (codecs part of the local offers) kept in cache. */
+#define TMED_CODEC_SDP_TEMPLATES_MAX	16
 
 /** cast any pointer to @ref tmedia_codec_t* object */
 #define TMEDIA_CODEC(self)		((tmedia_codec_t*)(self))
@@ -322,6 +324,7 @@ TINYMEDIA_API const struct tmedia_codec_plugin_def_s* tmedia_codec_plugin_regist
 TINYMEDIA_API int tmedia_codec_plugin_unregister(const tmedia_codec_plugin_def_t* plugin);
 TINYMEDIA_API int tmedia_codec_plugin_unregister_all();
 TINYMEDIA_API tmedia_codec_t* tmedia_codec_create(const char* format);
+TINYMEDIA_API tmedia_codec_t* tmedia_codec_create_2(const tmedia_codec_plugin_def_t* plugin);
 TINYMEDIA_API char* tmedia_codec_get_rtpmap(const tmedia_codec_t* self);
 TINYMEDIA_API tsk_bool_t tmedia_codec_sdp_att_match(const tmedia_codec_t* self, const char* att_name, const char* att_value);
 TINYMEDIA_API char* tmedia_codec_sdp_att_get(const tmedia_codec_t* self, const char* att_name);
@@ -136,6 +136,17 @@ TINYMEDIA_API int tmedia_defaults_set_ssl_certs(const char* priv_path, const cha
 TINYMEDIA_API int tmedia_defaults_get_ssl_certs(const char** priv_path, const char** pub_path, const char** ca_path, tsk_bool_t *verify);
 TINYMEDIA_API int tmedia_defaults_set_max_fds(int32_t max_fds);
 TINYMEDIA_API tsk_size_t tmedia_defaults_get_max_fds();
+TINYMEDIA_API int tmedia_defaults_set_video_enc_pipeline_enabled(tsk_bool_t enabled);
+TINYMEDIA_API tsk_bool_t tmedia_defaults_get_video_enc_pipeline_enabled();
+TINYMEDIA_API int tmedia_defaults_set_cpu_budget(int32_t cpu_budget);
+TINYMEDIA_API int32_t tmedia_defaults_get_cpu_budget();
+TINYMEDIA_API int tmedia_defaults_set_codec_threads_max(int32_t codec_threads_max);
+TINYMEDIA_API int32_t tmedia_defaults_get_codec_threads_max();
+TINYMEDIA_API int tmedia_defaults_set_cpu_affinity_enabled(tsk_bool_t enabled);
+TINYMEDIA_API tsk_bool_t tmedia_defaults_get_cpu_affinity_enabled();
+TINYMEDIA_API int tmedia_defaults_set_videojb_decode_pool_enabled(tsk_bool_t enabled);
+TINYMEDIA_API tsk_bool_t tmedia_defaults_get_videojb_decode_pool_enabled();
+TINYMEDIA_API uint64_t tmedia_defaults_get_generation();
 
 TMEDIA_END_DECLS
 
@@ -0,0 +1,42 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+* Copyright (C) 2015 Doubango Telecom.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tmedia_scheduler.h
+ * @brief Process-wide media scheduler: shares the CPU budget (see @ref tmedia_defaults_set_cpu_budget) between the codecs and the media threads.
+ */
+#ifndef TINYMEDIA_SCHEDULER_H
+#define TINYMEDIA_SCHEDULER_H
+
+#include "tinymedia_config.h"
+
+#include "tsk_common.h"
+
+TMEDIA_BEGIN_DECLS
+
+TINYMEDIA_API int32_t tmedia_scheduler_get_cpu_count();
+TINYMEDIA_API int32_t tmedia_scheduler_get_cpu_budget();
+TINYMEDIA_API int32_t tmedia_scheduler_codec_threads_acquire();
+TINYMEDIA_API int tmedia_scheduler_codec_threads_release(int32_t threads);
+TINYMEDIA_API int tmedia_scheduler_bind_current_thread();
+
+TMEDIA_END_DECLS
+
+#endif /* TINYMEDIA_SCHEDULER_H */
@@ -101,8 +101,14 @@ typedef struct tmedia_session_s
 	tmedia_type_t type;
 	//! list of codec ids used as filter on the enabled codecs
 	tmedia_codec_id_t codecs_allowed;
-	//! list of codecs managed by this session (enabled)
+	//! list of codecs managed by this session (enabled). Only the codecs already instantiated (see @ref codecs_enabled).
 	tmedia_codecs_L_t* codecs;
+	//! enabled codecs: the registered plugins are shared and immutable descriptors and the instances are only created when needed (e.g. matching a remote offer)
+	struct {
+		const struct tmedia_codec_plugin_def_s* plugin;
+		struct tmedia_codec_s* codec; // null until instantiated
+	} codecs_enabled[TMED_CODEC_MAX_PLUGINS];
+	tsk_size_t codecs_enabled_count;
 	//! negociated codec
 	tmedia_codecs_L_t* neg_codecs;
 	//! whether the ro have been prepared (up to the manager to update the value)
@@ -119,6 +125,11 @@ typedef struct tmedia_session_s
 	tmedia_qos_tline_t* qos;
 	//! bandwidth level
 	tmedia_bandwidth_level_t bl;
+	//! video flip (decoded and encoded frames), applied to the video codecs when they are created
+	struct {
+		tsk_bool_t in;
+		tsk_bool_t out;
+	} flip;
 	//! error callback function: not part of the plugin (likes .t140 or .rtcp) because it's not part of the API
 	struct{
 		tmedia_session_onerror_cb_f fun;
@@ -205,6 +216,7 @@ TINYMEDIA_API const tmedia_session_plugin_def_t* tmedia_session_plugin_find_by_m
 TINYMEDIA_API int tmedia_session_plugin_unregister(const tmedia_session_plugin_def_t* plugin);
 TINYMEDIA_API tmedia_session_t* tmedia_session_create(tmedia_type_t type);
 TINYMEDIA_API tmedia_codecs_L_t* tmedia_session_match_codec(tmedia_session_t* self, const tsdp_header_M_t* M);
+TINYMEDIA_API int tmedia_session_instantiate_codecs(tmedia_session_t* self);
 TINYMEDIA_API int tmedia_session_set_onrtcp_cbfn(tmedia_session_t* self, const void* usrdata, tmedia_session_rtcp_onevent_cb_f fun);
 TINYMEDIA_API int tmedia_session_send_rtcp_event(tmedia_session_t* self, tmedia_rtcp_event_type_t event_type, uint32_t ssrc_media);
 TINYMEDIA_API int tmedia_session_recv_rtcp_event(tmedia_session_t* self, tmedia_rtcp_event_type_t event_type, uint32_t ssrc_media);
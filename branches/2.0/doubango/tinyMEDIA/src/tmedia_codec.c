@@ -44,6 +44,20 @@
 /* pointer to all registered codecs */
 const tmedia_codec_plugin_def_t* __tmedia_codec_plugins[TMED_CODEC_MAX_PLUGINS] = {0};
 
+/* SDP templates: codecs part of the local offers (fmt, rtpmap, imageattr and fmtp) */
+typedef struct tmedia_codec_sdp_template_s
+{
+	TSK_DECLARE_OBJECT;
+
+	char* key;
+	tsdp_header_M_t* M; // only holds the formats and the attributes
+}
+tmedia_codec_sdp_template_t;
+static const tsk_object_def_t *tmedia_codec_sdp_template_def_t;
+static tsk_list_t* __tmedia_codec_sdp_templates = tsk_null; // created when the first plugin is registered
+
+static int _tmedia_codec_to_sdp(const tmedia_codecs_L_t* codecs, tsdp_header_M_t* m);
+
 
 /*== Predicate function to find a codec object by format */
 static int __pred_find_codec_by_format(const tsk_list_item_t *item, const void *format)
@@ -54,6 +68,53 @@ static int __pred_find_codec_by_format(const tsk_list_item_t *item, const void *
 	return -1;
 }
 
+/*== Predicate function to find a SDP template by key */
+static int __pred_find_sdp_template_by_key(const tsk_list_item_t *item, const void *key)
+{
+	if(item && item->data){
+		return tsk_strcmp(((const tmedia_codec_sdp_template_t *)item->data)->key, (const char*)key);
+	}
+	return -1;
+}
+
+/*== Predicate function to find a SDP template built using a plugin (each codec part of the key starts with "<plugin address>/", see @ref _tmedia_codec_sdp_template_key) */
+static int __pred_find_sdp_template_by_plugin(const tsk_list_item_t *item, const void *prefix)
+{
+	if(item && item->data){
+		const char* pos = ((const tmedia_codec_sdp_template_t *)item->data)->key;
+		tsk_size_t size = tsk_strlen((const char*)prefix);
+		while(pos && *pos){
+			if(!strncmp(pos, (const char*)prefix, size)){
+				return 0;
+			}
+			if((pos = strchr(pos, ';'))){
+				++pos;
+			}
+		}
+	}
+	return -1;
+}
+
+/* Drops the SDP templates built using a plugin and frees the list when no plugin is registered */
+static void _tmedia_codec_sdp_templates_remove(const tmedia_codec_plugin_def_t* plugin)
+{
+	if(!__tmedia_codec_sdp_templates){
+		return;
+	}
+	if(!__tmedia_codec_plugins[0]){
+		TSK_OBJECT_SAFE_FREE(__tmedia_codec_sdp_templates);
+		return;
+	}
+	if(plugin){
+		char* prefix = tsk_null;
+		tsk_sprintf(&prefix, "%p/", plugin);
+		tsk_list_lock(__tmedia_codec_sdp_templates);
+		while(tsk_list_remove_item_by_pred(__tmedia_codec_sdp_templates, __pred_find_sdp_template_by_plugin, prefix)) ;
+		tsk_list_unlock(__tmedia_codec_sdp_templates);
+		TSK_FREE(prefix);
+	}
+}
+
 /*== Predicate function to find a codec object by negociated format */
 static int __pred_find_codec_by_neg_format(const tsk_list_item_t *item, const void *format)
 {
@@ -247,6 +308,10 @@ int tmedia_codec_plugin_register(const tmedia_codec_plugin_def_t* plugin)
 		return -1;
 	}
 
+	if(!__tmedia_codec_sdp_templates){
+		__tmedia_codec_sdp_templates = tsk_list_create();
+	}
+
 	/* add or replace the plugin */
 	for(i = 0; i<TMED_CODEC_MAX_PLUGINS; i++){
 		if(!__tmedia_codec_plugins[i] || (__tmedia_codec_plugins[i] == plugin)){
@@ -274,6 +339,10 @@ int tmedia_codec_plugin_register_2(const tmedia_codec_plugin_def_t* plugin, int
 		return -1;
 	}
 	
+	if(!__tmedia_codec_sdp_templates){
+		__tmedia_codec_sdp_templates = tsk_list_create();
+	}
+
 	// count codecs and found if already registered
 	while(__tmedia_codec_plugins[count]){ 
 		if(__tmedia_codec_plugins[count] == plugin){
@@ -397,6 +466,7 @@ int tmedia_codec_plugin_unregister(const tmedia_codec_plugin_def_t* plugin)
 			}
 		}
 		__tmedia_codec_plugins[i] = tsk_null;
+		_tmedia_codec_sdp_templates_remove(plugin);
 	}
 	return (found ? 0 : -2);
 }
@@ -408,6 +478,7 @@ int tmedia_codec_plugin_unregister(const tmedia_codec_plugin_def_t* plugin)
 int tmedia_codec_plugin_unregister_all()
 {
 	memset((void*)__tmedia_codec_plugins, 0, sizeof(__tmedia_codec_plugins));
+	_tmedia_codec_sdp_templates_remove(tsk_null);
 	return 0;
 }
 
@@ -418,44 +489,62 @@ int tmedia_codec_plugin_unregister_all()
 */
 tmedia_codec_t* tmedia_codec_create(const char* format)
 {
-	tmedia_codec_t* codec = tsk_null;
 	const tmedia_codec_plugin_def_t* plugin;
 	tsk_size_t i = 0;
 
 	while((i < TMED_CODEC_MAX_PLUGINS) && (plugin = __tmedia_codec_plugins[i++])){
 		if(plugin->objdef && tsk_striequals(plugin->format, format)){
-			if((codec = tsk_object_new(plugin->objdef))){
-				/* initialize the newly created codec */
-				codec->id = plugin->codec_id;
-				codec->dyn = plugin->dyn;
-				codec->plugin = plugin;
-				codec->bl = tmedia_bl_medium;
-				switch(plugin->type){
-					case tmedia_audio:
-						{	/* Audio codec */
-							tmedia_codec_audio_t* audio = TMEDIA_CODEC_AUDIO(codec);
-							tmedia_codec_audio_init(TMEDIA_CODEC(audio), plugin->name, plugin->desc, plugin->format);
-							break;
-						}
-					case tmedia_video:
-						{ /* Video codec */
-							tmedia_codec_video_t* video = TMEDIA_CODEC_VIDEO(codec);
-							tmedia_codec_video_init(TMEDIA_CODEC(video), plugin->name, plugin->desc, plugin->format);
-							break;
-						}
-					case tmedia_msrp:
-						{	/* Msrp codec */
-							tmedia_codec_msrp_init(codec, plugin->name, plugin->desc);
-							break;
-						}
-					default:
-						{	/* Any other codec */
-							tmedia_codec_init(codec, plugin->type, plugin->name, plugin->desc, plugin->format);
-							break;
-						}
+			return tmedia_codec_create_2(plugin);
+		}
+	}
+
+	return tsk_null;
+}
+
+/**@ingroup tmedia_codec_group
+* Creates a new codec using a specific plugin. Unlike @ref tmedia_codec_create() this function doesn't use the format to find
+* the plugin which means it's possible to instantiate any of the plugins sharing the same format.
+* @param plugin The plugin (already registered or not) to use to create the codec.
+* @retval The newly created codec if succeed and Null otherwise.
+*/
+tmedia_codec_t* tmedia_codec_create_2(const tmedia_codec_plugin_def_t* plugin)
+{
+	tmedia_codec_t* codec;
+
+	if(!plugin || !plugin->objdef){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return tsk_null;
+	}
+
+	if((codec = tsk_object_new(plugin->objdef))){
+		/* initialize the newly created codec */
+		codec->id = plugin->codec_id;
+		codec->dyn = plugin->dyn;
+		codec->plugin = plugin;
+		codec->bl = tmedia_bl_medium;
+		switch(plugin->type){
+			case tmedia_audio:
+				{	/* Audio codec */
+					tmedia_codec_audio_t* audio = TMEDIA_CODEC_AUDIO(codec);
+					tmedia_codec_audio_init(TMEDIA_CODEC(audio), plugin->name, plugin->desc, plugin->format);
+					break;
+				}
+			case tmedia_video:
+				{ /* Video codec */
+					tmedia_codec_video_t* video = TMEDIA_CODEC_VIDEO(codec);
+					tmedia_codec_video_init(TMEDIA_CODEC(video), plugin->name, plugin->desc, plugin->format);
+					break;
+				}
+			case tmedia_msrp:
+				{	/* Msrp codec */
+					tmedia_codec_msrp_init(codec, plugin->name, plugin->desc);
+					break;
+				}
+			default:
+				{	/* Any other codec */
+					tmedia_codec_init(codec, plugin->type, plugin->name, plugin->desc, plugin->format);
+					break;
 				}
-				break;
-			}
 		}
 	}
 
@@ -578,14 +667,116 @@ again:
 	return 0;
 }
 
+/* Builds the key used to find the SDP template matching the codecs. The codecs part of the SDP only depends on the plugins, the bandwidth settings
+* and the default values (@ref tmedia_defaults_get_generation) as long as the codecs are not negotiated (or opened) yet.
+* Returns null if the codecs cannot use a template.
+*/
+static char* _tmedia_codec_sdp_template_key(const tmedia_codecs_L_t* codecs, const tsdp_header_M_t* m)
+{
+	const tsk_list_item_t* item;
+	const tmedia_codec_t* codec;
+	char* key = tsk_null;
+
+	if(!__tmedia_codec_sdp_templates || TSK_LIST_IS_EMPTY(codecs)){
+		return tsk_null;
+	}
+
+	tsk_list_foreach(item, codecs){
+		codec = (const tmedia_codec_t*)item->data;
+		if(!codec->plugin || codec->opened || codec->neg_format){
+			TSK_FREE(key);
+			return tsk_null;
+		}
+		tsk_strcat_2(&key, "%p/%d/%d/%d", codec->plugin, codec->bl, codec->bandwidth_max_upload, codec->bandwidth_max_download);
+		/* the attributes (e.g. imageattr, fmtp) also depend on the preferred sizes and ptimes */
+		if(codec->type & tmedia_video){
+			const tmedia_codec_video_t* video = (const tmedia_codec_video_t*)codec;
+			tsk_strcat_2(&key, "/%ux%ux%u/%ux%ux%u/%u/%u", video->in.width, video->in.height, video->in.fps, video->out.width, video->out.height, video->out.fps, video->out.max_br, video->out.max_mbps);
+		}
+		else if(codec->type & tmedia_audio){
+			const tmedia_codec_audio_t* audio = (const tmedia_codec_audio_t*)codec;
+			tsk_strcat_2(&key, "/%u/%d/%u/%d", audio->in.ptime, audio->in.channels, audio->out.ptime, audio->out.channels);
+		}
+		tsk_strcat(&key, ";");
+	}
+	tsk_strcat_2(&key, "%s/%llu", m->media, (unsigned long long)tmedia_defaults_get_generation());
+
+	return key;
+}
+
 /**@ingroup tmedia_codec_group
 * Serialize a list of codecs to sdp (m= line) message.<br>
-* Will add: fmt, rtpmap and fmtp.
+* Will add: fmt, rtpmap and fmtp.<br>
+* The formats and attributes generated for codecs not negotiated yet (e.g. initial offer) are cached and reused for the next offers with the same configuration.
 * @param codecs The list of codecs to convert
 * @param m The destination
 * @retval Zero if succeed and non-zero error code otherwise
 */
 int tmedia_codec_to_sdp(const tmedia_codecs_L_t* codecs, tsdp_header_M_t* m)
+{
+	const tsk_list_item_t* item;
+	tmedia_codec_sdp_template_t *tpl = tsk_null, *stored;
+	char* key;
+	int ret;
+
+	if(!m){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	if(!(key = _tmedia_codec_sdp_template_key(codecs, m))){
+		return _tmedia_codec_to_sdp(codecs, m);
+	}
+
+	tsk_list_lock(__tmedia_codec_sdp_templates);
+	tpl = tsk_object_ref((tsk_object_t*)tsk_list_find_object_by_pred(__tmedia_codec_sdp_templates, __pred_find_sdp_template_by_key, key));
+	tsk_list_unlock(__tmedia_codec_sdp_templates);
+
+	if(!tpl){
+		if(!(tpl = tsk_object_new(tmedia_codec_sdp_template_def_t)) || !(tpl->M = tsdp_header_M_create(m->media, 0, m->proto))){
+			TSK_DEBUG_ERROR("Failed to create SDP template");
+			TSK_OBJECT_SAFE_FREE(tpl);
+			TSK_FREE(key);
+			return _tmedia_codec_to_sdp(codecs, m);
+		}
+		if((ret = _tmedia_codec_to_sdp(codecs, tpl->M))){
+			TSK_OBJECT_SAFE_FREE(tpl);
+			TSK_FREE(key);
+			return ret;
+		}
+		tpl->key = key;
+		key = tsk_null;
+
+		tsk_list_lock(__tmedia_codec_sdp_templates);
+		if(tsk_list_count(__tmedia_codec_sdp_templates, tsk_null, tsk_null) >= TMED_CODEC_SDP_TEMPLATES_MAX){
+			tsk_list_item_t* oldest = tsk_list_pop_first_item(__tmedia_codec_sdp_templates);
+			TSK_OBJECT_SAFE_FREE(oldest);
+		}
+		stored = tsk_object_ref(tpl);
+		tsk_list_push_back_data(__tmedia_codec_sdp_templates, (void**)&stored);
+		tsk_list_unlock(__tmedia_codec_sdp_templates);
+	}
+	TSK_FREE(key);
+
+	/* copy the template: only the per-call fields (ports, ICE, crypto...) are added by the session */
+	tsk_list_foreach(item, tpl->M->FMTs){
+		if((ret = tsdp_header_M_add_fmt(m, ((const tsdp_fmt_t*)item->data)->value))){
+			goto bail;
+		}
+	}
+	tsk_list_foreach(item, tpl->M->Attributes){
+		const tsdp_header_A_t* A = (const tsdp_header_A_t*)item->data;
+		if((ret = tsdp_header_M_add_headers(m, TSDP_HEADER_A_VA_ARGS(A->field, A->value), tsk_null))){
+			goto bail;
+		}
+	}
+
+bail:
+	TSK_OBJECT_SAFE_FREE(tpl);
+	return ret;
+}
+
+static int _tmedia_codec_to_sdp(const tmedia_codecs_L_t* codecs, tsdp_header_M_t* m)
 {
 	const tsk_list_item_t* item;
 	const tmedia_codec_t* codec;
@@ -830,4 +1021,35 @@ float tmedia_codec_audio_get_timestamp_multiplier(tmedia_codec_id_t id, uint32_t
 				return 1;
 			}
 	}
-}
\ No newline at end of file
+}
+
+
+
+
+//=================================================================================================
+//	SDP template object definition
+//
+static tsk_object_t* tmedia_codec_sdp_template_ctor(tsk_object_t * self, va_list * app)
+{
+	tmedia_codec_sdp_template_t *tpl = self;
+	if(tpl){
+	}
+	return self;
+}
+static tsk_object_t* tmedia_codec_sdp_template_dtor(tsk_object_t * self)
+{
+	tmedia_codec_sdp_template_t *tpl = self;
+	if(tpl){
+		TSK_FREE(tpl->key);
+		TSK_OBJECT_SAFE_FREE(tpl->M);
+	}
+	return self;
+}
+static const tsk_object_def_t tmedia_codec_sdp_template_def_s =
+{
+	sizeof(tmedia_codec_sdp_template_t),
+	tmedia_codec_sdp_template_ctor,
+	tmedia_codec_sdp_template_dtor,
+	tsk_null,
+};
+static const tsk_object_def_t *tmedia_codec_sdp_template_def_t = &tmedia_codec_sdp_template_def_s;
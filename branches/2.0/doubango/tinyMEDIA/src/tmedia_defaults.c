@@ -89,6 +89,12 @@ static char* __ssl_certs_pub_path = tsk_null;
 static char* __ssl_certs_ca_path = tsk_null;
 static tsk_bool_t __ssl_certs_verify = tsk_false;
 static tsk_size_t __max_fds = 0; // Maximum number of FDs this process is allowed to open. Zero to disable.
+static tsk_bool_t __video_enc_pipeline_enabled = tsk_false; // Whether to encode the video frames on a dedicated thread instead of the producer's one (opt-in: one more thread and frame of latency per session)
+static int32_t __cpu_budget = 0; // Maximum number of processors used by the media engine. Zero to use all processors.
+static int32_t __codec_threads_max = 4; // Maximum number of threads per codec context (encoder or decoder)
+static tsk_bool_t __cpu_affinity_enabled = tsk_false; // Whether to bind the media threads to the processors in the budget
+static tsk_bool_t __videojb_decode_pool_enabled = tsk_false; // Whether the video jitter buffers decode on the shared pool instead of a thread per session
+static uint64_t __generation = 0; // Incremented each time a value used to build the codecs' SDP is set (invalidates the SDP templates)
 
 int tmedia_defaults_set_profile(tmedia_profile_t profile){
 	__profile = profile;
@@ -100,6 +106,7 @@ tmedia_profile_t tmedia_defaults_get_profile(){
 
 // @deprecated
 int tmedia_defaults_set_bl(tmedia_bandwidth_level_t bl){
+	++__generation;
 	__bl = bl;
 	return 0;
 }
@@ -117,6 +124,7 @@ tsk_bool_t tmedia_defaults_get_congestion_ctrl_enabled(){
 }
 
 int tmedia_defaults_set_video_fps(int32_t video_fps){
+	++__generation;
 	if(video_fps > 0 && video_fps <= 120){
 		__video_fps = video_fps;
 		return 0;
@@ -139,6 +147,7 @@ int32_t tmedia_defaults_get_video_motion_rank(){
 }
 
 int tmedia_defaults_set_bandwidth_video_upload_max(int32_t bw_video_up_max_kbps){
+	++__generation;
 	__bw_video_up_max_kbps = bw_video_up_max_kbps > 0 ? bw_video_up_max_kbps : INT_MAX;
 	return 0;
 }
@@ -147,6 +156,7 @@ int32_t tmedia_defaults_get_bandwidth_video_upload_max(){
 }
 
 int tmedia_defaults_set_bandwidth_video_download_max(int32_t bw_video_down_max_kbps){
+	++__generation;
 	__bw_video_down_max_kbps = bw_video_down_max_kbps > 0 ? bw_video_down_max_kbps : INT_MAX;
 	return 0;
 }
@@ -155,6 +165,7 @@ int32_t tmedia_defaults_get_bandwidth_video_download_max(){
 }
 
 int tmedia_defaults_set_pref_video_size(tmedia_pref_video_size_t pref_video_size){
+	++__generation;
 	__pref_video_size = pref_video_size;
 	return 0;
 }
@@ -263,6 +274,7 @@ tsk_bool_t tmedia_defaults_get_100rel_enabled(){
 }
 
 int tmedia_defaults_set_screen_size(int32_t sx, int32_t sy){
+	++__generation;
 	__sx = sx;
 	__sy = sy;
 	return 0;
@@ -277,6 +289,7 @@ int32_t tmedia_defaults_get_screen_y(){
 }
 
 int tmedia_defaults_set_audio_ptime(int32_t audio_ptime){
+	++__generation;
 	if(audio_ptime > 0){
 		__audio_ptime = audio_ptime;
 		return 0;
@@ -541,6 +554,7 @@ enum tmedia_mode_e tmedia_defaults_get_avpf_mode() {
 }
 
 int tmedia_defaults_set_opus_maxcapturerate(uint32_t opus_maxcapturerate){
+	++__generation;
 	switch(opus_maxcapturerate){
 		case 8000: case 12000: case 16000: case 24000: case 48000: __opus_maxcapturerate = opus_maxcapturerate; return 0;
 		default: TSK_DEBUG_ERROR("%u not valid for opus_maxcapturerate", opus_maxcapturerate); return -1;
@@ -551,6 +565,7 @@ uint32_t tmedia_defaults_get_opus_maxcapturerate(){
 }
 
 int tmedia_defaults_set_opus_maxplaybackrate(uint32_t opus_maxplaybackrate){
+	++__generation;
 	switch(opus_maxplaybackrate){
 		case 8000: case 12000: case 16000: case 24000: case 48000: __opus_maxplaybackrate = opus_maxplaybackrate; return 0;
 		default: TSK_DEBUG_ERROR("%u not valid for opus_maxplaybackrate", opus_maxplaybackrate); return -1;
@@ -585,3 +600,53 @@ int tmedia_defaults_set_max_fds(int32_t max_fds) {
 tsk_size_t tmedia_defaults_get_max_fds() {
 	return __max_fds;
 }
+
+int tmedia_defaults_set_video_enc_pipeline_enabled(tsk_bool_t enabled){
+	__video_enc_pipeline_enabled = enabled;
+	return 0;
+}
+tsk_bool_t tmedia_defaults_get_video_enc_pipeline_enabled(){
+	return __video_enc_pipeline_enabled;
+}
+
+int tmedia_defaults_set_cpu_budget(int32_t cpu_budget){
+	__cpu_budget = TSK_MAX(cpu_budget, 0);
+	return 0;
+}
+int32_t tmedia_defaults_get_cpu_budget(){
+	return __cpu_budget;
+}
+
+int tmedia_defaults_set_codec_threads_max(int32_t codec_threads_max){
+	if (codec_threads_max < 1) {
+		TSK_DEBUG_ERROR("%d not valid as maximum number of codec threads", codec_threads_max);
+		return -1;
+	}
+	__codec_threads_max = codec_threads_max;
+	return 0;
+}
+int32_t tmedia_defaults_get_codec_threads_max(){
+	return __codec_threads_max;
+}
+
+int tmedia_defaults_set_cpu_affinity_enabled(tsk_bool_t enabled){
+	__cpu_affinity_enabled = enabled;
+	return 0;
+}
+tsk_bool_t tmedia_defaults_get_cpu_affinity_enabled(){
+	return __cpu_affinity_enabled;
+}
+
+int tmedia_defaults_set_videojb_decode_pool_enabled(tsk_bool_t enabled){
+	__videojb_decode_pool_enabled = enabled;
+	return 0;
+}
+tsk_bool_t tmedia_defaults_get_videojb_decode_pool_enabled(){
+	return __videojb_decode_pool_enabled;
+}
+
+// Number of times a default value used by the codecs' SDP (sizes, fps, bandwidth, ptime...) was changed. Used to invalidate the SDP templates.
+// Not thread-safe but the value is only compared for equality.
+uint64_t tmedia_defaults_get_generation(){
+	return __generation;
+}
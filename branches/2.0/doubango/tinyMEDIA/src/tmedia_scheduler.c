@@ -0,0 +1,173 @@
+/*
+* Copyright (C) 2010-2015 Mamadou DIOP.
+* Copyright (C) 2015 Doubango Telecom.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tmedia_scheduler.c
+ * @brief Process-wide media scheduler: shares the CPU budget (see @ref tmedia_defaults_set_cpu_budget) between the codecs and the media threads.
+ * Each opened codec context (encoder or decoder) gets "budget / number of opened contexts" threads, clamped to [1, @ref tmedia_defaults_get_codec_threads_max()]
+ * and to the threads not granted yet: the sum never exceeds the budget, except that a context always gets at least one thread.
+ * The number of threads is computed when the codec is opened: the contexts already opened are not resized.
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#	define _GNU_SOURCE /* sched_setaffinity() */
+#endif
+
+#include "tinymedia/tmedia_scheduler.h"
+#include "tinymedia/tmedia_defaults.h"
+
+#include "tsk_mutex.h"
+#include "tsk_debug.h"
+
+#if TMEDIA_UNDER_WINDOWS
+#	include <windows.h>
+#elif defined(__linux__)
+#	include <sched.h>
+#	include <unistd.h>
+#else
+#	include <unistd.h>
+#endif
+
+static long __codec_contexts_count = 0; // number of codec contexts using threads from the budget
+static int32_t __codec_threads_granted = 0; // sum of the threads granted to the codec contexts
+static tsk_mutex_handle_t* __codec_threads_mutex = tsk_null;
+static long __bound_threads_count = 0; // number of threads bound to a core (used for round-robin)
+
+/** Gets the number of online processors.
+*/
+int32_t tmedia_scheduler_get_cpu_count()
+{
+	static int32_t __cpu_count = 0;
+	if(__cpu_count <= 0){
+#if TMEDIA_UNDER_WINDOWS
+		SYSTEM_INFO SystemInfo;
+#	if TMEDIA_UNDER_WINDOWS_RT
+		GetNativeSystemInfo(&SystemInfo);
+#	else
+		GetSystemInfo(&SystemInfo);
+#	endif
+		__cpu_count = (int32_t)SystemInfo.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+		__cpu_count = (int32_t)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+		if(__cpu_count <= 0){
+			__cpu_count = 1;
+		}
+	}
+	return __cpu_count;
+}
+
+/** Gets the number of processors the media engine is allowed to use.
+*/
+int32_t tmedia_scheduler_get_cpu_budget()
+{
+	int32_t budget = tmedia_defaults_get_cpu_budget();
+	int32_t cpu_count = tmedia_scheduler_get_cpu_count();
+	return (budget > 0 && budget < cpu_count) ? budget : cpu_count;
+}
+
+static tsk_mutex_handle_t* _tmedia_scheduler_codec_threads_mutex()
+{
+	if(!__codec_threads_mutex){
+		tsk_mutex_handle_t* mutex = tsk_mutex_create();
+		if(mutex && !tsk_atomic_cas_ptr(&__codec_threads_mutex, tsk_null, mutex)){
+			tsk_mutex_destroy(&mutex); // created by another thread
+		}
+	}
+	return __codec_threads_mutex;
+}
+
+/** Must be called when a codec context (encoder or decoder) supporting multi-threading is opened. @ref tmedia_scheduler_codec_threads_release must be called with the returned value when the context is closed.
+* @retval The number of threads the codec context should use.
+*/
+int32_t tmedia_scheduler_codec_threads_acquire()
+{
+	int32_t threads, threads_max = tmedia_defaults_get_codec_threads_max(), budget = tmedia_scheduler_get_cpu_budget();
+	tsk_mutex_handle_t* mutex = _tmedia_scheduler_codec_threads_mutex();
+	long count;
+
+	tsk_mutex_lock(mutex);
+	count = ++__codec_contexts_count;
+	threads = (int32_t)(budget / count);
+	threads = TSK_MIN(threads, (budget - __codec_threads_granted));
+	threads = TSK_CLAMP(1, threads, (threads_max > 0 ? threads_max : 1));
+	__codec_threads_granted += threads;
+	TSK_DEBUG_INFO("Codec threads = %d (contexts=%ld, granted=%d, budget=%d)", threads, count, __codec_threads_granted, budget);
+	tsk_mutex_unlock(mutex);
+	return threads;
+}
+
+/** Releases the threads acquired using @ref tmedia_scheduler_codec_threads_acquire.
+* @param threads The value returned by @ref tmedia_scheduler_codec_threads_acquire.
+*/
+int tmedia_scheduler_codec_threads_release(int32_t threads)
+{
+	tsk_mutex_handle_t* mutex = _tmedia_scheduler_codec_threads_mutex();
+	int ret = 0;
+
+	tsk_mutex_lock(mutex);
+	if(__codec_contexts_count <= 0 || threads <= 0 || threads > __codec_threads_granted){
+		TSK_DEBUG_ERROR("No codec threads to release");
+		ret = -1;
+	}
+	else{
+		--__codec_contexts_count;
+		__codec_threads_granted -= threads;
+	}
+	tsk_mutex_unlock(mutex);
+	return ret;
+}
+
+/** Binds the calling media thread to the next processor in the budget (round-robin), only if enabled using @ref tmedia_defaults_set_cpu_affinity_enabled.
+* @retval Zero if succeed (or disabled) and non-zero error code otherwise.
+*/
+int tmedia_scheduler_bind_current_thread()
+{
+	int32_t core;
+	long count;
+
+	if(!tmedia_defaults_get_cpu_affinity_enabled()){
+		return 0;
+	}
+
+	count = tsk_atomic_inc_fetch(&__bound_threads_count);
+	core = (int32_t)((count - 1) % tmedia_scheduler_get_cpu_budget());
+
+#if TMEDIA_UNDER_WINDOWS && !TMEDIA_UNDER_WINDOWS_RT
+	if(!SetThreadAffinityMask(GetCurrentThread(), ((DWORD_PTR)1 << core))){
+		TSK_DEBUG_ERROR("SetThreadAffinityMask(%d) failed", core);
+		return -2;
+	}
+#elif defined(__linux__) && defined(CPU_SET)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		if(sched_setaffinity(0, sizeof(set), &set) != 0){ // 0 = calling thread
+			TSK_DEBUG_ERROR("sched_setaffinity(%d) failed", core);
+			return -2;
+		}
+	}
+#else
+	TSK_DEBUG_WARN("Thread affinity not supported on this platform");
+	return 0;
+#endif
+	TSK_DEBUG_INFO("Media thread bound to core #%d", core);
+	return 0;
+}
@@ -64,6 +64,7 @@ const tsdp_message_t* _tmedia_session_mgr_get_lo(tmedia_session_mgr_t* self, tsk
 static int _tmedia_session_prepare(tmedia_session_t* self);
 static int _tmedia_session_set_ro(tmedia_session_t* self, const tsdp_header_M_t* m);
 static int _tmedia_session_load_codecs(tmedia_session_t* self);
+static tmedia_codec_t* _tmedia_session_get_codec_at(tmedia_session_t* self, tsk_size_t index);
 const char* tmedia_session_get_media(const tmedia_session_t* self);
 const tsdp_header_M_t* tmedia_session_get_lo(tmedia_session_t* self);
 int tmedia_session_set_ro(tmedia_session_t* self, const tsdp_header_M_t* m);
@@ -88,21 +89,10 @@ static int __pred_find_session_by_type(const tsk_list_item_t *item, const void *
 }
 
 /*== Predicate function to find codec object by format */
-static int __pred_find_codec_by_format(const tsk_list_item_t *item, const void *codec)
+static int __pred_find_codec_by_format(const tsk_list_item_t *item, const void *format)
 {
-	if (item && item->data && codec){
-		return tsk_stricmp(((const tmedia_codec_t*)item->data)->format, ((const tmedia_codec_t*)codec)->format);
-	}
-	return -1;
-}
-
-/*== Predicate function to find codec object by id */
-static int __pred_find_codec_by_id(const tsk_list_item_t *item, const void *id)
-{
-	if (item && item->data && id){
-		if (((const tmedia_codec_t*)item->data)->id == *((const tmedia_codec_id_t*)id)){
-			return 0;
-		}
+	if (item && item->data && format){
+		return tsk_stricmp(((const tmedia_codec_t*)item->data)->format, (const char*)format);
 	}
 	return -1;
 }
@@ -463,9 +453,11 @@ const tsdp_header_M_t* tmedia_session_get_lo(tmedia_session_t* self)
 tmedia_codecs_L_t* tmedia_session_match_codec(tmedia_session_t* self, const tsdp_header_M_t* M)
 {
 	const tmedia_codec_t *codec;
+	const tmedia_codec_plugin_def_t* plugin;
 	char *rtpmap = tsk_null, *fmtp = tsk_null, *image_attr = tsk_null, *name = tsk_null;
 	const tsdp_fmt_t* fmt;
-	const tsk_list_item_t *it1, *it2;
+	const tsk_list_item_t *it1;
+	tsk_size_t i;
 	tsk_bool_t found = tsk_false;
 	tmedia_codecs_L_t* matchingCodecs = tsk_null;
 
@@ -479,21 +471,22 @@ tmedia_codecs_L_t* tmedia_session_match_codec(tmedia_session_t* self, const tsdp
 	tsk_list_foreach(it1, M->FMTs){
 		fmt = it1->data;
 
-		/* foreach codec */
-		tsk_list_foreach(it2, self->codecs){
+		/* foreach codec: rtpmap and format are checked against the descriptor (plugin) which means the codec is only instantiated if it could match */
+		for (i = 0; i < self->codecs_enabled_count; ++i){
+			plugin = self->codecs_enabled[i].plugin;
 			/* 'tmedia_codec_id_none' is used for fake codecs (e.g. dtmf or msrp) and should not be filtered beacuse of backward compatibility*/
-			if (!(codec = it2->data) || !codec->plugin || !(codec->id == tmedia_codec_id_none || (codec->id & self->codecs_allowed))){
+			if (!(plugin->codec_id == tmedia_codec_id_none || (plugin->codec_id & self->codecs_allowed))){
 				continue;
 			}
 
 			// Guard to avoid matching a codec more than once
 			// For example, H.264 codecs without profiles (Jitsi, Tiscali PC client) to distinguish them could match more than once
-			if (matchingCodecs && tsk_list_find_object_by_pred(matchingCodecs, __pred_find_codec_by_format, codec)){
+			if (matchingCodecs && tsk_list_find_object_by_pred(matchingCodecs, __pred_find_codec_by_format, plugin->format)){
 				continue;
 			}
 
 			// Dyn. payload type
-			if (codec->dyn && (rtpmap = tsdp_header_M_get_rtpmap(M, fmt->value))){
+			if (plugin->dyn && (rtpmap = tsdp_header_M_get_rtpmap(M, fmt->value))){
 				int32_t rate, channels;
 				/* parse rtpmap */
 				if (tmedia_parse_rtpmap(rtpmap, &name, &rate, &channels)){
@@ -501,13 +494,13 @@ tmedia_codecs_L_t* tmedia_session_match_codec(tmedia_session_t* self, const tsdp
 				}
 
 				/* compare name and rate... what about channels? */
-				if (tsk_striequals(name, codec->name) && (!rate || !codec->plugin->rate || (codec->plugin->rate == rate))){
+				if (tsk_striequals(name, plugin->name) && (!rate || !plugin->rate || (plugin->rate == rate))){
 					goto compare_fmtp;
 				}
 			}
 			// Fixed payload type
 			else{
-				if (tsk_striequals(fmt->value, codec->format)){
+				if (tsk_striequals(fmt->value, plugin->format)){
 					goto compare_fmtp;
 				}
 			}
@@ -516,6 +509,9 @@ tmedia_codecs_L_t* tmedia_session_match_codec(tmedia_session_t* self, const tsdp
 			goto next;
 
 		compare_fmtp:
+			if (!(codec = _tmedia_session_get_codec_at(self, i))){
+				goto next;
+			}
 			if ((fmtp = tsdp_header_M_get_fmtp(M, fmt->value))){ /* remote have fmtp? */
 				if (tmedia_codec_sdp_att_match(codec, "fmtp", fmtp)){ /* fmtp matches? */
 					if (codec->type & tmedia_video) goto compare_imageattr;
@@ -628,6 +624,8 @@ int tmedia_session_set_bfcp_cbfn(tmedia_session_t* self, const void* usrdata, tm
 */
 int tmedia_session_deinit(tmedia_session_t* self)
 {
+	tsk_size_t i;
+
 	if (!self){
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return -1;
@@ -636,6 +634,10 @@ int tmedia_session_deinit(tmedia_session_t* self)
 	/* free codecs */
 	TSK_OBJECT_SAFE_FREE(self->codecs);
 	TSK_OBJECT_SAFE_FREE(self->neg_codecs);
+	for (i = 0; i < self->codecs_enabled_count; ++i){
+		TSK_OBJECT_SAFE_FREE(self->codecs_enabled[i].codec);
+	}
+	self->codecs_enabled_count = 0;
 
 	/* free lo, no and ro */
 	TSK_OBJECT_SAFE_FREE(self->M.lo);
@@ -683,29 +685,101 @@ int tmedia_session_t140_send_data(tmedia_session_t* self, enum tmedia_t140_data_
 	return -1;
 }
 
-/* internal function used to prepare a session */
-int _tmedia_session_load_codecs(tmedia_session_t* self)
+/* internal function: rebuilds the list of codecs using the instances already created (same order as the descriptors) */
+static int _tmedia_session_update_codecs(tmedia_session_t* self)
 {
-	tsk_size_t i = 0;
+	tsk_size_t i;
 	tmedia_codec_t* codec;
-	const tmedia_codec_plugin_def_t* plugin;
-	const tsk_list_item_t* item;
-	tmedia_type_t type;
+
+	if (!self->codecs && !(self->codecs = tsk_list_create())){
+		TSK_DEBUG_ERROR("Failed to create new list");
+		return -1;
+	}
+
+	tsk_list_lock(self->codecs);
+	tsk_list_clear_items(self->codecs);
+	for (i = 0; i < self->codecs_enabled_count; ++i){
+		if (self->codecs_enabled[i].codec && (codec = tsk_object_ref(self->codecs_enabled[i].codec))){
+			tsk_list_push_back_data(self->codecs, (void**)(&codec));
+		}
+	}
+	tsk_list_unlock(self->codecs);
+
+	return 0;
+}
+
+/* internal function: creates the codec associated to an enabled descriptor and applies the session's settings (set before the codec existed) */
+static tmedia_codec_t* _tmedia_session_create_codec_at(tmedia_session_t* self, tsk_size_t index)
+{
+	tmedia_codec_t* codec;
+	if (!(codec = tmedia_codec_create_2(self->codecs_enabled[index].plugin))){
+		TSK_DEBUG_ERROR("Failed to create codec with format='%s'", self->codecs_enabled[index].plugin->format);
+		return tsk_null;
+	}
+	codec->bl = self->bl;
+	if (codec->type & tmedia_video){
+		TMEDIA_CODEC_VIDEO(codec)->in.flip = self->flip.in;
+		TMEDIA_CODEC_VIDEO(codec)->out.flip = self->flip.out;
+	}
+	return (self->codecs_enabled[index].codec = codec);
+}
+
+/* internal function: gets the codec associated to an enabled descriptor and creates it if not already done */
+static tmedia_codec_t* _tmedia_session_get_codec_at(tmedia_session_t* self, tsk_size_t index)
+{
+	if (!self->codecs_enabled[index].codec){
+		if (!_tmedia_session_create_codec_at(self, index)){
+			return tsk_null;
+		}
+		_tmedia_session_update_codecs(self);
+	}
+	return self->codecs_enabled[index].codec;
+}
+
+/**@ingroup tmedia_session_group
+* Creates the enabled codecs not instantiated yet. The codecs are lazily created (e.g. when matching a remote offer) which means
+* this function must be called before using @a codecs as the list of all enabled codecs (e.g. to generate a local offer).
+* @param self the media session.
+* @retval Zero if succeed and non-zero error code otherwise.
+*/
+int tmedia_session_instantiate_codecs(tmedia_session_t* self)
+{
+	tsk_size_t i;
+	tsk_bool_t created = tsk_false;
 
 	if (!self){
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return -1;
 	}
 
-	if (!self->codecs && !(self->codecs = tsk_list_create())){
-		TSK_DEBUG_ERROR("Failed to create new list");
-		return -1;
+	for (i = 0; i < self->codecs_enabled_count; ++i){
+		if (!self->codecs_enabled[i].codec){
+			if (!_tmedia_session_create_codec_at(self, i)){
+				continue;
+			}
+			created = tsk_true;
+		}
 	}
 
-	tsk_list_lock(self->codecs);
+	return created ? _tmedia_session_update_codecs(self) : 0;
+}
 
-	/* remove old codecs */
-	tsk_list_clear_items(self->codecs);
+/* internal function used to prepare a session: only loads the descriptors, the codecs are instantiated on demand */
+int _tmedia_session_load_codecs(tmedia_session_t* self)
+{
+	tsk_size_t i = 0, j, k, count = 0;
+	tmedia_codec_t* codec;
+	const tmedia_codec_plugin_def_t* plugin;
+	const tmedia_codec_plugin_def_t* plugins[TMED_CODEC_MAX_PLUGINS];
+	tmedia_codec_t* codecs[TMED_CODEC_MAX_PLUGINS];
+	const tsk_list_item_t* item;
+	tmedia_type_t type;
+	tsk_bool_t enabled;
+
+	if (!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
 
 	type = self->type;
 	if ((type & tmedia_bfcp_video) == tmedia_bfcp_video) {
@@ -715,23 +789,44 @@ int _tmedia_session_load_codecs(tmedia_session_t* self)
 		type |= tmedia_audio;
 	}
 
-	/* for each registered plugin create a session instance */
+	/* for each registered plugin create a descriptor */
 	while ((i < TMED_CODEC_MAX_PLUGINS) && (plugin = __tmedia_codec_plugins[i++])){
 		/* 'tmedia_codec_id_none' is used for fake codecs (e.g. dtmf, bfcp or msrp) and should not be filtered beacuse of backward compatibility*/
-		if ((plugin->type & type) && (plugin->codec_id == tmedia_codec_id_none || (plugin->codec_id & self->codecs_allowed))){
+		if (plugin->objdef && (plugin->type & type) && (plugin->codec_id == tmedia_codec_id_none || (plugin->codec_id & self->codecs_allowed))){
 			// do not load bfcp codec for "audiobfcp" and "videobfcp" session
 			if ((plugin->type == tmedia_bfcp) && (type != tmedia_bfcp)) {
 				continue;
 			}
-			if ((codec = tmedia_codec_create(plugin->format))){
-				if (!self->codecs){
-					self->codecs = tsk_list_create();
+			/* reuse the codec if it was already instantiated (e.g. reINVITE) */
+			codec = tsk_null;
+			for (k = 0; k < self->codecs_enabled_count; ++k){
+				if (self->codecs_enabled[k].plugin == plugin && self->codecs_enabled[k].codec){
+					codec = self->codecs_enabled[k].codec;
+					self->codecs_enabled[k].codec = tsk_null;
+					break;
 				}
-				tsk_list_push_back_data(self->codecs, (void**)(&codec));
 			}
+			plugins[count] = plugin;
+			codecs[count++] = codec;
 		}
 	}
 
+	/* remove old codecs */
+	for (k = 0; k < self->codecs_enabled_count; ++k){
+		TSK_OBJECT_SAFE_FREE(self->codecs_enabled[k].codec);
+	}
+	for (k = 0; k < count; ++k){
+		self->codecs_enabled[k].plugin = plugins[k];
+		self->codecs_enabled[k].codec = codecs[k];
+	}
+	self->codecs_enabled_count = count;
+
+	if (_tmedia_session_update_codecs(self) != 0){
+		return -1;
+	}
+
+	tsk_list_lock(self->codecs);
+
 	// filter negotiated codecs with the newly loaded codecs
 	if (1){ // code valid for all use-cases but for now it's not fully tested and not needed for the clients
 	filter_neg_codecs:
@@ -739,7 +834,10 @@ int _tmedia_session_load_codecs(tmedia_session_t* self)
 			if (!(codec = (item->data))){
 				continue;
 			}
-			if (!(tsk_list_find_item_by_pred(self->codecs, __pred_find_codec_by_id, &codec->id))){
+			for (j = 0, enabled = tsk_false; j < self->codecs_enabled_count && !enabled; ++j){
+				enabled = (self->codecs_enabled[j].plugin->codec_id == codec->id);
+			}
+			if (!enabled){
 				const char* codec_name = codec->plugin ? codec->plugin->name : "unknown";
 				const char* neg_format = codec->neg_format ? codec->neg_format : codec->format;
 				TSK_DEBUG_INFO("Codec '%s' with format '%s' was negotiated but [supported codecs] updated without it -> removing", codec_name, neg_format);
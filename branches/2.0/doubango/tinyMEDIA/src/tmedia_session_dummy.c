@@ -120,6 +120,9 @@ const tsdp_header_M_t* tmedia_session_daudio_get_lo(tmedia_session_t* self)
 
 	if(changed){
 		/* from codecs to sdp */
+		if(!self->neg_codecs){
+			tmedia_session_instantiate_codecs(self);
+		}
 		tmedia_codec_to_sdp(self->neg_codecs ? self->neg_codecs : self->codecs, self->M.lo);
 		/* QoS */
 		if(self->qos){
@@ -236,6 +239,9 @@ const tsdp_header_M_t* tmedia_session_dvideo_get_lo(tmedia_session_t* self)
 
 	if(changed){
 		/* from codecs to sdp */
+		if(!self->neg_codecs){
+			tmedia_session_instantiate_codecs(self);
+		}
 		tmedia_codec_to_sdp(self->neg_codecs ? self->neg_codecs : self->codecs, self->M.lo);
 		/* QoS */
 		if(self->qos){
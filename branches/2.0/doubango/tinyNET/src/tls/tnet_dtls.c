@@ -30,9 +30,39 @@
 #include "tsk_string.h"
 #include "tsk_memory.h"
 #include "tsk_time.h"
+#include "tsk_list.h"
+#include "tsk_mutex.h"
+#include "tsk_semaphore.h"
+#include "tsk_thread.h"
 #include "tsk_safeobj.h"
 #include "tsk_debug.h"
 
+#if !defined(TNET_DTLS_WORKERS_MAX)
+#	define TNET_DTLS_WORKERS_MAX			8
+#endif
+#if !defined(TNET_DTLS_WORKERS_QUEUE_MAX)
+#	define TNET_DTLS_WORKERS_QUEUE_MAX		256 /* sockets waiting for a worker: above, the handshake is done inline */
+#endif
+#if !defined(TNET_DTLS_PENDING_MAX)
+#	define TNET_DTLS_PENDING_MAX			32 /* datagrams waiting for a worker, per socket: above, they are dropped (DTLS retransmits) */
+#endif
+
+//
+//	DTLS datagram waiting for a worker
+//
+typedef struct tnet_dtls_datagram_s
+{
+	TSK_DECLARE_OBJECT;
+
+	void* ptr;
+	tsk_size_t size;
+	uint64_t time; // queuing time (microseconds)
+}
+tnet_dtls_datagram_t;
+#if HAVE_OPENSSL && HAVE_OPENSSL_DTLS
+static const tsk_object_def_t *tnet_dtls_datagram_def_t;
+#endif
+
 typedef struct tnet_dtls_socket_s
 {
 	TSK_DECLARE_OBJECT;
@@ -72,10 +102,48 @@ typedef struct tnet_dtls_socket_s
 	BIO* wbio;
 #endif
 
+	struct {
+		tsk_list_t* datagrams; // "tnet_dtls_datagram_t" waiting for a worker, protected by the workers' mutex
+		tsk_size_t count;
+		tsk_bool_t scheduled; // whether the socket is in the workers' queue or being processed by a worker
+	} pending;
+
+	struct {
+		uint64_t start; // microseconds
+		tnet_dtls_socket_stats_t values;
+	} stats;
+
 	TSK_DECLARE_SAFEOBJ;
 }
 tnet_dtls_socket_t;
 
+//
+//	DTLS handshake workers: the handshake crypto (ECDHE, RSA...) runs here instead of the transport's thread
+//	The datagrams of a socket are processed in order by a single worker at a time.
+//
+static struct {
+	volatile tsk_bool_t started;
+	volatile tsk_bool_t running;
+	tsk_mutex_handle_t* mutex; /* created once and never destroyed: used by the network threads without holding a reference */
+	tsk_semaphore_handle_t* sem;
+	tsk_thread_handle_t* threads[TNET_DTLS_WORKERS_MAX];
+	tsk_size_t threads_count;
+	tnet_dtls_socket_t* queue[TNET_DTLS_WORKERS_QUEUE_MAX];
+	tsk_size_t queue_head;
+	tsk_size_t queue_count;
+} __workers;
+
+#if HAVE_OPENSSL && HAVE_OPENSSL_DTLS
+static int _tnet_dtls_socket_handle_incoming_data(tnet_dtls_socket_t* socket, const void* data, tsk_size_t size);
+
+static uint64_t _tnet_dtls_now_us()
+{
+	struct timeval tv;
+	tsk_gettimeofday(&tv, tsk_null);
+	return (((uint64_t)tv.tv_sec) * 1000000) + (uint64_t)tv.tv_usec;
+}
+#endif /* HAVE_OPENSSL && HAVE_OPENSSL_DTLS */
+
 #define _tnet_dtls_socket_do_handshake(self) tnet_dtls_socket_do_handshake(self, tsk_null)
 #define _tnet_dtls_socket_raise_event(self, type, data, size) ((self) && (self)->cb.func ? (self)->cb.func((self)->cb.usrdata, (type), (self), (data), (size)) : 0)
 #define _tnet_dtls_socket_raise_event_dataless(self, type) _tnet_dtls_socket_raise_event((self), (type), tsk_null, 0)
@@ -500,6 +568,10 @@ int tnet_dtls_socket_do_handshake(tnet_dtls_socket_handle_t* handle, const struc
 		goto bail;
 	}
 
+	if (!socket->stats.start) {
+		socket->stats.start = _tnet_dtls_now_us();
+	}
+
 	if (!socket->handshake_started) {
 		if ((ret = SSL_do_handshake(socket->ssl)) != 1) {
 			switch ((ret = SSL_get_error(socket->ssl, ret))) {
@@ -550,7 +622,10 @@ int tnet_dtls_socket_do_handshake(tnet_dtls_socket_handle_t* handle, const struc
 	BIO_reset(socket->wbio);
 
 	if ((socket->handshake_completed = SSL_is_init_finished(socket->ssl))) {
-		TSK_DEBUG_INFO("DTLS handshake completed");
+		socket->stats.values.handshake_duration = (_tnet_dtls_now_us() - socket->stats.start);
+		TSK_DEBUG_INFO("DTLS handshake completed in %llu us (processing = %llu us, queuing = %llu us, flights = %u)",
+			(unsigned long long)socket->stats.values.handshake_duration, (unsigned long long)socket->stats.values.processing_time,
+			(unsigned long long)socket->stats.values.queuing_time, (unsigned)socket->stats.values.flights);
 
 #if HAVE_OPENSSL_DTLS_SRTP
 		if (socket->use_srtp){
@@ -605,8 +680,219 @@ tsk_bool_t tnet_dtls_socket_is_handshake_completed(const tnet_dtls_socket_handle
 	return (handle && ((const tnet_dtls_socket_t *)handle)->handshake_completed);
 }
 
+/*
+Gets the handshake latency metrics.
+@param handle
+@param stats The metrics. All durations are in microseconds.
+@returns 0 if succeed, non-zero error code otherwise
+*/
+int tnet_dtls_socket_get_stats(const tnet_dtls_socket_handle_t* handle, tnet_dtls_socket_stats_t* stats)
+{
+	tnet_dtls_socket_t *socket = (tnet_dtls_socket_t *)handle;
+	if (!socket || !stats) {
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_safeobj_lock(socket);
+	*stats = socket->stats.values;
+	tsk_safeobj_unlock(socket);
+	return 0;
+}
+
+#if HAVE_OPENSSL && HAVE_OPENSSL_DTLS
+// queues the datagram for the workers. Returns 0 if queued (or dropped), 1 if it must be handled inline and negative code on error
+static int _tnet_dtls_workers_push(tnet_dtls_socket_t* socket, const void* data, tsk_size_t size)
+{
+	tnet_dtls_datagram_t* datagram;
+	int ret = 0;
+
+	tsk_mutex_lock(__workers.mutex);
+	if (!__workers.running) {
+		ret = 1;
+		goto bail;
+	}
+	if (!socket->pending.scheduled && __workers.queue_count >= TNET_DTLS_WORKERS_QUEUE_MAX) {
+		ret = 1; // no datagram pending for this socket and no worker on it: the order is kept
+		goto bail;
+	}
+	if (socket->pending.count >= TNET_DTLS_PENDING_MAX) {
+		TSK_DEBUG_WARN("Too many DTLS datagrams waiting for a worker: dropping %u bytes", (unsigned)size);
+		goto bail;
+	}
+	if (!(datagram = tsk_object_new(tnet_dtls_datagram_def_t)) || !(datagram->ptr = tsk_malloc(size))) {
+		TSK_OBJECT_SAFE_FREE(datagram);
+		ret = -3;
+		goto bail;
+	}
+	memcpy(datagram->ptr, data, size);
+	datagram->size = size;
+	datagram->time = _tnet_dtls_now_us();
+	tsk_list_push_back_data(socket->pending.datagrams, (void**)&datagram);
+	++socket->pending.count;
+	if (!socket->pending.scheduled) {
+		socket->pending.scheduled = tsk_true;
+		__workers.queue[(__workers.queue_head + __workers.queue_count) % TNET_DTLS_WORKERS_QUEUE_MAX] = tsk_object_ref(socket);
+		++__workers.queue_count;
+		tsk_semaphore_increment(__workers.sem);
+	}
+bail:
+	tsk_mutex_unlock(__workers.mutex);
+	return ret;
+}
+
+static void* TSK_STDCALL _tnet_dtls_workers_run(void* arg)
+{
+	tnet_dtls_socket_t* socket;
+	tnet_dtls_datagram_t* datagram;
+	tsk_list_item_t* item;
+
+	TSK_DEBUG_INFO("DTLS worker - enter");
+
+	for (;;) {
+		tsk_semaphore_decrement(__workers.sem);
+
+		tsk_mutex_lock(__workers.mutex);
+		if (!__workers.running) {
+			tsk_mutex_unlock(__workers.mutex);
+			break;
+		}
+		socket = tsk_null;
+		if (__workers.queue_count) {
+			socket = __workers.queue[__workers.queue_head];
+			__workers.queue[__workers.queue_head] = tsk_null;
+			__workers.queue_head = (__workers.queue_head + 1) % TNET_DTLS_WORKERS_QUEUE_MAX;
+			--__workers.queue_count;
+		}
+		tsk_mutex_unlock(__workers.mutex);
+
+		if (!socket) {
+			continue;
+		}
+		// process all datagrams received for this socket while it was waiting
+		for (;;) {
+			tsk_mutex_lock(__workers.mutex);
+			if (!(item = tsk_list_pop_first_item(socket->pending.datagrams))) {
+				socket->pending.scheduled = tsk_false;
+				tsk_mutex_unlock(__workers.mutex);
+				break;
+			}
+			--socket->pending.count;
+			tsk_mutex_unlock(__workers.mutex);
+
+			if ((datagram = (tnet_dtls_datagram_t*)item->data)) {
+				tsk_safeobj_lock(socket);
+				socket->stats.values.queuing_time += (_tnet_dtls_now_us() - datagram->time);
+				_tnet_dtls_socket_handle_incoming_data(socket, datagram->ptr, datagram->size);
+				tsk_safeobj_unlock(socket);
+			}
+			TSK_OBJECT_SAFE_FREE(item);
+		}
+		TSK_OBJECT_SAFE_FREE(socket);
+	}
+
+	TSK_DEBUG_INFO("DTLS worker - exit");
+	return tsk_null;
+}
+#endif /* HAVE_OPENSSL && HAVE_OPENSSL_DTLS */
+
+/*
+Starts the DTLS handshake workers. Incoming handshake data is then processed by a pool of "count" threads instead
+of the network thread which received it. The events are still posted to the transport.
+Must be called before creating the DTLS sockets (e.g. at startup).
+@param count The number of threads, up to TNET_DTLS_WORKERS_MAX.
+@returns 0 if succeed, non-zero error code otherwise
+*/
+int tnet_dtls_workers_start(tsk_size_t count)
+{
+#if !HAVE_OPENSSL || !HAVE_OPENSSL_DTLS
+	TSK_DEBUG_ERROR("OpenSSL or DTLS not enabled");
+	return -200;
+#else
+	tsk_size_t i;
+	if (__workers.started) {
+		return 0;
+	}
+	if (!count || count > TNET_DTLS_WORKERS_MAX) {
+		TSK_DEBUG_ERROR("%u not a valid number of DTLS workers", (unsigned)count);
+		return -1;
+	}
+	if (!__workers.mutex && !(__workers.mutex = tsk_mutex_create())) {
+		return -2;
+	}
+	if (!__workers.sem && !(__workers.sem = tsk_semaphore_create())) {
+		return -3;
+	}
+	__workers.running = tsk_true;
+	for (i = 0; i < count; ++i) {
+		if (tsk_thread_create(&__workers.threads[i], _tnet_dtls_workers_run, tsk_null) != 0) {
+			TSK_DEBUG_ERROR("Failed to create DTLS worker #%u", (unsigned)i);
+			break;
+		}
+		++__workers.threads_count;
+	}
+	__workers.started = (__workers.threads_count > 0);
+	if (!__workers.started) {
+		__workers.running = tsk_false;
+		return -4;
+	}
+	TSK_DEBUG_INFO("%u DTLS workers started", (unsigned)__workers.threads_count);
+	return 0;
+#endif
+}
+
+tsk_bool_t tnet_dtls_workers_is_started()
+{
+	return __workers.started;
+}
+
+/*
+Stops the DTLS handshake workers. The data not processed yet is dropped and the next handshakes are done inline.
+@returns 0 if succeed, non-zero error code otherwise
+*/
+int tnet_dtls_workers_stop()
+{
+	tsk_size_t i;
+	tnet_dtls_socket_t* socket;
+
+	if (!__workers.started) {
+		return 0;
+	}
+
+	tsk_mutex_lock(__workers.mutex);
+	__workers.started = tsk_false;
+	__workers.running = tsk_false;
+	tsk_mutex_unlock(__workers.mutex);
+
+	for (i = 0; i < __workers.threads_count; ++i) {
+		tsk_semaphore_increment(__workers.sem);
+	}
+	for (i = 0; i < __workers.threads_count; ++i) {
+		tsk_thread_join(&__workers.threads[i]);
+	}
+	__workers.threads_count = 0;
+
+	tsk_mutex_lock(__workers.mutex);
+	while (__workers.queue_count) {
+		socket = __workers.queue[__workers.queue_head];
+		__workers.queue[__workers.queue_head] = tsk_null;
+		__workers.queue_head = (__workers.queue_head + 1) % TNET_DTLS_WORKERS_QUEUE_MAX;
+		--__workers.queue_count;
+		if (socket) {
+			tsk_list_clear_items(socket->pending.datagrams);
+			socket->pending.count = 0;
+			socket->pending.scheduled = tsk_false;
+			TSK_OBJECT_SAFE_FREE(socket);
+		}
+	}
+	tsk_mutex_unlock(__workers.mutex);
+	// the semaphore could still be signaled: recreate it
+	tsk_semaphore_destroy(&__workers.sem);
+	return 0;
+}
+
 /*
 Handles DTLS data received over the network using standard functions (e.g. recvfrom())
+When the workers are started, the handshake data is queued and processed by a worker unless it has to be stored (TURN).
 @param handle
 @param data When "use_srtp" is enabled this must point to DTLS handshake data.
 @param size DTLS data size
@@ -619,14 +905,34 @@ int tnet_dtls_socket_handle_incoming_data(tnet_dtls_socket_handle_t* handle, con
 	return -200;
 #else
 	tnet_dtls_socket_t *socket = handle;
-	int ret = 0;
+	int ret;
 
 	if (!socket || !data || !size) {
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return -1;
 	}
 
+	// the stored handshaking data is read by the caller right after this function returns
+	// "handshake_completed" is read without locking the socket (a worker could hold it): once set, it's never cleared
+	if (__workers.started && !socket->handshake_completed && !socket->handshake_storedata) {
+		if ((ret = _tnet_dtls_workers_push(socket, data, size)) <= 0) {
+			return ret;
+		}
+	}
+
 	tsk_safeobj_lock(socket);
+	ret = _tnet_dtls_socket_handle_incoming_data(socket, data, size);
+	tsk_safeobj_unlock(socket);
+	return ret;
+#endif
+}
+
+#if HAVE_OPENSSL && HAVE_OPENSSL_DTLS
+// must be called with the socket locked
+static int _tnet_dtls_socket_handle_incoming_data(tnet_dtls_socket_t* socket, const void* data, tsk_size_t size)
+{
+	int ret = 0;
+	uint64_t start = _tnet_dtls_now_us();
 
 	TSK_DEBUG_INFO("Receive DTLS data: %lu", (unsigned long)size);
 
@@ -686,10 +992,11 @@ int tnet_dtls_socket_handle_incoming_data(tnet_dtls_socket_handle_t* handle, con
 	ret = _tnet_dtls_socket_do_handshake(socket);
 
 bail:
-	tsk_safeobj_unlock(socket);
+	socket->stats.values.processing_time += (_tnet_dtls_now_us() - start);
+	++socket->stats.values.flights;
 	return ret;
-#endif
 }
+#endif /* HAVE_OPENSSL && HAVE_OPENSSL_DTLS */
 
 
 //=================================================================================================
@@ -700,6 +1007,10 @@ static tsk_object_t* tnet_dtls_socket_ctor(tsk_object_t * self, va_list * app)
 	tnet_dtls_socket_t *socket = self;
 	if (socket){
 		tsk_safeobj_init(socket);
+		if (!(socket->pending.datagrams = tsk_list_create())) {
+			TSK_DEBUG_ERROR("Failed to create list");
+			return tsk_null;
+		}
 	}
 	return self;
 }
@@ -725,6 +1036,7 @@ static tsk_object_t* tnet_dtls_socket_dtor(tsk_object_t * self)
 		}
 #endif
 		TSK_FREE(socket->handshake_data.ptr);
+		TSK_OBJECT_SAFE_FREE(socket->pending.datagrams);
 		TSK_OBJECT_SAFE_FREE(socket->wrapped_sock);
 		tsk_safeobj_deinit(socket);
 
@@ -741,3 +1053,32 @@ static const tsk_object_def_t tnet_dtls_socket_def_s =
 	tsk_null,
 };
 const tsk_object_def_t *tnet_dtls_socket_def_t = &tnet_dtls_socket_def_s;
+
+
+#if HAVE_OPENSSL && HAVE_OPENSSL_DTLS
+//=================================================================================================
+//	DTLS datagram object definition
+//
+static tsk_object_t* tnet_dtls_datagram_ctor(tsk_object_t * self, va_list * app)
+{
+	return self;
+}
+
+static tsk_object_t* tnet_dtls_datagram_dtor(tsk_object_t * self)
+{
+	tnet_dtls_datagram_t *datagram = self;
+	if (datagram){
+		TSK_FREE(datagram->ptr);
+	}
+	return self;
+}
+
+static const tsk_object_def_t tnet_dtls_datagram_def_s =
+{
+	sizeof(tnet_dtls_datagram_t),
+	tnet_dtls_datagram_ctor,
+	tnet_dtls_datagram_dtor,
+	tsk_null,
+};
+static const tsk_object_def_t *tnet_dtls_datagram_def_t = &tnet_dtls_datagram_def_s;
+#endif /* HAVE_OPENSSL && HAVE_OPENSSL_DTLS */
@@ -48,11 +48,24 @@ tnet_dtls_socket_event_type_t;
 
 typedef int (*tnet_dtls_socket_cb_f)(const void* usrdata, tnet_dtls_socket_event_type_t e, const tnet_dtls_socket_handle_t* handle, const void* data, tsk_size_t size);
 
+/* handshake latency metrics, in microseconds */
+typedef struct tnet_dtls_socket_stats_s
+{
+	uint64_t handshake_duration; /* from the first flight to the completion, zero if not completed yet */
+	uint64_t processing_time; /* spent in the DTLS engine (crypto) handling the incoming flights */
+	uint64_t queuing_time; /* the incoming flights waited for a worker */
+	tsk_size_t flights; /* number of incoming datagrams handled */
+}
+tnet_dtls_socket_stats_t;
+
 TINYNET_API tsk_bool_t tnet_dtls_is_srtp_supported();
 TINYNET_API tsk_bool_t tnet_dtls_is_supported();
 TINYNET_API tnet_dtls_hash_type_t tnet_dtls_get_hash_from_string(const char* hash);
 TINYNET_API tnet_dtls_setup_t tnet_dtls_get_setup_from_string(const char* setup);
 TINYNET_API int tnet_dtls_get_fingerprint(const char* certfile, tnet_fingerprint_t* fingerprint, tnet_dtls_hash_type_t hash);
+TINYNET_API int tnet_dtls_workers_start(tsk_size_t count);
+TINYNET_API tsk_bool_t tnet_dtls_workers_is_started();
+TINYNET_API int tnet_dtls_workers_stop();
 TINYNET_API tnet_dtls_socket_handle_t* tnet_dtls_socket_create(struct tnet_socket_s* wrapped_sock, struct ssl_ctx_st* ssl_ctx);
 TINYNET_API tnet_fd_t tnet_dtls_socket_get_fd(const tnet_dtls_socket_handle_t* handle);
 TINYNET_API const struct sockaddr_storage* tnet_dtls_socket_get_remote_addr(const tnet_dtls_socket_handle_t* handle);
@@ -66,6 +79,7 @@ TINYNET_API tsk_bool_t tnet_dtls_socket_is_remote_cert_fp_match(tnet_dtls_socket
 TINYNET_API int tnet_dtls_socket_do_handshake(tnet_dtls_socket_handle_t* handle, const struct sockaddr_storage* remote_addr);
 TINYNET_API tsk_bool_t tnet_dtls_socket_is_handshake_completed(const tnet_dtls_socket_handle_t* handle);
 TINYNET_API int tnet_dtls_socket_handle_incoming_data(tnet_dtls_socket_handle_t* handle, const void* data, tsk_size_t size);
+TINYNET_API int tnet_dtls_socket_get_stats(const tnet_dtls_socket_handle_t* handle, tnet_dtls_socket_stats_t* stats);
 
 TINYNET_GEXTERN const tsk_object_def_t *tnet_dtls_socket_def_t;
 
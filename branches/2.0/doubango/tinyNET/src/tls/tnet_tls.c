@@ -30,10 +30,49 @@
 #include "tsk_memory.h"
 #include "tsk_debug.h"
 #include "tsk_safeobj.h"
+#include "tsk_time.h"
 
 #define TNET_TLS_TIMEOUT		2000
 #define TNET_TLS_RETRY_COUNT	10
 
+#if !defined(TNET_TLS_SESSIONS_MAX)
+#	define TNET_TLS_SESSIONS_MAX			64 /* client sessions (one per peer) */
+#endif
+#if !defined(TNET_TLS_SESSIONS_SERVER_MAX)
+#	define TNET_TLS_SESSIONS_SERVER_MAX		1024 /* server sessions (OpenSSL internal cache) */
+#endif
+#define TNET_TLS_SESSIONS_ID_CONTEXT		"doubango"
+
+/* Client session resumed when reconnecting to the same peer */
+typedef struct tnet_tls_session_s
+{
+	TSK_DECLARE_OBJECT;
+
+	char* peer;
+	uint64_t last_used;
+#if HAVE_OPENSSL
+	SSL_SESSION* session;
+#endif
+}
+tnet_tls_session_t;
+typedef tsk_list_t tnet_tls_sessions_L_t;
+#if HAVE_OPENSSL
+static const tsk_object_def_t *tnet_tls_session_def_t;
+#endif
+
+typedef struct tnet_tls_sessions_s
+{
+	TSK_DECLARE_OBJECT;
+
+	tnet_tls_sessions_L_t* list;
+	struct ssl_ctx_st* ctx_server; /* not owner */
+	uint64_t client_hits;
+	uint64_t client_misses;
+
+	TSK_DECLARE_SAFEOBJ;
+}
+tnet_tls_sessions_t;
+
 typedef struct tnet_tls_socket_s
 {
 	TSK_DECLARE_OBJECT;
@@ -43,6 +82,9 @@ typedef struct tnet_tls_socket_s
 #if HAVE_OPENSSL
 	SSL *ssl;
 #endif
+	tnet_tls_sessions_t* sessions; /* client only: where to resume/save the session */
+	char* peer;
+	tsk_bool_t handshake_done;
 
 	TSK_DECLARE_SAFEOBJ;
 }
@@ -80,11 +122,175 @@ tnet_tls_socket_handle_t* tnet_tls_socket_create(tnet_fd_t fd, struct ssl_ctx_st
 			TSK_OBJECT_SAFE_FREE(socket);
 			return tsk_null;
 		}
+		SSL_set_app_data(socket->ssl, socket); /* used by the sessions callbacks */
 	}
 	return socket;
 #endif
 }
 
+#if HAVE_OPENSSL
+static int _tnet_tls_sessions_pred_find_by_peer(const tsk_list_item_t *item, const void *peer)
+{
+	return tsk_strcmp(((const tnet_tls_session_t*)item->data)->peer, (const char*)peer);
+}
+
+/* Called by OpenSSL when the server sends a new session (or ticket). We take the reference when returning 1. */
+static int _tnet_tls_sessions_new_cb(SSL* ssl, SSL_SESSION* session)
+{
+	tnet_tls_socket_t* socket = (tnet_tls_socket_t*)SSL_get_app_data(ssl);
+	tnet_tls_session_t* entry;
+	if(!socket || !socket->sessions || !socket->peer){
+		return 0;
+	}
+	tsk_safeobj_lock(socket->sessions);
+	if(!(entry = (tnet_tls_session_t*)tsk_list_find_object_by_pred(socket->sessions->list, _tnet_tls_sessions_pred_find_by_peer, socket->peer))){
+		/* evict the least recently used peer */
+		if(tsk_list_count(socket->sessions->list, tsk_null, tsk_null) >= TNET_TLS_SESSIONS_MAX){
+			const tsk_list_item_t* item;
+			const tnet_tls_session_t* oldest = tsk_null;
+			tsk_list_foreach(item, socket->sessions->list){
+				if(!oldest || ((const tnet_tls_session_t*)item->data)->last_used < oldest->last_used){
+					oldest = (const tnet_tls_session_t*)item->data;
+				}
+			}
+			tsk_list_remove_item_by_data(socket->sessions->list, oldest);
+		}
+		if((entry = (tnet_tls_session_t*)tsk_object_new(tnet_tls_session_def_t))){
+			entry->peer = tsk_strdup(socket->peer);
+			tsk_list_push_back_data(socket->sessions->list, (void**)&entry);
+			entry = (tnet_tls_session_t*)tsk_list_find_object_by_pred(socket->sessions->list, _tnet_tls_sessions_pred_find_by_peer, socket->peer);
+		}
+	}
+	if(entry){
+		if(entry->session){
+			SSL_SESSION_free(entry->session);
+		}
+		entry->session = session;
+		entry->last_used = tsk_time_now();
+	}
+	tsk_safeobj_unlock(socket->sessions);
+	return entry ? 1 : 0;
+}
+
+static void _tnet_tls_sessions_info_cb(const SSL* ssl, int where, int ret)
+{
+	tnet_tls_socket_t* socket;
+	if((where & SSL_CB_HANDSHAKE_DONE) && (socket = (tnet_tls_socket_t*)SSL_get_app_data(ssl)) && socket->sessions && !socket->handshake_done){
+		socket->handshake_done = tsk_true;
+		tsk_safeobj_lock(socket->sessions);
+		if(SSL_session_reused((SSL*)ssl)){
+			++socket->sessions->client_hits;
+		}
+		else{
+			++socket->sessions->client_misses;
+		}
+		tsk_safeobj_unlock(socket->sessions);
+	}
+}
+#endif /* HAVE_OPENSSL */
+
+/**
+* Enables the session cache for both TLS contexts. Must be called before creating the sockets.
+* - client: sessions are saved per peer (see @ref tnet_tls_socket_set_session()) and resumed when reconnecting to the same peer (e.g. after a failover).
+* - server: OpenSSL internal session cache and session tickets.
+* @param ctx_client The client context. Could be null.
+* @param ctx_server The server context. Could be null.
+* @retval The session cache. Must not outlive the contexts.
+*/
+tnet_tls_sessions_t* tnet_tls_sessions_create(struct ssl_ctx_st* ctx_client, struct ssl_ctx_st* ctx_server)
+{
+#if !HAVE_OPENSSL
+	TSK_DEBUG_ERROR("OpenSSL not enabled");
+	return tsk_null;
+#else
+	tnet_tls_sessions_t* sessions;
+	if(!(sessions = (tnet_tls_sessions_t*)tsk_object_new(tnet_tls_sessions_def_t))){
+		TSK_DEBUG_ERROR("Failed to create TLS sessions cache");
+		return tsk_null;
+	}
+	if(ctx_client){
+		/* OpenSSL cannot index client sessions by peer: keep them ourself */
+		SSL_CTX_set_session_cache_mode(ctx_client, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(ctx_client, _tnet_tls_sessions_new_cb);
+	}
+	if((sessions->ctx_server = ctx_server)){
+		SSL_CTX_set_session_cache_mode(ctx_server, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_sess_set_cache_size(ctx_server, TNET_TLS_SESSIONS_SERVER_MAX);
+		/* required to resume sessions when the client certificates are verified */
+		SSL_CTX_set_session_id_context(ctx_server, (const unsigned char*)TNET_TLS_SESSIONS_ID_CONTEXT, (unsigned int)(sizeof(TNET_TLS_SESSIONS_ID_CONTEXT) - 1));
+		SSL_CTX_clear_options(ctx_server, SSL_OP_NO_TICKET);
+	}
+	return sessions;
+#endif
+}
+
+/**
+* Gets the number of resumed (hits) and full (misses) handshakes.
+*/
+int tnet_tls_sessions_get_stats(const tnet_tls_sessions_t* self, uint64_t* client_hits, uint64_t* client_misses, uint64_t* server_hits, uint64_t* server_misses)
+{
+#if !HAVE_OPENSSL
+	TSK_DEBUG_ERROR("OpenSSL not enabled");
+	return -200;
+#else
+	long hits = 0, good = 0;
+	if(!self){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(self->ctx_server){
+		hits = SSL_CTX_sess_hits(self->ctx_server);
+		good = SSL_CTX_sess_accept_good(self->ctx_server);
+	}
+	tsk_safeobj_lock(self);
+	if(client_hits) *client_hits = self->client_hits;
+	if(client_misses) *client_misses = self->client_misses;
+	tsk_safeobj_unlock(self);
+	if(server_hits) *server_hits = (uint64_t)hits;
+	if(server_misses) *server_misses = (uint64_t)((good > hits) ? (good - hits) : 0);
+	return 0;
+#endif
+}
+
+/**
+* Resumes the session from the last connection to the same @a peer (if any) and saves the new one. Client sockets only, must be called before connecting.
+* @param self The TLS socket.
+* @param sessions The session cache created using @ref tnet_tls_sessions_create().
+* @param peer The peer identifier (e.g. "host:port" where host is the FQDN/SNI or IP address).
+*/
+int tnet_tls_socket_set_session(tnet_tls_socket_handle_t* self, tnet_tls_sessions_t* sessions, const char* peer)
+{
+#if !HAVE_OPENSSL
+	TSK_DEBUG_ERROR("OpenSSL not enabled");
+	return -200;
+#else
+	tnet_tls_socket_t* socket = self;
+	const tnet_tls_session_t* entry;
+	if(!socket || !sessions || tsk_strnullORempty(peer)){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_safeobj_lock(socket);
+	TSK_OBJECT_SAFE_FREE(socket->sessions);
+	socket->sessions = (tnet_tls_sessions_t*)tsk_object_ref(sessions);
+	tsk_strupdate(&socket->peer, peer);
+	socket->handshake_done = tsk_false;
+	SSL_set_info_callback(socket->ssl, _tnet_tls_sessions_info_cb);
+
+	tsk_safeobj_lock(sessions);
+	if((entry = (const tnet_tls_session_t*)tsk_list_find_object_by_pred(sessions->list, _tnet_tls_sessions_pred_find_by_peer, peer)) && entry->session){
+		if(SSL_set_session(socket->ssl, entry->session) != 1){
+			TSK_DEBUG_WARN("SSL_set_session(%s) failed [%s]", peer, ERR_error_string(ERR_get_error(), tsk_null));
+		}
+		((tnet_tls_session_t*)entry)->last_used = tsk_time_now();
+	}
+	tsk_safeobj_unlock(sessions);
+
+	tsk_safeobj_unlock(socket);
+	return 0;
+#endif
+}
+
 int tnet_tls_socket_connect(tnet_tls_socket_handle_t* self)
 {
 #if !HAVE_OPENSSL
@@ -326,6 +532,8 @@ static tsk_object_t* tnet_tls_socket_dtor(tsk_object_t * self)
 			SSL_free(socket->ssl);
 		}
 #endif
+		TSK_OBJECT_SAFE_FREE(socket->sessions);
+		TSK_FREE(socket->peer);
 		tsk_safeobj_deinit(socket);
 	}
 	return self;
@@ -340,4 +548,72 @@ static const tsk_object_def_t tnet_tls_socket_def_s =
 };
 const tsk_object_def_t *tnet_tls_socket_def_t = &tnet_tls_socket_def_s;
 
+#if HAVE_OPENSSL
+//=================================================================================================
+//	TLS session object definition
+//
+static tsk_object_t* tnet_tls_session_ctor(tsk_object_t * self, va_list * app)
+{
+	tnet_tls_session_t *session = self;
+	if(session){
+	}
+	return self;
+}
+
+static tsk_object_t* tnet_tls_session_dtor(tsk_object_t * self)
+{ 
+	tnet_tls_session_t *session = self;
+	if(session){
+#if HAVE_OPENSSL
+		if(session->session){
+			SSL_SESSION_free(session->session);
+		}
+#endif
+		TSK_FREE(session->peer);
+	}
+	return self;
+}
+
+static const tsk_object_def_t tnet_tls_session_def_s = 
+{
+	sizeof(tnet_tls_session_t),
+	tnet_tls_session_ctor, 
+	tnet_tls_session_dtor,
+	tsk_null, 
+};
+static const tsk_object_def_t *tnet_tls_session_def_t = &tnet_tls_session_def_s;
+#endif /* HAVE_OPENSSL */
+
+//=================================================================================================
+//	TLS sessions cache object definition
+//
+static tsk_object_t* tnet_tls_sessions_ctor(tsk_object_t * self, va_list * app)
+{
+	tnet_tls_sessions_t *sessions = self;
+	if(sessions){
+		sessions->list = tsk_list_create();
+		tsk_safeobj_init(sessions);
+	}
+	return self;
+}
+
+static tsk_object_t* tnet_tls_sessions_dtor(tsk_object_t * self)
+{ 
+	tnet_tls_sessions_t *sessions = self;
+	if(sessions){
+		TSK_OBJECT_SAFE_FREE(sessions->list);
+		tsk_safeobj_deinit(sessions);
+	}
+	return self;
+}
+
+static const tsk_object_def_t tnet_tls_sessions_def_s = 
+{
+	sizeof(tnet_tls_sessions_t),
+	tnet_tls_sessions_ctor, 
+	tnet_tls_sessions_dtor,
+	tsk_null, 
+};
+const tsk_object_def_t *tnet_tls_sessions_def_t = &tnet_tls_sessions_def_s;
+
 
@@ -47,6 +47,7 @@ TNET_BEGIN_DECLS
 
 typedef void tnet_tls_socket_handle_t;
 struct ssl_ctx_st;
+struct tnet_tls_sessions_s;
 
 int tnet_tls_socket_connect(tnet_tls_socket_handle_t* self);
 int tnet_tls_socket_accept(tnet_tls_socket_handle_t* self);
@@ -56,8 +57,13 @@ int tnet_tls_socket_recv(tnet_tls_socket_handle_t* self, void** data, tsk_size_t
 
 TINYNET_API tsk_bool_t tnet_tls_is_supported();
 TINYNET_API tnet_tls_socket_handle_t* tnet_tls_socket_create(tnet_fd_t fd, struct ssl_ctx_st* ssl_ctx);
+TINYNET_API int tnet_tls_socket_set_session(tnet_tls_socket_handle_t* self, struct tnet_tls_sessions_s* sessions, const char* peer);
+
+TINYNET_API struct tnet_tls_sessions_s* tnet_tls_sessions_create(struct ssl_ctx_st* ctx_client, struct ssl_ctx_st* ctx_server);
+TINYNET_API int tnet_tls_sessions_get_stats(const struct tnet_tls_sessions_s* self, uint64_t* client_hits, uint64_t* client_misses, uint64_t* server_hits, uint64_t* server_misses);
 
 TINYNET_GEXTERN const tsk_object_def_t *tnet_tls_socket_def_t;
+TINYNET_GEXTERN const tsk_object_def_t *tnet_tls_sessions_def_t;
 
 TNET_END_DECLS
 
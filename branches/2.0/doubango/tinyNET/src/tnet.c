@@ -153,6 +153,8 @@ int tnet_cleanup()
 		goto bail;
 	}
 
+	tnet_dtls_workers_stop();
+
 #if TNET_UNDER_WINDOWS
 	__tnet_started = tsk_false;
 	return WSACleanup();
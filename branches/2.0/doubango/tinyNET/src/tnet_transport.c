@@ -88,6 +88,10 @@ static int _tnet_transport_ssl_init(tnet_transport_t* transport)
 				TSK_DEBUG_ERROR("SSL_CTX_set_cipher_list failed [%s]", ERR_error_string(ERR_get_error(), tsk_null));
 				return -4;
 			}
+			// sessions resumption: reconnecting to the same peer (e.g. after a failover) doesn't require a full handshake
+			if (!transport->tls.sessions && !(transport->tls.sessions = tnet_tls_sessions_create(transport->tls.ctx_client, transport->tls.ctx_server))){
+				TSK_DEBUG_WARN("Failed to create TLS sessions cache");
+			}
 		}
 #if HAVE_OPENSSL_DTLS
 		if ((transport->dtls.enabled = is_dtls)){
@@ -120,6 +124,7 @@ static int _tnet_transport_ssl_deinit(tnet_transport_t* transport)
 		return -1;
 	}
 #if HAVE_OPENSSL
+	TSK_OBJECT_SAFE_FREE(transport->tls.sessions);
 	if (transport->tls.ctx_client){
 		SSL_CTX_free(transport->tls.ctx_client);
 		transport->tls.ctx_client = tsk_null;
@@ -789,6 +794,12 @@ tnet_fd_t tnet_transport_connectto_3(const tnet_transport_handle_t *handle, stru
 		if (TNET_SOCKET_TYPE_IS_TLS(type) || TNET_SOCKET_TYPE_IS_WSS(type)) {
 #if HAVE_OPENSSL
 			tls_handle = tnet_tls_socket_create(fd, transport->tls.ctx_client);
+			if (tls_handle && transport->tls.sessions) {
+				char* peer = tsk_null;
+				tsk_sprintf(&peer, "%s:%u", host, port);
+				tnet_tls_socket_set_session(tls_handle, transport->tls.sessions, peer);
+				TSK_FREE(peer);
+			}
 			if (socket) {
 				TSK_OBJECT_SAFE_FREE(socket->tlshandle);
 				socket->tlshandle = tsk_object_ref(tls_handle);
@@ -150,6 +150,7 @@ typedef struct tnet_transport_s
 		tsk_bool_t verify; // whether to verify client/server certificate
 		struct ssl_ctx_st *ctx_client;
 		struct ssl_ctx_st *ctx_server;
+		struct tnet_tls_sessions_s *sessions; // client and server sessions cache (resumption)
 	}tls;
 
 	/* DTLS */
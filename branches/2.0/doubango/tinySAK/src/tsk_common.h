@@ -84,12 +84,34 @@ typedef unsigned int tsk_size_t;
 #if defined(__GNUC__) || (HAVE___SYNC_FETCH_AND_ADD && HAVE___SYNC_FETCH_AND_SUB)
 #	define tsk_atomic_inc(_ptr_) __sync_fetch_and_add((_ptr_), 1)
 #	define tsk_atomic_dec(_ptr_) __sync_fetch_and_sub((_ptr_), 1)
+#	define tsk_atomic_cas_ptr(_ptr_, _old_, _new_) __sync_bool_compare_and_swap((_ptr_), (_old_), (_new_))
 #elif defined(_MSC_VER)
 #	define tsk_atomic_inc(_ptr_) InterlockedIncrement((_ptr_))
 #	define tsk_atomic_dec(_ptr_) InterlockedDecrement((_ptr_))
+#	define tsk_atomic_cas_ptr(_ptr_, _old_, _new_) (InterlockedCompareExchangePointer((PVOID volatile*)(_ptr_), (PVOID)(_new_), (PVOID)(_old_)) == (PVOID)(_old_))
 #else
 #	define tsk_atomic_inc(_ptr_) ++(*(_ptr_))
 #	define tsk_atomic_dec(_ptr_) --(*(_ptr_))
+#	define tsk_atomic_cas_ptr(_ptr_, _old_, _new_) ((*(_ptr_) == (_old_)) ? ((*(_ptr_) = (_new_)), 1) : 0)
+#endif
+
+// Increment/decrement returning the new value (reference counting): increments are relaxed, decrements have acquire/release semantics
+#if defined(__ATOMIC_ACQ_REL)
+#	define tsk_atomic_load(_ptr_) __atomic_load_n((_ptr_), __ATOMIC_RELAXED)
+#	define tsk_atomic_inc_fetch(_ptr_) __atomic_add_fetch((_ptr_), 1, __ATOMIC_RELAXED)
+#	define tsk_atomic_dec_fetch(_ptr_) __atomic_sub_fetch((_ptr_), 1, __ATOMIC_ACQ_REL)
+#elif defined(__GNUC__) || (HAVE___SYNC_FETCH_AND_ADD && HAVE___SYNC_FETCH_AND_SUB)
+#	define tsk_atomic_load(_ptr_) (*(_ptr_)) /* volatile */
+#	define tsk_atomic_inc_fetch(_ptr_) __sync_add_and_fetch((_ptr_), 1)
+#	define tsk_atomic_dec_fetch(_ptr_) __sync_sub_and_fetch((_ptr_), 1)
+#elif defined(_MSC_VER)
+#	define tsk_atomic_load(_ptr_) (*(_ptr_)) /* volatile */
+#	define tsk_atomic_inc_fetch(_ptr_) InterlockedIncrement((_ptr_))
+#	define tsk_atomic_dec_fetch(_ptr_) InterlockedDecrement((_ptr_))
+#else
+#	define tsk_atomic_load(_ptr_) (*(_ptr_)) /* volatile */
+#	define tsk_atomic_inc_fetch(_ptr_) ++(*(_ptr_))
+#	define tsk_atomic_dec_fetch(_ptr_) --(*(_ptr_))
 #endif
 
 // Substract with saturation
@@ -21,6 +21,23 @@
  * @brief Utility functions for debugging purpose.
  */
 #include "tsk_debug.h"
+#include "tsk_memory.h"
+#include "tsk_thread.h"
+#include "tsk_mutex.h"
+#include "tsk_condwait.h"
+#include "tsk_time.h"
+
+#if TSK_UNDER_WINDOWS
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#endif
+#include <stdarg.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#	define vsnprintf	_vsnprintf
+#endif
 
 /**@defgroup tsk_debug_group Utility functions for debugging purpose.
 */
@@ -129,6 +146,321 @@ void tsk_debug_set_level(int level){
 	tsk_debug_level = level;
 }
 
+/* ============ Asynchronous output ============ */
+
+/* Maximum size of a message (longer messages are truncated) */
+#if !defined(TSK_DEBUG_ASYNC_RECORD_SIZE)
+#	define TSK_DEBUG_ASYNC_RECORD_SIZE		512
+#endif
+/* Number of records per thread. MUST be a power of 2. Sized for a burst of about a thousand messages between two flushes
+* (e.g. a SIP stack dumping its messages while a call is set up): about 520KB per thread that logs. */
+#if !defined(TSK_DEBUG_ASYNC_RECORDS_COUNT)
+#	define TSK_DEBUG_ASYNC_RECORDS_COUNT	1024
+#endif
+/* How often the background thread flushes the records (milliseconds) */
+#define TSK_DEBUG_ASYNC_FLUSH_INTERVAL		20
+
+#if defined(__GNUC__)
+#	define TSK_DEBUG_ASYNC_BARRIER()	__sync_synchronize()
+#elif defined(_MSC_VER)
+#	define TSK_DEBUG_ASYNC_BARRIER()	MemoryBarrier()
+#else
+#	define TSK_DEBUG_ASYNC_BARRIER()
+#endif
+
+typedef struct tsk_debug_async_record_s
+{
+	uint64_t time;
+	int level;
+	char text[TSK_DEBUG_ASYNC_RECORD_SIZE];
+}
+tsk_debug_async_record_t;
+
+/* Single producer (the thread owning the ring) / single consumer (the background thread) ring. No lock. */
+typedef struct tsk_debug_async_ring_s
+{
+	volatile uint32_t head; /* next record to write, only changed by the owner */
+	volatile uint32_t tail; /* next record to flush, only changed by the background thread */
+	volatile uint32_t dropped; /* INFO/WARN records dropped because the ring was full, only changed by the owner */
+	uint32_t dropped_reported;
+	volatile tsk_bool_t closed; /* the owner thread exited: the ring is freed once flushed */
+	struct tsk_debug_async_ring_s* next;
+	tsk_debug_async_record_t records[TSK_DEBUG_ASYNC_RECORDS_COUNT];
+}
+tsk_debug_async_ring_t;
+
+static volatile tsk_bool_t __async_started = tsk_false;
+static volatile tsk_bool_t __async_running = tsk_false;
+static tsk_bool_t __async_key_created = tsk_false;
+#if TSK_UNDER_WINDOWS
+static DWORD __async_key;
+#else
+static pthread_key_t __async_key;
+#endif
+static tsk_mutex_handle_t* __async_rings_mutex = tsk_null; /* only used to add/remove the rings (recursive: the callbacks could log) */
+static tsk_debug_async_ring_t* __async_rings = tsk_null;
+static uint64_t __async_dropped = 0;
+static tsk_thread_handle_t* __async_thread = tsk_null;
+static tsk_condwait_handle_t* __async_cond = tsk_null;
+
+static void _tsk_debug_async_flush();
+
+/* Called when a thread owning a ring exits */
+static void
+#if TSK_UNDER_WINDOWS
+WINAPI
+#endif
+_tsk_debug_async_ring_release(void* ring)
+{
+	if(ring){
+		TSK_DEBUG_ASYNC_BARRIER();
+		((tsk_debug_async_ring_t*)ring)->closed = tsk_true;
+		TSK_DEBUG_ASYNC_BARRIER(); /* read "__async_running" after closing the ring */
+		if(!__async_running){
+			/* no background thread to free the ring (exited after tsk_debug_async_stop()) */
+			_tsk_debug_async_flush();
+		}
+	}
+}
+
+static tsk_debug_async_ring_t* _tsk_debug_async_ring_get()
+{
+	tsk_debug_async_ring_t* ring;
+#if TSK_UNDER_WINDOWS
+	if((ring = (tsk_debug_async_ring_t*)FlsGetValue(__async_key))){
+		return ring;
+	}
+#else
+	if((ring = (tsk_debug_async_ring_t*)pthread_getspecific(__async_key))){
+		return ring;
+	}
+#endif
+	/* first message from this thread */
+	if(!(ring = (tsk_debug_async_ring_t*)tsk_calloc(1, sizeof(tsk_debug_async_ring_t)))){
+		return tsk_null;
+	}
+#if TSK_UNDER_WINDOWS
+	FlsSetValue(__async_key, ring);
+#else
+	pthread_setspecific(__async_key, ring);
+#endif
+	tsk_mutex_lock(__async_rings_mutex);
+	ring->next = __async_rings;
+	__async_rings = ring;
+	tsk_mutex_unlock(__async_rings_mutex);
+	return ring;
+}
+
+static void _tsk_debug_async_output(int level, const char* text)
+{
+	tsk_debug_f cb;
+	switch(level){
+		case DEBUG_LEVEL_INFO: cb = tsk_debug_info_cb; break;
+		case DEBUG_LEVEL_WARN: cb = tsk_debug_warn_cb; break;
+		case DEBUG_LEVEL_ERROR: cb = tsk_debug_error_cb; break;
+		default: cb = tsk_debug_fatal_cb; break;
+	}
+	if(cb){
+		cb(tsk_debug_arg_data, "%s", text);
+	}
+	else{
+		fputs(text, stderr);
+	}
+}
+
+/* Writes all pending records, oldest first (records from different threads are merged using their timestamps) */
+static void _tsk_debug_async_flush()
+{
+	tsk_debug_async_ring_t *ring, *oldest, **prev;
+	char drops[128];
+
+	tsk_mutex_lock(__async_rings_mutex);
+	for(;;){
+		oldest = tsk_null;
+		for(ring = __async_rings; ring; ring = ring->next){
+			if(ring->tail != ring->head && (!oldest || ring->records[ring->tail & (TSK_DEBUG_ASYNC_RECORDS_COUNT - 1)].time < oldest->records[oldest->tail & (TSK_DEBUG_ASYNC_RECORDS_COUNT - 1)].time)){
+				oldest = ring;
+			}
+		}
+		if(!oldest){
+			break;
+		}
+		TSK_DEBUG_ASYNC_BARRIER(); /* read the record after "head" */
+		_tsk_debug_async_output(oldest->records[oldest->tail & (TSK_DEBUG_ASYNC_RECORDS_COUNT - 1)].level, oldest->records[oldest->tail & (TSK_DEBUG_ASYNC_RECORDS_COUNT - 1)].text);
+		TSK_DEBUG_ASYNC_BARRIER(); /* release the record before moving "tail" */
+		++oldest->tail;
+	}
+	/* report the drops and free the rings of the exited threads */
+	prev = &__async_rings;
+	while((ring = *prev)){
+		uint32_t dropped = ring->dropped;
+		if(dropped != ring->dropped_reported){
+			__async_dropped += (dropped - ring->dropped_reported);
+			sprintf(drops, "**[DOUBANGO WARN]: %u log messages dropped (total=%llu)\n", (unsigned)(dropped - ring->dropped_reported), (unsigned long long)__async_dropped);
+			_tsk_debug_async_output(DEBUG_LEVEL_WARN, drops);
+			ring->dropped_reported = dropped;
+		}
+		if(ring->closed && ring->tail == ring->head){
+			*prev = ring->next;
+			tsk_free((void**)&ring);
+		}
+		else{
+			prev = &ring->next;
+		}
+	}
+	tsk_mutex_unlock(__async_rings_mutex);
+}
+
+static void* TSK_STDCALL _tsk_debug_async_run(void* arg)
+{
+	while(__async_running){
+		tsk_condwait_timedwait(__async_cond, TSK_DEBUG_ASYNC_FLUSH_INTERVAL);
+		_tsk_debug_async_flush();
+	}
+	_tsk_debug_async_flush();
+	return tsk_null;
+}
+
+/**@ingroup tsk_debug_group
+* Starts the asynchronous output. The messages are written into a per-thread ring (no lock, no I/O) and a background thread
+* writes them to <b>stderr</b> (or calls the callback functions) every few milliseconds. When a ring is full, the new INFO and WARN
+* messages are dropped and counted (see @ref tsk_debug_async_get_dropped()) while the ERROR and FATAL messages are written
+* synchronously by the calling thread. <br />
+* Should be called at startup, before creating the other threads. Not thread-safe.
+* @retval Zero if succeed and non-zero error code otherwise.
+* @sa @ref tsk_debug_async_stop()
+*/
+int tsk_debug_async_start()
+{
+	int ret;
+	if(__async_started){
+		return 0;
+	}
+	if(!__async_key_created){
+#if TSK_UNDER_WINDOWS
+		if((__async_key = FlsAlloc(_tsk_debug_async_ring_release)) == FLS_OUT_OF_INDEXES){
+			fprintf(stderr, "***[DOUBANGO ERROR]: FlsAlloc failed\n");
+			return -1;
+		}
+#else
+		if((ret = pthread_key_create(&__async_key, _tsk_debug_async_ring_release))){
+			fprintf(stderr, "***[DOUBANGO ERROR]: pthread_key_create failed with error code = %d\n", ret);
+			return -1;
+		}
+#endif
+		__async_key_created = tsk_true;
+	}
+	if(!__async_rings_mutex && !(__async_rings_mutex = tsk_mutex_create_2(tsk_true))){
+		return -2;
+	}
+	if(!__async_cond && !(__async_cond = tsk_condwait_create())){
+		return -3;
+	}
+	__async_running = tsk_true;
+	if((ret = tsk_thread_create(&__async_thread, _tsk_debug_async_run, tsk_null))){
+		__async_running = tsk_false;
+		return -4;
+	}
+	__async_started = tsk_true;
+	return 0;
+}
+
+/**@ingroup tsk_debug_group
+* Checks whether the asynchronous output is started.
+* @retval @ref tsk_true if started, @ref tsk_false otherwise.
+*/
+tsk_bool_t tsk_debug_async_is_started()
+{
+	return __async_started;
+}
+
+/**@ingroup tsk_debug_group
+* Writes a message into the calling thread's ring. Used by the @b TSK_DEBUG_* macros when the asynchronous output is started.
+* The message is formatted now (the arguments may not be valid later) but written by the background thread.
+* @param level The debug level of the message.
+* @param fmt The format, same as <a target=_blank href="http://www.cplusplus.com/reference/cstdio/printf/">printf</a>.
+* @retval Zero if succeed, 1 if the message was dropped (INFO and WARN only) and negative error code otherwise.
+*/
+int tsk_debug_async_print(int level, const char* fmt, ...)
+{
+	tsk_debug_async_ring_t* ring = tsk_null;
+	tsk_debug_async_record_t* record;
+	uint32_t count;
+	va_list ap;
+
+	if(!__async_started || !(ring = _tsk_debug_async_ring_get()) || ((count = (ring->head - ring->tail)) >= TSK_DEBUG_ASYNC_RECORDS_COUNT && level <= DEBUG_LEVEL_ERROR)){
+		/* fallback to the synchronous output (errors are never dropped, even if written before the pending records) */
+		char text[TSK_DEBUG_ASYNC_RECORD_SIZE];
+		va_start(ap, fmt);
+		vsnprintf(text, sizeof(text), fmt, ap);
+		va_end(ap);
+		text[sizeof(text) - 1] = '\0';
+		_tsk_debug_async_output(level, text);
+		return (__async_started && ring) ? 0 : -1;
+	}
+	if(count >= TSK_DEBUG_ASYNC_RECORDS_COUNT){
+		++ring->dropped;
+		return 1;
+	}
+	record = &ring->records[ring->head & (TSK_DEBUG_ASYNC_RECORDS_COUNT - 1)];
+	record->time = tsk_time_now();
+	record->level = level;
+	va_start(ap, fmt);
+	vsnprintf(record->text, sizeof(record->text), fmt, ap);
+	va_end(ap);
+	record->text[sizeof(record->text) - 1] = '\0';
+	TSK_DEBUG_ASYNC_BARRIER(); /* publish the record before moving "head" */
+	++ring->head;
+	TSK_DEBUG_ASYNC_BARRIER(); /* read "__async_started" after moving "head" */
+	if(!__async_started){
+		/* stopped while writing the record: the final flush could have missed it */
+		_tsk_debug_async_flush();
+	}
+	else if(level <= DEBUG_LEVEL_FATAL || count == (TSK_DEBUG_ASYNC_RECORDS_COUNT >> 1)){
+		/* the application is probably about to crash or the ring is filling up: flush now */
+		tsk_condwait_signal(__async_cond);
+	}
+	return 0;
+}
+
+/**@ingroup tsk_debug_group
+* Gets the total number of messages dropped because a ring was full. The drops are also reported in the output.
+* @retval The number of dropped messages.
+*/
+uint64_t tsk_debug_async_get_dropped()
+{
+	uint64_t dropped;
+	if(!__async_rings_mutex){
+		return 0;
+	}
+	tsk_mutex_lock(__async_rings_mutex);
+	dropped = __async_dropped;
+	tsk_mutex_unlock(__async_rings_mutex);
+	return dropped;
+}
+
+/**@ingroup tsk_debug_group
+* Stops the asynchronous output. All pending messages are written before returning. Not thread-safe. <br />
+* The other threads could still be logging: a message written while stopping is output by the writing thread and the ring of a thread
+* exiting after the stop is freed by this thread.
+* @retval Zero if succeed and non-zero error code otherwise.
+* @sa @ref tsk_debug_async_start()
+*/
+int tsk_debug_async_stop()
+{
+	if(!__async_started){
+		return 0;
+	}
+	__async_started = tsk_false; /* new messages use the synchronous output */
+	__async_running = tsk_false;
+	TSK_DEBUG_ASYNC_BARRIER(); /* read "head" and "closed" after the flags are cleared (see tsk_debug_async_print() and _tsk_debug_async_ring_release()) */
+	tsk_condwait_signal(__async_cond);
+	tsk_thread_join(&__async_thread);
+	/* the records published after the thread's last flush and the rings closed since */
+	_tsk_debug_async_flush();
+	return 0;
+}
+
 #endif /* TSK_HAVE_DEBUG_H */
 
 
@@ -138,6 +470,7 @@ void tsk_debug_set_level(int level){
 *  - @ref _Anchor_TinySAK_Debugging_StdErr "stderr"
 *  - @ref _Anchor_TinySAK_Debugging_Callback_Functions "Callback functions"
 *  - @ref _Anchor_TinySAK_Debugging_Custom_Debug_Header "Custom debug header"
+*  - @ref _Anchor_TinySAK_Debugging_Async "Asynchronous output"
 * - @ref _Anchor_TinySAK_Debugging_Public_Fuctions "Public functions"
 *
 * <hr />
@@ -202,7 +535,17 @@ tsk_debug_set_info_cb(_debug_info_write_to_file);
 * - must contain your own definitions of  @ref TSK_DEBUG_INFO(), @ref TSK_DEBUG_WARN(), @ref TSK_DEBUG_ERROR() and @ref TSK_DEBUG_FATAL().
 * - and you must add <i>-DTSK_HAVE_DEBUG_H=1</i> in your <i>CFLAGS</i> before building @a tinySAK project.
 * 
+* <h3>@anchor _Anchor_TinySAK_Debugging_Async Asynchronous output</h3>
+* By default the messages are written (or the callback functions called) by the thread calling the macro which means a slow output (e.g. a console or pipe) could slow down the network and media threads. <br />
+* After @ref tsk_debug_async_start(), the macros only format the message into a ring owned by the calling thread and a background thread writes it. The rings are lock-free and have a fixed size: when a thread logs faster than the output then, the new messages are dropped, counted and the drops reported in the output. <br />
+* @ref DEBUG_LEVEL_COMPILED could be used to remove the most verbose messages at build time.
+* 
 * <h2>@anchor _Anchor_TinySAK_Debugging_Public_Fuctions Public functions </h2>
+* - @ref tsk_debug_async_get_dropped
+* - @ref tsk_debug_async_is_started
+* - @ref tsk_debug_async_print
+* - @ref tsk_debug_async_start
+* - @ref tsk_debug_async_stop
 * - @ref tsk_debug_get_arg_data
 * - @ref tsk_debug_get_error_cb
 * - @ref tsk_debug_get_fatal_cb
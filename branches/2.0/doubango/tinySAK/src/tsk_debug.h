@@ -32,6 +32,9 @@ TSK_BEGIN_DECLS
 #if !defined(DEBUG_LEVEL)
 #	define DEBUG_LEVEL DEBUG_LEVEL_ERROR
 #endif
+#if !defined(DEBUG_LEVEL_COMPILED)
+#	define DEBUG_LEVEL_COMPILED DEBUG_LEVEL_INFO
+#endif
 
 /**@ingroup tsk_debug_group
 * @def DEBUG_LEVEL
@@ -40,6 +43,11 @@ TSK_BEGIN_DECLS
 * At runtime, this value could be changed using @ref tsk_debug_set_level().
 */
 /**@ingroup tsk_debug_group
+* @def DEBUG_LEVEL_COMPILED
+* Defines the most verbose level compiled in. The messages above this level are removed at build time and cannot be enabled using @ref tsk_debug_set_level(). <br />
+* Default value is @ref DEBUG_LEVEL_INFO (all messages compiled in). Example: <i>CFLAGS=$CFLAGS -DDEBUG_LEVEL_COMPILED=DEBUG_LEVEL_WARN</i> removes all @ref TSK_DEBUG_INFO() calls.
+*/
+/**@ingroup tsk_debug_group
 * @def DEBUG_LEVEL_INFO
 * @a INFO level (4). This is the lowest possible level and will turn on all logging.
 */
@@ -107,8 +115,10 @@ TSK_BEGIN_DECLS
 
 	/* INFO */
 #define TSK_DEBUG_INFO(FMT, ...)		\
-	if(tsk_debug_get_level() >= DEBUG_LEVEL_INFO){ \
-		if(tsk_debug_get_info_cb()) \
+	if(DEBUG_LEVEL_COMPILED >= DEBUG_LEVEL_INFO && tsk_debug_get_level() >= DEBUG_LEVEL_INFO){ \
+		if(tsk_debug_async_is_started()) \
+			tsk_debug_async_print(DEBUG_LEVEL_INFO, "*[DOUBANGO INFO]: " FMT "\n", ##__VA_ARGS__); \
+		else if(tsk_debug_get_info_cb()) \
 			tsk_debug_get_info_cb()(tsk_debug_get_arg_data(), "*[DOUBANGO INFO]: " FMT "\n", ##__VA_ARGS__); \
 		else \
 			fprintf(stderr, "*[DOUBANGO INFO]: " FMT "\n", ##__VA_ARGS__); \
@@ -117,8 +127,10 @@ TSK_BEGIN_DECLS
 
 	/* WARN */
 #define TSK_DEBUG_WARN(FMT, ...)		\
-	if(tsk_debug_get_level() >= DEBUG_LEVEL_WARN){ \
-		if(tsk_debug_get_warn_cb()) \
+	if(DEBUG_LEVEL_COMPILED >= DEBUG_LEVEL_WARN && tsk_debug_get_level() >= DEBUG_LEVEL_WARN){ \
+		if(tsk_debug_async_is_started()) \
+			tsk_debug_async_print(DEBUG_LEVEL_WARN, "**[DOUBANGO WARN]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
+		else if(tsk_debug_get_warn_cb()) \
 			tsk_debug_get_warn_cb()(tsk_debug_get_arg_data(), "**[DOUBANGO WARN]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
 		else \
 			fprintf(stderr, "**[DOUBANGO WARN]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
@@ -126,8 +138,10 @@ TSK_BEGIN_DECLS
 
 	/* ERROR */
 #define TSK_DEBUG_ERROR(FMT, ...) 		\
-	if(tsk_debug_get_level() >= DEBUG_LEVEL_ERROR){ \
-		if(tsk_debug_get_error_cb()) \
+	if(DEBUG_LEVEL_COMPILED >= DEBUG_LEVEL_ERROR && tsk_debug_get_level() >= DEBUG_LEVEL_ERROR){ \
+		if(tsk_debug_async_is_started()) \
+			tsk_debug_async_print(DEBUG_LEVEL_ERROR, "***[DOUBANGO ERROR]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
+		else if(tsk_debug_get_error_cb()) \
 			tsk_debug_get_error_cb()(tsk_debug_get_arg_data(), "***[DOUBANGO ERROR]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
 		else \
 			fprintf(stderr, "***[DOUBANGO ERROR]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
@@ -136,8 +150,10 @@ TSK_BEGIN_DECLS
 
 	/* FATAL */
 #define TSK_DEBUG_FATAL(FMT, ...) 		\
-	if(tsk_debug_get_level() >= DEBUG_LEVEL_FATAL){ \
-		if(tsk_debug_get_fatal_cb()) \
+	if(DEBUG_LEVEL_COMPILED >= DEBUG_LEVEL_FATAL && tsk_debug_get_level() >= DEBUG_LEVEL_FATAL){ \
+		if(tsk_debug_async_is_started()) \
+			tsk_debug_async_print(DEBUG_LEVEL_FATAL, "****[DOUBANGO FATAL]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
+		else if(tsk_debug_get_fatal_cb()) \
 			tsk_debug_get_fatal_cb()(tsk_debug_get_arg_data(), "****[DOUBANGO FATAL]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
 		else \
 			fprintf(stderr, "****[DOUBANGO FATAL]: function: \"%s()\" \nfile: \"%s\" \nline: \"%u\" \nMSG: " FMT "\n", __FUNCTION__,  __FILE__, __LINE__, ##__VA_ARGS__); \
@@ -157,6 +173,12 @@ TINYSAK_API tsk_debug_f tsk_debug_get_fatal_cb( );
 TINYSAK_API int tsk_debug_get_level( );
 TINYSAK_API void tsk_debug_set_level(int );
 
+TINYSAK_API int tsk_debug_async_start();
+TINYSAK_API tsk_bool_t tsk_debug_async_is_started();
+TINYSAK_API int tsk_debug_async_print(int level, const char* fmt, ...);
+TINYSAK_API uint64_t tsk_debug_async_get_dropped();
+TINYSAK_API int tsk_debug_async_stop();
+
 #endif /* TSK_HAVE_DEBUG_H */
 
 
@@ -35,6 +35,36 @@
 /**@defgroup tsk_fsm_group Finite-state machine (FSM) implementation.
 */
 
+/* Maximum state/action id (exclusive) usable as index in the shared tables. Tables with larger or
+* negative ids (other than the wildcards) are not indexed and the entries are scanned in order. */
+#define TSK_FSM_TABLE_INDEX_MAX		0xFF
+
+/* "from" states matching any current state */
+#define TSK_FSM_STATE_IS_WILDCARD(state) ((state) == tsk_fsm_state_any || (state) == tsk_fsm_state_current)
+
+struct tsk_fsm_table_s
+{
+	TSK_DECLARE_OBJECT;
+
+	tsk_fsm_entries_L_t* entries; /* owns the entries */
+	const tsk_fsm_entry_t** array; /* "entries" as an array, same order (the first matching entry wins) */
+	tsk_size_t count;
+
+	tsk_bool_t indexed;
+	tsk_fsm_state_id states_count; /* states in [0, states_count) have their own row, "states_count" is the row for all others */
+	tsk_fsm_action_id actions_count; /* same as "states_count" but for the actions */
+	uint16_t* buckets; /* (states_count + 1) * (actions_count + 1) + 1 offsets into "index" */
+	uint16_t* index; /* positions in "array" of the entries which could match (state, action), in order */
+};
+
+static tsk_bool_t _tsk_fsm_entry_match(const tsk_fsm_entry_t* entry, tsk_fsm_state_id state, tsk_fsm_action_id action)
+{
+	if(!TSK_FSM_STATE_IS_WILDCARD(entry->from) && (entry->from != state)){
+		return tsk_false;
+	}
+	return ((entry->action == tsk_fsm_action_any) || (entry->action == action));
+}
+
 int tsk_fsm_exec_nothing(va_list *app){ return 0/*success*/; }
 tsk_bool_t tsk_fsm_cond_always(const void* data1, const void* data2) { return tsk_true; }
 
@@ -52,39 +82,286 @@ tsk_fsm_entry_t* tsk_fsm_entry_create()
 	return (tsk_fsm_entry_t*)tsk_object_new(tsk_fsm_entry_def_t);
 }
 
-/**@ingroup tsk_fsm_group
-* Add entries (states) to the FSM.
-* @param self The FSM.
-* @param ... One of these  helper macros: @b TSK_FSM_ADD_*. MUST end with 
-* @b TSK_FSM_ADD_NULL.
-* @retval Zero if succeed and non-zero error code otherwise.
-*/
-int tsk_fsm_set(tsk_fsm_t* self, ...)
+static int _tsk_fsm_set(tsk_fsm_t* self, va_list* app)
 {
-	va_list args;
 	int guard;
 	
 	if(!self){
 		TSK_DEBUG_ERROR("Invalid parameter");
 		return -1;
 	}
+	if(self->table){
+		TSK_DEBUG_ERROR("The FSM uses a shared table which cannot be changed");
+		return -2;
+	}
+	if(!self->entries && !(self->entries = tsk_list_create())){
+		TSK_DEBUG_ERROR("Failed to create the list of entries");
+		return -3;
+	}
 	
-	va_start(args, self);
-	while((guard = va_arg(args, int)) == 1){
+	while((guard = va_arg(*app, int)) == 1){
 		tsk_fsm_entry_t* entry;
 		if((entry = tsk_fsm_entry_create())){
-			entry->from = va_arg(args, tsk_fsm_state_id);
-			entry->action = va_arg(args, tsk_fsm_action_id);
-			entry->cond = va_arg(args, tsk_fsm_cond);
-			entry->to = va_arg(args, tsk_fsm_state_id);
-			entry->exec = va_arg(args, tsk_fsm_exec);
-			entry->desc = va_arg(args, const char*);
+			entry->from = va_arg(*app, tsk_fsm_state_id);
+			entry->action = va_arg(*app, tsk_fsm_action_id);
+			entry->cond = va_arg(*app, tsk_fsm_cond);
+			entry->to = va_arg(*app, tsk_fsm_state_id);
+			entry->exec = va_arg(*app, tsk_fsm_exec);
+			entry->desc = va_arg(*app, const char*);
 			
 			tsk_list_push_descending_data(self->entries, (void**)&entry);
 		}
 	}
+	
+	return 0;
+}
+
+static int _tsk_fsm_set_shared(tsk_fsm_t* self, tsk_fsm_table_t** shared, tsk_fsm_prepare_f prepare, const void* prepare_data, va_list* app)
+{
+	int ret;
+
+	if(!self || !shared){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(*shared){
+		return tsk_fsm_set_table(self, *shared);
+	}
+	if(prepare && (ret = prepare(self, prepare_data))){
+		return ret;
+	}
+	if((ret = _tsk_fsm_set(self, app))){
+		return ret;
+	}
+	return tsk_fsm_compile(self, shared);
+}
+
+/**@ingroup tsk_fsm_group
+* Add entries (states) to the FSM.
+* @param self The FSM.
+* @param ... One of these  helper macros: @b TSK_FSM_ADD_*. MUST end with 
+* @b TSK_FSM_ADD_NULL.
+* @retval Zero if succeed and non-zero error code otherwise.
+*/
+int tsk_fsm_set(tsk_fsm_t* self, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, self);
+	ret = _tsk_fsm_set(self, &args);
+	va_end(args);
+
+	return ret;
+}
+
+/**@ingroup tsk_fsm_group
+* Sets the transitions of an FSM whose kind always uses the same ones (e.g. all NICT transactions).
+* The first FSM adds the entries and compiles them into a table published in @a shared (see @ref tsk_fsm_compile()),
+* the next ones only bind that table (see @ref tsk_fsm_set_table()).
+* @code
+* static tsk_fsm_table_t* __fsm_table = tsk_null;
+* tsk_fsm_set_shared(fsm, &__fsm_table,
+*		TSK_FSM_ADD_ALWAYS(_fsm_state_Started, _fsm_action_send, _fsm_state_Trying, exec_send, "Started_2_Trying_X_send"),
+*		TSK_FSM_ADD_NULL());
+* @endcode
+* @param self The FSM.
+* @param shared Pointer to the table shared by all the FSMs of the same kind. Must be initialized to @a tsk_null and never freed.
+* @param ... Same as @ref tsk_fsm_set(). Ignored once the table is built.
+* @retval Zero if succeed and non-zero error code otherwise.
+* @sa @ref tsk_fsm_set_shared_2()
+*/
+int tsk_fsm_set_shared(tsk_fsm_t* self, tsk_fsm_table_t** shared, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, shared);
+	ret = _tsk_fsm_set_shared(self, shared, tsk_null, tsk_null, &args);
+	va_end(args);
+
+	return ret;
+}
+
+/**@ingroup tsk_fsm_group
+* Same as @ref tsk_fsm_set_shared() but calls @a prepare before adding the entries, only when the table is built.
+* Useful when some of the entries are added by other modules using @ref tsk_fsm_set() (they are tried first).
+* @param self The FSM.
+* @param shared Pointer to the shared table.
+* @param prepare Function adding the first entries.
+* @param prepare_data Opaque data to pass to @a prepare.
+* @param ... Same as @ref tsk_fsm_set().
+* @retval Zero if succeed and non-zero error code otherwise.
+*/
+int tsk_fsm_set_shared_2(tsk_fsm_t* self, tsk_fsm_table_t** shared, tsk_fsm_prepare_f prepare, const void* prepare_data, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, prepare_data);
+	ret = _tsk_fsm_set_shared(self, shared, prepare, prepare_data, &args);
 	va_end(args);
+
+	return ret;
+}
+
+static tsk_fsm_table_t* _tsk_fsm_table_create(tsk_fsm_entries_L_t* entries)
+{
+	tsk_fsm_table_t* table;
+	const tsk_list_item_t* item;
+	tsk_fsm_state_id state;
+	tsk_fsm_action_id action;
+	tsk_size_t i, total;
+
+	if(!(table = (tsk_fsm_table_t*)tsk_object_new(tsk_fsm_table_def_t))){
+		TSK_DEBUG_ERROR("Failed to create the FSM table");
+		return tsk_null;
+	}
+	table->entries = entries ? (tsk_fsm_entries_L_t*)tsk_object_ref(entries) : tsk_list_create();
+	table->count = tsk_list_count(table->entries, tsk_null, tsk_null);
+	if(!(table->array = (const tsk_fsm_entry_t**)tsk_calloc(table->count + 1, sizeof(const tsk_fsm_entry_t*)))){
+		TSK_DEBUG_ERROR("Failed to allocate the FSM table");
+		TSK_OBJECT_SAFE_FREE(table);
+		return tsk_null;
+	}
+
+	table->indexed = tsk_true;
+	i = 0;
+	tsk_list_foreach(item, table->entries){
+		const tsk_fsm_entry_t* entry = (const tsk_fsm_entry_t*)item->data;
+		table->array[i++] = entry;
+		if(!TSK_FSM_STATE_IS_WILDCARD(entry->from)){
+			if(entry->from < 0 || entry->from >= TSK_FSM_TABLE_INDEX_MAX){
+				table->indexed = tsk_false;
+			}
+			else{
+				table->states_count = TSK_MAX(table->states_count, entry->from + 1);
+			}
+		}
+		if(entry->action != tsk_fsm_action_any){
+			if(entry->action < 0 || entry->action >= TSK_FSM_TABLE_INDEX_MAX){
+				table->indexed = tsk_false;
+			}
+			else{
+				table->actions_count = TSK_MAX(table->actions_count, entry->action + 1);
+			}
+		}
+	}
+
+	/* (state, action) -> matching entries. The states and actions not used in the table share the last row/column and
+	* only match the wildcard entries. */
+	if(table->indexed){
+		tsk_size_t buckets_count = (table->states_count + 1) * (table->actions_count + 1);
+		total = 0;
+		for(state = 0; state <= table->states_count; ++state){
+			for(action = 0; action <= table->actions_count; ++action){
+				for(i = 0; i < table->count; ++i){
+					total += _tsk_fsm_entry_match(table->array[i], state, action) ? 1 : 0;
+				}
+			}
+		}
+		if(total > 0xFFFF){
+			TSK_DEBUG_INFO("FSM table too large to be indexed (%u entries)", (unsigned)total);
+			table->indexed = tsk_false;
+		}
+		else if(!(table->buckets = (uint16_t*)tsk_calloc(buckets_count + 1, sizeof(uint16_t))) || !(table->index = (uint16_t*)tsk_calloc(total + 1, sizeof(uint16_t)))){
+			TSK_DEBUG_ERROR("Failed to allocate the FSM table index");
+			table->indexed = tsk_false;
+		}
+		else{
+			total = 0;
+			for(state = 0; state <= table->states_count; ++state){
+				for(action = 0; action <= table->actions_count; ++action){
+					table->buckets[(state * (table->actions_count + 1)) + action] = (uint16_t)total;
+					for(i = 0; i < table->count; ++i){
+						if(_tsk_fsm_entry_match(table->array[i], state, action)){
+							table->index[total++] = (uint16_t)i;
+						}
+					}
+				}
+			}
+			table->buckets[buckets_count] = (uint16_t)total;
+		}
+	}
 	
+	return table;
+}
+
+/* Returns the first entry matching the current state, the action and the condition */
+static const tsk_fsm_entry_t* _tsk_fsm_table_find(const tsk_fsm_table_t* table, tsk_fsm_state_id current, tsk_fsm_action_id action, const void* cond_data1, const void* cond_data2)
+{
+	tsk_size_t i;
+	if(table->indexed){
+		tsk_size_t bucket, end;
+		bucket = ((current >= 0 && current < table->states_count) ? current : table->states_count) * (table->actions_count + 1)
+			+ ((action >= 0 && action < table->actions_count) ? action : table->actions_count);
+		for(i = table->buckets[bucket], end = table->buckets[bucket + 1]; i < end; ++i){
+			if(table->array[table->index[i]]->cond(cond_data1, cond_data2)){
+				return table->array[table->index[i]];
+			}
+		}
+	}
+	else{
+		for(i = 0; i < table->count; ++i){
+			if(_tsk_fsm_entry_match(table->array[i], current, action) && table->array[i]->cond(cond_data1, cond_data2)){
+				return table->array[i];
+			}
+		}
+	}
+	return tsk_null;
+}
+
+/**@ingroup tsk_fsm_group
+* Converts the entries added using @ref tsk_fsm_set() into a table indexed by (state, action) and uses it for this FSM.
+* @param self The FSM.
+* @param shared Where to publish the table so that the next FSMs of the same kind can use it with @ref tsk_fsm_set_table()
+* instead of adding the same entries again. Could be null. If another FSM already published its table (race) then,
+* this one is dropped and the published one used.
+* @retval Zero if succeed and non-zero error code otherwise.
+*/
+int tsk_fsm_compile(tsk_fsm_t* self, tsk_fsm_table_t** shared)
+{
+	tsk_fsm_table_t* table;
+	int ret;
+
+	if(!self || self->table){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	if(!(table = _tsk_fsm_table_create(self->entries))){
+		return -2;
+	}
+	if(shared){
+		/* On success "*shared" holds our reference forever, otherwise use the one from the winner */
+		if(!tsk_atomic_cas_ptr(shared, tsk_null, table)){
+			TSK_OBJECT_SAFE_FREE(table);
+		}
+		return tsk_fsm_set_table(self, *shared);
+	}
+	ret = tsk_fsm_set_table(self, table);
+	TSK_OBJECT_SAFE_FREE(table);
+	return ret;
+}
+
+/**@ingroup tsk_fsm_group
+* Uses a shared table built using @ref tsk_fsm_compile() instead of per-FSM entries. No memory is allocated.
+* @param self The FSM.
+* @param table The shared table.
+* @retval Zero if succeed and non-zero error code otherwise.
+*/
+int tsk_fsm_set_table(tsk_fsm_t* self, tsk_fsm_table_t* table)
+{
+	if(!self || !table){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+	tsk_safeobj_lock(self);
+	if(self->table != table){
+		TSK_OBJECT_SAFE_FREE(self->table);
+		self->table = (tsk_fsm_table_t*)tsk_object_ref(table);
+	}
+	TSK_OBJECT_SAFE_FREE(self->entries);
+	tsk_safeobj_unlock(self);
 	return 0;
 }
 
@@ -120,6 +397,7 @@ int tsk_fsm_set_callback_terminated(tsk_fsm_t* self, tsk_fsm_onterminated_f call
 int tsk_fsm_act(tsk_fsm_t* self, tsk_fsm_action_id action, const void* cond_data1, const void* cond_data2, ...)
 {
 	tsk_list_item_t *item;
+	const tsk_fsm_entry_t* entry = tsk_null;
 	va_list ap;
 	tsk_bool_t found = tsk_false;
 	tsk_bool_t terminates = tsk_false; /* thread-safeness -> DO NOT REMOVE THIS VARIABLE */
@@ -138,41 +416,40 @@ int tsk_fsm_act(tsk_fsm_t* self, tsk_fsm_action_id action, const void* cond_data
 	tsk_safeobj_lock(self);
 	
 	va_start(ap, cond_data2);
-	tsk_list_foreach(item, self->entries)
-	{
-		tsk_fsm_entry_t* entry = (tsk_fsm_entry_t*)item->data;
-		if(((entry->from != tsk_fsm_state_any) && (entry->from != tsk_fsm_state_current)) && (entry->from != self->current)){
-			continue;
+	if(self->table){
+		entry = _tsk_fsm_table_find(self->table, self->current, action, cond_data1, cond_data2);
+	}
+	else{
+		tsk_list_foreach(item, self->entries)
+		{
+			// check state, action and condition
+			if(_tsk_fsm_entry_match((const tsk_fsm_entry_t*)item->data, self->current, action) && ((const tsk_fsm_entry_t*)item->data)->cond(cond_data1, cond_data2)){
+				entry = (const tsk_fsm_entry_t*)item->data;
+				break;
+			}
 		}
-
-		if((entry->action != tsk_fsm_action_any) && (entry->action != action)){
-			continue;
+	}
+	if(entry){
+		// For debug information
+		if(self->debug){
+			TSK_DEBUG_INFO("State machine: %s", entry->desc);
 		}
 		
-		// check condition
-		if(entry->cond(cond_data1, cond_data2)){
-			// For debug information
-			if(self->debug){
-				TSK_DEBUG_INFO("State machine: %s", entry->desc);
-			}
-			
-			if(entry->to != tsk_fsm_state_any && entry->to != tsk_fsm_state_current){ /* Stay at the current state if destination state is Any or Current */
-				self->current = entry->to;
-			}
-			
-			if(entry->exec){
-				if((ret_exec = entry->exec(&ap))){
-					TSK_DEBUG_INFO("State machine: Exec function failed. Moving to terminal state.");
-				}
-			}
-			else{ /* Nothing to execute */
-				ret_exec = 0;
+		if(entry->to != tsk_fsm_state_any && entry->to != tsk_fsm_state_current){ /* Stay at the current state if destination state is Any or Current */
+			self->current = entry->to;
+		}
+		
+		if(entry->exec){
+			if((ret_exec = entry->exec(&ap))){
+				TSK_DEBUG_INFO("State machine: Exec function failed. Moving to terminal state.");
 			}
-			
-			terminates = (ret_exec || (self->current == self->term));
-			found = tsk_true;
-			break;
 		}
+		else{ /* Nothing to execute */
+			ret_exec = 0;
+		}
+		
+		terminates = (ret_exec || (self->current == self->term));
+		found = tsk_true;
 	}
 	va_end(ap);
 	
@@ -234,7 +511,7 @@ static tsk_object_t* tsk_fsm_ctor(tsk_object_t * self, va_list * app)
 		fsm->current = va_arg(*app, tsk_fsm_state_id);
 		fsm->term = va_arg(*app, tsk_fsm_state_id);
 
-		fsm->entries = tsk_list_create();
+		/* "entries" is created by tsk_fsm_set() unless a shared table is used */
 
 #if defined(DEBUG) || defined(_DEBUG)
 		fsm->debug = 1; /* default value, could be changed at any time */
@@ -260,6 +537,7 @@ static tsk_object_t* tsk_fsm_dtor(tsk_object_t * self)
 		tsk_safeobj_deinit(fsm);
 
 		TSK_OBJECT_SAFE_FREE(fsm->entries);
+		TSK_OBJECT_SAFE_FREE(fsm->table);
 	}
 
 	return self;
@@ -330,3 +608,38 @@ static const tsk_object_def_t tsk_fsm_entry_def_s =
 	tsk_fsm_entry_cmp, 
 };
 const tsk_object_def_t *tsk_fsm_entry_def_t = &tsk_fsm_entry_def_s;
+
+
+//=================================================================================================
+//	fsm table object definition
+//
+static tsk_object_t* tsk_fsm_table_ctor(tsk_object_t * self, va_list * app)
+{
+	tsk_fsm_table_t *table = (tsk_fsm_table_t*)self;
+	if(table){
+	}
+
+	return self;
+}
+
+static tsk_object_t* tsk_fsm_table_dtor(tsk_object_t * self)
+{ 
+	tsk_fsm_table_t *table = (tsk_fsm_table_t*)self;
+	if(table){
+		TSK_FREE(table->array);
+		TSK_FREE(table->buckets);
+		TSK_FREE(table->index);
+		TSK_OBJECT_SAFE_FREE(table->entries);
+	}
+
+	return self;
+}
+
+static const tsk_object_def_t tsk_fsm_table_def_s = 
+{
+	sizeof(tsk_fsm_table_t),
+	tsk_fsm_table_ctor, 
+	tsk_fsm_table_dtor,
+	tsk_null, 
+};
+const tsk_object_def_t *tsk_fsm_table_def_t = &tsk_fsm_table_def_s;
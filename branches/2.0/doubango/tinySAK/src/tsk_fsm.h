@@ -86,6 +86,8 @@ typedef int tsk_fsm_action_id;
 typedef tsk_bool_t (*tsk_fsm_cond)(const void*, const void*);
 typedef int (*tsk_fsm_exec)(va_list *app);
 typedef int (*tsk_fsm_onterminated_f)(const void*);
+struct tsk_fsm_s;
+typedef int (*tsk_fsm_prepare_f)(struct tsk_fsm_s* self, const void* data);
 
 
 /**@ingroup tsk_fsm_group
@@ -142,6 +144,13 @@ tsk_fsm_entry_t;
 */
 typedef tsk_list_t tsk_fsm_entries_L_t;
 
+/**@ingroup tsk_fsm_group
+* Immutable transition table shared by all FSMs of the same kind (e.g. all NICT transactions).
+* Built once by @ref tsk_fsm_compile() and indexed by (state, action) for O(1) dispatch.
+* Use @ref tsk_fsm_set_shared() to build it with the first FSM of a kind and bind it to the next ones in a single call.
+*/
+typedef struct tsk_fsm_table_s tsk_fsm_table_t;
+
 /**@ingroup tsk_fsm_group
 * FSM.
 */
@@ -153,6 +162,7 @@ typedef struct tsk_fsm_s
 	tsk_fsm_state_id current;
 	tsk_fsm_state_id term;
 	tsk_fsm_entries_L_t* entries;
+	tsk_fsm_table_t* table; /* shared transitions, used instead of "entries" when set */
 
 	tsk_fsm_onterminated_f callback_term;
 	const void* callback_data;
@@ -166,6 +176,10 @@ TINYSAK_API tsk_fsm_t* tsk_fsm_create(tsk_fsm_state_id state_curr, tsk_fsm_state
 TINYSAK_API int tsk_fsm_exec_nothing(va_list *app);
 TINYSAK_API tsk_bool_t tsk_fsm_cond_always(const void*, const void*);
 TINYSAK_API int tsk_fsm_set(tsk_fsm_t* self, ...);
+TINYSAK_API int tsk_fsm_set_shared(tsk_fsm_t* self, tsk_fsm_table_t** shared, ...);
+TINYSAK_API int tsk_fsm_set_shared_2(tsk_fsm_t* self, tsk_fsm_table_t** shared, tsk_fsm_prepare_f prepare, const void* prepare_data, ...);
+TINYSAK_API int tsk_fsm_compile(tsk_fsm_t* self, tsk_fsm_table_t** shared);
+TINYSAK_API int tsk_fsm_set_table(tsk_fsm_t* self, tsk_fsm_table_t* table);
 TINYSAK_API int tsk_fsm_set_callback_terminated(tsk_fsm_t* self, tsk_fsm_onterminated_f callback, const void* callbackdata);
 TINYSAK_API int tsk_fsm_act(tsk_fsm_t* self, tsk_fsm_action_id action, const void* cond_data1, const void* cond_data2, ...);
 TINYSAK_API tsk_fsm_state_id tsk_fsm_get_current_state(tsk_fsm_t* self);
@@ -174,6 +188,7 @@ TINYSAK_API tsk_bool_t tsk_fsm_terminated(tsk_fsm_t* self);
 
 TINYSAK_GEXTERN const tsk_object_def_t *tsk_fsm_def_t;
 TINYSAK_GEXTERN const tsk_object_def_t *tsk_fsm_entry_def_t;
+TINYSAK_GEXTERN const tsk_object_def_t *tsk_fsm_table_def_t;
 
 TSK_END_DECLS
 
@@ -30,6 +30,7 @@
  */
 #include "tsk_memory.h"
 #include "tsk_debug.h"
+#include "tsk_common.h"
 
 #include <stdarg.h>
 #include <ctype.h>
@@ -38,6 +39,13 @@
 /**@defgroup tsk_memory_group Utility functions for memory management.
 */
 
+#if TSK_MEMORY_STATS
+static volatile long __tsk_memory_alloc_count = 0; /* "long" to match InterlockedIncrement() on Windows */
+#	define TSK_MEMORY_COUNT_ALLOC()	tsk_atomic_inc(&__tsk_memory_alloc_count)
+#else
+#	define TSK_MEMORY_COUNT_ALLOC()
+#endif
+
 /**@ingroup tsk_memory_group
 * Allocates a block of size bytes of memory, returning a pointer to the beginning of the block.
 * The content of the newly allocated block of memory is not initialized, remaining with indeterminate values.
@@ -51,6 +59,7 @@ void* tsk_malloc(tsk_size_t size)
 	if(!ret){
 		TSK_DEBUG_ERROR("Memory allocation failed");
 	}
+	TSK_MEMORY_COUNT_ALLOC();
 
 	return ret;
 }
@@ -75,6 +84,7 @@ void* tsk_realloc (void* ptr, tsk_size_t size)
 	void *ret = tsk_null;
 	
 	if(size) {
+		TSK_MEMORY_COUNT_ALLOC();
 		if(ptr){
 			if(!(ret = realloc(ptr, size))){
 				TSK_DEBUG_ERROR("Memory reallocation failed");
@@ -120,7 +130,22 @@ void* tsk_calloc(tsk_size_t num, tsk_size_t size)
 		if(!ret){
 			TSK_DEBUG_ERROR("Memory allocation failed. num=%u and size=%u", (unsigned)num, (unsigned)size);
 		}
+		TSK_MEMORY_COUNT_ALLOC();
 	}
 
 	return ret;
 }
+
+/**@ingroup tsk_memory_group
+* Gets the number of memory blocks allocated (or reallocated) using @a tsk_malloc, @a tsk_calloc and @a tsk_realloc since the application started.
+* The counter is atomic (safe when several threads allocate) and wraps after 2^32 allocations when "long" is 32-bit (e.g. Windows).
+* @retval The number of allocations or zero if the library was built without @ref TSK_MEMORY_STATS.
+*/
+uint64_t tsk_memory_get_alloc_count()
+{
+#if TSK_MEMORY_STATS
+	return (uint64_t)(unsigned long)tsk_atomic_load(&__tsk_memory_alloc_count);
+#else
+	return 0;
+#endif
+}
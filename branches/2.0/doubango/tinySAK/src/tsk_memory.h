@@ -56,10 +56,19 @@ TSK_BEGIN_DECLS
 #define TSK_SAFE_FREE_TABLE(pptr) TSK_SAFE_FREE_ARRAY((pptr), (sizeof((pptr))/sizeof((pptr)[0])))
 #define TSK_FREE_TABLE(pptr) TSK_SAFE_FREE_TABLE((pptr))
 
+/**@ingroup tsk_memory_group
+* @def TSK_MEMORY_STATS
+* Whether to count the memory allocations (see @ref tsk_memory_get_alloc_count). Useful for benchmarks. Default: disabled.
+*/
+#if !defined(TSK_MEMORY_STATS)
+#	define TSK_MEMORY_STATS	0
+#endif
+
 TINYSAK_API void* tsk_malloc(tsk_size_t size);
 TINYSAK_API void* tsk_realloc (void * ptr, tsk_size_t size);
 TINYSAK_API void tsk_free(void** ptr);
 TINYSAK_API void* tsk_calloc(tsk_size_t num, tsk_size_t size);
+TINYSAK_API uint64_t tsk_memory_get_alloc_count();
 
 TSK_END_DECLS
 
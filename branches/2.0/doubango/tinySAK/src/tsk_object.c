@@ -166,8 +166,8 @@ int tsk_object_cmp(const tsk_object_t *object1, const tsk_object_t *object2)
 tsk_object_t* tsk_object_ref(tsk_object_t *self)
 {
 	tsk_object_header_t* objhdr = TSK_OBJECT_HEADER(self);
-	if (objhdr && objhdr->refCount > 0) {
-		tsk_atomic_inc(&objhdr->refCount);
+	if (objhdr && tsk_atomic_load(&objhdr->refCount) > 0) {
+		tsk_atomic_inc_fetch(&objhdr->refCount);
 		return self;
 	}
 	return tsk_null;
@@ -186,9 +186,9 @@ tsk_object_t* tsk_object_unref(tsk_object_t *self)
 {
 	if (self) {
 		tsk_object_header_t* objhdr = TSK_OBJECT_HEADER(self);
-		if (objhdr->refCount > 0) { // If refCount is == 0 then, nothing should happen.
-			tsk_atomic_dec(&objhdr->refCount);
-			if (objhdr->refCount == 0) {
+		if (tsk_atomic_load(&objhdr->refCount) > 0) { // If refCount is == 0 then, nothing should happen.
+			// Only the thread dropping the last reference gets zero: never re-read the counter after decrementing it.
+			if (tsk_atomic_dec_fetch(&objhdr->refCount) == 0) {
 				tsk_object_delete(self);
 				return tsk_null;
 			}
@@ -38,6 +38,61 @@
 /**@defgroup tsk_params_group SIP/MSRP/XCAP Parameters parser.
 */
 
+/* Names of the interned parameters, indexed by tsk_param_name_t */
+static const struct{
+	const char* name;
+	tsk_size_t size;
+}
+__tsk_param_names[] = 
+{
+	{ "", 0 }, // tsk_param_name_unknown
+	{ "tag", 3 },
+	{ "branch", 6 },
+	{ "rport", 5 },
+	{ "received", 8 },
+	{ "expires", 7 },
+	{ "lr", 2 },
+	{ "transport", 9 },
+	{ "maddr", 5 },
+	{ "ttl", 3 },
+	{ "user", 4 },
+	{ "method", 6 },
+	{ "q", 1 },
+	{ "comp", 4 },
+	{ "sigcomp-id", 10 },
+	{ "ob", 2 },
+	{ "reg-id", 6 },
+	{ "+sip.instance", 13 },
+	{ "gr", 2 },
+	{ "pub-gruu", 8 },
+	{ "temp-gruu", 9 },
+	{ "phone-context", 13 },
+};
+
+/* Finds a parameter by name: interned names are compared as integers, the others as strings (case-insensitive).
+*/
+static const tsk_list_item_t* _tsk_params_find_item_by_name(const tsk_params_L_t *self, const char* name)
+{
+	const tsk_list_item_t *item;
+	const tsk_param_t *param;
+	const tsk_param_name_t name_id = tsk_param_name_intern(name, tsk_strlen(name));
+
+	tsk_list_foreach(item, self){
+		if(!(param = (const tsk_param_t*)item->data)){
+			continue;
+		}
+		if(param->name_id != tsk_param_name_unknown){
+			if(param->name_id == name_id){
+				return item;
+			}
+		}
+		else if(!tsk_stricmp(param->name, name)){ // not interned or name set by the caller
+			return item;
+		}
+	}
+	return tsk_null;
+}
+
 /* Predicate function used to find a parameter by name (case-insensitive).
 */
 static int pred_find_param_by_name(const tsk_list_item_t *item, const void *name)
@@ -63,6 +118,26 @@ tsk_param_t* tsk_param_create_null()
 	return tsk_param_create(tsk_null, tsk_null);
 }
 
+/**@ingroup tsk_params_group
+* Interns a parameter name.
+* @param name The name of the parameter (not necessarily null-terminated).
+* @param size The size (length) of the name.
+* @retval The interned name (case-insensitive) or @ref tsk_param_name_unknown.
+*/
+tsk_param_name_t tsk_param_name_intern(const char* name, tsk_size_t size)
+{
+	tsk_size_t i;
+	if(name && size){
+		const char first = (name[0] | 0x20); // to lower case (letters only, enough to filter)
+		for(i = 1; i < sizeof(__tsk_param_names)/sizeof(__tsk_param_names[0]); ++i){
+			if(__tsk_param_names[i].size == size && __tsk_param_names[i].name[0] == first && tsk_strniequals(__tsk_param_names[i].name, name, size)){
+				return (tsk_param_name_t)i;
+			}
+		}
+	}
+	return tsk_param_name_unknown;
+}
+
 /**@ingroup tsk_params_group
 * Converts a key-value-pair string (kvp) to @ref tsk_param_t object.
 * @param line The kvp (e.g. 'branch=z9hG4bK652hsge') string to parse.
@@ -80,6 +155,7 @@ tsk_param_t *tsk_params_parse_param(const char* line, tsk_size_t size)
 		if (param && equal && equal<end) {
 			if ((param->name = (char*)tsk_calloc((tsk_size_t)((equal - start) + 1), sizeof(const char)))) {
 				memcpy(param->name, start, (equal - start));
+				param->name_id = tsk_param_name_intern(param->name, (tsk_size_t)(equal - start));
 			}
 
 			if ((param->value = (char*)tsk_calloc((tsk_size_t)((end - equal - 1) + 1), sizeof(const char)))) {
@@ -89,6 +165,7 @@ tsk_param_t *tsk_params_parse_param(const char* line, tsk_size_t size)
 		else if (param) {
 			if ((param->name = (char*)tsk_calloc((tsk_size_t)((end - start) + 1), sizeof(const char)))) {
 				memcpy(param->name, start, (end - start));
+				param->name_id = tsk_param_name_intern(param->name, (tsk_size_t)(end - start));
 			}
 		}
 
@@ -105,7 +182,7 @@ tsk_param_t *tsk_params_parse_param(const char* line, tsk_size_t size)
 tsk_bool_t tsk_params_have_param(const tsk_params_L_t *self, const char* name)
 {
 	if(self){
-		if(tsk_list_find_item_by_pred(self, pred_find_param_by_name, name)){
+		if(_tsk_params_find_item_by_name(self, name)){
 			return tsk_true;
 		}
 	}
@@ -190,7 +267,7 @@ int tsk_params_remove_param(tsk_params_L_t *self, const char* name)
 const tsk_param_t *tsk_params_get_param_by_name(const tsk_params_L_t *self, const char* name)
 {
 	if(self){
-		const tsk_list_item_t *item_const = tsk_list_find_item_by_pred(self, pred_find_param_by_name, name);
+		const tsk_list_item_t *item_const = _tsk_params_find_item_by_name(self, name);
 		if(item_const){
 			return (const tsk_param_t*)item_const->data;
 		}
@@ -210,7 +287,7 @@ const tsk_param_t *tsk_params_get_param_by_name(const tsk_params_L_t *self, cons
 const char *tsk_params_get_param_value(const tsk_params_L_t *self, const char* name)
 {
 	if(self && name){
-		const tsk_list_item_t *item_const = tsk_list_find_item_by_pred(self, pred_find_param_by_name, name);
+		const tsk_list_item_t *item_const = _tsk_params_find_item_by_name(self, name);
 		if(item_const && item_const->data){
 			return ((const tsk_param_t *)item_const->data)->value;
 		}
@@ -354,6 +431,7 @@ static tsk_object_t* tsk_param_ctor(tsk_object_t* self, va_list * app)
 
 		if(!tsk_strnullORempty(name)) {
 			param->name = tsk_strdup(name);
+			param->name_id = tsk_param_name_intern(name, tsk_strlen(name));
 			if(!tsk_strnullORempty(value)) {
 				param->value = tsk_strdup(value);
 			}
@@ -42,6 +42,36 @@ TSK_BEGIN_DECLS
 
 #define TSK_PARAM(self)				((tsk_param_t*)(self))
 
+/**@ingroup tsk_params_group
+* Interned names of the most common parameters (see @ref tsk_param_name_intern).
+*/
+typedef enum tsk_param_name_e
+{
+	tsk_param_name_unknown, /**< Any other name (compared as string) */
+	tsk_param_name_tag,
+	tsk_param_name_branch,
+	tsk_param_name_rport,
+	tsk_param_name_received,
+	tsk_param_name_expires,
+	tsk_param_name_lr,
+	tsk_param_name_transport,
+	tsk_param_name_maddr,
+	tsk_param_name_ttl,
+	tsk_param_name_user,
+	tsk_param_name_method,
+	tsk_param_name_q,
+	tsk_param_name_comp,
+	tsk_param_name_sigcomp_id,
+	tsk_param_name_ob,
+	tsk_param_name_reg_id,
+	tsk_param_name_sip_instance,
+	tsk_param_name_gr,
+	tsk_param_name_pub_gruu,
+	tsk_param_name_temp_gruu,
+	tsk_param_name_phone_context,
+}
+tsk_param_name_t;
+
 /**@ingroup tsk_params_group
 * Parameter.
 */
@@ -51,6 +81,7 @@ typedef struct tsk_param_s
 
 	char *name;/**< The name of the parameter. */
 	char *value;/**< The value of the parameter. */
+	tsk_param_name_t name_id;/**< Interned @a name (set when the parameter is created or parsed). Must be reset to @ref tsk_param_name_unknown if @a name is changed. */
 	
 	tsk_bool_t tag;/**< tag to be used for any use case (e.g. validity of the parameter, whether to ignore the param., ...). Default value: @ref tsk_false.*/
 }
@@ -62,6 +93,7 @@ TINYSAK_API tsk_param_t* tsk_param_create(const char* name, const char* value);
 TINYSAK_API tsk_param_t* tsk_param_create_null();
 
 TINYSAK_API tsk_param_t *tsk_params_parse_param(const char* line, tsk_size_t size);
+TINYSAK_API tsk_param_name_t tsk_param_name_intern(const char* name, tsk_size_t size);
 
 TINYSAK_API tsk_bool_t tsk_params_have_param(const tsk_params_L_t *self, const char* name);
 TINYSAK_API int tsk_params_add_param(tsk_params_L_t **self, const char* name, const char* value);
@@ -484,8 +484,7 @@ static tsk_object_t* tsk_timer_ctor(tsk_object_t * self, va_list * app)
 	static volatile tsk_timer_id_t __tsk_unique_timer_id = 0;
 	tsk_timer_t *timer = (tsk_timer_t*)self;
 	if(timer){
-		tsk_atomic_inc(&__tsk_unique_timer_id);
-		timer->id = __tsk_unique_timer_id;
+		timer->id = tsk_atomic_inc_fetch(&__tsk_unique_timer_id);
 		timer->timeout = va_arg(*app, uint64_t);
 		timer->callback = va_arg(*app, tsk_timer_callback_f);
 		timer->arg = va_arg(*app, const void *);
@@ -54,6 +54,8 @@
 #define RUN_TEST_BASE64				0
 #define RUN_TEST_UUID				0
 #define RUN_TEST_FSM				0
+#define RUN_TEST_DEBUG				0
+#define RUN_TEST_REFCOUNT			0
 
 #if RUN_TEST_LISTS || RUN_TEST_ALL
 #include "test_lists.h"
@@ -135,6 +137,14 @@
 #include "test_fsm.h"
 #endif
 
+#if RUN_TEST_DEBUG || RUN_TEST_ALL
+#include "test_debug.h"
+#endif
+
+#if RUN_TEST_REFCOUNT || RUN_TEST_ALL
+#include "test_refcount.h"
+#endif
+
 
 #ifdef _WIN32_WCE
 int _tmain(int argc, _TCHAR* argv[])
@@ -280,6 +290,16 @@ int main()
 		test_fsm();
 #endif
 
+#if RUN_TEST_DEBUG || RUN_TEST_ALL
+		/* test asynchronous logging */
+		test_debug();
+#endif
+
+#if RUN_TEST_REFCOUNT || RUN_TEST_ALL
+		/* test concurrent reference counting */
+		test_refcount();
+#endif
+
 	}
 	while(LOOP);
 
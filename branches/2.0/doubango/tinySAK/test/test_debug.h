@@ -0,0 +1,104 @@
+/*
+* Copyright (C) 2009 Mamadou Diop.
+*
+* Contact: Mamadou Diop <diopmamadou(at)doubango.org>
+*	
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*	
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*	
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+#ifndef _TEST_DEBUG_H_
+#define _TEST_DEBUG_H_
+
+#define TEST_DEBUG_THREADS		4
+#define TEST_DEBUG_MESSAGES		1000 // per thread, including the errors
+#define TEST_DEBUG_ERRORS		(TEST_DEBUG_MESSAGES / 10)
+
+static volatile long test_debug_received = 0;
+static volatile long test_debug_errors = 0;
+
+static int test_debug_info_cb(const void* arg, const char* fmt, ...)
+{
+	tsk_atomic_inc(&test_debug_received); // called by the background thread or by the logging threads once stopped
+	return 0;
+}
+
+static int test_debug_error_cb(const void* arg, const char* fmt, ...)
+{
+	tsk_atomic_inc(&test_debug_errors); // called by the background thread or by the logging thread when its ring is full
+	return 0;
+}
+
+static void* test_debug_run(void* arg)
+{
+	int i;
+	for(i = 0; i < TEST_DEBUG_MESSAGES; ++i){
+		if((i % (TEST_DEBUG_MESSAGES / TEST_DEBUG_ERRORS)) == 0){
+			TSK_DEBUG_ERROR("thread=%d error=%d", *((int*)arg), i);
+		}
+		else{
+			TSK_DEBUG_INFO("thread=%d message=%d", *((int*)arg), i);
+		}
+	}
+	return tsk_null;
+}
+
+// "stop_first": the threads are still logging while the asynchronous output is stopped and exit after the stop
+static void test_debug_run_threads(tsk_bool_t stop_first)
+{
+	void* tid[TEST_DEBUG_THREADS] = { tsk_null };
+	int args[TEST_DEBUG_THREADS], i, level = tsk_debug_get_level();
+	uint64_t dropped = tsk_debug_async_get_dropped(); // total since the process started
+
+	test_debug_received = test_debug_errors = 0;
+
+	tsk_debug_set_level(DEBUG_LEVEL_INFO);
+	tsk_debug_set_info_cb(test_debug_info_cb);
+	tsk_debug_set_error_cb(test_debug_error_cb);
+	tsk_debug_async_start();
+
+	for(i = 0; i < TEST_DEBUG_THREADS; ++i){
+		args[i] = i;
+		tsk_thread_create(&tid[i], test_debug_run, &args[i]);
+	}
+	if(stop_first){
+		tsk_debug_async_stop(); // the new messages are written by the logging threads
+	}
+	for(i = 0; i < TEST_DEBUG_THREADS; ++i){
+		tsk_thread_join(&tid[i]);
+	}
+
+	tsk_debug_async_stop(); // flushes the pending messages
+	tsk_debug_set_info_cb(tsk_null);
+	tsk_debug_set_error_cb(tsk_null);
+	tsk_debug_set_level(level);
+
+	// every message is either written or dropped
+	dropped = tsk_debug_async_get_dropped() - dropped;
+	printf("async logging%s: received=%ld, dropped=%llu, expected=%d\n", stop_first ? " (stopped while logging)" : "", (long)test_debug_received, (unsigned long long)dropped, (TEST_DEBUG_THREADS * (TEST_DEBUG_MESSAGES - TEST_DEBUG_ERRORS)));
+	// the errors are never dropped
+	printf("async logging%s: errors=%ld, expected=%d%s\n", stop_first ? " (stopped while logging)" : "", (long)test_debug_errors, (TEST_DEBUG_THREADS * TEST_DEBUG_ERRORS),
+		(test_debug_errors == (TEST_DEBUG_THREADS * TEST_DEBUG_ERRORS) && (test_debug_received + (long)dropped) == (TEST_DEBUG_THREADS * (TEST_DEBUG_MESSAGES - TEST_DEBUG_ERRORS))) ? "" : " FAILED");
+}
+
+void test_debug()
+{
+	printf("test_debug//\n");
+
+	test_debug_run_threads(tsk_false);
+	test_debug_run_threads(tsk_true);
+}
+
+#endif /* _TEST_DEBUG_H_ */
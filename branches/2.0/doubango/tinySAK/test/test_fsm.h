@@ -223,6 +223,102 @@ test_fsm_action_t test_fsm_tests[TEST_FSM_ACTIONS_COUNT][TEST_FSM_ACTIONS_COUNT]
 };
 
 
+static int test_fsm_set_entries(tsk_fsm_t* fsm)
+{
+	return tsk_fsm_set(fsm,
+
+		/*=======================
+		* === Any === 
+		*/
+		// Any -> (transport error) -> Terminated
+		TSK_FSM_ADD_ALWAYS(tsk_fsm_state_any, test_fsm_action_transporterror, Terminated, test_fsm_exec_Any_2_Terminated_X_transportError, "test_fsm_exec_Any_2_Terminated_X_transportError"),
+		// Any -> (transport error) -> Terminated
+		TSK_FSM_ADD_ALWAYS(tsk_fsm_state_any, test_fsm_action_error, Terminated, test_fsm_exec_Any_2_Terminated_X_Error, "test_fsm_exec_Any_2_Terminated_X_Error"),
+		// Any -> (hangup) -> Terminated
+		// Any -> (hangup) -> Trying
+		
+		/*=======================
+		* === Started === 
+		*/
+		// Started -> (Send) -> Trying
+		TSK_FSM_ADD_ALWAYS(Started, test_fsm_action_send, Trying, test_fsm_exec_Started_2_Trying_X_send, "test_fsm_exec_Started_2_Trying_X_send"),
+		// Started -> (Any) -> Started
+		TSK_FSM_ADD_ALWAYS_NOTHING(Started, "test_fsm_exec_Started_2_Started_X_any"),
+		
+
+		/*=======================
+		* === Trying === 
+		*/
+		// Trying -> (1xx) -> Trying
+		TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_1xx, Trying, test_fsm_exec_Trying_2_Trying_X_1xx, "test_fsm_exec_Trying_2_Trying_X_1xx"),
+		// Trying -> (2xx) -> Terminated
+		TSK_FSM_ADD(Trying, test_fsm_action_2xx, test_fsm_cond_unsubscribing, Terminated, test_fsm_exec_Trying_2_Terminated_X_2xx, "test_fsm_exec_Trying_2_Terminated_X_2xx"),
+		// Trying -> (2xx) -> Connected
+		TSK_FSM_ADD(Trying, test_fsm_action_2xx, test_fsm_cond_subscribing, Connected, test_fsm_exec_Trying_2_Connected_X_2xx, "test_fsm_exec_Trying_2_Connected_X_2xx"),
+		// Trying -> (401/407/421/494) -> Trying
+		TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_401_407_421_494, Trying, test_fsm_exec_Trying_2_Trying_X_401_407_421_494, "test_fsm_exec_Trying_2_Trying_X_401_407_421_494"),
+		// Trying -> (423) -> Trying
+		TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_423, Trying, test_fsm_exec_Trying_2_Trying_X_423, "test_fsm_exec_Trying_2_Trying_X_423"),
+		// Trying -> (300_to_699) -> Terminated
+		TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_300_to_699, Terminated, test_fsm_exec_Trying_2_Terminated_X_300_to_699, "test_fsm_exec_Trying_2_Terminated_X_300_to_699"),
+		// Trying -> (cancel) -> Terminated
+		TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_cancel, Terminated, test_fsm_exec_Trying_2_Terminated_X_cancel, "test_fsm_exec_Trying_2_Terminated_X_cancel"),
+		// Trying -> (Notify) -> Trying
+		TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_notify, Trying, test_fsm_exec_Trying_2_Trying_X_NOTIFY, "test_fsm_exec_Trying_2_Trying_X_NOTIFY"),
+		// Trying -> (Any) -> Trying
+		TSK_FSM_ADD_ALWAYS_NOTHING(Trying, "test_fsm_exec_Trying_2_Trying_X_any"),
+
+
+		/*=======================
+		* === Connected === 
+		*/
+		// Connected -> (unsubscribe) -> Trying
+		TSK_FSM_ADD_ALWAYS(Connected, test_fsm_action_unsubscribe, Trying, test_fsm_exec_Connected_2_Trying_X_unsubscribe, "test_fsm_exec_Connected_2_Trying_X_unsubscribe"),
+		// Connected -> (refresh) -> Trying
+		TSK_FSM_ADD_ALWAYS(Connected, test_fsm_action_refresh, Trying, test_fsm_exec_Connected_2_Trying_X_refresh, "test_fsm_exec_Connected_2_Trying_X_refresh"),
+		// Connected -> (NOTIFY) -> Connected
+		TSK_FSM_ADD(Connected, test_fsm_action_notify, test_fsm_cond_notify_not_terminated, Connected, test_fsm_exec_Connected_2_Connected_X_NOTIFY, "test_fsm_exec_Connected_2_Connected_X_NOTIFY"),
+		// Connected -> (NOTIFY) -> Terminated
+		TSK_FSM_ADD(Connected, test_fsm_action_notify, test_fsm_cond_notify_terminated, Terminated, test_fsm_exec_Connected_2_Terminated_X_NOTIFY, "test_fsm_exec_Connected_2_Terminated_X_NOTIFY"),
+		// Connected -> (Any) -> Connected
+		TSK_FSM_ADD_ALWAYS_NOTHING(Connected, "test_fsm_exec_Connected_2_Connected_X_any"),
+
+		TSK_FSM_ADD_NULL());
+}
+
+static int test_fsm_prepare(tsk_fsm_t* fsm, const void* data)
+{
+	return test_fsm_set_entries(fsm);
+}
+
+/* Same scenarios using a shared table: the states must be the same as with the per-FSM entries. */
+static tsk_fsm_table_t* test_fsm_shared_table = tsk_null;
+static void test_fsm_table()
+{
+	size_t i, j, errors = 0;
+	test_fsm_ctx_t ctx;
+	ctx.unsubscribing = 0;
+
+	for(i=0; i<TEST_FSM_ACTIONS_COUNT; i++){
+		tsk_fsm_t* fsm_list = tsk_fsm_create(Started, Terminated);
+		tsk_fsm_t* fsm_table = tsk_fsm_create(Started, Terminated);
+		fsm_list->debug = fsm_table->debug = 0;
+
+		test_fsm_set_entries(fsm_list);
+		tsk_fsm_set_shared_2(fsm_table, &test_fsm_shared_table, test_fsm_prepare, tsk_null, TSK_FSM_ADD_NULL());
+
+		for(j=0; j<TEST_FSM_ACTIONS_COUNT; j++){
+			tsk_fsm_act(fsm_list, test_fsm_tests[i][j], &ctx, tsk_null, &ctx, tsk_null /*message*/);
+			tsk_fsm_act(fsm_table, test_fsm_tests[i][j], &ctx, tsk_null, &ctx, tsk_null /*message*/);
+			errors += (tsk_fsm_get_current_state(fsm_list) != tsk_fsm_get_current_state(fsm_table));
+		}
+
+		TSK_OBJECT_SAFE_FREE(fsm_list);
+		TSK_OBJECT_SAFE_FREE(fsm_table);
+	}
+	printf("FSM shared table: %u errors\n", (unsigned)errors);
+}
+
 void test_fsm()
 {
 	size_t i;
@@ -236,66 +332,7 @@ void test_fsm()
 		
 		tsk_fsm_set_callback_terminated(fsm, test_fsm_onterminated, &ctx);
 
-		tsk_fsm_set(fsm,
-
-			/*=======================
-			* === Any === 
-			*/
-			// Any -> (transport error) -> Terminated
-			TSK_FSM_ADD_ALWAYS(tsk_fsm_state_any, test_fsm_action_transporterror, Terminated, test_fsm_exec_Any_2_Terminated_X_transportError, "test_fsm_exec_Any_2_Terminated_X_transportError"),
-			// Any -> (transport error) -> Terminated
-			TSK_FSM_ADD_ALWAYS(tsk_fsm_state_any, test_fsm_action_error, Terminated, test_fsm_exec_Any_2_Terminated_X_Error, "test_fsm_exec_Any_2_Terminated_X_Error"),
-			// Any -> (hangup) -> Terminated
-			// Any -> (hangup) -> Trying
-			
-			/*=======================
-			* === Started === 
-			*/
-			// Started -> (Send) -> Trying
-			TSK_FSM_ADD_ALWAYS(Started, test_fsm_action_send, Trying, test_fsm_exec_Started_2_Trying_X_send, "test_fsm_exec_Started_2_Trying_X_send"),
-			// Started -> (Any) -> Started
-			TSK_FSM_ADD_ALWAYS_NOTHING(Started, "test_fsm_exec_Started_2_Started_X_any"),
-			
-
-			/*=======================
-			* === Trying === 
-			*/
-			// Trying -> (1xx) -> Trying
-			TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_1xx, Trying, test_fsm_exec_Trying_2_Trying_X_1xx, "test_fsm_exec_Trying_2_Trying_X_1xx"),
-			// Trying -> (2xx) -> Terminated
-			TSK_FSM_ADD(Trying, test_fsm_action_2xx, test_fsm_cond_unsubscribing, Terminated, test_fsm_exec_Trying_2_Terminated_X_2xx, "test_fsm_exec_Trying_2_Terminated_X_2xx"),
-			// Trying -> (2xx) -> Connected
-			TSK_FSM_ADD(Trying, test_fsm_action_2xx, test_fsm_cond_subscribing, Connected, test_fsm_exec_Trying_2_Connected_X_2xx, "test_fsm_exec_Trying_2_Connected_X_2xx"),
-			// Trying -> (401/407/421/494) -> Trying
-			TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_401_407_421_494, Trying, test_fsm_exec_Trying_2_Trying_X_401_407_421_494, "test_fsm_exec_Trying_2_Trying_X_401_407_421_494"),
-			// Trying -> (423) -> Trying
-			TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_423, Trying, test_fsm_exec_Trying_2_Trying_X_423, "test_fsm_exec_Trying_2_Trying_X_423"),
-			// Trying -> (300_to_699) -> Terminated
-			TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_300_to_699, Terminated, test_fsm_exec_Trying_2_Terminated_X_300_to_699, "test_fsm_exec_Trying_2_Terminated_X_300_to_699"),
-			// Trying -> (cancel) -> Terminated
-			TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_cancel, Terminated, test_fsm_exec_Trying_2_Terminated_X_cancel, "test_fsm_exec_Trying_2_Terminated_X_cancel"),
-			// Trying -> (Notify) -> Trying
-			TSK_FSM_ADD_ALWAYS(Trying, test_fsm_action_notify, Trying, test_fsm_exec_Trying_2_Trying_X_NOTIFY, "test_fsm_exec_Trying_2_Trying_X_NOTIFY"),
-			// Trying -> (Any) -> Trying
-			TSK_FSM_ADD_ALWAYS_NOTHING(Trying, "test_fsm_exec_Trying_2_Trying_X_any"),
-
-
-			/*=======================
-			* === Connected === 
-			*/
-			// Connected -> (unsubscribe) -> Trying
-			TSK_FSM_ADD_ALWAYS(Connected, test_fsm_action_unsubscribe, Trying, test_fsm_exec_Connected_2_Trying_X_unsubscribe, "test_fsm_exec_Connected_2_Trying_X_unsubscribe"),
-			// Connected -> (refresh) -> Trying
-			TSK_FSM_ADD_ALWAYS(Connected, test_fsm_action_refresh, Trying, test_fsm_exec_Connected_2_Trying_X_refresh, "test_fsm_exec_Connected_2_Trying_X_refresh"),
-			// Connected -> (NOTIFY) -> Connected
-			TSK_FSM_ADD(Connected, test_fsm_action_notify, test_fsm_cond_notify_not_terminated, Connected, test_fsm_exec_Connected_2_Connected_X_NOTIFY, "test_fsm_exec_Connected_2_Connected_X_NOTIFY"),
-			// Connected -> (NOTIFY) -> Terminated
-			TSK_FSM_ADD(Connected, test_fsm_action_notify, test_fsm_cond_notify_terminated, Terminated, test_fsm_exec_Connected_2_Terminated_X_NOTIFY, "test_fsm_exec_Connected_2_Terminated_X_NOTIFY"),
-			// Connected -> (Any) -> Connected
-			TSK_FSM_ADD_ALWAYS_NOTHING(Connected, "test_fsm_exec_Connected_2_Connected_X_any"),
-
-			TSK_FSM_ADD_NULL());
-
+		test_fsm_set_entries(fsm);
 
 		for(j=0; j<TEST_FSM_ACTIONS_COUNT; j++){
 			tsk_fsm_act(fsm, test_fsm_tests[i][j], &ctx, tsk_null, &ctx, tsk_null /*message*/);
@@ -305,6 +342,8 @@ void test_fsm()
 
 		printf("\n\n");
 	}
+
+	test_fsm_table();
 }
 
 #endif /* _TEST_FSM_H_ */
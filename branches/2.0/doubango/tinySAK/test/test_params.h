@@ -49,18 +49,29 @@ void test_params()
 	//
 	//
 	//
-	params = tsk_params_fromstring("octet-align=1; mode-set=0,1,2,3,4,5,6,7; mode-change-period=1; mode-change-capability=2; mode-change-neighbor=0", ';', tsk_true);
+	params = tsk_params_fromstring("octet-align=1; mode-set=0,1,2,3,4,5,6,7; mode-change-period=1; mode-change-capability=2; mode-change-neighbor=0", ";", tsk_true);
 	tsk_params_tostring(params, ';', buffer);
 	TSK_DEBUG_INFO("Buffer=[%s]", TSK_BUFFER_TO_STRING(buffer));
 	tsk_buffer_cleanup(buffer);
 	TSK_OBJECT_SAFE_FREE(params);
 	
-	params = tsk_params_fromstring("QCIF=1;CIF=2;MaxBR=4200", ';', tsk_true);
+	params = tsk_params_fromstring("QCIF=1;CIF=2;MaxBR=4200", ";", tsk_true);
 	tsk_params_tostring(params, ';', buffer);
 	TSK_DEBUG_INFO("Buffer=[%s]", TSK_BUFFER_TO_STRING(buffer));
 	tsk_buffer_cleanup(buffer);
 	TSK_OBJECT_SAFE_FREE(params);
 
+	//
+	//	Interned names (well-known SIP parameters) and case-insensitive lookup
+	//
+	params = tsk_params_fromstring("Branch=z9hG4bK776;rport;TAG=1928;maxbr=4200", ";", tsk_true);
+	if(!tsk_params_have_param(params, "branch") || !tsk_params_have_param(params, "rport") || !tsk_params_have_param(params, "MaxBR")
+		|| tsk_params_have_param(params, "received") || !tsk_striequals(tsk_params_get_param_value(params, "tag"), "1928")){
+		TSK_DEBUG_ERROR("Params lookup failed");
+	}
+	tsk_buffer_cleanup(buffer);
+	TSK_OBJECT_SAFE_FREE(params);
+
 	TSK_OBJECT_SAFE_FREE(buffer);
 }
 
@@ -0,0 +1,113 @@
+/*
+* Copyright (C) 2009 Mamadou Diop.
+*
+* Contact: Mamadou Diop <diopmamadou(at)doubango.org>
+*	
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*	
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*	
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+#ifndef _TEST_REFCOUNT_H_
+#define _TEST_REFCOUNT_H_
+
+#define TEST_REFCOUNT_THREADS		8
+#define TEST_REFCOUNT_LOOPS			200000
+#define TEST_REFCOUNT_OBJECTS		20000
+
+typedef struct test_refcount_obj_s
+{
+	TSK_DECLARE_OBJECT;
+}
+test_refcount_obj_t;
+
+static volatile long test_refcount_destroyed = 0;
+
+static tsk_object_t* test_refcount_obj_ctor(tsk_object_t * self, va_list * app)
+{
+	return self;
+}
+static tsk_object_t* test_refcount_obj_dtor(tsk_object_t * self)
+{
+	tsk_atomic_inc(&test_refcount_destroyed);
+	return self;
+}
+static const tsk_object_def_t test_refcount_obj_def_s =
+{
+	sizeof(test_refcount_obj_t),
+	test_refcount_obj_ctor,
+	test_refcount_obj_dtor,
+	tsk_null,
+};
+
+static tsk_object_t* test_refcount_shared;
+static tsk_object_t* test_refcount_objects[TEST_REFCOUNT_OBJECTS];
+
+// ref()/unref() the same object
+static void* test_refcount_hammer(void* arg)
+{
+	int i;
+	for(i = 0; i < TEST_REFCOUNT_LOOPS; ++i){
+		tsk_object_ref(test_refcount_shared);
+		tsk_object_unref(test_refcount_shared);
+	}
+	return tsk_null;
+}
+
+// all threads drop their reference at the same time: exactly one of them must destroy each object
+static void* test_refcount_release(void* arg)
+{
+	int i;
+	for(i = 0; i < TEST_REFCOUNT_OBJECTS; ++i){
+		tsk_object_unref(test_refcount_objects[i]);
+	}
+	return tsk_null;
+}
+
+static void test_refcount_run(void *(TSK_STDCALL *start) (void *))
+{
+	void* tid[TEST_REFCOUNT_THREADS] = { tsk_null };
+	int args[TEST_REFCOUNT_THREADS], i;
+	for(i = 0; i < TEST_REFCOUNT_THREADS; ++i){
+		args[i] = i;
+		tsk_thread_create(&tid[i], start, &args[i]);
+	}
+	for(i = 0; i < TEST_REFCOUNT_THREADS; ++i){
+		tsk_thread_join(&tid[i]);
+	}
+}
+
+void test_refcount()
+{
+	int i, j;
+
+	printf("test_refcount//\n");
+
+	test_refcount_shared = tsk_object_new(&test_refcount_obj_def_s);
+	test_refcount_run(test_refcount_hammer);
+	printf("shared object: refcount=%u (expected 1), destroyed=%ld (expected 0)\n", (unsigned)tsk_object_get_refcount(test_refcount_shared), (long)test_refcount_destroyed);
+	TSK_OBJECT_SAFE_FREE(test_refcount_shared);
+
+	test_refcount_destroyed = 0;
+	for(i = 0; i < TEST_REFCOUNT_OBJECTS; ++i){
+		test_refcount_objects[i] = tsk_object_new(&test_refcount_obj_def_s); // one reference per thread
+		for(j = 1; j < TEST_REFCOUNT_THREADS; ++j){
+			tsk_object_ref(test_refcount_objects[i]);
+		}
+	}
+	test_refcount_run(test_refcount_release);
+	printf("last reference race: destroyed=%ld (expected %d)\n", (long)test_refcount_destroyed, TEST_REFCOUNT_OBJECTS);
+}
+
+#endif /* _TEST_REFCOUNT_H_ */
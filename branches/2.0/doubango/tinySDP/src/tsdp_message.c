@@ -230,8 +230,11 @@ char* tsdp_message_tostring(const tsdp_message_t *self)
 	tsk_buffer_t* output = tsk_buffer_create_null();
 	char* ret = tsk_null;
 
-	if(!tsdp_message_serialize(self, output)){
-		ret = tsk_strndup(TSK_BUFFER_DATA(output), TSK_BUFFER_SIZE(output));
+	// serialize in place and steal the null-terminated buffer instead of duplicating it
+	if(output && !tsdp_message_serialize(self, output) && !tsk_buffer_append(output, "\0", 1)){
+		ret = (char*)output->data;
+		output->data = tsk_null;
+		output->size = 0;
 	}
 
 	TSK_OBJECT_SAFE_FREE(output);
@@ -38,6 +38,17 @@
 
 static void _tcomp_compartment_freeState(tcomp_compartment_t *compartment, tcomp_state_t **lpState);
 
+/* Removes all local states from the shared index. The caller must lock the compartment. */
+static void _tcomp_compartment_unindexStates(tcomp_compartment_t *compartment)
+{
+	const tsk_list_item_t *item;
+	if(compartment->state_index){
+		tsk_list_foreach(item, compartment->local_states){
+			tcomp_stateindex_remove(compartment->state_index, compartment, (const tcomp_state_t*)item->data);
+		}
+	}
+}
+
 tcomp_compartment_t* tcomp_compartment_create(uint64_t id, uint32_t sigCompParameters, tsk_bool_t useOnlyACKedStates)
 {
 	tcomp_compartment_t *compartment;
@@ -187,6 +198,7 @@ void tcomp_compartment_clearStates(tcomp_compartment_t *compartment)
 
 	tsk_safeobj_lock(compartment);
 
+	_tcomp_compartment_unindexStates(compartment);
 	tsk_list_clear_items(compartment->local_states);
 	compartment->total_memory_left = compartment->total_memory_size;
 
@@ -238,6 +250,9 @@ void tcomp_compartment_freeStateByPriority(tcomp_compartment_t *compartment)
 
 	if(lpState){
 		compartment->total_memory_left += TCOMP_GET_STATE_SIZE(lpState);
+		if(compartment->state_index){
+			tcomp_stateindex_remove(compartment->state_index, compartment, lpState);
+		}
 		tsk_list_remove_item_by_data(compartment->local_states, lpState);
 	}
 
@@ -256,6 +271,9 @@ static void _tcomp_compartment_freeState(tcomp_compartment_t *compartment, tcomp
 	tsk_safeobj_lock(compartment);
 
 	compartment->total_memory_left += TCOMP_GET_STATE_SIZE(*lpState);
+	if(compartment->state_index){
+		tcomp_stateindex_remove(compartment->state_index, compartment, *lpState);
+	}
 	tsk_list_remove_item_by_data(compartment->local_states, *lpState);
 	*lpState = tsk_null;
 
@@ -347,6 +365,9 @@ void tcomp_compartment_addState(tcomp_compartment_t *compartment, tcomp_state_t
 	if(usage_count == 0){ // alread exist?
 		compartment->total_memory_left -= TCOMP_GET_STATE_SIZE(*lpState);
 		usage_count = tcomp_state_inc_usage_count(*lpState);
+		if(compartment->state_index){
+			tcomp_stateindex_add(compartment->state_index, compartment, *lpState);
+		}
 		tsk_list_push_back_data(compartment->local_states, ((void**) lpState));
 	}
 
@@ -525,7 +546,9 @@ static tsk_object_t* tcomp_compartment_dtor(tsk_object_t* self)
 		TSK_OBJECT_SAFE_FREE(compartment->nacks);
 
 		/* Delete local states */
+		_tcomp_compartment_unindexStates(compartment);
 		TSK_OBJECT_SAFE_FREE(compartment->local_states);
+		TSK_OBJECT_SAFE_FREE(compartment->state_index);
 	}
 	else{
 		TSK_DEBUG_ERROR("Null Compartment");
@@ -36,6 +36,7 @@
 #include "tcomp_params.h"
 #include "tcomp_compressordata.h"
 #include "tcomp_result.h"
+#include "tcomp_stateindex.h"
 
 #include "tsk_safeobj.h"
 #include "tsk_object.h"
@@ -57,6 +58,7 @@ typedef struct tcomp_compartment_s
 	tcomp_params_t *local_parameters;
 	uint32_t total_memory_size;
 	uint32_t total_memory_left;
+	tcomp_stateindex_t *state_index; /**< Index shared by all compartments of the state handler (could be null). */
 
 	tcomp_buffer_handle_t *lpReqFeedback;
 	tcomp_buffer_handle_t *lpRetFeedback;
@@ -66,6 +66,14 @@ tcomp_statehandler_t* tcomp_statehandler_create()
 			TSK_OBJECT_SAFE_FREE(statehandler);
 			goto bail;
 		}
+		if(!(statehandler->state_index = tcomp_stateindex_create())){
+			TSK_OBJECT_SAFE_FREE(statehandler);
+			goto bail;
+		}
+		if(!(statehandler->udvm_programs = tsk_list_create())){
+			TSK_OBJECT_SAFE_FREE(statehandler);
+			goto bail;
+		}
 		statehandler->sigcomp_parameters->SigComp_version = SIP_RFC5049_SIGCOMP_VERSION;
 #if TCOMP_USE_ONLY_ACKED_STATES
 		statehandler->useOnlyACKedStates = tsk_true;
@@ -109,6 +117,9 @@ tcomp_compartment_t *tcomp_statehandler_getCompartment(const tcomp_statehandler_
 	item_const = tsk_list_find_item_by_pred(statehandler->compartments, pred_find_compartment_by_id, &id);
 	if(!item_const || !(result = item_const->data)){
 		newcomp = tcomp_compartment_create(id, tcomp_params_getParameters(statehandler->sigcomp_parameters), statehandler->useOnlyACKedStates);
+		if(newcomp){
+			newcomp->state_index = tsk_object_ref(statehandler->state_index);
+		}
 		result = newcomp;
 		tsk_list_push_back_data(statehandler->compartments, ((void**) &newcomp));
 	}
@@ -167,14 +178,24 @@ uint32_t tcomp_statehandler_findState(tcomp_statehandler_t *statehandler, const
 		return 0;
 	}
 	
-	tsk_safeobj_lock(statehandler);
-
 	//
 	// Compartments
 	//
-	tsk_list_foreach(item, statehandler->compartments){
-		tcomp_compartment_t *compartment = item->data;
-		count += tcomp_compartment_findState(compartment, partial_identifier, lpState);
+	if(tcomp_buffer_getSize(partial_identifier) >= TCOMP_STATE_INDEX_KEY_LEN){
+		/* The index has its own lock => neither the state handler nor the compartments are locked */
+		if((count = tcomp_stateindex_find(statehandler->state_index, partial_identifier, lpState))){
+			return count;
+		}
+	}
+
+	tsk_safeobj_lock(statehandler);
+
+	if(tcomp_buffer_getSize(partial_identifier) < TCOMP_STATE_INDEX_KEY_LEN){
+		/* Too short to be indexed (not allowed by RFC 3320) */
+		tsk_list_foreach(item, statehandler->compartments){
+			tcomp_compartment_t *compartment = item->data;
+			count += tcomp_compartment_findState(compartment, partial_identifier, lpState);
+		}
 	}
 	
 	if(count){
@@ -449,7 +470,9 @@ static void* tcomp_statehandler_dtor(tsk_object_t *self)
 		TSK_OBJECT_SAFE_FREE(statehandler->sigcomp_parameters);
 
 		TSK_OBJECT_SAFE_FREE(statehandler->dictionaries);
-		TSK_OBJECT_SAFE_FREE(statehandler->compartments);		
+		TSK_OBJECT_SAFE_FREE(statehandler->compartments);
+		TSK_OBJECT_SAFE_FREE(statehandler->state_index);
+		TSK_OBJECT_SAFE_FREE(statehandler->udvm_programs);
 	}
 	else{
 		TSK_DEBUG_ERROR("Null SigComp state handler.");
@@ -39,6 +39,7 @@
 #include "tcomp_buffer.h"
 #include "tcomp_compartment.h"
 #include "tcomp_state.h"
+#include "tcomp_stateindex.h"
 
 #include "tsk_safeobj.h"
 #include "tsk_object.h"
@@ -52,6 +53,8 @@ typedef struct tcomp_statehandler_s
 	TSK_DECLARE_OBJECT;
 	
 	tcomp_compartments_L_t *compartments;
+	tcomp_stateindex_t *state_index; /**< States of all compartments, by partial identifier. */
+	tsk_list_t *udvm_programs; /**< Pre-decoded bytecode (@ref tcomp_udvm_program_t) shared by all decompressions. */
 	tcomp_params_t *sigcomp_parameters;
 	
 	tcomp_dictionaries_L_t *dictionaries;
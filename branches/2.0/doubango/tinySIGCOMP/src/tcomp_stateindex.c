@@ -0,0 +1,233 @@
+/*
+* Copyright (C) 2010-2011 Mamadou Diop.
+*
+* Contact: Mamadou Diop <diopmamadou(at)doubango[dot]org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tcomp_stateindex.c
+ * @brief  Index of the states saved in all compartments, keyed by partial state identifier.
+ * States are hashed on the first @ref TCOMP_STATE_INDEX_KEY_LEN bytes of their identifier (the shortest partial identifier allowed)
+ * which means a lookup only visits the states sharing the same bucket instead of all states of all compartments.
+ * Collisions (and longer partial identifiers) are disambiguated by comparing the whole partial identifier.
+ *
+ * @author Mamadou Diop <diopmamadou(at)yahoo.fr>
+ *
+
+ */
+#include "tcomp_stateindex.h"
+
+#include "tsk_memory.h"
+#include "tsk_debug.h"
+
+typedef struct tcomp_stateindex_entry_s
+{
+	tcomp_state_t *state; /* weak reference */
+	const void* owner; /* compartment */
+	uint32_t hash;
+	struct tcomp_stateindex_entry_s *next;
+}
+tcomp_stateindex_entry_t;
+
+/* FNV-1a */
+static uint32_t _tcomp_stateindex_hash(const uint8_t* key)
+{
+	tsk_size_t i;
+	uint32_t hash = 2166136261U;
+	for(i = 0; i < TCOMP_STATE_INDEX_KEY_LEN; ++i){
+		hash = (hash ^ key[i]) * 16777619U;
+	}
+	return hash;
+}
+
+static int _tcomp_stateindex_resize(tcomp_stateindex_t *index, tsk_size_t buckets_count)
+{
+	tsk_size_t i;
+	tcomp_stateindex_entry_t *entry, *next, **buckets;
+
+	if(!(buckets = (tcomp_stateindex_entry_t**)tsk_calloc(buckets_count, sizeof(tcomp_stateindex_entry_t*)))){
+		TSK_DEBUG_ERROR("Failed to allocate %u buckets", (unsigned)buckets_count);
+		return -1;
+	}
+	for(i = 0; i < index->buckets_count; ++i){
+		for(entry = index->buckets[i]; entry; entry = next){
+			next = entry->next;
+			entry->next = buckets[entry->hash & (buckets_count - 1)];
+			buckets[entry->hash & (buckets_count - 1)] = entry;
+		}
+	}
+	TSK_FREE(index->buckets);
+	index->buckets = buckets;
+	index->buckets_count = buckets_count;
+	return 0;
+}
+
+/**Creates new state index.
+*/
+tcomp_stateindex_t* tcomp_stateindex_create()
+{
+	tcomp_stateindex_t* index;
+	if((index = tsk_object_new(tcomp_stateindex_def_t))){
+		if(_tcomp_stateindex_resize(index, TCOMP_STATE_INDEX_BUCKETS_MIN)){
+			TSK_OBJECT_SAFE_FREE(index);
+		}
+	}
+	return index;
+}
+
+/**Adds a state. Must be called with a valid state (see @ref tcomp_state_makeValid).
+* @param index The index.
+* @param owner The compartment holding the state.
+* @param state The state to add.
+*/
+int tcomp_stateindex_add(tcomp_stateindex_t *index, const void* owner, tcomp_state_t *state)
+{
+	tcomp_stateindex_entry_t *entry;
+	tsk_size_t i;
+
+	if(!index || !state || tcomp_buffer_getSize(state->identifier) < TCOMP_STATE_INDEX_KEY_LEN){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	if(!(entry = (tcomp_stateindex_entry_t*)tsk_calloc(1, sizeof(tcomp_stateindex_entry_t)))){
+		TSK_DEBUG_ERROR("Failed to allocate new entry");
+		return -2;
+	}
+	entry->state = state;
+	entry->owner = owner;
+	entry->hash = _tcomp_stateindex_hash(tcomp_buffer_getReadOnlyBuffer(state->identifier));
+
+	tsk_safeobj_lock(index);
+	// keep the load factor under 2
+	if(index->count >= (index->buckets_count << 1)){
+		_tcomp_stateindex_resize(index, (index->buckets_count << 1));
+	}
+	i = entry->hash & (index->buckets_count - 1);
+	entry->next = index->buckets[i];
+	index->buckets[i] = entry;
+	++index->count;
+	tsk_safeobj_unlock(index);
+
+	return 0;
+}
+
+/**Removes a state previously added using @ref tcomp_stateindex_add.
+*/
+int tcomp_stateindex_remove(tcomp_stateindex_t *index, const void* owner, const tcomp_state_t *state)
+{
+	tcomp_stateindex_entry_t **entry, *found = tsk_null;
+
+	if(!index || !state || tcomp_buffer_getSize(state->identifier) < TCOMP_STATE_INDEX_KEY_LEN){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return -1;
+	}
+
+	tsk_safeobj_lock(index);
+	entry = &index->buckets[_tcomp_stateindex_hash(tcomp_buffer_getReadOnlyBuffer(state->identifier)) & (index->buckets_count - 1)];
+	for(; *entry; entry = &(*entry)->next){
+		if((*entry)->state == state && (*entry)->owner == owner){
+			found = *entry;
+			*entry = found->next;
+			--index->count;
+			break;
+		}
+	}
+	tsk_safeobj_unlock(index);
+
+	TSK_FREE(found);
+	return found ? 0 : -2;
+}
+
+/**Finds the states matching a partial identifier.
+* @param index The index.
+* @param partial_identifier The partial identifier. Should be at least @ref TCOMP_STATE_INDEX_KEY_LEN bytes long.
+* @param lpState The last matching state.
+* @retval The number of matching states.
+*/
+uint32_t tcomp_stateindex_find(tcomp_stateindex_t *index, const tcomp_buffer_handle_t *partial_identifier, tcomp_state_t **lpState)
+{
+	uint32_t count = 0;
+	const tcomp_stateindex_entry_t *entry;
+
+	if(!index || tcomp_buffer_getSize(partial_identifier) < TCOMP_STATE_INDEX_KEY_LEN){
+		TSK_DEBUG_ERROR("Invalid parameter");
+		return 0;
+	}
+
+	tsk_safeobj_lock(index);
+	for(entry = index->buckets[_tcomp_stateindex_hash(tcomp_buffer_getReadOnlyBuffer(partial_identifier)) & (index->buckets_count - 1)]; entry; entry = entry->next){
+		if(tcomp_buffer_startsWith(entry->state->identifier, partial_identifier)){
+			*lpState = entry->state; // override
+			count++;
+		}
+	}
+	tsk_safeobj_unlock(index);
+
+	return count;
+}
+
+
+
+
+
+
+
+//========================================================
+//	State index object definition
+//
+
+static tsk_object_t* tcomp_stateindex_ctor(tsk_object_t * self, va_list * app)
+{
+	tcomp_stateindex_t *index = self;
+	if(index){
+		/* Initialize safeobject */
+		tsk_safeobj_init(index);
+	}
+	return self;
+}
+
+static tsk_object_t* tcomp_stateindex_dtor(tsk_object_t * self)
+{
+	tcomp_stateindex_t *index = self;
+	if(index){
+		tsk_size_t i;
+		tcomp_stateindex_entry_t *entry, *next;
+
+		/* Deinitialize safeobject */
+		tsk_safeobj_deinit(index);
+
+		for(i = 0; i < index->buckets_count; ++i){
+			for(entry = index->buckets[i]; entry; entry = next){
+				next = entry->next;
+				TSK_FREE(entry);
+			}
+		}
+		TSK_FREE(index->buckets);
+	}
+	return self;
+}
+
+static const tsk_object_def_t tcomp_stateindex_def_s =
+{
+	sizeof(tcomp_stateindex_t),
+	tcomp_stateindex_ctor,
+	tcomp_stateindex_dtor,
+	tsk_null
+};
+const tsk_object_def_t *tcomp_stateindex_def_t = &tcomp_stateindex_def_s;
@@ -0,0 +1,74 @@
+/*
+* Copyright (C) 2010-2011 Mamadou Diop.
+*
+* Contact: Mamadou Diop <diopmamadou(at)doubango[dot]org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tcomp_stateindex.h
+ * @brief  Index of the states saved in all compartments, keyed by partial state identifier.
+ *
+ * @author Mamadou Diop <diopmamadou(at)yahoo.fr>
+ *
+
+ */
+#ifndef TCOMP_STATE_INDEX_H
+#define TCOMP_STATE_INDEX_H
+
+#include "tinysigcomp_config.h"
+
+#include "tcomp_state.h"
+
+#include "tsk_safeobj.h"
+#include "tsk_object.h"
+
+TCOMP_BEGIN_DECLS
+
+/**Minimum length of a partial state identifier (RFC 3320 - 9.4.5. STATE-ACCESS). The index is keyed on these bytes.
+*/
+#define TCOMP_STATE_INDEX_KEY_LEN			6
+#define TCOMP_STATE_INDEX_BUCKETS_MIN		64
+
+struct tcomp_stateindex_entry_s;
+
+/**State index.
+* Holds weak references to the states (the compartments own them) which means a state must be removed from the index before being released.
+*/
+typedef struct tcomp_stateindex_s
+{
+	TSK_DECLARE_OBJECT;
+
+	struct tcomp_stateindex_entry_s **buckets;
+	tsk_size_t buckets_count; /**< Always a power of 2. */
+	tsk_size_t count;
+
+	TSK_DECLARE_SAFEOBJ;
+}
+tcomp_stateindex_t;
+
+tcomp_stateindex_t* tcomp_stateindex_create();
+
+int tcomp_stateindex_add(tcomp_stateindex_t *index, const void* owner, tcomp_state_t *state);
+int tcomp_stateindex_remove(tcomp_stateindex_t *index, const void* owner, const tcomp_state_t *state);
+uint32_t tcomp_stateindex_find(tcomp_stateindex_t *index, const tcomp_buffer_handle_t *partial_identifier, tcomp_state_t **lpState);
+
+TINYSIGCOMP_GEXTERN const tsk_object_def_t *tcomp_stateindex_def_t;
+
+TCOMP_END_DECLS
+
+#endif /* TCOMP_STATE_INDEX_H */
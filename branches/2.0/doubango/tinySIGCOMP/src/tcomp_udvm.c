@@ -106,6 +106,8 @@ tcomp_udvm_t* tcomp_udvm_create(tcomp_message_t* _sigCompMessage, tcomp_statehan
 			TCOMP_UDVM_SET_2BYTES_VAL(TCOMP_UDVM_HEADER_STATE_LENGTH_INDEX, tcomp_buffer_getSize(lpState->value));
 			
 			udvm->executionPointer = lpState->instruction;
+			udvm->bytecode.start = lpState->address;
+			udvm->bytecode.size = (uint32_t)tcomp_buffer_getSize(lpState->value);
 		}
 		else // DON'T HAVE STATE
 		{
@@ -124,6 +126,8 @@ tcomp_udvm_t* tcomp_udvm_create(tcomp_message_t* _sigCompMessage, tcomp_statehan
 
 			// Set pointer indicating execution index
 			udvm->executionPointer = bytecodes_destination;
+			udvm->bytecode.start = (uint32_t)bytecodes_destination;
+			udvm->bytecode.size = (uint32_t)tcomp_buffer_getSize(udvm->sigCompMessage->uploaded_UDVM_buffer);
 		}
 
 		/* RFC 3320-Section_8.6.  UDVM Cycles
@@ -155,15 +159,30 @@ static tsk_bool_t tcomp_udvm_runByteCode(tcomp_udvm_t *udvm)
 {
 	uint32_t operand_1, operand_2, operand_3, operand_4, operand_5, operand_6, operand_7;
 	tsk_bool_t excution_failed = tsk_false, end_message = tsk_false;
+	tcomp_udvm_program_t* program = tsk_null;
 	if(!udvm->isOK) {
 		TSK_DEBUG_ERROR("Cannot run()/execute() invalid bytecode");
 		return tsk_false;
 	}
 
+#if TCOMP_UDVM_PREDECODE
+	program = tcomp_udvm_program_get(udvm);
+#endif
+
 	// LOOP - EXCUTE all bytecode
 	while( !excution_failed && !end_message )
 	{
-		uint8_t udvm_instruction = * (TCOMP_UDVM_GET_BUFFER_AT(udvm->executionPointer));
+		uint8_t udvm_instruction;
+
+		if(program){
+			/* Execute the pre-decoded instructions until reaching one which is not (e.g. modified or outside the bytecode) */
+			tcomp_udvm_program_run(udvm, program, &excution_failed, &end_message);
+			if(excution_failed || end_message){
+				break;
+			}
+		}
+
+		udvm_instruction = * (TCOMP_UDVM_GET_BUFFER_AT(udvm->executionPointer));
 		udvm->last_memory_address_of_instruction = udvm->executionPointer;
 		udvm->executionPointer++; /* Skip the 1-byte [INSTRUCTION]. */
 
@@ -487,6 +506,7 @@ static tsk_bool_t tcomp_udvm_runByteCode(tcomp_udvm_t *udvm)
 	}
 
 bail:
+	TSK_OBJECT_SAFE_FREE(program);
 	udvm->lpResult->consumed_cycles = udvm->consumed_cycles;
 	return (!excution_failed);
 }
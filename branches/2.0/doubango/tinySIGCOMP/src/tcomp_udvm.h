@@ -59,6 +59,47 @@ TCOMP_BEGIN_DECLS
 #define TCOMP_UDVM_GET_BUFFER()				tcomp_buffer_getBuffer(udvm->memory)
 #define TCOMP_UDVM_GET_BUFFER_AT(position)	tcomp_buffer_getBufferAtPos(udvm->memory, position)
 
+#define TCOMP_UDVM_OPERAND_TYPE_VALUE			0 /**< The operand value is known at decoding time. */
+#define TCOMP_UDVM_OPERAND_TYPE_MEMORY			1 /**< The operand value is memory[value]. */
+#define TCOMP_UDVM_OPERAND_TYPE_MEMORY_ADDRESS	2 /**< The operand value is (memory_address_of_instruction + memory[value]) modulo 2^16. */
+
+/**Pre-decoded UDVM operand.
+*/
+typedef struct tcomp_udvm_operand_s
+{
+	uint16_t value;
+	uint8_t type;
+}
+tcomp_udvm_operand_t;
+
+/**Pre-decoded UDVM instruction (opcode and fixed operands). Variable-length operands (e.g. MULTILOAD values) are still read from the UDVM memory.
+*/
+typedef struct tcomp_udvm_predecoded_s
+{
+	unsigned valid:1;
+	uint8_t opcode;
+	uint8_t length; /**< Size of the opcode and of the fixed operands. */
+	uint32_t max_memory_address; /**< Highest memory address read by the operands (must be < UDVM memory size). */
+	tcomp_udvm_operand_t operands[7];
+}
+tcomp_udvm_predecoded_t;
+
+/**Bytecode pre-decoded at each possible instruction address. Immutable once created which means it could be shared by all UDVM machines.
+*/
+typedef struct tcomp_udvm_program_s
+{
+	TSK_DECLARE_OBJECT;
+
+	uint32_t hash;
+	uint32_t start; /**< UDVM memory address where the bytecode is loaded. */
+	uint32_t size;
+	uint8_t* code;
+	tcomp_udvm_predecoded_t* instructions; /**< One per byte of code. */
+}
+tcomp_udvm_program_t;
+
+typedef tsk_list_t tcomp_udvm_programs_L_t; /**< List of @ref tcomp_udvm_program_t elements. */
+
 typedef struct tcomp_udvm_s
 {
 	TSK_DECLARE_OBJECT;
@@ -77,6 +118,12 @@ typedef struct tcomp_udvm_s
 	uint32_t executionPointer;
 	uint32_t last_memory_address_of_instruction;
 
+	/* bytecode loaded at creation (uploaded or from state) */
+	struct{
+		uint32_t start;
+		uint32_t size;
+	} bytecode;
+
 	struct{
 		void* ptr;
 		tsk_size_t size;
@@ -96,6 +143,12 @@ uint32_t tcomp_udvm_opget_reference_param(tcomp_udvm_t *udvm);
 uint32_t tcomp_udvm_opget_multitype_param(tcomp_udvm_t *udvm);
 uint32_t tcomp_udvm_opget_address_param(tcomp_udvm_t *udvm, uint32_t memory_address_of_instruction);
 
+/*
+* Pre-decoded bytecode
+*/
+tcomp_udvm_program_t* tcomp_udvm_program_get(tcomp_udvm_t *udvm);
+void tcomp_udvm_program_run(tcomp_udvm_t *udvm, const tcomp_udvm_program_t* program, tsk_bool_t *excution_failed, tsk_bool_t *end_message);
+
 /*
 * ByteCopy
 */
@@ -162,6 +215,7 @@ tsk_bool_t TCOMP_UDVM_EXEC_INST__END_MESSAGE(tcomp_udvm_t *udvm, uint32_t reques
 
 
 TINYSIGCOMP_GEXTERN const tsk_object_def_t *tcomp_udvm_def_t;
+TINYSIGCOMP_GEXTERN const tsk_object_def_t *tcomp_udvm_program_def_t;
 
 TCOMP_END_DECLS
 
@@ -0,0 +1,487 @@
+/*
+* Copyright (C) 2010-2011 Mamadou Diop.
+*
+* Contact: Mamadou Diop <diopmamadou(at)doubango[dot]org>
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+
+/**@file tcomp_udvm.predecode.c
+ * @brief  SigComp UDVM machine (pre-decoded bytecode).
+ * The same decompressor bytecode is uploaded (or accessed from state) again and again. Instead of decoding the operands of each
+ * instruction every time it's executed, the bytecode is decoded once at every address and cached in the state handler (keyed by its hash).
+ * As the bytecode could modify itself, a pre-decoded instruction is only used if its bytes are still the same in the UDVM memory,
+ * otherwise the instruction is interpreted as usual (see @ref tcomp_udvm_decompress).
+ *
+ * @author Mamadou Diop <diopmamadou(at)yahoo.fr>
+ *
+
+ */
+#include "tcomp_udvm.h"
+#include "tcomp_operands.h"
+
+#include "tsk_ppfcs32.h"
+#include "tsk_memory.h"
+#include "tsk_debug.h"
+
+#include <string.h>
+
+/* RFC 3320 - 9. UDVM Instruction Set: fixed operands of each instruction using the RFC notation
+* (# literal, $ reference, % multitype, @ address). The variable operands (MULTILOAD, SWITCH, INPUT-HUFFMAN, PUSH, POP and JUMP)
+* are read by the instructions themselves.
+*/
+static const char* __tcomp_udvm_operands[TCOMP_UDVM_INST__END_MESSAGE + 1] =
+{
+	"", /* DECOMPRESSION-FAILURE */
+	"$%", /* AND */
+	"$%", /* OR */
+	"$", /* NOT */
+	"$%", /* LSHIFT */
+	"$%", /* RSHIFT */
+	"$%", /* ADD */
+	"$%", /* SUBTRACT */
+	"$%", /* MULTIPLY */
+	"$%", /* DIVIDE */
+	"$%", /* REMAINDER */
+	"%%%", /* SORT-ASCENDING */
+	"%%%", /* SORT-DESCENDING */
+	"%%%", /* SHA-1 */
+	"%%", /* LOAD */
+	"%#", /* MULTILOAD */
+	"", /* PUSH */
+	"", /* POP */
+	"%%%", /* COPY */
+	"%%$", /* COPY-LITERAL */
+	"%%$", /* COPY-OFFSET */
+	"%%%%", /* MEMSET */
+	"", /* JUMP */
+	"%%@@@", /* COMPARE */
+	"@", /* CALL */
+	"", /* RETURN */
+	"#%", /* SWITCH */
+	"%%%$", /* CRC */
+	"%%@", /* INPUT-BYTES */
+	"%%@", /* INPUT-BITS */
+	"%@#", /* INPUT-HUFFMAN */
+	"%%%%%%", /* STATE-ACCESS */
+	"%%%%%", /* STATE-CREATE */
+	"%%", /* STATE-FREE */
+	"%%", /* OUTPUT */
+	"%%%%%%%", /* END-MESSAGE */
+};
+
+/* Same encodings as tcomp_udvm_opget_*_param() */
+static tsk_bool_t _tcomp_udvm_decode_operand(const uint8_t* code, uint32_t size, uint32_t *pos, char type, uint32_t memory_address_of_instruction, tcomp_udvm_operand_t* operand)
+{
+	const uint8_t* ptr = code + *pos;
+	uint32_t length = 1;
+
+	if(*pos >= size){
+		return tsk_false;
+	}
+	operand->type = TCOMP_UDVM_OPERAND_TYPE_VALUE;
+
+	switch(type){
+		case '#': /* literal */
+		case '$': /* reference */
+			{
+				switch(*ptr & 0xc0){
+					case 0x00:
+					case 0x40:
+						operand->value = (type == '#') ? *ptr : (2 * (*ptr & 0x7f));
+						break;
+					case 0x80:
+						if((length = 2) + *pos > size){
+							return tsk_false;
+						}
+						operand->value = (type == '#') ? (TSK_BINARY_GET_2BYTES(ptr) & 0x3fff) : (2 * (TSK_BINARY_GET_2BYTES(ptr) & 0x3fff));
+						break;
+					default:
+						if((length = 3) + *pos > size){
+							return tsk_false;
+						}
+						operand->value = TSK_BINARY_GET_2BYTES(ptr + 1);
+						break;
+				}
+				break;
+			}
+		case '%': /* multitype */
+		case '@': /* address */
+			{
+				switch(operand_multitype_indexes[*ptr]){
+					case 1: operand->value = *ptr; break;
+					case 2: operand->value = 2 * (*ptr & 0x3f); operand->type = TCOMP_UDVM_OPERAND_TYPE_MEMORY; break;
+					case 3: operand->value = (1 << ((*ptr & 0x01) + 6)); break;
+					case 4: operand->value = (1 << ((*ptr & 0x07) + 8)); break;
+					case 5: operand->value = (*ptr & 0x1f) + 65504; break;
+					case 6: case 7: case 8:
+						{
+							if((length = 2) + *pos > size){
+								return tsk_false;
+							}
+							switch(operand_multitype_indexes[*ptr]){
+								case 6: operand->value = (TSK_BINARY_GET_2BYTES(ptr) & 0x0fff) + 61440; break;
+								case 7: operand->value = (TSK_BINARY_GET_2BYTES(ptr) & 0x1fff); break;
+								default: operand->value = (TSK_BINARY_GET_2BYTES(ptr) & 0x1fff); operand->type = TCOMP_UDVM_OPERAND_TYPE_MEMORY; break;
+							}
+							break;
+						}
+					case 9: case 10:
+						{
+							if((length = 3) + *pos > size){
+								return tsk_false;
+							}
+							operand->value = TSK_BINARY_GET_2BYTES(ptr + 1);
+							if(operand_multitype_indexes[*ptr] == 10){
+								operand->type = TCOMP_UDVM_OPERAND_TYPE_MEMORY;
+							}
+							break;
+						}
+					default:
+						/* invalid operand: let the interpreter raise the NACK */
+						return tsk_false;
+				}
+				if(type == '@'){
+					if(operand->type == TCOMP_UDVM_OPERAND_TYPE_MEMORY){
+						operand->type = TCOMP_UDVM_OPERAND_TYPE_MEMORY_ADDRESS;
+					}
+					else{
+						operand->value = (uint16_t)((memory_address_of_instruction + operand->value) % 65536);
+					}
+				}
+				break;
+			}
+		default:
+			return tsk_false;
+	}
+
+	*pos += length;
+	return tsk_true;
+}
+
+static void _tcomp_udvm_decode_instruction(const tcomp_udvm_program_t* program, uint32_t offset, tcomp_udvm_predecoded_t* instruction)
+{
+	const char* operands;
+	uint32_t pos = offset + 1, i;
+
+	memset(instruction, 0, sizeof(*instruction));
+	if((instruction->opcode = program->code[offset]) > TCOMP_UDVM_INST__END_MESSAGE){
+		return;
+	}
+	for(i = 0, operands = __tcomp_udvm_operands[instruction->opcode]; operands[i]; ++i){
+		tcomp_udvm_operand_t* operand = &instruction->operands[i];
+		if(!_tcomp_udvm_decode_operand(program->code, program->size, &pos, operands[i], (program->start + offset), operand)){
+			return;
+		}
+		if(operand->type != TCOMP_UDVM_OPERAND_TYPE_VALUE && (uint32_t)(operand->value + 1) > instruction->max_memory_address){
+			instruction->max_memory_address = (operand->value + 1);
+		}
+	}
+	instruction->length = (uint8_t)(pos - offset);
+	instruction->valid = 1;
+}
+
+static tcomp_udvm_program_t* _tcomp_udvm_program_create(const uint8_t* code, uint32_t start, uint32_t size, uint32_t hash)
+{
+	tcomp_udvm_program_t* program;
+	uint32_t offset;
+
+	if(!(program = tsk_object_new(tcomp_udvm_program_def_t))){
+		return tsk_null;
+	}
+	if(!(program->code = tsk_malloc(size)) || !(program->instructions = tsk_calloc(size, sizeof(tcomp_udvm_predecoded_t)))){
+		TSK_OBJECT_SAFE_FREE(program);
+		return tsk_null;
+	}
+	memcpy(program->code, code, size);
+	program->start = start;
+	program->size = size;
+	program->hash = hash;
+
+	/* data and code could be mixed and any address could be a jump target => decode at each address */
+	for(offset = 0; offset < size; ++offset){
+		_tcomp_udvm_decode_instruction(program, offset, &program->instructions[offset]);
+	}
+
+	return program;
+}
+
+/**Gets the pre-decoded version of the bytecode loaded in the UDVM memory (from the cache or newly created).
+* @retval The program (must be released by the caller) or @a tsk_null if the bytecode cannot be pre-decoded.
+*/
+tcomp_udvm_program_t* tcomp_udvm_program_get(tcomp_udvm_t *udvm)
+{
+	tcomp_udvm_program_t* program = tsk_null;
+	tsk_list_t* programs;
+	const tsk_list_item_t* item;
+	const uint8_t* code;
+	uint32_t hash, count = 0;
+
+	if(!udvm || !udvm->stateHandler || !(programs = udvm->stateHandler->udvm_programs)){
+		return tsk_null;
+	}
+	if(!udvm->bytecode.size || udvm->bytecode.size > TCOMP_UDVM_PROGRAM_MAX_SIZE || (udvm->bytecode.start + udvm->bytecode.size) > TCOMP_UDVM_GET_SIZE()){
+		return tsk_null;
+	}
+	code = TCOMP_UDVM_GET_BUFFER_AT(udvm->bytecode.start);
+	hash = tsk_pppfcs32(TSK_PPPINITFCS32, code, (int32_t)udvm->bytecode.size);
+
+	tsk_list_lock(programs);
+	tsk_list_foreach(item, programs){
+		const tcomp_udvm_program_t* curr = (const tcomp_udvm_program_t*)item->data;
+		if(curr->hash == hash && curr->start == udvm->bytecode.start && curr->size == udvm->bytecode.size && !memcmp(curr->code, code, curr->size)){
+			program = tsk_object_ref((tsk_object_t*)curr);
+			break;
+		}
+		++count;
+	}
+	if(!program && (program = _tcomp_udvm_program_create(code, udvm->bytecode.start, udvm->bytecode.size, hash))){
+		tcomp_udvm_program_t* cached = tsk_object_ref(program);
+		if(count >= TCOMP_UDVM_PROGRAMS_MAX_COUNT){
+			tsk_list_remove_first_item(programs);
+		}
+		tsk_list_push_back_data(programs, (void**)&cached);
+	}
+	tsk_list_unlock(programs);
+
+	return program;
+}
+
+static TCOMP_INLINE const tcomp_udvm_predecoded_t* _tcomp_udvm_program_fetch(tcomp_udvm_t *udvm, const tcomp_udvm_program_t* program)
+{
+	const tcomp_udvm_predecoded_t* instruction;
+	uint32_t offset = (udvm->executionPointer - program->start);
+
+	if(offset >= program->size){
+		return tsk_null;
+	}
+	instruction = &program->instructions[offset];
+	if(!instruction->valid || instruction->max_memory_address > TCOMP_UDVM_GET_SIZE()
+		|| memcmp(TCOMP_UDVM_GET_BUFFER_AT(udvm->executionPointer), &program->code[offset], instruction->length)){
+		return tsk_null;
+	}
+	return instruction;
+}
+
+static TCOMP_INLINE uint32_t _tcomp_udvm_operand_get(tcomp_udvm_t *udvm, const tcomp_udvm_operand_t* operand)
+{
+	switch(operand->type){
+		case TCOMP_UDVM_OPERAND_TYPE_VALUE: return operand->value;
+		case TCOMP_UDVM_OPERAND_TYPE_MEMORY: return TCOMP_UDVM_GET_2BYTES_VAL(operand->value);
+		default: return ((udvm->last_memory_address_of_instruction + TCOMP_UDVM_GET_2BYTES_VAL(operand->value)) % 65536);
+	}
+}
+
+#define TCOMP_UDVM_OP(index)	_tcomp_udvm_operand_get(udvm, &instruction->operands[index])
+
+#define TCOMP_UDVM_FETCH() \
+	if(!(instruction = _tcomp_udvm_program_fetch(udvm, program))){ \
+		return; \
+	} \
+	udvm->last_memory_address_of_instruction = udvm->executionPointer; \
+	udvm->executionPointer += instruction->length
+
+#define TCOMP_UDVM_EXEC(inst) \
+	if(!(inst)){ \
+		TSK_DEBUG_ERROR("Execution failed for instruction = %s", TCOMP_INST_DESCRIPTIONS[instruction->opcode].desc); \
+		*excution_failed = tsk_true; \
+		return; \
+	}
+
+#if TCOMP_UDVM_HAVE_COMPUTED_GOTO
+#	define TCOMP_UDVM_CASE(name)	L_##name
+#	define TCOMP_UDVM_NEXT()		TCOMP_UDVM_FETCH(); goto *labels[instruction->opcode]
+#else
+#	define TCOMP_UDVM_CASE(name)	case TCOMP_UDVM_INST__##name
+#	define TCOMP_UDVM_NEXT()		goto next
+#endif
+
+/**Executes pre-decoded instructions from the current execution pointer.
+* Returns when the execution fails or ends or when the next instruction is not available pre-decoded (the caller must then interpret it).
+*/
+void tcomp_udvm_program_run(tcomp_udvm_t *udvm, const tcomp_udvm_program_t* program, tsk_bool_t *excution_failed, tsk_bool_t *end_message)
+{
+	const tcomp_udvm_predecoded_t* instruction;
+#if TCOMP_UDVM_HAVE_COMPUTED_GOTO
+	/* Threaded dispatch: each instruction jumps directly to the next one */
+	static const void* labels[TCOMP_UDVM_INST__END_MESSAGE + 1] =
+	{
+		&&L_DECOMPRESSION_FAILURE, &&L_AND, &&L_OR, &&L_NOT, &&L_LSHIFT, &&L_RSHIFT, &&L_ADD, &&L_SUBTRACT, &&L_MULTIPLY, &&L_DIVIDE,
+		&&L_REMAINDER, &&L_SORT_ASCENDING, &&L_SORT_DESCENDING, &&L_SHA_1, &&L_LOAD, &&L_MULTILOAD, &&L_PUSH, &&L_POP, &&L_COPY,
+		&&L_COPY_LITERAL, &&L_COPY_OFFSET, &&L_MEMSET, &&L_JUMP, &&L_COMPARE, &&L_CALL, &&L_RETURN, &&L_SWITCH, &&L_CRC,
+		&&L_INPUT_BYTES, &&L_INPUT_BITS, &&L_INPUT_HUFFMAN, &&L_STATE_ACCESS, &&L_STATE_CREATE, &&L_STATE_FREE, &&L_OUTPUT, &&L_END_MESSAGE
+	};
+
+	TCOMP_UDVM_FETCH();
+	goto *labels[instruction->opcode];
+#else
+next:
+	TCOMP_UDVM_FETCH();
+	switch(instruction->opcode)
+#endif
+	{
+		TCOMP_UDVM_CASE(DECOMPRESSION_FAILURE):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__DECOMPRESSION_FAILURE(udvm));
+			*excution_failed = tsk_true;
+			return;
+		TCOMP_UDVM_CASE(AND):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__AND(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(OR):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__OR(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(NOT):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__NOT(udvm, TCOMP_UDVM_OP(0)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(LSHIFT):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__LSHIFT(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(RSHIFT):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__RSHIFT(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(ADD):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__ADD(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(SUBTRACT):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__SUBTRACT(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(MULTIPLY):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__MULTIPLY(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(DIVIDE):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__DIVIDE(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(REMAINDER):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__REMAINDER(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(SORT_ASCENDING):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__SORT_ASCENDING(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(SORT_DESCENDING):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__SORT_DESCENDING(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(SHA_1):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__SHA_1(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(LOAD):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__LOAD(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(MULTILOAD):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__MULTILOAD(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(PUSH):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__PUSH2(udvm));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(POP):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__POP2(udvm));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(COPY):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__COPY(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(COPY_LITERAL):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__COPY_LITERAL(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(COPY_OFFSET):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__COPY_OFFSET(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(MEMSET):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__MEMSET(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2), TCOMP_UDVM_OP(3)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(JUMP):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__JUMP2(udvm));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(COMPARE):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__COMPARE(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2), TCOMP_UDVM_OP(3), TCOMP_UDVM_OP(4)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(CALL):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__CALL(udvm, TCOMP_UDVM_OP(0)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(RETURN):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__RETURN(udvm));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(SWITCH):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__SWITCH(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(CRC):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__CRC(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2), TCOMP_UDVM_OP(3)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(INPUT_BYTES):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__INPUT_BYTES(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(INPUT_BITS):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__INPUT_BITS(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(INPUT_HUFFMAN):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__INPUT_HUFFMAN(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(STATE_ACCESS):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__STATE_ACCESS(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2), TCOMP_UDVM_OP(3), TCOMP_UDVM_OP(4), TCOMP_UDVM_OP(5)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(STATE_CREATE):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__STATE_CREATE(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2), TCOMP_UDVM_OP(3), TCOMP_UDVM_OP(4)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(STATE_FREE):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__STATE_FREE(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(OUTPUT):
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__OUTPUT(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1)));
+			TCOMP_UDVM_NEXT();
+		TCOMP_UDVM_CASE(END_MESSAGE):
+			*end_message = tsk_true;
+			TCOMP_UDVM_EXEC(TCOMP_UDVM_EXEC_INST__END_MESSAGE(udvm, TCOMP_UDVM_OP(0), TCOMP_UDVM_OP(1), TCOMP_UDVM_OP(2), TCOMP_UDVM_OP(3), TCOMP_UDVM_OP(4), TCOMP_UDVM_OP(5), TCOMP_UDVM_OP(6)));
+			return;
+#if !TCOMP_UDVM_HAVE_COMPUTED_GOTO
+		default:
+			return;
+#endif
+	}
+}
+
+
+
+
+
+
+//========================================================
+//	UDVM program definition
+//
+static tsk_object_t* tcomp_udvm_program_ctor(tsk_object_t * self, va_list * app)
+{
+	tcomp_udvm_program_t *program = self;
+	if(program){
+	}
+	return self;
+}
+
+static tsk_object_t* tcomp_udvm_program_dtor(tsk_object_t *self)
+{
+	tcomp_udvm_program_t *program = self;
+	if(program){
+		TSK_FREE(program->code);
+		TSK_FREE(program->instructions);
+	}
+	return self;
+}
+
+static const tsk_object_def_t tcomp_udvm_program_def_s =
+{
+	sizeof(tcomp_udvm_program_t),
+	tcomp_udvm_program_ctor,
+	tcomp_udvm_program_dtor,
+	tsk_null
+};
+const tsk_object_def_t *tcomp_udvm_program_def_t = &tcomp_udvm_program_def_s;
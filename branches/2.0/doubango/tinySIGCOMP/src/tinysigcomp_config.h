@@ -82,6 +82,27 @@
 #	define TCOMP_USE_ONLY_ACKED_STATES	0
 #endif
 
+//
+//	UDVM - pre-decoded bytecode (see tcomp_udvm.predecode.c)
+//
+#if !defined(TCOMP_UDVM_PREDECODE)
+#	define TCOMP_UDVM_PREDECODE			1
+#endif
+#if !defined(TCOMP_UDVM_PROGRAMS_MAX_COUNT)
+#	define TCOMP_UDVM_PROGRAMS_MAX_COUNT	8 /* per state handler */
+#endif
+#if !defined(TCOMP_UDVM_PROGRAM_MAX_SIZE)
+#	define TCOMP_UDVM_PROGRAM_MAX_SIZE		4096 /* bytecode larger than this is always interpreted */
+#endif
+/* Threaded dispatch (labels as values) */
+#if !defined(TCOMP_UDVM_HAVE_COMPUTED_GOTO)
+#	if defined(__GNUC__)
+#		define TCOMP_UDVM_HAVE_COMPUTED_GOTO	1
+#	else
+#		define TCOMP_UDVM_HAVE_COMPUTED_GOTO	0
+#	endif
+#endif
+
 /* Disable some well-known warnings
 */
 #ifdef _MSC_VER
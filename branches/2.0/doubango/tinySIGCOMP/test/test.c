@@ -32,10 +32,12 @@
 #include "test_manager.h"
 #include "test_osc.h"
 #include "test_tortures.h"
+#include "test_benchmark.h"
 
 #define TEST_TORTURES	1
 #define TEST_MANAGER	0
 #define TEST_OSC		0
+#define TEST_BENCHMARK	0
 
 #ifdef _WIN32_WCE
 int _tmain(int argc, _TCHAR* argv[])
@@ -54,6 +56,10 @@ int main()
 #if TEST_OSC
 	test_osc();
 #endif
+
+#if TEST_BENCHMARK
+	test_benchmark();
+#endif
 	
 	getchar();
 
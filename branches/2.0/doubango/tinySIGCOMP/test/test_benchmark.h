@@ -0,0 +1,310 @@
+/*
+* Copyright (C) 2009 Mamadou Diop.
+* Copyright (C) 2012 Doubango Telecom <http://doubango.org>.
+*
+* This file is part of Open Source Doubango Framework.
+*
+* DOUBANGO is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* DOUBANGO is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with DOUBANGO.
+*
+*/
+#ifndef TEST_TINYSIGCOMP_BENCHMARK_H
+#define TEST_TINYSIGCOMP_BENCHMARK_H
+
+/* Replays SIP/SDP and presence traffic through compress -> decompress using many compartments and reports the throughput.
+* Allocations/message are only reported when tinySAK is built with TSK_MEMORY_STATS=1.
+* Each compartment is a client/server pair of managers (like two endpoints): identical states replayed in several compartments
+* must not be shared. Any compression or decompression failure aborts the benchmark.
+*/
+
+#include "tsk_time.h"
+#include "tsk_memory.h"
+
+#define BENCHMARK_ROUNDS				10
+#define BENCHMARK_COMPARTMENT_ID_CLIENT	"urn:uuid:2e5fdc76-00be-4314-8202-1116fa82a474-%u"
+#define BENCHMARK_COMPARTMENT_ID_SERVER	"urn:uuid:2e5fdc76-00be-4314-8202-1116fa82a475-%u"
+
+static const tsk_size_t BENCHMARK_COMPARTMENTS[] = { 1, 10, 100 };
+static const uint32_t BENCHMARK_DMS[] = { 4096, 8192, 16384 };
+
+static const sigcomp_test_t SIGCOMP_TESTS_PRESENCE[]=
+{
+	{
+		"PUBLISH (client -> server)",
+		"PUBLISH sip:johndoe@test.3gpp.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP 192.168.0.11:64549;branch=z9hG4bK1491780557;rport;comp=sigcomp;sigcomp-id=\"urn:uuid:d343a50a-2961-4a25-93d8-4e0677b68e6b\"\r\n"
+		"From: <sip:johndoe@test.3gpp.com>;tag=1491780556\r\n"
+		"To: <sip:johndoe@test.3gpp.com>\r\n"
+		"Contact: <sip:johndoe@192.168.0.11:64549;transport=udp;sigcomp-id=urn:uuid:d343a50a-2961-4a25-93d8-4e0677b68e6b>\r\n"
+		"Call-ID: 7c5bd2b1-74fc-4ab2-a00b-b9c4c6d0e0a3\r\n"
+		"CSeq: 1793 PUBLISH\r\n"
+		"Content-Type: application/pidf+xml\r\n"
+		"Max-Forwards: 70\r\n"
+		"Event: presence\r\n"
+		"Expires: 600000\r\n"
+		"SIP-If-Match: ac7a8gh0jx\r\n"
+		"P-Access-Network-Info: ADSL;utran-cell-id-3gpp=00000000\r\n"
+		"User-Agent: IM-client/OMA1.0 Boghe/v2.0.132.808\r\n"
+		"P-Preferred-Identity: <sip:johndoe@test.3gpp.com>\r\n"
+		"Content-Length: 551\r\n"
+		"\r\n"
+		"<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
+		"<presence xmlns:cp=\"urn:ietf:params:xml:ns:pidf:cipid\" xmlns:caps=\"urn:ietf:params:xml:ns:pidf:caps\" xmlns:rpid=\"urn:ietf:params:xml:ns:pidf:rpid\" xmlns:pdm=\"urn:ietf:params:xml:ns:pidf:data-model\" xmlns:p=\"urn:ietf:params:xml:ns:pidf-diff\" xmlns:op=\"urn:oma:xml:prs:pidf:oma-pres\" entity=\"sip:johndoe@test.3gpp.com\" xmlns=\"urn:ietf:params:xml:ns:pidf\">\r\n"
+		"<pdm:person id=\"HIGIRCKD\"><op:overriding-willingness><op:basic>open</op:basic></op:overriding-willingness><rpid:activities><rpid:busy /></rpid:activities></pdm:person>\r\n"
+		"</presence>",
+		IS_CLIENT_YES,
+		TOBE_LOST_NO
+	},
+	{
+		"200 PUBLISH (server -> client)",
+		"SIP/2.0 200 OK\r\n"
+		"Via: SIP/2.0/UDP 192.168.0.11:64549;branch=z9hG4bK1491780557;rport=64549;comp=sigcomp;sigcomp-id=\"urn:uuid:d343a50a-2961-4a25-93d8-4e0677b68e6b\"\r\n"
+		"From: <sip:johndoe@test.3gpp.com>;tag=1491780556\r\n"
+		"To: <sip:johndoe@test.3gpp.com>;tag=3241039211\r\n"
+		"Call-ID: 7c5bd2b1-74fc-4ab2-a00b-b9c4c6d0e0a3\r\n"
+		"CSeq: 1793 PUBLISH\r\n"
+		"Expires: 600000\r\n"
+		"SIP-ETag: ac7a8gh0jx\r\n"
+		"Content-Length: 0\r\n"
+		"\r\n",
+		IS_CLIENT_NO,
+		TOBE_LOST_NO
+	},
+	{
+		"NOTIFY (server -> client)",
+		"NOTIFY sip:johndoe@192.168.0.11:64549;transport=udp;sigcomp-id=urn:uuid:d343a50a-2961-4a25-93d8-4e0677b68e6b SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP 192.168.0.12:5060;branch=z9hG4bK3241039212;comp=sigcomp\r\n"
+		"From: <sip:bob@test.3gpp.com>;tag=3241039210\r\n"
+		"To: <sip:johndoe@test.3gpp.com>;tag=2106713218\r\n"
+		"Call-ID: 5e4a9f52-c4b7-4d6b-9f37-2d44ee0b6a2f\r\n"
+		"CSeq: 11 NOTIFY\r\n"
+		"Contact: <sip:bob@192.168.0.12:5060;comp=sigcomp>\r\n"
+		"Max-Forwards: 70\r\n"
+		"Event: presence\r\n"
+		"Subscription-State: active;expires=3600\r\n"
+		"Content-Type: application/pidf+xml\r\n"
+		"Content-Length: 489\r\n"
+		"\r\n"
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+		"<presence xmlns=\"urn:ietf:params:xml:ns:pidf\" xmlns:pdm=\"urn:ietf:params:xml:ns:pidf:data-model\" xmlns:rpid=\"urn:ietf:params:xml:ns:pidf:rpid\" entity=\"sip:bob@test.3gpp.com\">\r\n"
+		"<tuple id=\"a8098a\"><status><basic>open</basic></status><contact priority=\"0.8\">sip:bob@192.168.0.12</contact><timestamp>2012-04-30T22:00:29Z</timestamp></tuple>\r\n"
+		"<pdm:person id=\"p1\"><rpid:activities><rpid:on-the-phone/></rpid:activities><pdm:note>In a meeting</pdm:note></pdm:person>\r\n"
+		"</presence>",
+		IS_CLIENT_NO,
+		TOBE_LOST_NO
+	},
+	{
+		"200 NOTIFY (client -> server)",
+		"SIP/2.0 200 OK\r\n"
+		"Via: SIP/2.0/UDP 192.168.0.12:5060;branch=z9hG4bK3241039212;comp=sigcomp\r\n"
+		"From: <sip:bob@test.3gpp.com>;tag=3241039210\r\n"
+		"To: <sip:johndoe@test.3gpp.com>;tag=2106713218\r\n"
+		"Call-ID: 5e4a9f52-c4b7-4d6b-9f37-2d44ee0b6a2f\r\n"
+		"CSeq: 11 NOTIFY\r\n"
+		"Content-Length: 0\r\n"
+		"\r\n",
+		IS_CLIENT_YES,
+		TOBE_LOST_NO
+	},
+};
+
+typedef struct benchmark_corpus_s
+{
+	const sigcomp_test_t* tests;
+	tsk_size_t count;
+}
+benchmark_corpus_t;
+
+static const benchmark_corpus_t BENCHMARK_CORPUS[] =
+{
+	{ SIGCOMP_TESTS_CALL, sizeof(SIGCOMP_TESTS_CALL)/sizeof(SIGCOMP_TESTS_CALL[0]) },
+	{ SIGCOMP_TESTS_SUBSCRIBE, sizeof(SIGCOMP_TESTS_SUBSCRIBE)/sizeof(SIGCOMP_TESTS_SUBSCRIBE[0]) },
+	{ SIGCOMP_TESTS_PRESENCE, sizeof(SIGCOMP_TESTS_PRESENCE)/sizeof(SIGCOMP_TESTS_PRESENCE[0]) },
+};
+
+typedef struct benchmark_stats_s
+{
+	uint64_t msgs;
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+	uint64_t cycles;
+	uint64_t allocs;
+	uint64_t duration; /* milliseconds */
+}
+benchmark_stats_t;
+
+static tcomp_manager_handle_t* benchmark_manager_create(uint32_t dms)
+{
+	tcomp_manager_handle_t* manager = tcomp_manager_create();
+	if(manager){
+		tcomp_manager_addSipSdpDictionary(manager);
+		tcomp_manager_addPresenceDictionary(manager);
+		tcomp_manager_setDecompression_Memory_Size(manager, dms);
+		tcomp_manager_setCycles_Per_Bit(manager, SIGCOMP_CPB);
+		tcomp_manager_setState_Memory_Size(manager, SIGCOMP_SMS);
+		tcomp_manager_setUseOnlyACKedStates(manager, USE_ONLY_ACKED_STATES);
+	}
+	return manager;
+}
+
+static int benchmark_run(tsk_size_t compartments_count, uint32_t dms, benchmark_stats_t* stats)
+{
+	tsk_size_t i, j, k, round;
+	tsk_size_t outLen;
+	char comp_id_client[64], comp_id_server[64];
+	const sigcomp_test_t* test;
+	uint64_t start, allocs_start;
+	int ret = 0;
+
+	tcomp_manager_handle_t **clients = tsk_null, **servers = tsk_null;
+	tcomp_result_t *result_client = tsk_null, *result_server = tsk_null;
+
+	static char buff_client[MAX_BUFFER_SIZE];
+	static char buff_server[MAX_BUFFER_SIZE];
+
+	memset(stats, 0, sizeof(*stats));
+
+	clients = tsk_calloc(compartments_count, sizeof(tcomp_manager_handle_t*));
+	servers = tsk_calloc(compartments_count, sizeof(tcomp_manager_handle_t*));
+	if(!clients || !servers){
+		TSK_DEBUG_ERROR("Failed to allocate managers");
+		ret = -1;
+		goto bail;
+	}
+	for(j = 0; j < compartments_count; ++j){
+		if(!(clients[j] = benchmark_manager_create(dms)) || !(servers[j] = benchmark_manager_create(dms))){
+			TSK_DEBUG_ERROR("Failed to create managers");
+			ret = -1;
+			goto bail;
+		}
+	}
+	result_client = tcomp_result_create();
+	result_server = tcomp_result_create();
+
+	tcomp_result_setOutputBuffer(result_client, buff_client, sizeof(buff_client), IS_STREAM, STREAM_ID);
+	tcomp_result_setOutputBuffer(result_server, buff_server, sizeof(buff_server), IS_STREAM, STREAM_ID);
+
+	start = tsk_gettimeofday_ms();
+	allocs_start = tsk_memory_get_alloc_count();
+
+	for(round = 0; round < BENCHMARK_ROUNDS; ++round){
+		for(k = 0; k < sizeof(BENCHMARK_CORPUS)/sizeof(BENCHMARK_CORPUS[0]); ++k){
+			for(i = 0; i < BENCHMARK_CORPUS[k].count; ++i){
+				test = &BENCHMARK_CORPUS[k].tests[i];
+				for(j = 0; j < compartments_count; ++j){
+					tsk_bool_t server_decompress = test->is_client;
+					tcomp_manager_handle_t *compressor = test->is_client ? clients[j] : servers[j];
+					tcomp_manager_handle_t *decompressor = server_decompress ? servers[j] : clients[j];
+					tcomp_result_t* result = server_decompress ? result_server : result_client;
+
+					sprintf(comp_id_client, BENCHMARK_COMPARTMENT_ID_CLIENT, (unsigned)j);
+					sprintf(comp_id_server, BENCHMARK_COMPARTMENT_ID_SERVER, (unsigned)j);
+
+					// compress
+					outLen = tcomp_manager_compress(compressor,
+						test->is_client ? comp_id_client : comp_id_server,
+						tsk_strlen(test->is_client ? comp_id_client : comp_id_server),
+						test->msg,
+						tsk_strlen(test->msg),
+						test->is_client ? buff_client : buff_server,
+						test->is_client ? sizeof(buff_client) : sizeof(buff_server),
+						IS_STREAM);
+					++stats->msgs;
+					stats->bytes_in += tsk_strlen(test->msg);
+					if(!outLen){
+						TSK_DEBUG_ERROR("Failed to compress %s message (compartment=%u, dms=%u)", test->description, (unsigned)j, dms);
+						ret = -2;
+						goto bail;
+					}
+					stats->bytes_out += outLen;
+
+					// decompress
+					tcomp_result_setCompartmentId(result, server_decompress ? comp_id_server : comp_id_client, tsk_strlen(server_decompress ? comp_id_server : comp_id_client));
+					outLen = tcomp_manager_decompress(decompressor, server_decompress ? buff_client : buff_server, outLen, result);
+					stats->cycles += result->consumed_cycles;
+					if(!outLen){
+						TSK_DEBUG_ERROR("Failed to decompress %s message (compartment=%u, dms=%u)", test->description, (unsigned)j, dms);
+						ret = -3;
+						goto bail;
+					}
+					tcomp_manager_provideCompartmentId(decompressor, result); // save states
+				}
+			}
+		}
+	}
+
+	stats->duration = (tsk_gettimeofday_ms() - start);
+	stats->allocs = (tsk_memory_get_alloc_count() - allocs_start);
+
+bail:
+	for(j = 0; j < compartments_count; ++j){
+		sprintf(comp_id_client, BENCHMARK_COMPARTMENT_ID_CLIENT, (unsigned)j);
+		sprintf(comp_id_server, BENCHMARK_COMPARTMENT_ID_SERVER, (unsigned)j);
+		if(clients && clients[j]){
+			tcomp_manager_closeCompartment(clients[j], comp_id_client, tsk_strlen(comp_id_client));
+			TSK_OBJECT_SAFE_FREE(clients[j]);
+		}
+		if(servers && servers[j]){
+			tcomp_manager_closeCompartment(servers[j], comp_id_server, tsk_strlen(comp_id_server));
+			TSK_OBJECT_SAFE_FREE(servers[j]);
+		}
+	}
+	TSK_FREE(clients);
+	TSK_FREE(servers);
+
+	TSK_OBJECT_SAFE_FREE(result_client);
+	TSK_OBJECT_SAFE_FREE(result_server);
+
+	return ret;
+}
+
+static int test_benchmark()
+{
+	tsk_size_t i, j;
+	benchmark_stats_t stats;
+	int ret = 0;
+	int debug_level = tsk_debug_get_level();
+
+	tsk_debug_set_level(DEBUG_LEVEL_ERROR); // logging would dominate the measurements
+
+	printf("%12s %6s %10s %10s %12s %10s %12s %12s\n", "compartments", "dms", "msgs", "msgs/s", "bytes in", "saved(%)", "cycles/msg", "allocs/msg");
+	for(i = 0; i < sizeof(BENCHMARK_COMPARTMENTS)/sizeof(BENCHMARK_COMPARTMENTS[0]); ++i){
+		for(j = 0; j < sizeof(BENCHMARK_DMS)/sizeof(BENCHMARK_DMS[0]); ++j){
+			if((ret = benchmark_run(BENCHMARK_COMPARTMENTS[i], BENCHMARK_DMS[j], &stats)) != 0){
+				printf("FAILED: compartments=%u, dms=%u\n", (unsigned)BENCHMARK_COMPARTMENTS[i], (unsigned)BENCHMARK_DMS[j]);
+				goto bail;
+			}
+			printf("%12u %6u %10llu %10.0f %12llu %10.2f %12.0f ",
+				(unsigned)BENCHMARK_COMPARTMENTS[i],
+				(unsigned)BENCHMARK_DMS[j],
+				(unsigned long long)stats.msgs,
+				stats.duration ? ((double)stats.msgs * 1000.0) / (double)stats.duration : 0.0,
+				(unsigned long long)stats.bytes_in,
+				stats.bytes_in ? (100.0 - (((double)stats.bytes_out * 100.0) / (double)stats.bytes_in)) : 0.0,
+				stats.msgs ? ((double)stats.cycles / (double)stats.msgs) : 0.0);
+			if(TSK_MEMORY_STATS && stats.msgs){
+				printf("%12.1f\n", ((double)stats.allocs / (double)stats.msgs));
+			}
+			else{
+				printf("%12s\n", "n/a");
+			}
+		}
+	}
+
+bail:
+	tsk_debug_set_level(debug_level);
+
+	return ret;
+}
+
+#endif /* TEST_TINYSIGCOMP_BENCHMARK_H */
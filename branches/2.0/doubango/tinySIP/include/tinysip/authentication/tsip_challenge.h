@@ -71,6 +71,15 @@ typedef struct tsip_challenge_s
 
 	tsk_md5string_t cnonce;
 	unsigned nc;
+
+	/* HA1 and MD5 state after hashing "HA1:nonce:", reused until the credentials, realm, algorithm or nonce change */
+	struct{
+		tsk_bool_t ha1_valid;
+		char* password; /* password used to compute HA1 (owned by the stack and may be updated at any time) */
+		tsk_md5string_t ha1;
+		tsk_bool_t prefix_valid;
+		tsk_md5context_t prefix;
+	} cache;
 }
 tsip_challenge_t;
 
@@ -85,10 +85,8 @@ typedef struct tsip_transport_stream_peer_s
 	// list of dialogs managed by this peer
 	tsk_strings_L_t *dialogs_cids;
 
-	// temp buffers used to send/recv websocket data before (un)masking
+	// temp buffer used to frame websocket data before sending (received data is unmasked in place)
 	struct{
-		void* rcv_buffer;
-		uint64_t rcv_buffer_size;
 		void* snd_buffer;
 		uint64_t snd_buffer_size;
 		tsk_bool_t handshaking_done;
@@ -92,6 +92,11 @@ TSIP_BEGIN_DECLS
 //}
 //tsip_status_line_t;
 
+#define TSIP_MESSAGE_HTYPES_SIZE	4 /* 256 header types */
+/* Must be called each time a header is pushed into "headers" */
+#define TSIP_MESSAGE_HTYPE_SET(self, htype)		if((unsigned)(htype) < (TSIP_MESSAGE_HTYPES_SIZE << 6)) { (self)->htypes[((unsigned)(htype)) >> 6] |= (((uint64_t)1) << (((unsigned)(htype)) & 63)); }
+#define TSIP_MESSAGE_HTYPE_ISSET(self, htype)	(((unsigned)(htype) >= (TSIP_MESSAGE_HTYPES_SIZE << 6)) || ((self)->htypes[((unsigned)(htype)) >> 6] & (((uint64_t)1) << (((unsigned)(htype)) & 63))))
+
 /**
  * @struct	tsip_message_t
  *
@@ -140,6 +145,7 @@ typedef struct tsip_message_s
 
 	/*== OTHER HEADERS*/
 	tsip_headers_L_t *headers;
+	uint64_t htypes[TSIP_MESSAGE_HTYPES_SIZE]; /**< Bitmap of the types pushed into @a headers (never cleared), used to skip the lookup of missing headers. Must be updated using @ref TSIP_MESSAGE_HTYPE_SET. */
 
 	/*== to hack the message */
 	char* sigcomp_id;
@@ -218,35 +218,65 @@ bail:
 #undef SERVER_DATA
 }
 
-int tsip_challenge_get_response(tsip_challenge_t *self, const char* method, const char* uristring, const tsk_buffer_t* entity_body, tsk_md5string_t* response)
+/* Case-sensitive and null-safe comparison (passwords) */
+#define TSIP_CHALLENGE_STR_EQUALS(s1, s2) (((s1) && (s2)) ? !strcmp((s1), (s2)) : ((s1) == (s2)))
+
+static void _tsip_challenge_cache_reset(tsip_challenge_t *self)
 {
-	if(TSIP_CHALLENGE_IS_DIGEST(self) && self->stack){
-		tsk_md5string_t ha1, ha2;
-		nonce_count_t nc;
+	self->cache.ha1_valid = tsk_false;
+	self->cache.prefix_valid = tsk_false;
+}
 
-		/* ===
-			Calculate HA1 = MD5(A1) = M5(username:realm:secret)
-			In case of AKAv1-MD5 and AKAv2-MD5 the secret must be computed as per RFC 3310 + 3GPP TS 206/7/8/9.
-			The resulting AKA RES parameter is treated as a "password"/"secret" when calculating the response directive of RFC 2617.
-		*/
-		if(TSIP_CHALLENGE_IS_AKAv1(self) || TSIP_CHALLENGE_IS_AKAv2(self)){
-			char* akaresult = tsk_null;
-			tsip_challenge_get_akares(self, TSIP_CHALLENGE_STACK(self)->identity.password, &akaresult);
-			if(thttp_auth_digest_HA1(TSIP_CHALLENGE_USERNAME(self), self->realm, akaresult, &ha1)){
-				// return -1;
-			}
-			TSK_FREE(akaresult);
+/* Computes HA1 only if the credentials, realm, algorithm or nonce (AKA) changed since the previous request */
+static const tsk_md5string_t* _tsip_challenge_get_ha1(tsip_challenge_t *self)
+{
+	const char* password = TSIP_CHALLENGE_PASSWORD(self);
+	int ret = 0;
+
+	if(self->cache.ha1_valid && TSIP_CHALLENGE_STR_EQUALS(self->cache.password, password)){
+		return (const tsk_md5string_t*)&self->cache.ha1;
+	}
+	_tsip_challenge_cache_reset(self);
+
+	/* ===
+		Calculate HA1 = MD5(A1) = M5(username:realm:secret)
+		In case of AKAv1-MD5 and AKAv2-MD5 the secret must be computed as per RFC 3310 + 3GPP TS 206/7/8/9.
+		The resulting AKA RES parameter is treated as a "password"/"secret" when calculating the response directive of RFC 2617.
+	*/
+	if(TSIP_CHALLENGE_IS_AKAv1(self) || TSIP_CHALLENGE_IS_AKAv2(self)){
+		char* akaresult = tsk_null;
+		ret = tsip_challenge_get_akares(self, password, &akaresult);
+		thttp_auth_digest_HA1(TSIP_CHALLENGE_USERNAME(self), self->realm, akaresult, &self->cache.ha1);
+		TSK_FREE(akaresult);
+	}
+	else{
+		if(!tsk_strnullORempty(self->ha1_hexstr)){
+			// use HA1 provide be the user (e.g. webrtc2sip server will need this to authenticate INVITEs when acting as b2bua)
+			memset(self->cache.ha1, 0, sizeof(tsk_md5string_t));
+			memcpy(self->cache.ha1, self->ha1_hexstr, (TSK_MD5_DIGEST_SIZE << 1));
 		}
 		else{
-			if(!tsk_strnullORempty(self->ha1_hexstr)){
-				// use HA1 provide be the user (e.g. webrtc2sip server will need this to authenticate INVITEs when acting as b2bua)
-				memset(ha1, 0, sizeof(tsk_md5string_t));
-				memcpy(ha1, self->ha1_hexstr, (TSK_MD5_DIGEST_SIZE << 1));
-			}
-			else{
-				thttp_auth_digest_HA1(TSIP_CHALLENGE_USERNAME(self), self->realm, TSIP_CHALLENGE_STACK(self)->identity.password, &ha1);
-			}
+			ret = thttp_auth_digest_HA1(TSIP_CHALLENGE_USERNAME(self), self->realm, password, &self->cache.ha1);
 		}
+	}
+
+	if(ret == 0){ // failures are not cached: the next request will retry
+		tsk_strupdate(&self->cache.password, password);
+		self->cache.ha1_valid = tsk_true;
+	}
+	return (const tsk_md5string_t*)&self->cache.ha1;
+}
+
+int tsip_challenge_get_response(tsip_challenge_t *self, const char* method, const char* uristring, const tsk_buffer_t* entity_body, tsk_md5string_t* response)
+{
+	if(TSIP_CHALLENGE_IS_DIGEST(self) && self->stack){
+		const tsk_md5string_t *ha1;
+		tsk_md5string_t ha2;
+		tsk_md5context_t ctx;
+		tsk_md5digest_t digest;
+		nonce_count_t nc = { 0 };
+
+		ha1 = _tsip_challenge_get_ha1(self);
 
 		/* ===
 			HA2 
@@ -257,17 +287,31 @@ int tsip_challenge_get_response(tsip_challenge_t *self, const char* method, cons
 			self->qop,
 			&ha2);
 
-		/* RESPONSE */
-		if(self->nc){
-			THTTP_NCOUNT_2_STRING(self->nc, nc);
+		/* RESPONSE: same as thttp_auth_digest_response() but "HA1:nonce:" is only hashed once per challenge */
+		if(!self->cache.prefix_valid){
+			tsk_md5init(&self->cache.prefix);
+			tsk_md5update(&self->cache.prefix, (const uint8_t*)*ha1, TSK_MD5_STRING_SIZE);
+			tsk_md5update(&self->cache.prefix, (const uint8_t*)":", 1);
+			tsk_md5update(&self->cache.prefix, (const uint8_t*)self->nonce, tsk_strlen(self->nonce));
+			tsk_md5update(&self->cache.prefix, (const uint8_t*)":", 1);
+			self->cache.prefix_valid = self->cache.ha1_valid;
 		}
-		thttp_auth_digest_response((const tsk_md5string_t *)&ha1, 
-			self->nonce,
-			nc,
-			self->cnonce,
-			self->qop,
-			(const tsk_md5string_t *)&ha2,
-			response);
+		ctx = self->cache.prefix;
+		if(self->qop){ /* "auth" or "auth-int" */
+			if(self->nc){
+				THTTP_NCOUNT_2_STRING(self->nc, nc);
+			}
+			tsk_md5update(&ctx, (const uint8_t*)nc, strlen(nc));
+			tsk_md5update(&ctx, (const uint8_t*)":", 1);
+			tsk_md5update(&ctx, (const uint8_t*)self->cnonce, tsk_strlen(self->cnonce));
+			tsk_md5update(&ctx, (const uint8_t*)":", 1);
+			tsk_md5update(&ctx, (const uint8_t*)self->qop, tsk_strlen(self->qop));
+			tsk_md5update(&ctx, (const uint8_t*)":", 1);
+		}
+		tsk_md5update(&ctx, (const uint8_t*)ha2, TSK_MD5_STRING_SIZE);
+		tsk_md5final(digest, &ctx);
+		tsk_str_from_hex(digest, TSK_MD5_DIGEST_SIZE, *response);
+		(*response)[TSK_MD5_STRING_SIZE] = '\0';
 		
 		if(self->qop){
 			self->nc++;
@@ -283,6 +327,10 @@ int tsip_challenge_update(tsip_challenge_t *self, const char* scheme, const char
 	if(self){
 		int noncechanged = !tsk_striequals(self->nonce, nonce);
 
+		if(!TSIP_CHALLENGE_STR_EQUALS(self->nonce, nonce) || !TSIP_CHALLENGE_STR_EQUALS(self->realm, realm) || !tsk_striequals(self->algorithm, algorithm)){
+			_tsip_challenge_cache_reset(self);
+		}
+
 		tsk_strupdate(&self->scheme, scheme);
 		tsk_strupdate(&self->realm, realm);
 		tsk_strupdate(&self->nonce, nonce);
@@ -309,6 +357,7 @@ int tsip_challenge_set_cred(tsip_challenge_t *self, const char* username, const
 	}
 	tsk_strupdate(&self->username, username);
 	tsk_strupdate(&self->ha1_hexstr, ha1_hexstr);
+	_tsip_challenge_cache_reset(self);
 	return 0;
 }
 
@@ -459,6 +508,7 @@ static tsk_object_t* tsip_challenge_dtor(tsk_object_t *self)
 		TSK_FREE(challenge->opaque);
 		TSK_FREE(challenge->algorithm);
 		TSK_FREE(challenge->ha1_hexstr);
+		TSK_FREE(challenge->cache.password);
 	}
 	else{
 		TSK_DEBUG_ERROR("Null SIP challenge object.");
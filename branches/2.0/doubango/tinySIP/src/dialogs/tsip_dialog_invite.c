@@ -309,27 +309,33 @@ tsip_dialog_invite_t* tsip_dialog_invite_create(const tsip_ssession_handle_t* ss
 	return tsk_object_new(tsip_dialog_invite_def_t,  ss, call_id);
 }
 
-int tsip_dialog_invite_init(tsip_dialog_invite_t *self)
+/* Transitions shared by all the INVITE dialogs (built once) */
+static tsk_fsm_table_t* __tsip_dialog_invite_fsm_table = tsk_null;
+
+/* Adds the special cases (they should be tried first) */
+static int _tsip_dialog_invite_fsm_prepare(tsk_fsm_t* fsm, const void* self)
 {
-	/* special cases (fsm) should be tried first */
-	
 	/* ICE */
-	tsip_dialog_invite_ice_init(self);
+	tsip_dialog_invite_ice_init((tsip_dialog_invite_t*)self);
 	/* Client-Side dialog */
-	 tsip_dialog_invite_client_init(self);
+	 tsip_dialog_invite_client_init((tsip_dialog_invite_t*)self);
 	/* Server-Side dialog */
-	tsip_dialog_invite_server_init(self);
+	tsip_dialog_invite_server_init((tsip_dialog_invite_t*)self);
 	/* 3GPP TS 24.610: Communication Hold  */
-	tsip_dialog_invite_hold_init(self);
+	tsip_dialog_invite_hold_init((tsip_dialog_invite_t*)self);
 	/* 3GPP TS 24.629: Explicit Communication Transfer (ECT) using IP Multimedia (IM) Core Network (CN) subsystem */
-	tsip_dialog_invite_ect_init(self);
+	tsip_dialog_invite_ect_init((tsip_dialog_invite_t*)self);
 	/* RFC 4028: Session Timers */
-	tsip_dialog_invite_stimers_init(self);
+	tsip_dialog_invite_stimers_init((tsip_dialog_invite_t*)self);
 	/* RFC 3312: Integration of Resource Management and Session Initiation Protocol (SIP) */
-	tsip_dialog_invite_qos_init(self);
-	
+	tsip_dialog_invite_qos_init((tsip_dialog_invite_t*)self);
+	return 0;
+}
+
+int tsip_dialog_invite_init(tsip_dialog_invite_t *self)
+{
 	/* Initialize the state machine (all other cases) */
-	tsk_fsm_set(TSIP_DIALOG_GET_FSM(self),
+	tsk_fsm_set_shared_2(TSIP_DIALOG_GET_FSM(self), &__tsip_dialog_invite_fsm_table, _tsip_dialog_invite_fsm_prepare, self,
 	
 		/*=======================
 		* === Started === 
@@ -1401,6 +1407,7 @@ int send_CANCEL(tsip_dialog_invite_t *self)
 						if(!cancel->headers){
 							cancel->headers = tsk_list_create();
 						}
+						TSIP_MESSAGE_HTYPE_SET(cancel, header->type);
 						tsk_list_push_back_data(cancel->headers, (void**)&header);
 						break;
                     default: break;
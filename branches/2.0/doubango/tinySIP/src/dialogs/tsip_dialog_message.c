@@ -155,12 +155,15 @@ tsip_dialog_message_t* tsip_dialog_message_create(const tsip_ssession_handle_t*
 	return tsk_object_new(tsip_dialog_message_def_t, ss);
 }
 
+/* Transitions shared by all the MESSAGE dialogs (built once) */
+static tsk_fsm_table_t* __tsip_dialog_message_fsm_table = tsk_null;
+
 int tsip_dialog_message_init(tsip_dialog_message_t *self)
 {
 	//const tsk_param_t* param;
 
 	/* Initialize the state machine. */
-	tsk_fsm_set(TSIP_DIALOG_GET_FSM(self),
+	tsk_fsm_set_shared(TSIP_DIALOG_GET_FSM(self), &__tsip_dialog_message_fsm_table,
 			
 			/*=======================
 			* === Started === 
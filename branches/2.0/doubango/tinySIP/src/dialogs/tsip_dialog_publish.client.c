@@ -220,6 +220,9 @@ tsip_dialog_publish_t* tsip_dialog_publish_create(const tsip_ssession_handle_t*
 	return tsk_object_new(tsip_dialog_publish_def_t, ss);
 }
 
+/* Transitions shared by all the PUBLISH dialogs (built once) */
+static tsk_fsm_table_t* __tsip_dialog_publish_fsm_table = tsk_null;
+
 /**
  * Initializes the dialog.
  *
@@ -228,7 +231,7 @@ tsip_dialog_publish_t* tsip_dialog_publish_create(const tsip_ssession_handle_t*
 int tsip_dialog_publish_init(tsip_dialog_publish_t *self)
 {	
 	/* Initialize the State Machine. */
-	tsk_fsm_set(TSIP_DIALOG_GET_FSM(self),
+	tsk_fsm_set_shared(TSIP_DIALOG_GET_FSM(self), &__tsip_dialog_publish_fsm_table,
 			
 			/*=======================
 			* === Started === 
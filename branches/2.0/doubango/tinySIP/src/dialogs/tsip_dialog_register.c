@@ -170,19 +170,27 @@ tsip_dialog_register_t* tsip_dialog_register_create(const tsip_ssession_handle_t
 }
 
 
+/* Transitions shared by all the REGISTER dialogs (built once) */
+static tsk_fsm_table_t* __tsip_dialog_register_fsm_table = tsk_null;
+
+/* Adds the client and server sides (tried before the common side) */
+static int _tsip_dialog_register_fsm_prepare(tsk_fsm_t* fsm, const void* self)
+{
+	// Initialize client side
+	tsip_dialog_register_client_init((tsip_dialog_register_t*)self);
+	// initialize server side
+	tsip_dialog_register_server_init((tsip_dialog_register_t*)self);
+	return 0;
+}
+
 /** Initializes the dialog.
  *
  * @param [in,out]	self	The dialog to initialize. 
 **/
 int tsip_dialog_register_init(tsip_dialog_register_t *self)
 {
-	// Initialize client side
-	tsip_dialog_register_client_init(self);
-	// initialize server side
-	tsip_dialog_register_server_init(self);
-	
 	/* Initialize common side */
-	tsk_fsm_set(TSIP_DIALOG_GET_FSM(self),
+	tsk_fsm_set_shared_2(TSIP_DIALOG_GET_FSM(self), &__tsip_dialog_register_fsm_table, _tsip_dialog_register_fsm_prepare, self,
 			
 			/*=======================
 			* === Any === 
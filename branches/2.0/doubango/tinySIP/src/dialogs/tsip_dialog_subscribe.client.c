@@ -241,6 +241,9 @@ tsip_dialog_subscribe_t* tsip_dialog_subscribe_create(const tsip_ssession_handle
 	return tsk_object_new(tsip_dialog_subscribe_def_t, ss);
 }
 
+/* Transitions shared by all the SUBSCRIBE dialogs (built once) */
+static tsk_fsm_table_t* __tsip_dialog_subscribe_fsm_table = tsk_null;
+
 /**	Initializes the dialog.
  *
  * @param [in,out]	self	The dialog to initialize. 
@@ -248,7 +251,7 @@ tsip_dialog_subscribe_t* tsip_dialog_subscribe_create(const tsip_ssession_handle
 int tsip_dialog_subscribe_init(tsip_dialog_subscribe_t *self)
 {	
 	/* Initialize the State Machine. */
-	tsk_fsm_set(TSIP_DIALOG_GET_FSM(self),
+	tsk_fsm_set_shared(TSIP_DIALOG_GET_FSM(self), &__tsip_dialog_subscribe_fsm_table,
 			
 			/*=======================
 			* === Started === 
@@ -44,6 +44,7 @@
 		const tsk_list_item_t *item;\
 		tsk_list_foreach(item, headers){\
 			tsip_header_t *hdr = tsk_object_ref((void*)item->data);\
+			TSIP_MESSAGE_HTYPE_SET(message, hdr->type);\
 			tsk_list_push_back_data(message->headers, ((void**) &hdr));\
 		}\
 		\
@@ -52,6 +53,7 @@
 #define ADD_HEADER(header)\
 	if(header)\
 	{\
+		TSIP_MESSAGE_HTYPE_SET(message, TSIP_HEADER(header)->type);\
 		tsk_list_push_back_data(message->headers, ((void**) &header));\
 	}
 
@@ -5680,6 +5682,7 @@ _match:
 					message->Contact = hdr;
 				}
 				else{
+					TSIP_MESSAGE_HTYPE_SET(message, TSIP_HEADER(hdr)->type);
 					tsk_list_push_back_data(message->headers, ((void**) &hdr));
 				}
 			}
@@ -6304,6 +6307,7 @@ _match:
 					message->firstVia = hdr;
 				}
 				else{
+					TSIP_MESSAGE_HTYPE_SET(message, TSIP_HEADER(hdr)->type);
 					tsk_list_push_back_data(message->headers, ((void**) &hdr));
 				}
 			}
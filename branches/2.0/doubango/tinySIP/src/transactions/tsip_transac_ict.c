@@ -85,6 +85,9 @@
 
 #define TRANSAC_ICT_TIMER_SCHEDULE(TX)			TRANSAC_TIMER_SCHEDULE(ict, TX)
 
+/* Transitions shared by all the ICTs (built once) */
+static tsk_fsm_table_t* __tsip_transac_ict_fsm_table = tsk_null;
+
 /* ======================== internal functions ======================== */
 int tsip_transac_ict_init(tsip_transac_ict_t *self);
 int tsip_transac_ict_send_ACK(tsip_transac_ict_t *self, const tsip_response_t* response); // ACK
@@ -240,7 +243,7 @@ int tsip_transac_ict_timer_callback(const tsip_transac_ict_t* self, tsk_timer_id
 int tsip_transac_ict_init(tsip_transac_ict_t *self)
 {
 	/* Initialize the state machine. */
-	tsk_fsm_set(TSIP_TRANSAC_GET_FSM(self),
+	tsk_fsm_set_shared(TSIP_TRANSAC_GET_FSM(self), &__tsip_transac_ict_fsm_table,
 			
 			/*=======================
 			* === Started === 
@@ -238,11 +238,14 @@ int tsip_transac_ist_timer_callback(const tsip_transac_ist_t* self, tsk_timer_id
 	return ret;
 }
 
+/* Transitions shared by all the ISTs (built once) */
+static tsk_fsm_table_t* __tsip_transac_ist_fsm_table = tsk_null;
+
 int tsip_transac_ist_init(tsip_transac_ist_t *self)
 {
 	/* Initialize the state machine.
 	*/
-	tsk_fsm_set(TSIP_TRANSAC_GET_FSM(self),
+	tsk_fsm_set_shared(TSIP_TRANSAC_GET_FSM(self), &__tsip_transac_ist_fsm_table,
 			
 			/*=======================
 			* === Started === 
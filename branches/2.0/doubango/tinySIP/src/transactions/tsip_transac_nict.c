@@ -203,6 +203,9 @@ int tsip_transac_nict_timer_callback(const tsip_transac_nict_t* self, tsk_timer_
 	return ret;
 }
 
+/* Transitions shared by all the NICTs (built once) */
+static tsk_fsm_table_t* __tsip_transac_nict_fsm_table = tsk_null;
+
 /** Initializes the transaction.
  *
  * @author	Mamadou
@@ -213,7 +216,7 @@ int tsip_transac_nict_timer_callback(const tsip_transac_nict_t* self, tsk_timer_
 int tsip_transac_nict_init(tsip_transac_nict_t *self)
 {
 	/* Initialize the state machine. */
-	tsk_fsm_set(TSIP_TRANSAC_GET_FSM(self),
+	tsk_fsm_set_shared(TSIP_TRANSAC_GET_FSM(self), &__tsip_transac_nict_fsm_table,
 			
 			/*=======================
 			* === Started === 
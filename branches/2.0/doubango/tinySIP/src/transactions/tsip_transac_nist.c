@@ -84,6 +84,9 @@
 		self->lastResponse = tsk_object_ref((void*)response); \
 	}
 
+/* Transitions shared by all the NISTs (built once) */
+static tsk_fsm_table_t* __tsip_transac_nist_fsm_table = tsk_null;
+
 /* ======================== internal functions ======================== */
 int tsip_transac_nist_init(tsip_transac_nist_t *self);
 int tsip_transac_nist_OnTerminated(tsip_transac_nist_t *self);
@@ -194,7 +197,7 @@ int tsip_transac_nist_init(tsip_transac_nist_t *self)
 {
 	/* Initialize the state machine.
 	*/
-	tsk_fsm_set(TSIP_TRANSAC_GET_FSM(self),
+	tsk_fsm_set_shared(TSIP_TRANSAC_GET_FSM(self), &__tsip_transac_nist_fsm_table,
 			
 			/*=======================
 			* === Started === 
@@ -1070,8 +1070,6 @@ static tsk_object_t* tsip_transport_stream_peer_dtor(tsk_object_t * self)
 		TSK_OBJECT_SAFE_FREE(peer->rcv_buff_stream);
 		TSK_OBJECT_SAFE_FREE(peer->snd_buff_stream);
 		
-		TSK_SAFE_FREE(peer->ws.rcv_buffer);
-		peer->ws.rcv_buffer_size = 0;
 		TSK_SAFE_FREE(peer->ws.snd_buffer);
 		peer->ws.snd_buffer_size = 0;
 
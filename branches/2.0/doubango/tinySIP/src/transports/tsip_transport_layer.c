@@ -350,6 +350,8 @@ static int tsip_transport_layer_ws_cb(const tnet_transport_event_t* e)
 	tsk_bool_t go_message = tsk_false;
 	uint64_t data_len = 0;
 	uint64_t pay_len = 0;
+	const uint8_t* pay_ptr = tsk_null;
+	tsk_size_t consumed = 0; // processed bytes, removed from the stream buffer only once, when leaving
 	tsip_transport_stream_peer_t* peer;
 
 	switch(e->type){
@@ -413,14 +415,15 @@ static int tsip_transport_layer_ws_cb(const tnet_transport_event_t* e)
 
 	/* Check if we have all HTTP/SIP/WS headers. */
 parse_buffer:
-	if(check_end_of_hdrs && (endOfheaders = tsk_strindexOf(TSK_BUFFER_DATA(peer->rcv_buff_stream),TSK_BUFFER_SIZE(peer->rcv_buff_stream), "\r\n\r\n"/*2CRLF*/)) < 0){
+	if(check_end_of_hdrs && (endOfheaders = tsk_strindexOf(((const char*)TSK_BUFFER_DATA(peer->rcv_buff_stream)) + consumed, (TSK_BUFFER_SIZE(peer->rcv_buff_stream) - consumed), "\r\n\r\n"/*2CRLF*/)) < 0){
 		TSK_DEBUG_INFO("No all headers in the WS buffer");
 		goto bail;
 	}
 
 	/* WebSocket handling*/
-	if(peer->rcv_buff_stream->size > 4){
-		const uint8_t* pdata = (const uint8_t*)peer->rcv_buff_stream->data;
+	if((peer->rcv_buff_stream->size - consumed) > 4){
+		uint8_t* pdata = ((uint8_t*)peer->rcv_buff_stream->data) + consumed;
+		const tsk_size_t avail = (peer->rcv_buff_stream->size - consumed);
 
 		/* WebSocket Handshake */
 		if(pdata[0] == 'G' && pdata[1] == 'E' && pdata[2] == 'T'){
@@ -429,8 +432,8 @@ parse_buffer:
 			tsk_buffer_t *http_buff = tsk_null;
 			const thttp_header_Sec_WebSocket_Protocol_t* http_hdr_proto;
 			const thttp_header_Sec_WebSocket_Key_t* http_hdr_key;
-			const char* msg_start = (const char*)peer->rcv_buff_stream->data;
-			const char* msg_end = (msg_start + peer->rcv_buff_stream->size);
+			const char* msg_start = (const char*)pdata;
+			const char* msg_end = (msg_start + avail);
 			int32_t idx;
 
 			if((idx = tsk_strindexOf(msg_start, (msg_end - msg_start), "\r\n")) > 2){
@@ -506,7 +509,7 @@ parse_buffer:
 				goto bail;
 			}
 			
-			tsk_buffer_remove(peer->rcv_buff_stream, 0, (endOfheaders + 4/*2CRLF*/)); /* Remove HTTP headers and CRLF */
+			consumed += (endOfheaders + 4/*2CRLF*/); /* Remove HTTP headers and CRLF */
 			TSK_OBJECT_SAFE_FREE(http_req);
 			TSK_OBJECT_SAFE_FREE(http_resp);
 			TSK_OBJECT_SAFE_FREE(http_buff);
@@ -518,8 +521,6 @@ parse_buffer:
 			if((pdata[0] & 0x01)/* FIN */){
 				const uint8_t mask_flag = (pdata[1] >> 7); // Must be "1" for "client -> server"
 				uint8_t mask_key[4] = { 0x00 };
-				uint64_t pay_idx;
-				uint8_t* pws_rcv_buffer;
 
 				if(pdata[0] & 0x40 || pdata[0] & 0x20 || pdata[0] & 0x10){
 					TSK_DEBUG_ERROR("Unknown extension: %d", (pdata[0] >> 4) & 0x07);
@@ -531,14 +532,14 @@ parse_buffer:
 				data_len = 2;
 				
 				if(pay_len == 126){
-					if(peer->rcv_buff_stream->size < 4) { TSK_DEBUG_WARN("Too short"); goto bail; }
+					if(avail < 4) { TSK_DEBUG_WARN("Too short"); goto bail; }
 					pay_len = (pdata[2] << 8 | pdata[3]);
 					pdata = &pdata[4];
 					data_len += 2;
 				}
 				else if(pay_len == 127){
-					if((peer->rcv_buff_stream->size - data_len) < 8) { TSK_DEBUG_WARN("Too short"); goto bail; }
-					pay_len = (((uint64_t)pdata[2]) << 56 | ((uint64_t)pdata[3]) << 48 | ((uint64_t)pdata[4]) << 40 | ((uint64_t)pdata[5]) << 32 | ((uint64_t)pdata[6]) << 24 | ((uint64_t)pdata[7]) << 16 | ((uint64_t)pdata[8]) << 8 || ((uint64_t)pdata[9]));
+					if((avail - data_len) < 8) { TSK_DEBUG_WARN("Too short"); goto bail; }
+					pay_len = (((uint64_t)pdata[2]) << 56 | ((uint64_t)pdata[3]) << 48 | ((uint64_t)pdata[4]) << 40 | ((uint64_t)pdata[5]) << 32 | ((uint64_t)pdata[6]) << 24 | ((uint64_t)pdata[7]) << 16 | ((uint64_t)pdata[8]) << 8 | ((uint64_t)pdata[9]));
 					pdata = &pdata[10];
 					data_len += 8;
 				}
@@ -547,7 +548,7 @@ parse_buffer:
 				}
 
 				if(mask_flag){ // must be "true"
-					if((peer->rcv_buff_stream->size - data_len) < 4) { TSK_DEBUG_WARN("Too short"); goto bail; }
+					if((avail - data_len) < 4) { TSK_DEBUG_WARN("Too short"); goto bail; }
 					mask_key[0] = pdata[0];
 					mask_key[1] = pdata[1];
 					mask_key[2] = pdata[2];
@@ -556,28 +557,18 @@ parse_buffer:
 					data_len += 4;
 				}
 				
-				if((peer->rcv_buff_stream->size - data_len) < pay_len){
+				if((avail - data_len) < pay_len){
 					TSK_DEBUG_INFO("No all data in the WS buffer");
 					goto bail;
 				}
 
-				// create ws buffer tohold unmasked data
-				if(peer->ws.rcv_buffer_size < pay_len){
-					if(!(peer->ws.rcv_buffer = tsk_realloc(peer->ws.rcv_buffer, (tsk_size_t)pay_len))){
-						TSK_DEBUG_ERROR("Failed to allocate buffer of size %lld", pay_len);
-						peer->ws.rcv_buffer_size = 0;
-						goto bail;
-					}
-					peer->ws.rcv_buffer_size = (tsk_size_t)pay_len;
-				}
-
-				pws_rcv_buffer = (uint8_t*)peer->ws.rcv_buffer;
 				data_len += pay_len;
 
-				// unmasking the payload
-				for(pay_idx = 0; pay_idx < pay_len; ++pay_idx){
-					pws_rcv_buffer[pay_idx] = (pdata[pay_idx] ^ mask_key[(pay_idx & 3)]);
+				// unmasking the payload in place (the frame is consumed once parsed)
+				if(mask_flag){
+					thttp_auth_ws_unmask(pdata, pdata, (tsk_size_t)pay_len, mask_key);
 				}
+				pay_ptr = pdata;
 				
 				go_message = tsk_true;
 			}
@@ -596,16 +587,16 @@ parse_buffer:
 	
 	// If we are there this mean that we have all SIP headers.
 	//	==> Parse the SIP message without the content.
-	TSK_DEBUG_INFO("Receiving SIP o/ WebSocket message: %.*s", pay_len, (const char*)peer->ws.rcv_buffer);
-	tsk_ragel_state_init(&state, peer->ws.rcv_buffer, (tsk_size_t)pay_len);
+	TSK_DEBUG_INFO("Receiving SIP o/ WebSocket message: %.*s", (int)pay_len, (const char*)pay_ptr);
+	tsk_ragel_state_init(&state, (const char*)pay_ptr, (tsk_size_t)pay_len);
 	if (tsip_message_parse(&state, &message, tsk_false/* do not extract the content */) == tsk_true) {
 		const uint8_t* body_start = (const uint8_t*)state.eoh;
-		int64_t clen = (pay_len - (int64_t)(body_start - ((const uint8_t*)peer->ws.rcv_buffer)));
+		int64_t clen = (pay_len - (int64_t)(body_start - pay_ptr));
 		if (clen > 0) {
 			// Add the content to the message. */
 			tsip_message_add_content(message, tsk_null, body_start, (tsk_size_t)clen);
 		}
-		tsk_buffer_remove(peer->rcv_buff_stream, 0, (tsk_size_t)data_len);
+		consumed += (tsk_size_t)data_len;
 	}
 
 	if(message && message->firstVia && message->Call_ID && message->CSeq && message->From && message->To){
@@ -617,9 +608,10 @@ parse_buffer:
 		/* Alert transaction/dialog layer */
 		ret = tsip_transport_layer_handle_incoming_msg(transport, message);
 		/* Parse next chunck */
-		if(TSK_BUFFER_SIZE(peer->rcv_buff_stream) >= TSIP_MIN_STREAM_CHUNCK_SIZE){
+		if((TSK_BUFFER_SIZE(peer->rcv_buff_stream) - consumed) >= TSIP_MIN_STREAM_CHUNCK_SIZE){
 			/* message already passed to the dialog/transac layers */
 			TSK_OBJECT_SAFE_FREE(message);
+			go_message = tsk_false;
 			goto parse_buffer;
 		}
 	}
@@ -631,6 +623,9 @@ parse_buffer:
 	}
 
 bail:
+	if(consumed && TSK_BUFFER_SIZE(peer->rcv_buff_stream)){ // buffer could have been cleaned up on error
+		tsk_buffer_remove(peer->rcv_buff_stream, 0, TSK_MIN(consumed, TSK_BUFFER_SIZE(peer->rcv_buff_stream)));
+	}
 	TSK_OBJECT_SAFE_FREE(message);
 	TSK_OBJECT_SAFE_FREE(peer);
 
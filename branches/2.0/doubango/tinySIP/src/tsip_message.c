@@ -113,6 +113,7 @@ int	tsip_message_add_header(tsip_message_t *self, const tsip_header_t *hdr)
 			default: break;
 		}
 
+		TSIP_MESSAGE_HTYPE_SET(self, header->type);
 		tsk_list_push_back_data(self->headers, (void**)&header);
 
 		return 0;
@@ -222,6 +223,10 @@ const tsip_header_t *tsip_message_get_headerAt(const tsip_message_t *self, tsip_
 			break;
 		}
 
+		if(!TSIP_MESSAGE_HTYPE_ISSET(self, type)){ /* never added */
+			goto bail;
+		}
+
 		tsk_list_foreach(item, self->headers){
 			if(!__pred_find_header_by_type(item, &type)){
 				if(pos++ >= index){